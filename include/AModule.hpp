@@ -1,12 +1,12 @@
 #pragma once
 
-#include <glibmm/dispatcher.h>
 #include <glibmm/markup.h>
 #include <gtkmm.h>
 #include <gtkmm/eventbox.h>
 #include <json/json.h>
 
 #include "IModule.hpp"
+#include "util/dispatcher.hpp"
 
 namespace waybar {
 
@@ -21,7 +21,7 @@ class AModule : public IModule {
   auto doAction(const std::string &name) -> void override;
 
   /// Emitting on this dispatcher triggers a update() call
-  Glib::Dispatcher dp;
+  util::Dispatcher dp;
 
   bool expandEnabled() const;
 
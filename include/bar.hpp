@@ -15,6 +15,7 @@
 #include "AModule.hpp"
 #include "group.hpp"
 #include "util/kill_signal.hpp"
+#include "util/update_batcher.hpp"
 #include "xdg-output-unstable-v1-client-protocol.h"
 
 namespace waybar {
@@ -72,6 +73,12 @@ class Bar : public sigc::trackable {
   void show();
   void hide();
   void handleSignal(int);
+  /**
+   * Apply a new config in place. Modules whose config subtree is unchanged are kept alive and only
+   * moved to their new position, the others are rebuilt.
+   * Returns false if bar options changed, the bar has to be recreated then.
+   */
+  bool reload(const Json::Value &config);
   util::KillSignalAction getOnSigusr1Action();
   util::KillSignalAction getOnSigusr2Action();
 
@@ -93,9 +100,20 @@ class Bar : public sigc::trackable {
  private:
   void onMap(GdkEventAny *);
   auto setupWidgets() -> void;
-  void getModules(const Factory &, const std::string &, waybar::Group *);
-  void setupAltFormatKeyForModule(const std::string &module_name);
-  void setupAltFormatKeyForModuleList(const char *module_list_name);
+  /// A module of a modules-* list, with the children of a group after it
+  struct ModuleSlot {
+    std::string pos;
+    std::string ref;
+    std::vector<std::shared_ptr<waybar::AModule>> modules;
+  };
+
+  void getModules(const Factory &, const std::string &);
+  AModule *createModule(const Factory &, const std::string &ref, const std::string &pos,
+                        bool vertical, std::vector<std::shared_ptr<AModule>> &owned);
+  void rebuildModuleLists();
+  void packModules();
+  static void setupAltFormatKeyForModule(Json::Value &config, const std::string &module_name);
+  static void setupAltFormatKeyForModuleList(Json::Value &config, const char *module_list_name);
   void setMode(const bar_mode &);
   void setPassThrough(bool passthrough);
   void setPosition(Gtk::PositionType position);
@@ -115,6 +133,7 @@ class Bar : public sigc::trackable {
   Gtk::Box center_;
   Gtk::Box right_;
   Gtk::Box box_;
+  util::UpdateBatcher update_batcher_;
   std::vector<std::shared_ptr<waybar::AModule>> modules_left_;
   std::vector<std::shared_ptr<waybar::AModule>> modules_center_;
   std::vector<std::shared_ptr<waybar::AModule>> modules_right_;
@@ -123,6 +142,7 @@ class Bar : public sigc::trackable {
   std::unique_ptr<BarIpcClient> _ipc_client;
 #endif
   std::vector<std::shared_ptr<waybar::AModule>> modules_all_;
+  std::vector<ModuleSlot> module_slots_;
 
   waybar::util::KillSignalAction onSigusr1 = util::SIGNALACTION_DEFAULT_SIGUSR1;
   waybar::util::KillSignalAction onSigusr2 = util::SIGNALACTION_DEFAULT_SIGUSR2;
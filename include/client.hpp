@@ -20,6 +20,12 @@ class Client {
   static Client *inst();
   int main(int argc, char *argv[]);
   void reset();
+  /**
+   * Reload the config file without restarting: bars are updated in place when only their
+   * modules changed, and only the modules whose config changed are rebuilt.
+   * Returns false if that failed and a full restart is needed.
+   */
+  bool reload();
 
   Glib::RefPtr<Gtk::Application> gtk_app;
   Glib::RefPtr<Gdk::Display> gdk_display;
@@ -37,6 +43,8 @@ class Client {
   void bindInterfaces();
   void handleOutput(struct waybar_output &output);
   auto setupCss(const std::string &css_file) -> void;
+  void setupStyle();
+  void removeBar(std::unique_ptr<Bar> bar);
   struct waybar_output &getOutput(void *);
   std::vector<Json::Value> getOutputConfigs(struct waybar_output &output);
 
@@ -56,6 +64,8 @@ class Client {
   std::list<struct waybar_output> outputs_;
   std::unique_ptr<CssReloadHelper> m_cssReloadHelper;
   std::string m_cssFile;
+  std::string config_opt_;
+  std::string style_opt_;
 };
 
 }  // namespace waybar
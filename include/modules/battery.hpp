@@ -14,7 +14,10 @@
 
 #include "ALabel.hpp"
 #include "bar.hpp"
-#include "util/sleeper_thread.hpp"
+#if defined(__linux__)
+#include "util/reactor.hpp"
+#endif
+#include "util/shared_producer.hpp"
 
 namespace waybar::modules {
 
@@ -23,34 +26,59 @@ namespace fs = std::filesystem;
 class Battery : public ALabel {
  public:
   Battery(const std::string&, const waybar::Bar&, const Json::Value&);
-  virtual ~Battery();
+  virtual ~Battery() = default;
   auto update() -> void override;
 
  private:
-  static inline const fs::path data_dir_ = "/sys/class/power_supply/";
+  struct Sample {
+    bool present;
+    uint8_t capacity;
+    float time_remaining;
+    std::string status;
+    float power;
+    uint16_t cycles;
+    float health;
+  };
+
+  /// Watches the power supplies and reads them on behalf of the instances of every bar
+  class Source {
+   public:
+    Source(const Json::Value& config, util::SharedProducer<Sample>& producer);
+    ~Source();
+    Sample sample();
+
+   private:
+    static inline const fs::path data_dir_ = "/sys/class/power_supply/";
+
+    void refreshBatteries();
+    void worker();
+    const std::string getAdapterStatus(uint8_t capacity) const;
+    std::tuple<uint8_t, float, std::string, float, uint16_t, float> getInfos();
+
+    const Json::Value config_;
+    util::SharedProducer<Sample>& producer_;
+    int global_watch;
+    std::map<fs::path, int> batteries_;
+    fs::path adapter_;
+    int battery_watch_fd_;
+    int global_watch_fd_;
+    bool warnFirstTime_{true};
+
+#if defined(__linux__)
+    util::Reactor::Watch battery_watch_;
+    util::Reactor::Watch global_watch_;
+#endif
+  };
 
-  void refreshBatteries();
-  void worker();
-  const std::string getAdapterStatus(uint8_t capacity) const;
-  std::tuple<uint8_t, float, std::string, float, uint16_t, float> getInfos();
   const std::string formatTimeRemaining(float hoursRemaining);
   void setBarClass(std::string&);
   void processEvents(std::string& state, std::string& status, uint8_t capacity);
 
-  int global_watch;
-  std::map<fs::path, int> batteries_;
-  fs::path adapter_;
-  int battery_watch_fd_;
-  int global_watch_fd_;
-  std::mutex battery_list_mutex_;
   std::string old_status_;
   std::string last_event_;
-  bool warnFirstTime_{true};
   const Bar& bar_;
 
-  util::SleeperThread thread_;
-  util::SleeperThread thread_battery_update_;
-  util::SleeperThread thread_timer_;
+  util::SharedProducer<Sample>::Subscription producer_;
 };
 
 }  // namespace waybar::modules
@@ -3,6 +3,7 @@
 #include <json/json.h>
 #include <sigc++/sigc++.h>
 
+#include "util/SafeSignal.hpp"
 #include "util/sleeper_thread.hpp"
 
 namespace cava {
@@ -33,10 +34,11 @@ class CavaBackend final {
   void doPauseResume();
   void Update();
   // Signal accessor
-  using type_signal_update = sigc::signal<void(const std::string&)>;
-  type_signal_update signal_update();
-  using type_signal_silence = sigc::signal<void()>;
-  type_signal_silence signal_silence();
+  // Frames are produced at the framerate, the main thread only renders the latest one
+  using type_signal_update = ConflatingSafeSignal<std::string>;
+  type_signal_update& signal_update();
+  using type_signal_silence = SafeSignal<>;
+  type_signal_silence& signal_silence();
 
  private:
   CavaBackend(const Json::Value& config);
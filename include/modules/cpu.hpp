@@ -10,7 +10,7 @@
 #include <vector>
 
 #include "ALabel.hpp"
-#include "util/sleeper_thread.hpp"
+#include "util/shared_producer.hpp"
 
 namespace waybar::modules {
 
@@ -21,9 +21,16 @@ class Cpu : public ALabel {
   auto update() -> void override;
 
  private:
-  std::vector<std::tuple<size_t, size_t>> prev_times_;
-
-  util::SleeperThread thread_;
+  struct Sample {
+    double load1;
+    std::vector<uint16_t> usage;
+    std::string tooltip;
+    float max_frequency;
+    float min_frequency;
+    float avg_frequency;
+  };
+
+  util::SharedProducer<Sample>::Subscription producer_;
 };
 
 }  // namespace waybar::modules
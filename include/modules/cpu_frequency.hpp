@@ -10,7 +10,7 @@
 #include <vector>
 
 #include "ALabel.hpp"
-#include "util/sleeper_thread.hpp"
+#include "util/shared_producer.hpp"
 
 namespace waybar::modules {
 
@@ -24,9 +24,11 @@ class CpuFrequency : public ALabel {
   static std::tuple<float, float, float> getCpuFrequency();
 
  private:
+  using Sample = std::tuple<float, float, float>;
+
   static std::vector<float> parseCpuFrequencies();
 
-  util::SleeperThread thread_;
+  util::SharedProducer<Sample>::Subscription producer_;
 };
 
 }  // namespace waybar::modules
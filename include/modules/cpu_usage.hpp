@@ -10,7 +10,7 @@
 #include <vector>
 
 #include "ALabel.hpp"
-#include "util/sleeper_thread.hpp"
+#include "util/shared_producer.hpp"
 
 namespace waybar::modules {
 
@@ -25,11 +25,11 @@ class CpuUsage : public ALabel {
       std::vector<std::tuple<size_t, size_t>>&);
 
  private:
-  static std::vector<std::tuple<size_t, size_t>> parseCpuinfo();
+  using Sample = std::tuple<std::vector<uint16_t>, std::string>;
 
-  std::vector<std::tuple<size_t, size_t>> prev_times_;
+  static std::vector<std::tuple<size_t, size_t>> parseCpuinfo();
 
-  util::SleeperThread thread_;
+  util::SharedProducer<Sample>::Subscription producer_;
 };
 
 }  // namespace waybar::modules
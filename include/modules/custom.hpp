@@ -8,6 +8,7 @@
 #include "ALabel.hpp"
 #include "util/command.hpp"
 #include "util/json.hpp"
+#include "util/shared_producer.hpp"
 #include "util/sleeper_thread.hpp"
 
 namespace waybar::modules {
@@ -20,9 +21,8 @@ class Custom : public ALabel {
   void refresh(int /*signal*/) override;
 
  private:
-  void delayWorker();
+  void sharedWorker(std::chrono::milliseconds interval);
   void continuousWorker();
-  void waitingWorker();
   void parseOutputRaw();
   void parseOutputJson();
   void handleEvent();
@@ -40,9 +40,13 @@ class Custom : public ALabel {
   int percentage_;
   FILE* fp_;
   int pid_;
+  // Partial line read from the continuous command
+  std::string line_buf_;
   util::command::res output_;
   util::JsonParser parser_;
 
+  // Periodic and signal-driven scripts run once for all bars
+  util::SharedProducer<util::command::res>::Subscription producer_;
   util::SleeperThread thread_;
 };
 
@@ -7,7 +7,7 @@
 
 #include "ALabel.hpp"
 #include "util/format.hpp"
-#include "util/sleeper_thread.hpp"
+#include "util/scheduler.hpp"
 
 namespace waybar::modules {
 
@@ -18,7 +18,7 @@ class Disk : public ALabel {
   auto update() -> void override;
 
  private:
-  util::SleeperThread thread_;
+  util::PeriodicJob thread_;
   std::string path_;
   std::string unit_;
 
@@ -1,6 +1,5 @@
 #pragma once
 
-#include <list>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -8,23 +7,26 @@
 #include <vector>
 
 #include "util/json.hpp"
+#include "util/json_lines_ipc.hpp"
 
 namespace waybar::modules::fht {
 
-class EventHandler {
- public:
-  virtual void onEvent(const Json::Value& ev) = 0;
-  virtual ~EventHandler() = default;
-};
+using EventHandler = util::JsonEventHandler;
 
 class IPC {
  public:
-  IPC() { startIPC(); }
+  IPC();
 
-  void registerForIPC(const std::string& ev, EventHandler* ev_handler);
-  void unregisterForIPC(EventHandler* handler);
+  void registerForIPC(const std::string& ev, EventHandler* ev_handler) {
+    ipc_.registerForIPC(ev, ev_handler);
+  }
+  void unregisterForIPC(EventHandler* handler) { ipc_.unregisterForIPC(handler); }
 
   static Json::Value send(const Json::Value& request);
+  /// Send a request from the main thread without waiting for the reply, see JsonLinesIpc::queue
+  void queue(Json::Value request, std::string key = "") {
+    ipc_.queue(std::move(request), std::move(key));
+  }
 
   // The data members are only safe to access while dataMutex_ is locked.
   std::lock_guard<std::mutex> lockData() { return std::lock_guard(dataMutex_); }
@@ -32,17 +34,15 @@ class IPC {
   const std::vector<Json::Value>& windows() const { return windows_; }
 
  private:
-  void startIPC();
-  static int connectToSocket();
-  void parseIPC(const std::string&);
+  /// Reducer of the event stream, returns the event name
+  std::string parseIPC(const Json::Value& ev);
 
   std::mutex dataMutex_;
   std::vector<Json::Value> workspaces_;
   std::vector<Json::Value> windows_;
 
-  util::JsonParser parser_;
-  std::mutex callbackMutex_;
-  std::list<std::pair<std::string, EventHandler*>> callbacks_;
+  // Last, so that the stream stops before the state goes away
+  util::JsonLinesIpc ipc_;
 };
 
 inline std::unique_ptr<IPC> gIPC;
@@ -6,6 +6,7 @@
 #include "AAppIconLabel.hpp"
 #include "bar.hpp"
 #include "modules/fht/backend.hpp"
+#include "util/rewrite_string.hpp"
 
 namespace waybar::modules::fht {
 
@@ -21,6 +22,7 @@ class Window : public AAppIconLabel, public EventHandler {
   void setClass(const std::string &className, bool enable);
 
   const Bar &bar_;
+  util::RewriteRuleSet rewriteRules_;
 
   std::string oldAppId_;
 };
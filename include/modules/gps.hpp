@@ -10,7 +10,8 @@
 #include <gps.h>
 
 #include "ALabel.hpp"
-#include "util/sleeper_thread.hpp"
+#include "util/reactor.hpp"
+#include "util/scheduler.hpp"
 
 namespace waybar::modules {
 
@@ -29,8 +30,10 @@ class Gps : public ALabel {
 
   const std::string getFixStatusString() const;
 
-  util::SleeperThread thread_, gps_thread_;
+  util::PeriodicJob thread_;
+  util::Reactor::Watch gps_watch_;
   gps_data_t gps_data_;
+  int last_gps_mode_ = 0;
   std::string state_;
 
   bool hideDisconnected = true;
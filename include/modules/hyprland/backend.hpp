@@ -1,13 +1,27 @@
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
 #include <filesystem>
-#include <list>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <set>
+#include <span>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
+#include <variant>
+#include <vector>
 
+#include "modules/hyprland/state.hpp"
+#include "util/command_queue.hpp"
+#include "util/handler_registry.hpp"
 #include "util/json.hpp"
+#include "util/stop_source.hpp"
 
 namespace waybar::modules::hyprland {
 
@@ -27,26 +41,92 @@ class IPC {
   ~IPC();
   static IPC& inst();
 
+  /**
+   * Handlers run on the IPC event thread, without any IPC lock held, so they may do socket1
+   * queries and (un)register handlers. Once unregisterForIPC returns, the handler is not running
+   * and won't be called again.
+   */
   void registerForIPC(const std::string& ev, EventHandler* ev_handler);
   void unregisterForIPC(EventHandler* handler);
 
+  /// Uncached request, use it for commands (e.g. "dispatch ...")
   static std::string getSocket1Reply(const std::string& rq);
+  /**
+   * Queue a command for socket1 and return right away, for the main thread. `done` gets the reply
+   * on the queue thread; without it, replies other than "ok" are logged. A command with a `key`
+   * replaces the queued one with the same key that wasn't sent yet.
+   */
+  void queueSocket1Command(std::string rq, std::string key = "",
+                           std::function<void(const std::string&)> done = nullptr);
+  /**
+   * Cached JSON query (e.g. "clients").
+   * Replies are reused until the next socket2 event. On a miss, the queries seen on the last
+   * event of the same kind are fetched along in a single [[BATCH]] request, and concurrent
+   * identical queries wait for the one in flight.
+   */
   Json::Value getSocket1JsonReply(const std::string& rq);
+  /// Same cached reply, unparsed, for replies read with util::JsonSchema
+  std::shared_ptr<const std::string> getSocket1JsonText(const std::string& rq);
   static std::filesystem::path getSocketFolder(const char* instanceSig);
 
+  /// Compositor state kept up to date from the events
+  HyprlandState& state() { return state_; }
+
  protected:
   static std::filesystem::path socketFolder_;
 
+  void parseIPC(const std::string&);
+
  private:
+  struct StringHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view str) const { return std::hash<std::string_view>{}(str); }
+  };
+
+  struct CachedReply {
+    uint64_t generation;
+    std::chrono::steady_clock::time_point time;
+    std::shared_ptr<const std::string> text;
+    // Parsed on the first getSocket1JsonReply
+    std::shared_ptr<const Json::Value> value;
+  };
+
   void socketListener();
-  void parseIPC(const std::string&);
+  int connectSocket2(const char* instanceSig);
+  /// Read and dispatch events until EOF, an error or stop
+  void readEvents(int fd);
+  /// Hand the events received in one read over to the event thread
+  void queueEvents(std::span<const std::string_view> events);
+  /// Event thread: applies the events to the state and runs the handlers
+  void dispatchEvents();
+  /// Start a new event tick, invalidating the cached replies
+  void beginEvent(std::string_view event);
+  bool isFresh(const CachedReply& reply) const;
+  CachedReply cachedReply(const std::string& rq);
+  std::vector<std::string> fetchJson(const std::vector<std::string>& queries);
 
   std::thread ipcThread_;
-  std::mutex callbackMutex_;
+  std::thread eventThread_;
+  std::mutex eventMutex_;
+  std::condition_variable eventCv_;
+  std::vector<std::string> pendingEvents_;
+
+  util::HandlerRegistry<std::string, EventHandler, std::monostate, StringHash> handlers_;
   util::JsonParser parser_;
-  std::list<std::pair<std::string, EventHandler*>> callbacks_;
-  int socketfd_;  // the hyprland socket file descriptor
+  HyprlandState state_{*this};
+
+  std::mutex queryMutex_;
+  std::condition_variable queryCv_;
+  uint64_t generation_ = 0;
+  std::string generationEvent_;
+  std::unordered_map<std::string, CachedReply> replyCache_;
+  std::unordered_set<std::string> inFlight_;
+  // Queries issued on the last occurrence of each kind of event, fetched together on the next one
+  std::unordered_map<std::string, std::set<std::string>> eventQueries_;
+  // Queries issued since the current event
+  std::set<std::string> currentQueries_;
   pid_t socketOwnerPid_;
-  bool running_ = true;  // the ipcThread will stop running when this is false
+  util::StopSource stop_;  // stops the ipcThread
+  util::CommandQueue commands_;
 };
 };  // namespace waybar::modules::hyprland
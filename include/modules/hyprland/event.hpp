@@ -0,0 +1,158 @@
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+namespace waybar::modules::hyprland {
+
+/**
+ * Decoders for socket2 events ("NAME>>PAYLOAD").
+ *
+ * Every field is a view into the event line, nothing is copied: the line must outlive the
+ * decoded event. Payload fields are separated by commas, and the last one keeps the rest of the
+ * line since titles and workspace names may contain commas themselves.
+ */
+struct Event {
+  std::string_view name;
+  std::string_view payload;
+
+  static Event parse(std::string_view line) {
+    auto pos = line.find(">>");
+    if (pos == std::string_view::npos) {
+      return {line.substr(0, line.find('>')), {}};
+    }
+    return {line.substr(0, pos), line.substr(pos + 2)};
+  }
+};
+
+/// Split a payload on its first `N - 1` commas, nullopt if there are fewer
+template <size_t N>
+std::optional<std::array<std::string_view, N>> splitFields(std::string_view payload) {
+  std::array<std::string_view, N> fields;
+  for (size_t i = 0; i + 1 < N; i++) {
+    auto pos = payload.find(',');
+    if (pos == std::string_view::npos) {
+      return std::nullopt;
+    }
+    fields[i] = payload.substr(0, pos);
+    payload.remove_prefix(pos + 1);
+  }
+  fields[N - 1] = payload;
+  return fields;
+}
+
+inline std::optional<int> parseInt(std::string_view str) {
+  int value;
+  auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+  if (ec != std::errc() || ptr != str.data() + str.size()) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+/// openwindow>>ADDRESS,WORKSPACENAME,CLASS,TITLE
+struct OpenWindowEvent {
+  std::string_view address;
+  std::string_view workspaceName;
+  std::string_view windowClass;
+  std::string_view title;
+
+  static std::optional<OpenWindowEvent> parse(std::string_view payload) {
+    auto fields = splitFields<4>(payload);
+    if (!fields) {
+      return std::nullopt;
+    }
+    auto [address, workspaceName, windowClass, title] = *fields;
+    return OpenWindowEvent{address, workspaceName, windowClass, title};
+  }
+};
+
+/// movewindowv2>>ADDRESS,WORKSPACEID,WORKSPACENAME
+struct MoveWindowEvent {
+  std::string_view address;
+  std::string_view workspaceId;
+  std::string_view workspaceName;
+
+  static std::optional<MoveWindowEvent> parse(std::string_view payload) {
+    auto fields = splitFields<3>(payload);
+    if (!fields) {
+      return std::nullopt;
+    }
+    auto [address, workspaceId, workspaceName] = *fields;
+    return MoveWindowEvent{address, workspaceId, workspaceName};
+  }
+};
+
+/// windowtitlev2>>ADDRESS,TITLE and changefloatingmode>>ADDRESS,FLOATING
+struct WindowValueEvent {
+  std::string_view address;
+  std::string_view value;
+
+  static std::optional<WindowValueEvent> parse(std::string_view payload) {
+    auto fields = splitFields<2>(payload);
+    if (!fields) {
+      return std::nullopt;
+    }
+    auto [address, value] = *fields;
+    return WindowValueEvent{address, value};
+  }
+};
+
+/// workspacev2, createworkspacev2, destroyworkspacev2>>ID,NAME and renameworkspace>>ID,NEWNAME
+struct WorkspaceEvent {
+  std::string_view id;
+  std::string_view name;
+
+  static std::optional<WorkspaceEvent> parse(std::string_view payload) {
+    auto fields = splitFields<2>(payload);
+    if (!fields) {
+      return std::nullopt;
+    }
+    auto [id, name] = *fields;
+    return WorkspaceEvent{id, name};
+  }
+};
+
+/// moveworkspacev2>>ID,NAME,MONITOR
+struct MoveWorkspaceEvent {
+  std::string_view id;
+  std::string_view name;
+  std::string_view monitor;
+
+  static std::optional<MoveWorkspaceEvent> parse(std::string_view payload) {
+    // The monitor name can't contain commas, the workspace name can
+    auto nameEnd = payload.rfind(',');
+    auto fields = splitFields<2>(payload.substr(0, nameEnd));
+    if (nameEnd == std::string_view::npos || !fields) {
+      return std::nullopt;
+    }
+    return MoveWorkspaceEvent{(*fields)[0], (*fields)[1], payload.substr(nameEnd + 1)};
+  }
+};
+
+/// focusedmonv2>>MONITOR,WORKSPACEID and activespecial>>WORKSPACENAME,MONITOR
+struct MonitorEvent {
+  std::string_view monitor;
+  std::string_view workspace;
+
+  static std::optional<MonitorEvent> parseFocused(std::string_view payload) {
+    auto fields = splitFields<2>(payload);
+    if (!fields) {
+      return std::nullopt;
+    }
+    return MonitorEvent{(*fields)[0], (*fields)[1]};
+  }
+
+  static std::optional<MonitorEvent> parseSpecial(std::string_view payload) {
+    auto pos = payload.rfind(',');
+    if (pos == std::string_view::npos) {
+      return std::nullopt;
+    }
+    return MonitorEvent{payload.substr(pos + 1), payload.substr(0, pos)};
+  }
+};
+
+}  // namespace waybar::modules::hyprland
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <json/value.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace waybar::modules::hyprland {
+
+class IPC;
+
+/// A window, as in "j/clients". Addresses are kept without the "0x" prefix, like in events.
+struct ClientInfo {
+  std::string address;
+  int workspaceId = -1;
+  std::string workspaceName;
+  int monitor = -1;
+  std::string className;
+  std::string initialClassName;
+  std::string title;
+  std::string initialTitle;
+  bool mapped = true;
+  bool hidden = false;
+  bool floating = false;
+  bool fullscreen = false;
+  bool grouped = false;
+  bool swallowing = false;
+
+  /// Parse a "j/clients" reply
+  static std::vector<ClientInfo> parseList(std::string_view json);
+  /// The fields of a "j/clients" entry used by the modules
+  Json::Value toJson() const;
+};
+
+struct WorkspaceInfo {
+  int id = -1;
+  std::string name;
+  std::string monitor;
+  int windows = 0;
+  bool hasFullscreen = false;
+  // Last focused window on the workspace, without the "0x" prefix
+  std::string lastWindow;
+  std::string lastWindowTitle;
+
+  /// Parse a "j/workspaces" reply
+  static std::vector<WorkspaceInfo> parseList(std::string_view json);
+};
+
+struct MonitorInfo {
+  int id = -1;
+  std::string name;
+  int activeWorkspaceId = -1;
+  int specialWorkspaceId = 0;
+  std::string specialWorkspaceName;
+  bool focused = false;
+
+  /// Parse a "j/monitors" reply
+  static std::vector<MonitorInfo> parseList(std::string_view json);
+};
+
+/// Change applied to the state by one event
+struct StateDelta {
+  enum class Kind {
+    Resynced,
+    ClientAdded,
+    ClientRemoved,
+    ClientChanged,
+    WorkspaceAdded,
+    WorkspaceRemoved,
+    WorkspaceChanged,
+    MonitorChanged,
+    ActiveWindowChanged,
+  };
+
+  Kind kind;
+  // Client address for client deltas and ActiveWindowChanged
+  std::string address;
+  // Affected workspace, or the workspace of the client
+  int workspaceId = -1;
+  // Monitor name for MonitorChanged
+  std::string monitor;
+};
+
+class StateListener {
+ public:
+  /// Called on the IPC thread, after the state was updated
+  virtual void onStateChanged(const std::vector<StateDelta>& deltas) = 0;
+  virtual ~StateListener() = default;
+};
+
+/**
+ * Workspaces, monitors and clients of the compositor, shared by all Hyprland modules.
+ *
+ * Fetched from socket1 when the IPC starts, then kept up to date from the socket2 events: the IPC
+ * applies each event before dispatching it, so handlers see the state it led to. Most events are
+ * applied as is; openwindow fetches the clients for the new window, createworkspacev2 the
+ * workspaces. Everything is fetched again on configreloaded, monitor hotplug, after a reconnect,
+ * a failed fetch, or an event referring to something unknown.
+ *
+ * socket1 is only queried on the IPC event thread, without holding the lock, and the result is
+ * swapped in. Accessors return copies and are safe to call from any thread; they only wait for
+ * the first sync.
+ */
+class HyprlandState {
+ public:
+  explicit HyprlandState(IPC& ipc);
+
+  void addListener(StateListener* listener);
+  void removeListener(StateListener* listener);
+
+  /// Apply a socket2 event and notify the listeners
+  void apply(std::string_view event, std::string_view payload);
+  /// Fetch everything again from socket1, on the IPC event thread. Failures are logged, and the
+  /// next event retries.
+  void resync();
+  /// Mark the state stale after events were missed, the next event fetches it again
+  void invalidate();
+  /// No compositor to sync from: accessors don't wait for a first sync, and events are ignored
+  void disable();
+
+  std::optional<ClientInfo> client(std::string_view address);
+  std::vector<ClientInfo> clients();
+  std::vector<ClientInfo> clientsOnWorkspace(int workspaceId);
+  /// All clients, in the "j/clients" format
+  Json::Value clientsJson();
+
+  std::optional<WorkspaceInfo> workspace(int id);
+  std::optional<WorkspaceInfo> workspaceByName(std::string_view name);
+  std::vector<WorkspaceInfo> workspaces();
+  /// Active workspace of the focused monitor
+  std::optional<WorkspaceInfo> activeWorkspace();
+  /// Active workspace of the given monitor
+  std::optional<WorkspaceInfo> activeWorkspace(std::string_view monitorName);
+
+  std::optional<MonitorInfo> monitor(std::string_view name);
+  std::vector<MonitorInfo> monitors();
+
+  /// Address of the focused window, empty if none
+  std::string activeWindow();
+
+ private:
+  /// Parsed socket1 replies, fetched before taking the lock
+  struct Snapshot {
+    std::vector<ClientInfo> clients;
+    std::vector<WorkspaceInfo> workspaces;
+    std::vector<MonitorInfo> monitors;
+    std::string activeWindow;
+  };
+
+  Snapshot fetchAll();
+  /// The replies `event` needs to be applied, if any
+  Snapshot fetchFor(std::string_view event);
+  void waitReadyLocked(std::unique_lock<std::mutex>& lock);
+  void setWorkspacesLocked(std::vector<WorkspaceInfo>& workspaces);
+  /// Count `client` in or out (`change` of 1 or -1) of its workspace
+  void countLocked(const ClientInfo& client, int change, std::vector<StateDelta>& deltas);
+  bool applyLocked(std::string_view event, std::string_view payload, Snapshot& fetched,
+                   std::vector<StateDelta>& deltas);
+  WorkspaceInfo* findWorkspaceLocked(std::string_view name);
+  MonitorInfo* focusedMonitorLocked();
+  void notify(const std::vector<StateDelta>& deltas);
+
+  IPC& ipc_;
+  std::mutex mutex_;
+  // Set once the first sync was attempted, accessors wait for it
+  std::condition_variable readyCv_;
+  bool ready_ = false;
+  bool synced_ = false;
+  // The last fetch failed or events were missed, the next event fetches everything
+  bool stale_ = false;
+  std::unordered_map<std::string, ClientInfo> clients_;
+  std::map<int, WorkspaceInfo> workspaces_;
+  std::map<std::string, MonitorInfo, std::less<>> monitors_;
+  std::string activeWindow_;
+
+  std::mutex listenerMutex_;
+  std::list<StateListener*> listeners_;
+};
+
+}  // namespace waybar::modules::hyprland
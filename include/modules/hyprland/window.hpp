@@ -2,16 +2,19 @@
 
 #include <fmt/format.h>
 
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "AAppIconLabel.hpp"
 #include "bar.hpp"
 #include "modules/hyprland/backend.hpp"
 #include "util/json.hpp"
+#include "util/rewrite_string.hpp"
 
 namespace waybar::modules::hyprland {
 
-class Window : public waybar::AAppIconLabel, public EventHandler {
+class Window : public waybar::AAppIconLabel, public StateListener {
  public:
   Window(const std::string&, const waybar::Bar&, const Json::Value&);
   ~Window() override;
@@ -25,7 +28,7 @@ class Window : public waybar::AAppIconLabel, public EventHandler {
     std::string last_window;
     std::string last_window_title;
 
-    static auto parse(const Json::Value& value) -> Workspace;
+    static auto from(const std::optional<WorkspaceInfo>& info) -> Workspace;
   };
 
   struct WindowData {
@@ -38,18 +41,19 @@ class Window : public waybar::AAppIconLabel, public EventHandler {
     bool fullscreen;
     bool grouped;
 
-    static auto parse(const Json::Value&) -> WindowData;
+    static auto from(const ClientInfo& client) -> WindowData;
   };
 
   static auto getActiveWorkspace(const std::string&) -> Workspace;
   static auto getActiveWorkspace() -> Workspace;
-  void onEvent(const std::string& ev) override;
+  void onStateChanged(const std::vector<StateDelta>& deltas) override;
   void queryActiveWorkspace();
   void setClass(const std::string&, bool enable);
 
   bool separateOutputs_;
   std::mutex mutex_;
   const Bar& bar_;
+  util::RewriteRuleSet rewriteRules_;
   util::JsonParser parser_;
   WindowData windowData_;
   Workspace workspace_;
@@ -2,7 +2,9 @@
 
 #include <fmt/format.h>
 
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "AAppIconLabel.hpp"
 #include "bar.hpp"
@@ -10,7 +12,7 @@
 
 namespace waybar::modules::hyprland {
 
-class WindowCount : public waybar::AAppIconLabel, public EventHandler {
+class WindowCount : public waybar::AAppIconLabel, public StateListener {
  public:
   WindowCount(const std::string&, const waybar::Bar&, const Json::Value&);
   ~WindowCount() override;
@@ -22,12 +24,12 @@ class WindowCount : public waybar::AAppIconLabel, public EventHandler {
     int id;
     int windows;
     bool hasfullscreen;
-    static auto parse(const Json::Value& value) -> Workspace;
+    static auto from(const std::optional<WorkspaceInfo>& info) -> Workspace;
   };
 
   auto getActiveWorkspace(const std::string&) -> Workspace;
   auto getActiveWorkspace() -> Workspace;
-  void onEvent(const std::string& ev) override;
+  void onStateChanged(const std::vector<StateDelta>& deltas) override;
   void queryActiveWorkspace();
   void setClass(const std::string&, bool enable);
 
@@ -17,6 +17,7 @@
 #include "AModule.hpp"
 #include "bar.hpp"
 #include "modules/hyprland/backend.hpp"
+#include "modules/hyprland/event.hpp"
 #include "util/enum.hpp"
 #include "util/regex_collection.hpp"
 
@@ -45,6 +46,7 @@ class WindowCreationPayload {
   WindowCreationPayload(std::string workspace_name, WindowAddress window_address,
                         std::string window_class, std::string window_title, bool is_active);
   WindowCreationPayload(Json::Value const& client_data);
+  WindowCreationPayload(OpenWindowEvent const& event, bool is_active);
 
   int incrementTimeSpentUncreated();
   bool isEmpty(Workspaces& workspace_manager);
@@ -53,7 +55,7 @@ class WindowCreationPayload {
   void setActive(bool value) { m_isActive = value; }
 
   std::string getWorkspaceName() const { return m_workspaceName; }
-  WindowAddress getAddress() const { return m_windowAddress; }
+  WindowAddress const& getAddress() const { return m_windowAddress; }
 
   void moveToWorkspace(std::string& new_workspace_name);
 
@@ -11,11 +11,13 @@
 #include <optional>
 #include <regex>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "AModule.hpp"
 #include "bar.hpp"
 #include "modules/hyprland/backend.hpp"
+#include "modules/hyprland/event.hpp"
 #include "modules/hyprland/windowcreationpayload.hpp"
 #include "modules/hyprland/workspace.hpp"
 #include "util/enum.hpp"
@@ -69,7 +71,12 @@ class Workspaces : public AModule, public EventHandler {
   void onEvent(const std::string& e) override;
   void updateWindowCount();
   void sortSpecialCentered();
+  /// Full sort, only needed when the order depends on more than the workspaces themselves
   void sortWorkspaces();
+  /// Insert into the sorted m_workspaces and move its button to the matching position
+  void insertWorkspace(std::unique_ptr<Workspace> workspace);
+  bool isWorkspaceBefore(Workspace const& a, Workspace const& b) const;
+  void repositionRenamedWorkspaces();
   void createWorkspace(Json::Value const& workspace_data,
                        Json::Value const& clients_data = Json::Value::nullRef);
 
@@ -92,24 +99,24 @@ class Workspaces : public AModule, public EventHandler {
   void registerIpc();
 
   // workspace events
-  void onWorkspaceActivated(std::string const& payload);
-  void onSpecialWorkspaceActivated(std::string const& payload);
-  void onWorkspaceDestroyed(std::string const& payload);
-  void onWorkspaceCreated(std::string const& payload,
+  void onWorkspaceActivated(std::string_view payload);
+  void onSpecialWorkspaceActivated(std::string_view payload);
+  void onWorkspaceDestroyed(std::string_view payload);
+  void onWorkspaceCreated(std::string_view payload,
                           Json::Value const& clientsData = Json::Value::nullRef);
-  void onWorkspaceMoved(std::string const& payload);
-  void onWorkspaceRenamed(std::string const& payload);
+  void onWorkspaceMoved(std::string_view payload);
+  void onWorkspaceRenamed(std::string_view payload);
   static std::optional<int> parseWorkspaceId(std::string const& workspaceIdStr);
 
   // monitor events
-  void onMonitorFocused(std::string const& payload);
+  void onMonitorFocused(std::string_view payload);
 
   // window events
-  void onWindowOpened(std::string const& payload);
+  void onWindowOpened(std::string_view payload);
   void onWindowClosed(std::string const& addr);
-  void onWindowMoved(std::string const& payload);
+  void onWindowMoved(std::string_view payload);
 
-  void onWindowTitleEvent(std::string const& payload);
+  void onWindowTitleEvent(std::string_view payload);
   void onActiveWindowChanged(WindowAddress const& payload);
 
   void onConfigReloaded();
@@ -119,13 +126,12 @@ class Workspaces : public AModule, public EventHandler {
   // event payload management
   template <typename... Args>
   static std::string makePayload(Args const&... args);
-  static std::pair<std::string, std::string> splitDoublePayload(std::string const& payload);
-  static std::tuple<std::string, std::string, std::string> splitTriplePayload(
-      std::string const& payload);
 
   // Update methods
   void doUpdate();
   void removeWorkspacesToRemove();
+  /// Queue a workspace for the UI thread to create, with the clients it holds
+  void queueWorkspace(Json::Value const& workspace_data, Json::Value const& clients_data);
   void createWorkspacesToCreate();
   static std::vector<int> getVisibleWorkspaces();
   void updateWorkspaceStates();
@@ -176,6 +182,7 @@ class Workspaces : public AModule, public EventHandler {
   std::vector<std::unique_ptr<Workspace>> m_workspaces;
   std::vector<std::pair<Json::Value, Json::Value>> m_workspacesToCreate;
   std::vector<std::string> m_workspacesToRemove;
+  std::vector<int> m_workspacesToReposition;
   std::vector<WindowCreationPayload> m_windowsToCreate;
 
   IconLoader m_iconLoader;
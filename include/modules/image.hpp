@@ -10,7 +10,7 @@
 #include "gtkmm/box.h"
 #include "util/command.hpp"
 #include "util/json.hpp"
-#include "util/sleeper_thread.hpp"
+#include "util/scheduler.hpp"
 
 namespace waybar::modules {
 
@@ -34,7 +34,7 @@ class Image : public AModule {
   std::chrono::milliseconds interval_;
   util::command::res output_;
 
-  util::SleeperThread thread_;
+  util::PeriodicJob thread_;
 };
 
 }  // namespace waybar::modules
@@ -7,7 +7,7 @@
 #include <fstream>
 
 #include "ALabel.hpp"
-#include "util/sleeper_thread.hpp"
+#include "util/scheduler.hpp"
 
 namespace waybar::modules {
 
@@ -33,7 +33,7 @@ class JACK : public ALabel {
   bool running_;
   std::mutex mutex_;
   std::string state_;
-  util::SleeperThread thread_;
+  util::PeriodicJob thread_;
 };
 
 }  // namespace waybar::modules
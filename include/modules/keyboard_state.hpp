@@ -8,7 +8,7 @@
 
 #include "AModule.hpp"
 #include "bar.hpp"
-#include "util/sleeper_thread.hpp"
+#include "util/reactor.hpp"
 
 extern "C" {
 #include <libevdev/libevdev.h>
@@ -25,6 +25,7 @@ class KeyboardState : public AModule {
 
  private:
   auto tryAddDevice(const std::string&) -> void;
+  auto handleHotplug() -> bool;
 
   Gtk::Box box_;
   Gtk::Label numlock_label_;
@@ -42,8 +43,10 @@ class KeyboardState : public AModule {
   struct libinput* libinput_;
   std::unordered_map<std::string, struct libinput_device*> libinput_devices_;
   std::set<int> binding_keys;
+  std::set<std::string> pending_devices_;
+  int hotplug_fd_{-1};
 
-  util::SleeperThread libinput_thread_, hotplug_thread_;
+  util::Reactor::Watch libinput_watch_, hotplug_watch_;
 };
 
 }  // namespace waybar::modules
@@ -10,7 +10,7 @@
 #include <vector>
 
 #include "ALabel.hpp"
-#include "util/sleeper_thread.hpp"
+#include "util/shared_producer.hpp"
 
 namespace waybar::modules {
 
@@ -24,7 +24,9 @@ class Load : public ALabel {
   static std::tuple<double, double, double> getLoad();
 
  private:
-  util::SleeperThread thread_;
+  using Sample = std::tuple<double, double, double>;
+
+  util::SharedProducer<Sample>::Subscription producer_;
 };
 
 }  // namespace waybar::modules
@@ -6,7 +6,7 @@
 #include <unordered_map>
 
 #include "ALabel.hpp"
-#include "util/sleeper_thread.hpp"
+#include "util/shared_producer.hpp"
 
 namespace waybar::modules {
 
@@ -17,11 +17,13 @@ class Memory : public ALabel {
   auto update() -> void override;
 
  private:
-  void parseMeminfo();
+  using Meminfo = std::unordered_map<std::string, unsigned long>;
 
-  std::unordered_map<std::string, unsigned long> meminfo_;
+  static Meminfo parseMeminfo();
 
-  util::SleeperThread thread_;
+  Meminfo meminfo_;
+
+  util::SharedProducer<Meminfo>::Subscription producer_;
 };
 
 }  // namespace waybar::modules
@@ -12,7 +12,7 @@ extern "C" {
 }
 
 #include "ALabel.hpp"
-#include "util/sleeper_thread.hpp"
+#include "util/scheduler.hpp"
 
 namespace waybar::modules::mpris {
 
@@ -81,7 +81,7 @@ class Mpris : public ALabel {
   std::string lastStatus;
   std::string lastPlayer;
 
-  util::SleeperThread thread_;
+  util::PeriodicJob thread_;
   std::chrono::time_point<std::chrono::system_clock> last_update_;
 };
 
@@ -12,7 +12,8 @@
 #include <vector>
 
 #include "ALabel.hpp"
-#include "util/sleeper_thread.hpp"
+#include "util/reactor.hpp"
+#include "util/shared_producer.hpp"
 #ifdef WANT_RFKILL
 #include "util/rfkill.hpp"
 #endif
@@ -24,76 +25,111 @@ namespace waybar::modules {
 class Network : public ALabel {
  public:
   Network(const std::string&, const Json::Value&);
-  virtual ~Network();
+  virtual ~Network() = default;
   auto update() -> void override;
 
  private:
-  static const uint8_t MAX_RETRY{5};
-  static const uint8_t EPOLL_MAX{200};
-
-  static int handleEvents(struct nl_msg*, void*);
-  static int handleEventsDone(struct nl_msg*, void*);
-  static int handleScan(struct nl_msg*, void*);
-
-  void askForStateDump(void);
-
-  void worker();
-  void createInfoSocket();
-  void createEventSocket();
-  void parseEssid(struct nlattr**);
-  void parseSignal(struct nlattr**);
-  void parseFreq(struct nlattr**);
-  void parseBssid(struct nlattr**);
-  bool associatedOrJoined(struct nlattr**);
-  bool matchInterface(const std::string& ifname, const std::vector<std::string>& altnames,
-                      std::string& matched) const;
-  auto getInfo() -> void;
-  const std::string getNetworkState() const;
-  void clearIface();
-  std::optional<std::pair<unsigned long long, unsigned long long>> readBandwidthUsage();
-
-  int ifid_{-1};
-  ip_addr_pref addr_pref_{ip_addr_pref::IPV4};
-  struct sockaddr_nl nladdr_{0};
-  struct nl_sock* sock_{nullptr};
-  struct nl_sock* ev_sock_{nullptr};
-  int efd_{-1};
-  int ev_fd_{-1};
-  int nl80211_id_{-1};
-  std::mutex mutex_;
-
-  bool want_route_dump_{false};
-  bool want_link_dump_{false};
-  bool want_addr_dump_{false};
-  bool dump_in_progress_{false};
-  bool is_p2p_{false};
-
-  unsigned long long bandwidth_down_total_{0};
-  unsigned long long bandwidth_up_total_{0};
-
-  std::string state_;
-  std::string essid_;
-  std::string bssid_;
-  bool carrier_{false};
-  std::string ifname_;
-  std::string ipaddr_;
-  std::string ipaddr6_;
-  std::string gwaddr_;
-  std::string netmask_;
-  std::string netmask6_;
-  int cidr_{0};
-  int cidr6_{0};
-  int32_t signal_strength_dbm_;
-  uint8_t signal_strength_;
-  std::string signal_strength_app_;
-  uint32_t route_priority;
-
-  util::SleeperThread thread_;
-  util::SleeperThread thread_timer_;
+  struct Sample {
+    int ifid;
+    bool carrier;
+    std::string ifname;
+    std::string essid;
+    std::string bssid;
+    std::string ipaddr;
+    std::string ipaddr6;
+    std::string gwaddr;
+    std::string netmask;
+    std::string netmask6;
+    int cidr;
+    int cidr6;
+    int32_t signal_strength_dbm;
+    uint8_t signal_strength;
+    std::string signal_strength_app;
+    float frequency;
+    bool rfkill;
+    unsigned long long bandwidth_down;
+    unsigned long long bandwidth_up;
+  };
+
+  /// Follows the interface over netlink on behalf of the instances of every bar
+  class Source {
+   public:
+    Source(const Json::Value& config, util::SharedProducer<Sample>& producer);
+    ~Source();
+    Sample sample();
+
+   private:
+    static const uint8_t MAX_RETRY{5};
+
+    static int handleEvents(struct nl_msg*, void*);
+    static int handleEventsDone(struct nl_msg*, void*);
+    static int handleScan(struct nl_msg*, void*);
+
+    void askForStateDump(void);
+
+    void worker();
+    void createInfoSocket();
+    void createEventSocket();
+    void parseEssid(struct nlattr**);
+    void parseSignal(struct nlattr**);
+    void parseFreq(struct nlattr**);
+    void parseBssid(struct nlattr**);
+    bool associatedOrJoined(struct nlattr**);
+    bool matchInterface(const std::string& ifname, const std::vector<std::string>& altnames,
+                        std::string& matched) const;
+    auto getInfo() -> void;
+    void clearIface();
+    std::optional<std::pair<unsigned long long, unsigned long long>> readBandwidthUsage();
+
+    const Json::Value config_;
+    util::SharedProducer<Sample>& producer_;
+
+    int ifid_{-1};
+    ip_addr_pref addr_pref_{ip_addr_pref::IPV4};
+    struct sockaddr_nl nladdr_{0};
+    struct nl_sock* sock_{nullptr};
+    struct nl_sock* ev_sock_{nullptr};
+    int nl80211_id_{-1};
+    std::mutex mutex_;
+
+    bool want_route_dump_{false};
+    bool want_link_dump_{false};
+    bool want_addr_dump_{false};
+    bool dump_in_progress_{false};
+    bool is_p2p_{false};
+
+    unsigned long long bandwidth_down_total_{0};
+    unsigned long long bandwidth_up_total_{0};
+
+    std::string essid_;
+    std::string bssid_;
+    bool carrier_{false};
+    std::string ifname_;
+    std::string ipaddr_;
+    std::string ipaddr6_;
+    std::string gwaddr_;
+    std::string netmask_;
+    std::string netmask6_;
+    int cidr_{0};
+    int cidr6_{0};
+    int32_t signal_strength_dbm_;
+    uint8_t signal_strength_;
+    std::string signal_strength_app_;
+    uint32_t route_priority;
+    float frequency_{0};
+
+    util::Reactor::Watch ev_watch_;
 #ifdef WANT_RFKILL
-  util::Rfkill rfkill_{RFKILL_TYPE_WLAN};
+    util::Rfkill rfkill_{RFKILL_TYPE_WLAN};
 #endif
-  float frequency_{0};
+  };
+
+  const std::string getNetworkState(const Sample&) const;
+
+  ip_addr_pref addr_pref_{ip_addr_pref::IPV4};
+  std::string state_;
+
+  util::SharedProducer<Sample>::Subscription producer_;
 };
 
 }  // namespace waybar::modules
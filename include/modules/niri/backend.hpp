@@ -1,50 +1,57 @@
 #pragma once
 
 #include <list>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "modules/niri/state.hpp"
 #include "util/json.hpp"
+#include "util/json_lines_ipc.hpp"
 
 namespace waybar::modules::niri {
 
-class EventHandler {
- public:
-  virtual void onEvent(const Json::Value& ev) = 0;
-  virtual ~EventHandler() = default;
-};
+using EventHandler = util::JsonEventHandler;
 
 class IPC {
  public:
-  IPC() { startIPC(); }
+  IPC();
+
+  /// Raw events, by name
+  void registerForIPC(const std::string& ev, EventHandler* ev_handler) {
+    ipc_.registerForIPC(ev, ev_handler);
+  }
+  void unregisterForIPC(EventHandler* handler) { ipc_.unregisterForIPC(handler); }
 
-  void registerForIPC(const std::string& ev, EventHandler* ev_handler);
-  void unregisterForIPC(EventHandler* handler);
+  /// What each event changed in the state, before the raw event handlers run. Once
+  /// removeListener returns, the listener is not running and won't be called again.
+  void addListener(StateListener* listener);
+  void removeListener(StateListener* listener);
 
   static Json::Value send(const Json::Value& request);
+  /// Send a request from the main thread without waiting for the reply, see JsonLinesIpc::queue
+  void queue(Json::Value request, std::string key = "") {
+    ipc_.queue(std::move(request), std::move(key));
+  }
 
-  // The data members are only safe to access while dataMutex_ is locked.
+  // The state is only safe to access while dataMutex_ is locked.
   std::lock_guard<std::mutex> lockData() { return std::lock_guard(dataMutex_); }
-  const std::vector<Json::Value>& workspaces() const { return workspaces_; }
-  const std::vector<Json::Value>& windows() const { return windows_; }
-  const std::vector<std::string>& keyboardLayoutNames() const { return keyboardLayoutNames_; }
-  unsigned keyboardLayoutCurrent() const { return keyboardLayoutCurrent_; }
+  const NiriState& state() const { return state_; }
 
  private:
-  void startIPC();
-  static int connectToSocket();
-  void parseIPC(const std::string&);
+  /// Reducer of the event stream, returns the event name
+  std::string parseIPC(const Json::Value& ev);
 
   std::mutex dataMutex_;
-  std::vector<Json::Value> workspaces_;
-  std::vector<Json::Value> windows_;
-  std::vector<std::string> keyboardLayoutNames_;
-  unsigned keyboardLayoutCurrent_;
-
-  util::JsonParser parser_;
-  std::mutex callbackMutex_;
-  std::list<std::pair<std::string, EventHandler*>> callbacks_;
+  NiriState state_;
+
+  std::mutex listenerMutex_;
+  std::list<StateListener*> listeners_;
+
+  // Last, so that the stream stops before the state goes away
+  util::JsonLinesIpc ipc_;
 };
 
 inline std::unique_ptr<IPC> gIPC;
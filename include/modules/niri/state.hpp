@@ -0,0 +1,116 @@
+#pragma once
+
+#include <json/value.h>
+
+#include <compare>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace waybar::modules::niri {
+
+/// Change applied to the state by one event
+struct StateDelta {
+  enum class Kind {
+    WorkspaceAdded,
+    WorkspaceRemoved,
+    // The output or the index of the workspace changed, and so did its position
+    WorkspaceMoved,
+    WorkspaceChanged,
+    // is_active or is_focused changed
+    WorkspaceActivated,
+    // A window moving to another workspace is removed from the old one and added to the new one
+    WindowAdded,
+    WindowRemoved,
+    WindowChanged,
+    WindowFocusChanged,
+    KeyboardLayoutChanged,
+  };
+
+  Kind kind;
+  // The workspace or the window, 0 for WindowFocusChanged when no window is focused
+  uint64_t id = 0;
+  // Workspace of the window for window deltas, 0 if none
+  uint64_t workspaceId = 0;
+};
+
+class StateListener {
+ public:
+  /// Called on the IPC thread, after the state was updated
+  virtual void onStateChanged(const std::vector<StateDelta>& deltas) = 0;
+  virtual ~StateListener() = default;
+};
+
+/// Workspaces are ordered by output, then by index
+struct WorkspaceKey {
+  std::string output;
+  unsigned idx;
+  uint64_t id;
+
+  auto operator<=>(const WorkspaceKey&) const = default;
+};
+
+/**
+ * Workspaces, windows and keyboard layouts of niri, kept up to date from the event stream.
+ *
+ * Workspaces and windows are indexed by id: an event only touches the entries it is about, and
+ * the full lists niri sends on WorkspacesChanged and WindowsChanged are diffed against the state
+ * so that only what changed is reported. Not thread-safe, the IPC guards it with its data mutex.
+ */
+class NiriState {
+ public:
+  using Workspaces = std::map<WorkspaceKey, Json::Value>;
+
+  /**
+   * Apply the payload of an event and append what changed to `deltas`. Returns false for the
+   * events the state doesn't follow.
+   */
+  bool apply(const std::string& event, const Json::Value& payload,
+             std::vector<StateDelta>& deltas);
+
+  /// In display order
+  const Workspaces& workspaces() const { return workspaces_; }
+  const Json::Value* workspace(uint64_t id) const;
+  /// nullptr if none
+  const Json::Value* focusedWorkspace() const;
+  const Json::Value* activeWorkspace(const std::string& output) const;
+
+  const std::unordered_map<uint64_t, Json::Value>& windows() const { return windows_; }
+  const Json::Value* window(uint64_t id) const;
+  /// Number of windows on a workspace
+  size_t windowCount(uint64_t workspaceId) const;
+
+  const std::vector<std::string>& keyboardLayoutNames() const { return keyboardLayoutNames_; }
+  unsigned keyboardLayoutCurrent() const { return keyboardLayoutCurrent_; }
+
+ private:
+  void setWorkspaces(const Json::Value& workspaces, std::vector<StateDelta>& deltas);
+  void activateWorkspace(const Json::Value& payload, std::vector<StateDelta>& deltas);
+  /// Set a flag of a workspace, and report it if it changed
+  void setWorkspaceFlag(uint64_t id, const char* flag, bool value,
+                        std::vector<StateDelta>& deltas);
+  Json::Value* findWorkspace(uint64_t id);
+
+  void setWindows(const Json::Value& windows, std::vector<StateDelta>& deltas);
+  void updateWindow(const Json::Value& window, std::vector<StateDelta>& deltas);
+  void removeWindow(uint64_t id, std::vector<StateDelta>& deltas);
+  void focusWindow(std::optional<uint64_t> id, std::vector<StateDelta>& deltas);
+  void countWindow(const Json::Value& window, int n);
+
+  Workspaces workspaces_;
+  std::unordered_map<uint64_t, Workspaces::iterator> workspaceIndex_;
+  std::unordered_map<std::string, uint64_t> activeWorkspaces_;
+  std::optional<uint64_t> focusedWorkspace_;
+
+  std::unordered_map<uint64_t, Json::Value> windows_;
+  std::unordered_map<uint64_t, size_t> windowCounts_;
+  std::optional<uint64_t> focusedWindow_;
+
+  std::vector<std::string> keyboardLayoutNames_;
+  unsigned keyboardLayoutCurrent_ = 0;
+};
+
+}  // namespace waybar::modules::niri
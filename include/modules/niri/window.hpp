@@ -3,26 +3,36 @@
 #include <gtkmm/button.h>
 #include <json/value.h>
 
+#include <atomic>
+#include <cstdint>
+
 #include "AAppIconLabel.hpp"
 #include "bar.hpp"
 #include "modules/niri/backend.hpp"
+#include "util/rewrite_string.hpp"
 
 namespace waybar::modules::niri {
 
-class Window : public AAppIconLabel, public EventHandler {
+class Window : public AAppIconLabel, public StateListener {
  public:
   Window(const std::string &, const Bar &, const Json::Value &);
   ~Window() override;
   void update() override;
 
  private:
-  void onEvent(const Json::Value &ev) override;
+  void onStateChanged(const std::vector<StateDelta> &deltas) override;
+  /// Whether a change can affect what the module shows
+  bool isRelevant(const StateDelta &delta) const;
   void doUpdate();
   void setClass(const std::string &className, bool enable);
 
   const Bar &bar_;
+  util::RewriteRuleSet rewriteRules_;
 
   std::string oldAppId_;
+  // Ids of what was last shown, 0 if none
+  std::atomic<uint64_t> shownWorkspace_ = 0;
+  std::atomic<uint64_t> shownWindow_ = 0;
 };
 
 }  // namespace waybar::modules::niri
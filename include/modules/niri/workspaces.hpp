@@ -3,21 +3,29 @@
 #include <gtkmm/button.h>
 #include <json/value.h>
 
+#include <mutex>
+#include <unordered_set>
+
 #include "AModule.hpp"
 #include "bar.hpp"
 #include "modules/niri/backend.hpp"
 
 namespace waybar::modules::niri {
 
-class Workspaces : public AModule, public EventHandler {
+class Workspaces : public AModule, public StateListener {
  public:
   Workspaces(const std::string &, const Bar &, const Json::Value &);
   ~Workspaces() override;
   void update() override;
 
  private:
-  void onEvent(const Json::Value &ev) override;
+  void onStateChanged(const std::vector<StateDelta> &deltas) override;
   void doUpdate();
+  /// Whether the workspace has a button on this bar
+  bool isShown(const Json::Value &ws) const;
+  /// Remove, add and reorder the buttons, and update all of them
+  void rebuild(const NiriState &state);
+  void updateButton(Gtk::Button &button, const Json::Value &ws);
   Gtk::Button &addButton(const Json::Value &ws);
   std::string getIcon(const std::string &value, const Json::Value &ws);
 
@@ -25,6 +33,11 @@ class Workspaces : public AModule, public EventHandler {
   Gtk::Box box_;
   // Map from niri workspace id to button.
   std::unordered_map<uint64_t, Gtk::Button> buttons_;
+
+  // What changed since the last update, filled on the IPC thread
+  std::mutex mutex_;
+  bool rebuild_ = true;
+  std::unordered_set<uint64_t> changed_;
 };
 
 }  // namespace waybar::modules::niri
@@ -42,6 +42,8 @@ class Ipc {
   const std::string getSocketPath() const;
   int open(const std::string &) const;
   struct ipc_response send(int fd, uint32_t type, const std::string &payload = "");
+  /// Send a message without waiting for its reply
+  void write(int fd, uint32_t type, const std::string &payload);
   struct ipc_response recv(int fd);
 
   int fd_;
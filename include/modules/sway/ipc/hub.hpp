@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "modules/sway/ipc/client.hpp"
+#include "modules/sway/ipc/tree.hpp"
+#include "util/command_queue.hpp"
+#include "util/handler_registry.hpp"
+#include "util/json.hpp"
+
+namespace waybar::modules::sway {
+
+class IpcHandler {
+ public:
+  virtual ~IpcHandler() = default;
+  /// An event of one of the types the handler registered for
+  virtual void onEvent(const struct Ipc::ipc_response& /*res*/) {}
+  /// The tree, after a burst of events of the types the handler registered for changed it
+  virtual void onTree(const SwayTree& /*tree*/, const std::vector<TreeDelta>& /*deltas*/) {}
+};
+
+/**
+ * Sway IPC connection shared by all the modules of all the bars: one event socket, one command
+ * socket and one thread. Use IpcHub::inst(), do not create other instances.
+ *
+ * The events already received when the thread wakes up are handled as one burst. Once a handler
+ * registered for the tree, the hub keeps a SwayTree updated from the window and workspace events,
+ * and shares it with all of them. GET_TREE is only sent for the first sync, and when an event
+ * can't be applied to the tree.
+ */
+class IpcHub : protected Ipc {
+ protected:
+  IpcHub();  // use IpcHub::inst() instead.
+
+ public:
+  using Tree = std::shared_ptr<const SwayTree>;
+  using CmdCallback = std::function<void(const struct ipc_response&)>;
+
+  ~IpcHub();
+  static IpcHub& inst();
+
+  /**
+   * Handlers run on the hub thread, without any hub lock held, so they may send commands and
+   * (un)register handlers. Once unregister returns, the handler is not running and won't be
+   * called again.
+   */
+  void registerForEvents(IpcHandler* handler, std::initializer_list<uint32_t> events);
+  void registerForTree(IpcHandler* handler, std::initializer_list<uint32_t> events);
+  void unregister(IpcHandler* handler);
+
+  /// Send a command on the shared command socket and return the reply
+  struct ipc_response sendCmd(uint32_t type, const std::string& payload = "");
+  /**
+   * Queue a command for the command socket and return right away, for the main thread. `done`
+   * gets the reply on the queue thread; without it, the failures of an IPC_COMMAND are logged.
+   * A command with a `key` replaces the queued one with the same key that wasn't sent yet.
+   */
+  void queueCmd(uint32_t type, std::string payload, std::string key = "",
+                CmdCallback done = nullptr);
+  /// The tree, a snapshot that later events don't change
+  Tree tree();
+
+ private:
+  // Key of the tree handlers, along with the events they registered for. The other handlers are
+  // registered by event type.
+  static constexpr uint32_t TREE_HANDLERS = 0;
+
+  /// Subscribe the event socket to the events it isn't subscribed to yet
+  void subscribe(uint32_t events);
+  /// Read the pending events and dispatch them
+  void handleBurst();
+  /// Apply the tree events of a burst, or mark the tree for a resync
+  void applyToTree(const std::vector<struct ipc_response>& events, std::vector<TreeDelta>& deltas);
+  void resyncTreeLocked();
+  void dispatch(const std::vector<struct ipc_response>& events,
+                const std::vector<TreeDelta>& deltas);
+  bool hasPendingEvent() const;
+
+  util::HandlerRegistry<uint32_t, IpcHandler, uint32_t> handlers_;
+  std::mutex subscribeMutex_;
+  // Events the event socket is subscribed to, as event_mask bits
+  uint32_t subscribed_ = 0;
+
+  std::mutex treeMutex_;
+  util::JsonParser parser_;
+  // Copied before applying events when a snapshot of it is still in use
+  std::shared_ptr<SwayTree> tree_ = std::make_shared<SwayTree>();
+  // Whether tree_ is the GET_TREE reply with all the events received since applied
+  bool synced_ = false;
+
+  // Last, so that it stops before the rest goes away
+  util::CommandQueue commands_;
+};
+
+}  // namespace waybar::modules::sway
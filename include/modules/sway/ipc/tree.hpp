@@ -0,0 +1,80 @@
+#pragma once
+
+#include <json/value.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace waybar::modules::sway {
+
+/// Change applied to the tree by one event
+struct TreeDelta {
+  enum class Kind {
+    Resynced,
+    NodeChanged,
+    TitleChanged,
+    NodeRemoved,
+    FocusChanged,
+    WorkspaceAdded,
+    WorkspaceRemoved,
+    WorkspaceChanged,
+  };
+
+  Kind kind;
+  // The container or workspace, the newly focused one for FocusChanged
+  int64_t id = -1;
+};
+
+/**
+ * The reply of IPC_GET_TREE, kept up to date from the window and workspace events.
+ *
+ * Containers are indexed by id, and events replace or remove the container they carry: a title
+ * change only copies the window it's about. Events that don't say where a container went (window
+ * new, move and floating, workspace move) can't be applied, the tree must then be fetched again.
+ * Not thread-safe, the IPC hub copies it before changing a tree still being read.
+ */
+class SwayTree {
+ public:
+  SwayTree() = default;
+  /// Deep copy, with an index of its own
+  SwayTree(const SwayTree& other);
+  SwayTree& operator=(const SwayTree&) = delete;
+
+  /// Replace the whole tree with a GET_TREE reply
+  void reset(Json::Value root);
+  /**
+   * Apply a window or workspace event and append what changed to `deltas`. Returns false if it
+   * can't be applied, the tree is then left half updated and must be reset.
+   */
+  bool apply(uint32_t type, const Json::Value& event, std::vector<TreeDelta>& deltas);
+
+  const Json::Value& root() const { return root_; }
+  const Json::Value* node(int64_t id) const;
+  /// Id of the focused container or workspace, -1 if none
+  int64_t focusedId() const { return focused_; }
+  /// The workspace containing a container, nullptr for outputs and unknown ids
+  const Json::Value* workspaceOf(int64_t id) const;
+
+ private:
+  struct Entry {
+    Json::Value* node;
+    int64_t parent;
+  };
+
+  bool applyWindow(const Json::Value& event, std::vector<TreeDelta>& deltas);
+  bool applyWorkspace(const Json::Value& event, std::vector<TreeDelta>& deltas);
+  void index(Json::Value& node, int64_t parent);
+  void unindex(const Json::Value& node);
+  /// Replace a known container and its children with the one from an event
+  bool replace(const Json::Value& container);
+  bool remove(int64_t id);
+  Json::Value* output(const std::string& name);
+
+  Json::Value root_;
+  std::unordered_map<int64_t, Entry> nodes_;
+  int64_t focused_ = -1;
+};
+
+}  // namespace waybar::modules::sway
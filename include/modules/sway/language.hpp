@@ -9,15 +9,15 @@
 #include "ALabel.hpp"
 #include "bar.hpp"
 #include "client.hpp"
-#include "modules/sway/ipc/client.hpp"
+#include "modules/sway/ipc/hub.hpp"
 #include "util/json.hpp"
 
 namespace waybar::modules::sway {
 
-class Language : public ALabel, public sigc::trackable {
+class Language : public ALabel, public IpcHandler {
  public:
   Language(const std::string& id, const Json::Value& config);
-  virtual ~Language() = default;
+  ~Language() override;
   auto update() -> void override;
 
  private:
@@ -44,7 +44,7 @@ class Language : public ALabel, public sigc::trackable {
     std::map<std::string, rxkb_layout*> base_layouts_by_name_;
   };
 
-  void onEvent(const struct Ipc::ipc_response&);
+  void onEvent(const struct Ipc::ipc_response&) override;
   void onCmd(const struct Ipc::ipc_response&);
 
   auto set_current_layout(std::string current_layout) -> void;
@@ -62,7 +62,7 @@ class Language : public ALabel, public sigc::trackable {
 
   util::JsonParser parser_;
   std::mutex mutex_;
-  Ipc ipc_;
+  IpcHub& ipc_;
 };
 
 }  // namespace waybar::modules::sway
@@ -5,24 +5,24 @@
 #include "ALabel.hpp"
 #include "bar.hpp"
 #include "client.hpp"
-#include "modules/sway/ipc/client.hpp"
+#include "modules/sway/ipc/hub.hpp"
 #include "util/json.hpp"
 
 namespace waybar::modules::sway {
 
-class Mode : public ALabel, public sigc::trackable {
+class Mode : public ALabel, public IpcHandler {
  public:
   Mode(const std::string&, const Json::Value&);
-  virtual ~Mode() = default;
+  ~Mode() override;
   auto update() -> void override;
 
  private:
-  void onEvent(const struct Ipc::ipc_response&);
+  void onEvent(const struct Ipc::ipc_response&) override;
 
   std::string mode_;
   util::JsonParser parser_;
   std::mutex mutex_;
-  Ipc ipc_;
+  IpcHub& ipc_;
 };
 
 }  // namespace waybar::modules::sway
@@ -8,20 +8,18 @@
 #include "ALabel.hpp"
 #include "bar.hpp"
 #include "client.hpp"
-#include "modules/sway/ipc/client.hpp"
+#include "modules/sway/ipc/hub.hpp"
 #include "util/json.hpp"
 
 namespace waybar::modules::sway {
-class Scratchpad : public ALabel {
+class Scratchpad : public ALabel, public IpcHandler {
  public:
   Scratchpad(const std::string&, const Json::Value&);
-  virtual ~Scratchpad() = default;
+  ~Scratchpad() override;
   auto update() -> void override;
 
  private:
-  auto getTree() -> void;
-  auto onCmd(const struct Ipc::ipc_response&) -> void;
-  auto onEvent(const struct Ipc::ipc_response&) -> void;
+  auto onTree(const SwayTree& tree, const std::vector<TreeDelta>& deltas) -> void override;
 
   std::string tooltip_format_;
   bool show_empty_;
@@ -29,7 +27,6 @@ class Scratchpad : public ALabel {
   std::string tooltip_text_;
   int count_;
   std::mutex mutex_;
-  Ipc ipc_;
-  util::JsonParser parser_;
+  IpcHub& ipc_;
 };
 }  // namespace waybar::modules::sway
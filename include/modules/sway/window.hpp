@@ -7,27 +7,27 @@
 #include "AAppIconLabel.hpp"
 #include "bar.hpp"
 #include "client.hpp"
-#include "modules/sway/ipc/client.hpp"
+#include "modules/sway/ipc/hub.hpp"
 #include "util/json.hpp"
+#include "util/rewrite_string.hpp"
 
 namespace waybar::modules::sway {
 
-class Window : public AAppIconLabel, public sigc::trackable {
+class Window : public AAppIconLabel, public IpcHandler {
  public:
   Window(const std::string&, const waybar::Bar&, const Json::Value&);
-  virtual ~Window() = default;
+  ~Window() override;
   auto update() -> void override;
 
  private:
   void setClass(const std::string& classname, bool enable);
-  void onEvent(const struct Ipc::ipc_response&);
-  void onCmd(const struct Ipc::ipc_response&);
+  void onTree(const SwayTree& tree, const std::vector<TreeDelta>& deltas) override;
   std::tuple<std::size_t, int, int, std::string, std::string, std::string, std::string, std::string,
              std::string>
   getFocusedNode(const Json::Value& nodes, std::string& output);
-  void getTree();
 
   const Bar& bar_;
+  util::RewriteRuleSet rewrite_rules_;
   std::string window_;
   int windowId_;
   std::string app_id_;
@@ -38,9 +38,8 @@ class Window : public AAppIconLabel, public sigc::trackable {
   std::string shell_;
   std::string marks_;
   int floating_count_;
-  util::JsonParser parser_;
   std::mutex mutex_;
-  Ipc ipc_;
+  IpcHub& ipc_;
 };
 
 }  // namespace waybar::modules::sway
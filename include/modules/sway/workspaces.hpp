@@ -4,56 +4,79 @@
 #include <gtkmm/button.h>
 #include <gtkmm/label.h>
 
+#include <cstdint>
+#include <memory>
 #include <string_view>
 #include <unordered_map>
 
 #include "AModule.hpp"
 #include "bar.hpp"
 #include "client.hpp"
-#include "modules/sway/ipc/client.hpp"
+#include "modules/sway/ipc/hub.hpp"
 #include "util/json.hpp"
 #include "util/regex_collection.hpp"
 
 namespace waybar::modules::sway {
 
-class Workspaces : public AModule, public sigc::trackable {
+class Workspaces : public AModule, public IpcHandler, public sigc::trackable {
  public:
   Workspaces(const std::string&, const waybar::Bar&, const Json::Value&);
-  ~Workspaces() override = default;
+  ~Workspaces() override;
   auto update() -> void override;
 
  private:
   static constexpr std::string_view workspace_switch_cmd_ = "workspace {} \"{}\"";
   static constexpr std::string_view persistent_workspace_switch_cmd_ =
       R"(workspace {} "{}"; move workspace to output "{}"; workspace {} "{}")";
+  // Queued workspace switches replace each other
+  static constexpr std::string_view workspace_switch_key_ = "workspace";
+
+  /// A workspace, digested on the IPC thread so that update() only has the widgets to change
+  struct WorkspaceState {
+    // The workspace without its containers, or a persistent workspace from the config
+    Json::Value node;
+    std::string name;
+    std::string label;
+    bool focused = false;
+    bool visible = false;
+    bool urgent = false;
+    bool empty = true;
+  };
+  using WorkspaceStates = std::vector<WorkspaceState>;
 
   static int convertWorkspaceNameToNum(std::string name);
   static int windowRewritePriorityFunction(std::string const& window_rule);
 
-  void onCmd(const struct Ipc::ipc_response&);
-  void onEvent(const struct Ipc::ipc_response&);
-  bool filterButtons();
+  void onTree(const SwayTree& tree, const std::vector<TreeDelta>& deltas) override;
+  /// Replace workspaces_ with the workspaces of the tree, under digestMutex_
+  void digestTree(const SwayTree& tree);
+  WorkspaceState digest(Json::Value node, int64_t focused);
+  bool filterButtons(const WorkspaceStates& workspaces);
   static bool hasFlag(const Json::Value&, const std::string&);
+  static void setClass(Gtk::Button& button, const std::string& classname, bool enable);
   void updateWindows(const Json::Value&, std::string&);
   Gtk::Button& addButton(const Json::Value&);
-  void onButtonReady(const Json::Value&, Gtk::Button&);
-  std::string getIcon(const std::string&, const Json::Value&);
-  std::string getCycleWorkspace(std::vector<Json::Value>::iterator, bool prev) const;
+  void onButtonReady(const WorkspaceState&, Gtk::Button&);
+  std::string getIcon(const WorkspaceState&);
+  std::string getCycleWorkspace(const WorkspaceStates& workspaces,
+                                WorkspaceStates::const_iterator it, bool prev) const;
   uint16_t getWorkspaceIndex(const std::string& name) const;
   static std::string trimWorkspaceName(std::string);
   bool handleScroll(GdkEventScroll* /*unused*/) override;
 
   const Bar& bar_;
-  std::vector<Json::Value> workspaces_;
+  // Replaced as a whole by onTree, under mutex_
+  std::shared_ptr<const WorkspaceStates> workspaces_ = std::make_shared<const WorkspaceStates>();
   std::vector<std::string> high_priority_named_;
   std::vector<std::string> workspaces_order_;
   Gtk::Box box_;
   std::string m_formatWindowSeparator;
   util::RegexCollection m_windowRewriteRules;
-  util::JsonParser parser_;
   std::unordered_map<std::string, Gtk::Button> buttons_;
   std::mutex mutex_;
-  Ipc ipc_;
+  // Serializes the digests of the constructor and of the IPC thread
+  std::mutex digestMutex_;
+  IpcHub& ipc_;
 };
 
 }  // namespace waybar::modules::sway
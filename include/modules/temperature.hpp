@@ -5,7 +5,7 @@
 #include <fstream>
 
 #include "ALabel.hpp"
-#include "util/sleeper_thread.hpp"
+#include "util/scheduler.hpp"
 
 namespace waybar::modules {
 
@@ -21,7 +21,7 @@ class Temperature : public ALabel {
   bool isWarning(uint16_t);
 
   std::string file_path_;
-  util::SleeperThread thread_;
+  util::PeriodicJob thread_;
 };
 
 }  // namespace waybar::modules
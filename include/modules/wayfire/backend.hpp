@@ -12,6 +12,8 @@
 #include <unordered_map>
 #include <utility>
 
+#include "util/reactor.hpp"
+
 namespace waybar::modules::wayfire {
 
 using EventHandler = std::function<void(const std::string& event)>;
@@ -97,11 +99,16 @@ class IPC {
   std::mutex handlers_mutex;
   State state;
   std::mutex state_mutex;
+  std::optional<Sock> event_sock_;
+  std::string event_buf_;
+  util::Reactor::Watch event_watch_;
 
   IPC() { start(); }
 
   static auto connect() -> Sock;
+  auto parse(const char* begin, const char* end) -> Json::Value;
   auto receive(Sock& sock) -> Json::Value;
+  auto receive_events() -> bool;
   auto start() -> void;
   auto root_event_handler(const std::string& event, const Json::Value& data) -> void;
   auto update_state_handler(const std::string& event, const Json::Value& data) -> void;
@@ -3,6 +3,7 @@
 #include "AAppIconLabel.hpp"
 #include "bar.hpp"
 #include "modules/wayfire/backend.hpp"
+#include "util/rewrite_string.hpp"
 
 namespace waybar::modules::wayfire {
 
@@ -11,6 +12,7 @@ class Window : public AAppIconLabel {
   EventHandler handler;
 
   const Bar& bar_;
+  util::RewriteRuleSet rewrite_rules_;
   std::string old_app_id_;
 
  public:
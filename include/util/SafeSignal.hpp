@@ -1,9 +1,11 @@
 #pragma once
 
-#include <glibmm/dispatcher.h>
 #include <sigc++/signal.h>
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <thread>
@@ -11,6 +13,8 @@
 #include <type_traits>
 #include <utility>
 
+#include "util/dispatcher.hpp"
+
 #ifdef __OpenBSD__
 #define SIGRTMIN SIGUSR1 - 1
 #define SIGRTMAX SIGUSR1 + 1
@@ -18,14 +22,95 @@
 
 namespace waybar {
 
+/// Every emitted value is delivered, in order
+struct QueuePolicy {};
+/// Only the latest pending value is delivered, the values it replaced are counted as dropped
+struct ConflatePolicy {};
+
+namespace detail {
+
+template <typename Policy, typename T>
+class SafeSignalStorage;
+
+template <typename T>
+class SafeSignalStorage<QueuePolicy, T> {
+ public:
+  /// Returns true if the main thread has to be notified
+  template <typename... EmitArgs>
+  bool push(EmitArgs&&... args) {
+    std::unique_lock lock(mutex_);
+    queue_.emplace(std::forward<EmitArgs>(args)...);
+    return true;
+  }
+
+  template <typename Fn>
+  void drain(Fn&& fn) {
+    for (std::unique_lock lock(mutex_); !queue_.empty(); lock.lock()) {
+      auto args = queue_.front();
+      queue_.pop();
+      lock.unlock();
+      fn(args);
+    }
+  }
+
+  uint64_t dropped() const { return 0; }
+
+ private:
+  std::mutex mutex_;
+  std::queue<T> queue_;
+};
+
+/**
+ * Lock-free single slot: the producer swaps in a new value and frees the one it replaced, the
+ * consumer swaps the slot out.
+ */
+template <typename T>
+class SafeSignalStorage<ConflatePolicy, T> {
+ public:
+  SafeSignalStorage() = default;
+  SafeSignalStorage(const SafeSignalStorage&) = delete;
+  SafeSignalStorage& operator=(const SafeSignalStorage&) = delete;
+  ~SafeSignalStorage() { delete slot_.load(); }
+
+  template <typename... EmitArgs>
+  bool push(EmitArgs&&... args) {
+    auto* value = new T(std::forward<EmitArgs>(args)...);
+    std::unique_ptr<T> replaced(slot_.exchange(value, std::memory_order_acq_rel));
+    if (replaced) {
+      // The main thread is already notified and will pick up the new value
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  }
+
+  template <typename Fn>
+  void drain(Fn&& fn) {
+    std::unique_ptr<T> value(slot_.exchange(nullptr, std::memory_order_acq_rel));
+    if (value) {
+      fn(*value);
+    }
+  }
+
+  uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<T*> slot_ = nullptr;
+  std::atomic<uint64_t> dropped_ = 0;
+};
+
+}  // namespace detail
+
 /**
  * Thread-safe signal wrapper.
- * Uses Glib::Dispatcher to pass events to another thread and locked queue to pass the arguments.
+ * Uses util::Dispatcher to pass events to the main thread and a storage selected by `Policy` to
+ * pass the arguments: a locked queue (QueuePolicy) or a single "latest value wins" slot
+ * (ConflatePolicy) for producers that can outrun the main thread.
  */
-template <typename... Args>
-struct SafeSignal : sigc::signal<void(std::decay_t<Args>...)> {
+template <typename Policy, typename... Args>
+struct BasicSafeSignal : sigc::signal<void(std::decay_t<Args>...)> {
  public:
-  SafeSignal() { dp_.connect(sigc::mem_fun(*this, &SafeSignal::handle_event)); }
+  BasicSafeSignal() { dp_.connect(sigc::mem_fun(*this, &BasicSafeSignal::handle_event)); }
 
   template <typename... EmitArgs>
   void emit(EmitArgs&&... args) {
@@ -38,11 +123,7 @@ struct SafeSignal : sigc::signal<void(std::decay_t<Args>...)> {
        * disrupts chronological order.
        */
       signal_t::emit(std::forward<EmitArgs>(args)...);
-    } else {
-      {
-        std::unique_lock lock(mutex_);
-        queue_.emplace(std::forward<EmitArgs>(args)...);
-      }
+    } else if (storage_.push(std::forward<EmitArgs>(args)...)) {
       dp_.emit();
     }
   }
@@ -52,6 +133,9 @@ struct SafeSignal : sigc::signal<void(std::decay_t<Args>...)> {
     emit(std::forward<EmitArgs>(args)...);
   }
 
+  /// Number of values replaced before the main thread could deliver them
+  uint64_t dropped() const { return storage_.dropped(); }
+
  protected:
   using signal_t = sigc::signal<void(std::decay_t<Args>...)>;
   using slot_t = decltype(std::declval<signal_t>().make_slot());
@@ -61,20 +145,20 @@ struct SafeSignal : sigc::signal<void(std::decay_t<Args>...)> {
   using signal_t::make_slot;
 
   void handle_event() {
-    for (std::unique_lock lock(mutex_); !queue_.empty(); lock.lock()) {
-      auto args = queue_.front();
-      queue_.pop();
-      lock.unlock();
-      std::apply(cached_fn_, args);
-    }
+    storage_.drain([this](const arg_tuple_t& args) { std::apply(cached_fn_, args); });
   }
 
-  Glib::Dispatcher dp_;
-  std::mutex mutex_;
-  std::queue<arg_tuple_t> queue_;
+  util::Dispatcher dp_;
+  detail::SafeSignalStorage<Policy, arg_tuple_t> storage_;
   const std::thread::id main_tid_ = std::this_thread::get_id();
   // cache functor for signal emission to avoid recreating it on each event
   const slot_t cached_fn_ = make_slot();
 };
 
+template <typename... Args>
+using SafeSignal = BasicSafeSignal<QueuePolicy, Args...>;
+
+template <typename... Args>
+using ConflatingSafeSignal = BasicSafeSignal<ConflatePolicy, Args...>;
+
 }  // namespace waybar
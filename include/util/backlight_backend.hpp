@@ -4,6 +4,7 @@
 #include <spdlog/spdlog.h>
 
 #include <chrono>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
@@ -12,7 +13,8 @@
 
 #include "giomm/dbusproxy.h"
 #include "util/backend_common.hpp"
-#include "util/sleeper_thread.hpp"
+#include "util/reactor.hpp"
+#include "util/scheduler.hpp"
 
 #define GET_BEST_DEVICE(varname, backend, preferred_device)          \
   decltype((backend).devices_) __devices;                            \
@@ -71,17 +73,21 @@ class BacklightBackend {
 
  private:
   void set_brightness_internal(const std::string &device_name, int brightness, int max_brightness);
+  void refresh_devices(bool enumerate);
 
   std::function<void()> on_updated_cb_;
   std::chrono::milliseconds polling_interval_;
 
   std::optional<BacklightDevice> previous_best_;
-  // thread must destruct before shared data
-  util::SleeperThread udev_thread_;
+  std::unique_ptr<udev, decltype(&udev_unref)> udev_{nullptr, udev_unref};
+  std::unique_ptr<udev_monitor, decltype(&udev_monitor_unref)> udev_monitor_{nullptr,
+                                                                             udev_monitor_unref};
+  std::mutex refresh_mutex_;
+  // watchers must destruct before shared data
+  util::Reactor::Watch udev_watch_;
+  util::PeriodicJob poll_job_;
 
   Glib::RefPtr<Gio::DBus::Proxy> login_proxy_;
-
-  static constexpr int EPOLL_MAX_EVENTS = 16;
 };
 
 }  // namespace waybar::util
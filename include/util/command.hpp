@@ -8,6 +8,7 @@
 
 #ifdef __linux__
 #include <sys/prctl.h>
+#include <sys/syscall.h>
 #endif
 #ifdef __FreeBSD__
 #include <sys/procctl.h>
@@ -15,6 +16,8 @@
 
 #include <array>
 
+#include "util/stop_source.hpp"
+
 extern std::mutex reap_mtx;
 extern std::list<pid_t> reap;
 
@@ -25,13 +28,26 @@ struct res {
   std::string out;
 };
 
-inline std::string read(FILE* fp) {
-  std::array<char, 128> buffer = {0};
+/**
+ * Read the output of a command until EOF.
+ * With `stop`, the read is abandoned as soon as stop is requested and the partial output returned.
+ */
+inline std::string read(FILE* fp, const StopSource* stop = nullptr) {
+  std::array<char, 4096> buffer;
   std::string output;
-  while (feof(fp) == 0) {
-    if (fgets(buffer.data(), 128, fp) != nullptr) {
-      output += buffer.data();
+  int fd = fileno(fp);
+  while (stop == nullptr || stop->wait(fd)) {
+    auto n = ::read(fd, buffer.data(), buffer.size());
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      spdlog::error("Unable to read cmd output: {}", strerror(errno));
+    }
+    if (n <= 0) {
+      break;
     }
+    output.append(buffer.data(), n);
   }
 
   // Remove last newline
@@ -41,14 +57,84 @@ inline std::string read(FILE* fp) {
   return output;
 }
 
-inline int close(FILE* fp, pid_t pid) {
+/**
+ * Read the next line of a continuous command into `line`, without the newline.
+ * `buffer` holds what was read past that line and must be kept between calls.
+ * Returns false on EOF, error or when `stop` is requested.
+ */
+inline bool readLine(FILE* fp, std::string& buffer, std::string& line,
+                     const StopSource* stop = nullptr) {
+  std::array<char, 4096> chunk;
+  int fd = fileno(fp);
+  size_t scanned = 0;
+  while (true) {
+    if (auto pos = buffer.find('\n', scanned); pos != std::string::npos) {
+      line.assign(buffer, 0, pos);
+      buffer.erase(0, pos + 1);
+      return true;
+    }
+    scanned = buffer.size();
+    if (stop != nullptr && !stop->wait(fd)) {
+      return false;
+    }
+    auto n = ::read(fd, chunk.data(), chunk.size());
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      // Last line without a trailing newline
+      if (buffer.empty()) {
+        return false;
+      }
+      line = std::move(buffer);
+      buffer.clear();
+      return true;
+    }
+    buffer.append(chunk.data(), n);
+  }
+}
+
+/**
+ * Wait for `pid` to exit or `stop` to be requested, returns false on stop.
+ * Relies on pidfd; where it is not available this returns immediately and the caller's waitpid
+ * blocks as before.
+ */
+inline bool waitExit(pid_t pid, const StopSource* stop) {
+#if defined(__linux__) && defined(SYS_pidfd_open)
+  if (stop == nullptr) {
+    return true;
+  }
+  int pidfd = syscall(SYS_pidfd_open, pid, 0);
+  if (pidfd == -1) {
+    return true;
+  }
+  bool exited = stop->wait(pidfd);
+  ::close(pidfd);
+  return exited;
+#else
+  return true;
+#endif
+}
+
+/// Close the output of a command and reap it. When `stop` is requested, the command is terminated.
+inline int close(FILE* fp, pid_t pid, const StopSource* stop = nullptr) {
   int stat = -1;
   pid_t ret;
 
   fclose(fp);
+  if (!waitExit(pid, stop)) {
+    killpg(pid, SIGTERM);
+  }
   do {
     ret = waitpid(pid, &stat, WCONTINUED | WUNTRACED);
 
+    if (ret == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      spdlog::debug("waitpid failed: {}", strerror(errno));
+      break;
+    }
     if (WIFEXITED(stat)) {
       spdlog::debug("Cmd exited with code {}", WEXITSTATUS(stat));
     } else if (WIFSIGNALED(stat)) {
@@ -57,8 +143,6 @@ inline int close(FILE* fp, pid_t pid) {
       spdlog::debug("Cmd stopped by {}", WSTOPSIG(stat));
     } else if (WIFCONTINUED(stat)) {
       spdlog::debug("Cmd continued");
-    } else if (ret == -1) {
-      spdlog::debug("waitpid failed: {}", strerror(errno));
     } else {
       break;
     }
@@ -115,26 +199,30 @@ inline FILE* open(const std::string& cmd, int& pid, const std::string& output_na
     execlp("/bin/sh", "sh", "-c", cmd.c_str(), (char*)0);
     exit(0);
   } else {
+    // Also set the group from the parent, so that it exists before a killpg on stop
+    setpgid(child_pid, child_pid);
     ::close(fd[1]);
   }
   pid = child_pid;
   return fdopen(fd[0], "r");
 }
 
-inline struct res exec(const std::string& cmd, const std::string& output_name) {
+/// Run `cmd` and collect its output. When `stop` is requested, the command is terminated.
+inline struct res exec(const std::string& cmd, const std::string& output_name,
+                       const StopSource* stop = nullptr) {
   int pid;
   auto fp = command::open(cmd, pid, output_name);
   if (!fp) return {-1, ""};
-  auto output = command::read(fp);
-  auto stat = command::close(fp, pid);
+  auto output = command::read(fp, stop);
+  auto stat = command::close(fp, pid, stop);
   return {WEXITSTATUS(stat), output};
 }
 
-inline struct res execNoRead(const std::string& cmd) {
+inline struct res execNoRead(const std::string& cmd, const StopSource* stop = nullptr) {
   int pid;
   auto fp = command::open(cmd, pid, "");
   if (!fp) return {-1, ""};
-  auto stat = command::close(fp, pid);
+  auto stat = command::close(fp, pid, stop);
   return {WEXITSTATUS(stat), ""};
 }
 
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "scheduler.hpp"
+
+namespace waybar::util {
+
+/**
+ * Commands run one after the other on the shared Scheduler, so that click and scroll handlers
+ * return without waiting for the compositor.
+ *
+ * A command pushed with a key replaces the queued command with the same key that hasn't started
+ * yet, e.g. scrolling through workspaces faster than the compositor follows only switches to the
+ * last one. Pending commands are dropped when the queue is destroyed.
+ */
+class CommandQueue {
+ public:
+  using Command = std::function<void()>;
+
+  CommandQueue();
+  CommandQueue(const CommandQueue&) = delete;
+  CommandQueue& operator=(const CommandQueue&) = delete;
+  /// Waits for the running command
+  ~CommandQueue();
+
+  /// Thread-safe. Exceptions thrown by the command are logged.
+  void push(Command command, std::string key = "");
+
+ private:
+  void run();
+
+  std::mutex mutex_;
+  std::deque<std::pair<std::string, Command>> commands_;
+  Scheduler::JobPtr job_;
+};
+
+}  // namespace waybar::util
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <sigc++/connection.h>
+#include <sigc++/signal.h>
+
+#include <atomic>
+#include <memory>
+
+namespace waybar::util {
+
+/**
+ * Cross-thread notification to the main loop, a drop-in for Glib::Dispatcher.
+ *
+ * Instead of a pipe and a GSource per instance, all dispatchers post into one process-wide queue
+ * backed by a single eventfd. The main loop is woken up once and runs every queued dispatcher.
+ * Emissions of a dispatcher that is already queued are coalesced into a single call.
+ */
+class Dispatcher {
+ public:
+  Dispatcher();
+  Dispatcher(const Dispatcher&) = delete;
+  Dispatcher& operator=(const Dispatcher&) = delete;
+  ~Dispatcher();
+
+  /// Thread-safe, the connected slots run on the main loop
+  void emit();
+  void operator()() { emit(); }
+
+  /// Must be called from the main thread
+  sigc::connection connect(const sigc::slot<void()>& slot);
+
+  struct State {
+    sigc::signal<void()> signal;
+    std::atomic<bool> queued = false;
+    // Cleared by the destructor, a queued state may outlive its dispatcher
+    std::atomic<bool> alive = true;
+  };
+
+ private:
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace waybar::util
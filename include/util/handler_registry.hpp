@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace waybar::util {
+
+/**
+ * Event handlers of an IPC client, by event (Hyprland, Sway, Niri and Fht).
+ *
+ * The table is copy-on-write: dispatch() loads the current one and runs the handlers without any
+ * lock, so registering never waits for a handler, and handlers may add and remove handlers,
+ * themselves included. Each registration counts the dispatches running it, remove() waits for
+ * those of other threads: once it returns, the handler is not running and won't be called again.
+ *
+ * `Data` is stored along with each registration and passed to the handler's call, e.g. the events
+ * a Sway tree handler registered for.
+ */
+template <typename Key, typename Handler, typename Data = std::monostate,
+          typename Hash = std::hash<Key>, typename Equal = std::equal_to<>>
+class HandlerRegistry {
+ public:
+  HandlerRegistry() = default;
+  HandlerRegistry(const HandlerRegistry&) = delete;
+  HandlerRegistry& operator=(const HandlerRegistry&) = delete;
+
+  /// Thread-safe. A handler added during a dispatch is called from the next one.
+  void add(const Key& key, Handler* handler, Data data = {}) {
+    std::lock_guard lock(writeMutex_);
+    auto table = std::make_shared<Table>(*table_.load());
+    (*table)[key].push_back(std::make_shared<Slot>(handler, std::move(data)));
+    table_.store(std::move(table));
+  }
+
+  /// Remove all the registrations of `handler`. Thread-safe.
+  void remove(Handler* handler) {
+    std::vector<std::shared_ptr<Slot>> removed;
+    {
+      std::lock_guard lock(writeMutex_);
+      auto table = std::make_shared<Table>(*table_.load());
+      for (auto it = table->begin(); it != table->end();) {
+        std::erase_if(it->second, [&](const auto& slot) {
+          if (slot->handler != handler) {
+            return false;
+          }
+          removed.push_back(slot);
+          return true;
+        });
+        it = it->second.empty() ? table->erase(it) : std::next(it);
+      }
+      table_.store(std::move(table));
+    }
+
+    for (const auto& slot : removed) {
+      // Paired with the increment in dispatch(): either the dispatch sees the flag and skips the
+      // handler, or we see its count and wait
+      slot->removed.store(true);
+      const auto own = Running::count(slot.get());
+      for (auto n = slot->running.load(); n > own; n = slot->running.load()) {
+        slot->running.wait(n);
+      }
+    }
+  }
+
+  /// Call `call(handler, data)` for the handlers registered for `key`, in registration order
+  template <typename K, typename F>
+  void dispatch(const K& key, F&& call) const {
+    auto table = table_.load();
+    auto it = table->find(key);
+    if (it == table->end()) {
+      return;
+    }
+    for (const auto& slot : it->second) {
+      Running running(slot.get());
+      if (!slot->removed.load()) {
+        call(*slot->handler, std::as_const(slot->data));
+      }
+    }
+  }
+
+ private:
+  struct Slot {
+    Slot(Handler* handler, Data data) : handler(handler), data(std::move(data)) {}
+
+    Handler* const handler;
+    const Data data;
+    std::atomic<bool> removed = false;
+    // Dispatches running the handler, or about to
+    std::atomic<int> running = 0;
+  };
+  using Table = std::unordered_map<Key, std::vector<std::shared_ptr<Slot>>, Hash, Equal>;
+
+  /// Counts a dispatch of a slot, and keeps the ones running on this thread, innermost first
+  class Running {
+   public:
+    explicit Running(Slot* slot) : slot_(slot), outer_(innermost_) {
+      slot_->running.fetch_add(1);
+      innermost_ = this;
+    }
+    ~Running() {
+      innermost_ = outer_;
+      slot_->running.fetch_sub(1);
+      slot_->running.notify_all();
+    }
+    Running(const Running&) = delete;
+    Running& operator=(const Running&) = delete;
+
+    /// Dispatches of `slot` running on this thread
+    static int count(const Slot* slot) {
+      int n = 0;
+      for (const auto* running = innermost_; running != nullptr; running = running->outer_) {
+        n += running->slot_ == slot ? 1 : 0;
+      }
+      return n;
+    }
+
+   private:
+    Slot* slot_;
+    const Running* outer_;
+    static inline thread_local const Running* innermost_ = nullptr;
+  };
+
+  std::mutex writeMutex_;
+  std::atomic<std::shared_ptr<const Table>> table_{std::make_shared<const Table>()};
+};
+
+}  // namespace waybar::util
@@ -3,11 +3,11 @@
 #include <fmt/ostream.h>
 #include <json/json.h>
 
-#include <algorithm>
-#include <codecvt>
-#include <iostream>
-#include <locale>
-#include <regex>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 
 #if (FMT_VERSION >= 90000)
 
@@ -22,26 +22,58 @@ class JsonParser {
  public:
   JsonParser() = default;
 
-  Json::Value parse(const std::string& jsonStr) {
+  Json::Value parse(std::string_view jsonStr) {
     Json::Value root;
 
-    // replace all occurrences of "\x" with "\u00", because JSON doesn't allow "\x" escape sequences
-    std::string modifiedJsonStr = replaceHexadecimalEscape(jsonStr);
+    // replace all "\x" escapes with "\u00", because JSON doesn't allow "\x" escape sequences
+    std::string escaped;
+    if (replaceHexadecimalEscape(jsonStr, escaped)) {
+      jsonStr = escaped;
+    }
 
-    std::istringstream jsonStream(modifiedJsonStr);
     std::string errs;
-    if (!Json::parseFromStream(m_readerBuilder, jsonStream, &root, &errs)) {
+    if (!reader()->parse(jsonStr.data(), jsonStr.data() + jsonStr.size(), &root, &errs)) {
       throw std::runtime_error("Error parsing JSON: " + errs);
     }
     return root;
   }
 
  private:
-  Json::CharReaderBuilder m_readerBuilder;
+  // A CharReader keeps state while parsing, share one per thread instead of one per call
+  static Json::CharReader* reader() {
+    thread_local std::unique_ptr<Json::CharReader> reader(
+        Json::CharReaderBuilder().newCharReader());
+    return reader.get();
+  }
 
-  static std::string replaceHexadecimalEscape(const std::string& str) {
-    static std::regex re("\\\\x");
-    return std::regex_replace(str, re, "\\u00");
+  /// Single scan, jumping from backslash to backslash. Leaves `out` alone and returns false if
+  /// there is no "\x" escape, which is the common case.
+  static bool replaceHexadecimalEscape(std::string_view str, std::string& out) {
+    const char* begin = str.data();
+    const char* end = begin + str.size();
+    const char* copied = begin;
+    const char* pos = begin;
+    while ((pos = static_cast<const char*>(std::memchr(pos, '\\', end - pos))) != nullptr) {
+      if (pos + 1 == end) {
+        break;
+      }
+      if (pos[1] == 'x') {
+        if (out.empty()) {
+          out.reserve(str.size() + 16);
+        }
+        out.append(copied, pos);
+        out.append("\\u00");
+        copied = pos + 2;
+      }
+      // skip the escaped character, "\\x" is an escaped backslash followed by x
+      pos += 2;
+    }
+    if (copied == begin) {
+      return false;
+    }
+    out.append(copied, end);
+    return true;
   }
 };
+
 }  // namespace waybar::util
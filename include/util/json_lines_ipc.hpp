@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "util/command_queue.hpp"
+#include "util/handler_registry.hpp"
+#include "util/json.hpp"
+#include "util/line_buffer.hpp"
+#include "util/reactor.hpp"
+#include "util/scheduler.hpp"
+
+namespace waybar::util {
+
+class JsonEventHandler {
+ public:
+  virtual void onEvent(const Json::Value& ev) = 0;
+  virtual ~JsonEventHandler() = default;
+};
+
+/**
+ * Event stream of a compositor speaking newline-delimited JSON on a unix socket (Niri, Fht).
+ *
+ * The socket is read on the shared Reactor into a LineBuffer, each line is parsed in place and
+ * handed to the backend's reducer, which applies it to the backend state and names the event for
+ * the handlers registered for it. When the compositor closes the stream, the connection is retried
+ * on the Scheduler with a growing delay; compositors send their whole state again on a new stream.
+ */
+class JsonLinesIpc {
+ public:
+  struct Protocol {
+    /// For the logs, e.g. "Niri"
+    std::string name;
+    /// Environment variable with the socket path
+    std::string socketEnv;
+    /// Request starting the event stream
+    Json::Value subscribe;
+    /// Line the compositor replies to it with before the events, if any
+    std::string ack;
+  };
+  /// Apply an event to the backend state, and return its name. Runs on the reactor thread, and
+  /// must not block either.
+  using Reducer = std::function<std::string(const Json::Value& ev)>;
+
+  JsonLinesIpc(Protocol protocol, Reducer reducer);
+  JsonLinesIpc(const JsonLinesIpc&) = delete;
+  JsonLinesIpc& operator=(const JsonLinesIpc&) = delete;
+  /// Waits for the running reducer and handlers
+  ~JsonLinesIpc();
+
+  /**
+   * Handlers run on the shared reactor thread, after the reducer. Like reactor callbacks they must
+   * not block, since every other watch waits for them: read the state and emit a dispatcher, leave
+   * the rest to the main thread. Once unregisterForIPC returns, the handler is not running and
+   * won't be called again.
+   */
+  void registerForIPC(const std::string& ev, JsonEventHandler* handler);
+  void unregisterForIPC(JsonEventHandler* handler);
+
+  /// Send one request on a connection of its own, and return the reply. Blocks.
+  static Json::Value send(const Protocol& protocol, const Json::Value& request);
+  /**
+   * Queue a request and return right away, for the main thread. Error replies are logged. A
+   * request with a `key` replaces the queued one with the same key that wasn't sent yet.
+   */
+  void queue(Json::Value request, std::string key = "");
+
+ private:
+  /// Connected socket, or -1 if the environment variable is not set. Throws if unreachable.
+  static int connectToSocket(const Protocol& protocol);
+  static std::string toLine(const Json::Value& value);
+
+  void connect();
+  bool receive(uint32_t events);
+  void handleLine(std::string_view line);
+  void disconnect();
+
+  const Protocol protocol_;
+  const Reducer reducer_;
+  JsonParser parser_;
+
+  // Connection state, used by the connect job and by the reactor callback, never at the same time.
+  // fd_ outlives its watch: the connect job resets the watch before closing it.
+  int fd_ = -1;
+  bool acked_ = false;
+  bool connected_ = true;
+  std::chrono::milliseconds backoff_;
+  LineBuffer buffer_;
+  std::vector<std::string_view> lines_;
+  Reactor::Watch watch_;
+  Scheduler::JobPtr connectJob_;
+
+  HandlerRegistry<std::string, JsonEventHandler> handlers_;
+
+  // Last, so that it stops before the rest goes away
+  CommandQueue commands_;
+};
+
+}  // namespace waybar::util
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace waybar::util {
+
+/**
+ * On-demand JSON reader: walks a document in place, without building a DOM.
+ *
+ * Values are read or skipped in document order. Conversions follow Json::Value: reading a
+ * value of another type gives the default (numbers and booleans convert to each other), and
+ * "\x" escapes are accepted in strings. Malformed documents throw std::runtime_error.
+ *
+ *   reader.beginObject();
+ *   std::string_view key;
+ *   while (reader.nextMember(key)) {
+ *     if (key == "title") title = reader.readString(); else reader.skip();
+ *   }
+ */
+class JsonReader {
+ public:
+  enum class Type { Null, Bool, Number, String, Array, Object, End };
+
+  explicit JsonReader(std::string_view json) : json_(json) {}
+
+  /// Type of the next value, End when the document is exhausted
+  Type peek();
+
+  /// Enter an object. If the next value is something else, it's skipped and false is returned.
+  bool beginObject();
+  /// Move to the next member of the current object, false (and leave it) at its end.
+  /// `key` stays valid until the next call.
+  bool nextMember(std::string_view& key);
+
+  /// Enter an array, like beginObject
+  bool beginArray();
+  /// Move to the next element of the current array, false (and leave it) at its end
+  bool nextElement();
+
+  std::string readString();
+  int64_t readInt();
+  double readDouble();
+  bool readBool();
+  /// Number of elements of an array, 0 for anything else
+  size_t readArraySize();
+  void skip();
+
+  void read(std::string& out) { out = readString(); }
+  void read(int& out) { out = static_cast<int>(readInt()); }
+  void read(int64_t& out) { out = readInt(); }
+  void read(double& out) { out = readDouble(); }
+  void read(bool& out) { out = readBool(); }
+
+ private:
+  char skipWhitespace();
+  void expect(char c);
+  std::string_view readRawString(std::string& scratch);
+  std::string_view readNumberToken();
+  void skipString();
+  [[noreturn]] void fail(const char* what) const;
+
+  std::string_view json_;
+  size_t pos_ = 0;
+  std::string key_;
+};
+
+/**
+ * Declares the members of T read from JSON objects, by dotted path ("workspace.id").
+ * Members not declared are skipped without being decoded.
+ *
+ *   const JsonSchema<Client> schema = {
+ *       {"class", &Client::className},
+ *       {"workspace.id", &Client::workspaceId},
+ *       {"grouped", [](Client& c, JsonReader& r) { c.grouped = r.readArraySize() > 0; }},
+ *   };
+ *   std::vector<Client> clients = schema.readArray(reply);
+ */
+template <typename T>
+class JsonSchema {
+ public:
+  using Reader = std::function<void(T&, JsonReader&)>;
+
+  struct Field {
+    Field(std::string_view path, Reader reader) : path(path), reader(std::move(reader)) {}
+    template <typename M>
+    Field(std::string_view path, M T::*member)
+        : path(path), reader([member](T& out, JsonReader& json) { json.read(out.*member); }) {}
+
+    std::string_view path;
+    Reader reader;
+  };
+
+  JsonSchema(std::initializer_list<Field> fields) {
+    for (const auto& field : fields) {
+      auto* node = &root_;
+      std::string_view path = field.path;
+      while (true) {
+        auto dot = path.find('.');
+        node = &node->child(path.substr(0, dot));
+        if (dot == std::string_view::npos) {
+          break;
+        }
+        path.remove_prefix(dot + 1);
+      }
+      node->reader = field.reader;
+    }
+  }
+
+  /// Fill `out` from the object at the reader's position
+  void readObject(JsonReader& json, T& out) const { readNode(json, root_, out); }
+
+  T read(std::string_view document) const {
+    T out{};
+    JsonReader json(document);
+    if (json.peek() != JsonReader::Type::End) {
+      readObject(json, out);
+    }
+    return out;
+  }
+
+  /// An array of objects, an empty document gives an empty list
+  std::vector<T> readArray(std::string_view document) const {
+    std::vector<T> out;
+    JsonReader json(document);
+    if (json.peek() == JsonReader::Type::End || !json.beginArray()) {
+      return out;
+    }
+    while (json.nextElement()) {
+      readObject(json, out.emplace_back());
+    }
+    return out;
+  }
+
+ private:
+  struct Node {
+    // Few members per level, a linear search beats hashing
+    std::vector<std::pair<std::string, Node>> children;
+    Reader reader;
+
+    Node& child(std::string_view key) {
+      for (auto& [name, node] : children) {
+        if (name == key) {
+          return node;
+        }
+      }
+      return children.emplace_back(std::string(key), Node{}).second;
+    }
+
+    const Node* find(std::string_view key) const {
+      for (const auto& [name, node] : children) {
+        if (name == key) {
+          return &node;
+        }
+      }
+      return nullptr;
+    }
+  };
+
+  static void readNode(JsonReader& json, const Node& node, T& out) {
+    if (!json.beginObject()) {
+      return;
+    }
+    std::string_view key;
+    while (json.nextMember(key)) {
+      const auto* child = node.find(key);
+      if (child == nullptr) {
+        json.skip();
+      } else if (child->reader) {
+        child->reader(out, json);
+      } else {
+        readNode(json, *child, out);
+      }
+    }
+  }
+
+  Node root_;
+};
+
+}  // namespace waybar::util
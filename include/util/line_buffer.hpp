@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace waybar::util {
+
+/**
+ * Receive buffer for line-based protocols.
+ *
+ * Reads go straight into `prepare()`, complete lines are handed out as views into the buffer
+ * without copying. The unconsumed tail is moved back to the front when space is needed, and the
+ * buffer only grows for lines longer than it.
+ */
+class LineBuffer {
+ public:
+  explicit LineBuffer(size_t capacity = 4096) : data_(capacity) {}
+
+  /// Writable space of at least `min` bytes. Invalidates the views returned by `lines`.
+  std::span<char> prepare(size_t min = 4096) {
+    if (data_.size() - end_ < min) {
+      // Move the partial line to the front, then grow if that's not enough
+      std::memmove(data_.data(), data_.data() + begin_, end_ - begin_);
+      end_ -= begin_;
+      scan_ -= begin_;
+      begin_ = 0;
+      if (data_.size() - end_ < min) {
+        data_.resize(std::max(data_.size() * 2, end_ + min));
+      }
+    }
+    return {data_.data() + end_, data_.size() - end_};
+  }
+
+  /// Mark `n` bytes of the prepared space as received
+  void commit(size_t n) { end_ += n; }
+
+  /// Append the complete lines received so far to `out`, without their '\n'
+  void lines(std::vector<std::string_view>& out) {
+    while (scan_ < end_) {
+      const auto* newline =
+          static_cast<const char*>(std::memchr(data_.data() + scan_, '\n', end_ - scan_));
+      if (newline == nullptr) {
+        scan_ = end_;
+        break;
+      }
+      auto pos = static_cast<size_t>(newline - data_.data());
+      out.emplace_back(data_.data() + begin_, pos - begin_);
+      begin_ = scan_ = pos + 1;
+    }
+    if (begin_ == end_) {
+      begin_ = end_ = scan_ = 0;
+    }
+  }
+
+  /// Bytes of the incomplete last line
+  size_t pending() const { return end_ - begin_; }
+
+  void clear() { begin_ = end_ = scan_ = 0; }
+
+ private:
+  std::vector<char> data_;
+  // Unconsumed data is [begin_, end_), lines were searched up to scan_
+  size_t begin_ = 0;
+  size_t end_ = 0;
+  size_t scan_ = 0;
+};
+
+}  // namespace waybar::util
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace waybar::util {
+
+/**
+ * A cache of values by string, holding at most `capacity` entries and evicting the least recently
+ * used one when full.
+ *
+ * Entries live in a vector reserved up front and are chained in recency order by their indices,
+ * the map only points into them. Lookups take a string_view and a hash computed by the caller, so that the hash is
+ * computed once for a lookup followed by an insertion, and hits don't allocate.
+ *
+ *   auto hash = LruCache<T>::hash(key);
+ *   if (auto* value = cache.find(key, hash)) return *value;
+ *   return cache.insert(key, hash, compute(key));
+ */
+template <typename V>
+class LruCache {
+ public:
+  explicit LruCache(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)) {
+    // Never reallocated, the index keeps views of the keys
+    entries_.reserve(capacity_);
+    index_.reserve(capacity_);
+  }
+
+  // The index points into the entries, which a copy wouldn't update
+  LruCache(const LruCache&) = delete;
+  LruCache& operator=(const LruCache&) = delete;
+  LruCache(LruCache&&) = default;
+  LruCache& operator=(LruCache&&) = default;
+
+  static size_t hash(std::string_view key) { return std::hash<std::string_view>{}(key); }
+
+  /// The value cached for `key`, now the most recently used, or nullptr
+  V* find(std::string_view key, size_t keyHash) {
+    auto it = index_.find(Key{key, keyHash});
+    if (it == index_.end()) {
+      misses_++;
+      return nullptr;
+    }
+    hits_++;
+    moveToFront(it->second);
+    return &entries_[it->second].value;
+  }
+
+  /// Cache `value` for `key`, which must not be cached yet. The reference is valid until the next
+  /// insertion.
+  V& insert(std::string_view key, size_t keyHash, V value) {
+    uint32_t entry;
+    if (entries_.size() < capacity_) {
+      entry = entries_.size();
+      entries_.emplace_back();
+    } else {
+      entry = tail_;
+      index_.erase(Key{entries_[entry].key, entries_[entry].hash});
+      unlink(entry);
+    }
+    auto& slot = entries_[entry];
+    slot.key.assign(key);
+    slot.hash = keyHash;
+    slot.value = std::move(value);
+    index_.emplace(Key{slot.key, keyHash}, entry);
+    linkFront(entry);
+    return slot.value;
+  }
+
+  void clear() {
+    index_.clear();
+    entries_.clear();
+    head_ = tail_ = NONE;
+  }
+
+  size_t size() const { return entries_.size(); }
+  size_t capacity() const { return capacity_; }
+  uint64_t hits() const { return hits_; }
+  uint64_t misses() const { return misses_; }
+
+ private:
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  struct Entry {
+    std::string key;
+    size_t hash = 0;
+    V value{};
+    uint32_t prev = NONE;
+    uint32_t next = NONE;
+  };
+
+  // A view of an entry's key with its hash, which the map doesn't recompute
+  struct Key {
+    std::string_view text;
+    size_t hash;
+
+    bool operator==(const Key& other) const { return hash == other.hash && text == other.text; }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const { return key.hash; }
+  };
+
+  void unlink(uint32_t entry) {
+    auto& node = entries_[entry];
+    (node.prev == NONE ? head_ : entries_[node.prev].next) = node.next;
+    (node.next == NONE ? tail_ : entries_[node.next].prev) = node.prev;
+  }
+
+  void linkFront(uint32_t entry) {
+    auto& node = entries_[entry];
+    node.prev = NONE;
+    node.next = head_;
+    (head_ == NONE ? tail_ : entries_[head_].prev) = entry;
+    head_ = entry;
+  }
+
+  void moveToFront(uint32_t entry) {
+    if (entry != head_) {
+      unlink(entry);
+      linkFront(entry);
+    }
+  }
+
+  size_t capacity_;
+  std::vector<Entry> entries_;
+  std::unordered_map<Key, uint32_t, KeyHash> index_;
+  uint32_t head_ = NONE;
+  uint32_t tail_ = NONE;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+};
+
+}  // namespace waybar::util
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <sys/epoll.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace waybar::util {
+
+/**
+ * Process-wide epoll reactor for fd-driven backends.
+ *
+ * A single thread owns one epoll set; backends register an fd, an interest mask and a callback
+ * instead of parking a thread in a blocking read. Callbacks run on the reactor thread, one at a
+ * time, and must not block: read what is available and return. A callback returns false to stop
+ * watching its fd, e.g. on EOF or error.
+ * Wakeups are counted per watch and reported when the watch is removed.
+ */
+class Reactor {
+ public:
+  using Callback = std::function<bool(uint32_t events)>;
+
+  /// RAII registration, removes the fd from the reactor when destroyed or reset
+  class Watch {
+   public:
+    Watch() = default;
+    Watch(const Watch&) = delete;
+    Watch& operator=(const Watch&) = delete;
+    Watch(Watch&& other) noexcept : id_(std::exchange(other.id_, 0)) {}
+    Watch& operator=(Watch&& other) noexcept {
+      reset();
+      id_ = std::exchange(other.id_, 0);
+      return *this;
+    }
+    ~Watch() { reset(); }
+
+    bool active() const { return id_ != 0; }
+    void reset() {
+      if (id_ != 0) {
+        Reactor::instance().remove(std::exchange(id_, 0));
+      }
+    }
+
+   private:
+    friend class Reactor;
+    explicit Watch(uint64_t id) : id_(id) {}
+
+    uint64_t id_ = 0;
+  };
+
+  static Reactor& instance();
+
+  /**
+   * Start watching `fd` for `events` (EPOLLIN, EPOLLOUT, ...).
+   * EPOLLERR and EPOLLHUP are always reported, the callback is expected to return false then.
+   * Throws std::runtime_error if the fd can't be added to the epoll set.
+   */
+  Watch watch(int fd, uint32_t events, Callback callback, std::string name = "");
+
+  Reactor(const Reactor&) = delete;
+  Reactor& operator=(const Reactor&) = delete;
+  ~Reactor();
+
+ private:
+  struct Registration {
+    int fd;
+    std::string name;
+    Callback callback;
+    uint64_t wakeups = 0;
+  };
+
+  Reactor();
+
+  /// Stop watching; waits for a running callback unless called from the reactor thread
+  void remove(uint64_t id);
+  void removeLocked(uint64_t id);
+  void run();
+
+  int epoll_fd_ = -1;
+  int wakeup_fd_ = -1;
+  std::mutex mutex_;
+  std::condition_variable done_cv_;
+  std::unordered_map<uint64_t, std::shared_ptr<Registration>> registrations_;
+  uint64_t next_id_ = 1;
+  uint64_t dispatching_ = 0;
+  uint64_t total_wakeups_ = 0;
+  bool running_ = true;
+  std::thread thread_;
+};
+
+}  // namespace waybar::util
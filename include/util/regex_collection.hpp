@@ -2,22 +2,27 @@
 
 #include <json/json.h>
 
+#include <cstdint>
 #include <functional>
-#include <regex>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
+
+#include "util/lru_cache.hpp"
+#include "util/regex_set.hpp"
 
 namespace waybar::util {
 
 struct Rule {
-  std::regex rule;
+  std::string rule;
   std::string repr;
   int priority;
 
   // Fix for Clang < 16
   // See https://en.cppreference.com/w/cpp/compiler_support/20 "Parenthesized initialization of
   // aggregates"
-  Rule(std::regex rule, std::string repr, int priority)
+  Rule(std::string rule, std::string repr, int priority)
       : rule(std::move(rule)), repr(std::move(repr)), priority(priority) {}
 };
 
@@ -25,29 +30,45 @@ int default_priority_function(std::string& key);
 
 /* A collection of regexes and strings, with a default string to return if no regexes.
  * When a regex is matched, the corresponding string is returned.
- * All regexes that are matched are cached, so that the regexes are only
- * evaluated once against a given string.
+ * The results for the most recently seen strings are cached, so that the regexes
+ * are only evaluated once against a given string.
  * Regexes may be given a higher priority than others, so that they are matched
  * first. The priority function is given the regex string, and should return a
  * higher number for higher priority regexes.
+ * All regexes are compiled into a single RegexSet, and evaluated in one pass.
  */
 class RegexCollection {
+ public:
+  // Window titles change all the time, keep the cache from growing with them
+  static constexpr size_t DEFAULT_CACHE_CAPACITY = 512;
+
  private:
-  std::vector<Rule> rules;
-  std::map<std::string, std::string> regex_cache;
+  struct Result {
+    std::string repr;
+    bool matched_any = false;
+  };
+
+  RegexSet rules{std::regex_constants::ECMAScript | std::regex_constants::icase};
+  // Replacement of each rule of the set
+  std::vector<std::string> reprs;
+  LruCache<Result> regex_cache{DEFAULT_CACHE_CAPACITY};
   std::string default_repr;
 
-  std::string find_match(std::string& value, bool& matched_any);
+  std::string find_match(std::string_view value, bool& matched_any);
 
  public:
   RegexCollection() = default;
   RegexCollection(
       const Json::Value& map, std::string default_repr = "",
-      const std::function<int(std::string&)>& priority_function = default_priority_function);
-  ~RegexCollection() = default;
+      const std::function<int(std::string&)>& priority_function = default_priority_function,
+      size_t cache_capacity = DEFAULT_CACHE_CAPACITY);
+
+  /// The returned reference is valid until the next lookup of an uncached string
+  const std::string& get(std::string_view value, bool& matched_any);
+  const std::string& get(std::string_view value);
 
-  std::string& get(std::string& value, bool& matched_any);
-  std::string& get(std::string& value);
+  uint64_t cache_hits() const { return regex_cache.hits(); }
+  uint64_t cache_misses() const { return regex_cache.misses(); }
 };
 
 }  // namespace waybar::util
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace waybar::util {
+
+/// The result of a RegexSet search: which pattern matched, and its groups
+class RegexMatch {
+ public:
+  RegexMatch(std::string_view input, size_t pattern, std::vector<ptrdiff_t> slots)
+      : input_(input), pattern_(pattern), slots_(std::move(slots)) {}
+
+  /// Index of the pattern in the set
+  size_t pattern() const { return pattern_; }
+  /// Number of groups, the whole match included
+  size_t size() const { return slots_.size() / 2; }
+  bool matched(size_t group) const { return group < size() && slots_[group * 2] >= 0; }
+  std::string_view operator[](size_t group) const;
+  std::string_view prefix() const { return input_.substr(0, slots_[0]); }
+  std::string_view suffix() const { return input_.substr(slots_[1]); }
+
+  /// Expand "$&", "$1".."$99", "$`", "$'" and "$$" in `fmt`, like std::match_results::format
+  std::string format(std::string_view fmt) const;
+
+ private:
+  std::string_view input_;
+  size_t pattern_;
+  // Start and end offsets of each group, -1 for groups that didn't participate
+  std::vector<ptrdiff_t> slots_;
+};
+
+/**
+ * A list of regular expressions (ECMAScript syntax, like std::regex) compiled into one program,
+ * so that an input is searched for all of them in a single pass.
+ *
+ * The patterns share a lazily built DFA, which finds the first pattern matching anywhere in the
+ * input with one table lookup per byte. Only that pattern is then run again by a Pike VM, to get
+ * its groups with the leftmost, first-alternative semantics of std::regex_search. Patterns
+ * using what the VM doesn't implement (backreferences, lookaheads, POSIX classes, loops whose body
+ * can match the empty string) are kept as std::regex, and only tried when they could still win.
+ *
+ * Searching fills the DFA cache, a set can't be searched from several threads at once.
+ */
+class RegexSet {
+ public:
+  explicit RegexSet(
+      std::regex_constants::syntax_option_type flags = std::regex_constants::ECMAScript);
+
+  /// Append a pattern and return its index. Throws std::regex_error if it's invalid.
+  size_t add(std::string_view pattern);
+
+  size_t size() const { return patterns_.size(); }
+  bool empty() const { return patterns_.empty(); }
+
+  /// The match of the first pattern found anywhere in `input`
+  std::optional<RegexMatch> search(std::string_view input);
+
+  /// Indices of all the patterns found in `input`, in order
+  std::vector<size_t> matchAll(std::string_view input);
+
+ private:
+  struct Inst {
+    enum class Op : uint8_t { Byte, Class, Split, Jmp, Save, Assert, Match };
+
+    Op op;
+    // Byte: the byte, Class: index in classes_, Split and Jmp: target, Save: slot,
+    // Assert: the assertion
+    uint32_t x = 0;
+    // Split: lower priority target
+    uint32_t y = 0;
+    uint32_t pattern = 0;
+  };
+
+  struct Pattern {
+    // Entry point in insts_, NO_START for the ones kept as std::regex
+    uint32_t start;
+    // Capture groups, the whole match included
+    size_t groups;
+    // Bytes a match can start with, and whether it can be empty
+    std::bitset<256> first{};
+    bool nullable = false;
+  };
+
+  struct DfaState {
+    // NFA instructions reached by the last byte, before following empty transitions
+    std::vector<uint32_t> pcs;
+    uint32_t context;
+    // Per byte class then the end of input: next state, and the patterns matched before moving
+    // on as an index in matchSets_
+    std::vector<std::pair<uint32_t, uint32_t>> next;
+  };
+
+  class Compiler;
+  struct Threads;
+  struct Frame;
+
+  void buildByteClasses();
+  void resetDfa();
+  uint32_t dfaState(std::vector<uint32_t>&& pcs, uint32_t context);
+  std::pair<uint32_t, uint32_t> dfaStep(uint32_t state, size_t byteClass);
+  /// Call `onMatch` with the compiled patterns matching at each position, until it returns false
+  template <typename F>
+  void dfaRun(std::string_view input, F&& onMatch);
+  /// Index of the first compiled pattern matching `input`, or size() if none does
+  size_t dfaSearch(std::string_view input);
+  /// Groups of the leftmost match of a compiled pattern
+  std::vector<ptrdiff_t> capture(std::string_view input, size_t pattern) const;
+  void addThread(Threads& list, uint32_t pc, std::string_view input, size_t pos,
+                 ptrdiff_t* slots, std::vector<Frame>& stack) const;
+
+  std::regex_constants::syntax_option_type flags_;
+  std::vector<Inst> insts_;
+  std::vector<std::bitset<256>> classes_;
+  std::vector<Pattern> patterns_;
+  size_t slots_ = 2;
+  std::vector<std::pair<size_t, std::regex>> fallback_;
+
+  // Bytes no instruction tells apart share a class and DFA transitions
+  std::array<uint8_t, 256> byteClasses_{};
+  std::array<uint8_t, 256> classBytes_{};
+  size_t numByteClasses_ = 0;
+  std::vector<DfaState> dfa_;
+  std::unordered_map<std::string, uint32_t> dfaIndex_;
+  // Sorted sets of patterns matched by a transition, the first one is empty
+  std::vector<std::vector<uint32_t>> matchSets_;
+  std::map<std::vector<uint32_t>, uint32_t> matchSetIndex_;
+  std::vector<uint32_t> visited_;
+  uint32_t generation_ = 0;
+};
+
+}  // namespace waybar::util
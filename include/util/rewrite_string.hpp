@@ -1,10 +1,47 @@
 #pragma once
 #include <json/json.h>
 
+#include <regex>
 #include <string>
+#include <string_view>
+#include <vector>
+
+#include "util/lru_cache.hpp"
+#include "util/regex_set.hpp"
 
 namespace waybar::util {
 std::string rewriteString(const std::string&, const Json::Value&);
 std::string rewriteStringOnce(const std::string& value, const Json::Value& rules,
                               bool& matched_any);
+
+/**
+ * "rewrite" rules compiled once, for modules rewriting every title they display.
+ *
+ * Rewrites like rewriteString(): each rule matching the whole value replaces its matches in the
+ * result of the previous ones. The rules are matched in a single pass of a RegexSet, and the
+ * results for the most recent values are kept.
+ */
+class RewriteRuleSet {
+ public:
+  static constexpr size_t DEFAULT_CACHE_CAPACITY = 32;
+
+  RewriteRuleSet() = default;
+  explicit RewriteRuleSet(const Json::Value& rules,
+                          size_t cacheCapacity = DEFAULT_CACHE_CAPACITY);
+
+  std::string rewrite(std::string_view value);
+  bool empty() const { return rules_.empty(); }
+
+ private:
+  struct Rule {
+    std::regex regex;
+    std::string replacement;
+  };
+
+  // The rules anchored at both ends, as they have to match the whole value
+  RegexSet matcher_{std::regex_constants::ECMAScript | std::regex_constants::icase};
+  std::vector<Rule> rules_;
+  LruCache<std::string> cache_{DEFAULT_CACHE_CAPACITY};
+};
+
 }  // namespace waybar::util
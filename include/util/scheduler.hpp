@@ -0,0 +1,163 @@
+#pragma once
+
+#include <sigc++/connection.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "prepare_for_sleep.h"
+#include "stop_source.hpp"
+
+namespace waybar::util {
+
+/**
+ * Process-wide scheduler for periodic module jobs.
+ *
+ * One driver thread keeps the armed jobs in a hierarchical timer wheel and hands expired jobs to
+ * a small, elastic worker pool. Deadlines are snapped to the nearest point of a grid proportional
+ * to the requested delay (aligned on wall clock boundaries), so jobs with compatible intervals
+ * land in the same wheel slot and share a single wakeup. A job may thus run up to half a grid
+ * unit early, i.e. 1/8 of its delay.
+ *
+ * A job that throws is logged and run again after its last delay (1s if it never asked for one),
+ * doubled after every failure in a row, up to a minute.
+ *
+ * Jobs that may block for long (commands, socket requests without a timeout) are marked as
+ * blocking: while they run they don't count against the worker cap, so that slow scripts or a
+ * hung compositor socket don't stall the other modules.
+ */
+class Scheduler {
+ public:
+  using clock = std::chrono::steady_clock;
+  using duration = std::chrono::system_clock::duration;
+
+  struct Job;
+  using JobPtr = std::shared_ptr<Job>;
+
+  static Scheduler& instance();
+
+  /// Create a parked job. It will not run until `wake` or `arm` is called.
+  JobPtr add(std::function<void()> func, bool blocking = false);
+  /// Run the job as soon as a worker is available.
+  void wake(const JobPtr& job);
+  /// Run the job after `delay`. When called from within the job, this sets its next run.
+  void arm(const JobPtr& job, duration delay);
+  /// Do not run the job again until `wake` is called.
+  void park(const JobPtr& job);
+  /// Stop the job and wait until an in-flight run has finished. The function, and whatever it
+  /// captured, is destroyed before returning unless the job cancels itself.
+  void cancel(const JobPtr& job);
+
+  Scheduler(const Scheduler&) = delete;
+  Scheduler& operator=(const Scheduler&) = delete;
+
+ private:
+  class TimerWheel;
+
+  Scheduler();
+  ~Scheduler() = delete;
+
+  void driverLoop();
+  void workerLoop();
+  void enqueueLocked(const JobPtr& job);
+  void armLocked(const JobPtr& job, duration delay);
+  void advanceLocked();
+  uint64_t currentTick() const;
+
+  std::mutex mutex_;
+  std::condition_variable driver_cv_;
+  std::condition_variable worker_cv_;
+  std::condition_variable done_cv_;
+  std::unique_ptr<TimerWheel> wheel_;
+  std::deque<JobPtr> queue_;
+  clock::time_point epoch_;
+  clock::time_point next_wakeup_ = clock::time_point::max();
+  unsigned workers_ = 0;
+  unsigned idle_workers_ = 0;
+  // Workers running a blocking job, left out of the cap
+  unsigned blocking_workers_ = 0;
+  bool driver_started_ = false;
+};
+
+/**
+ * SleeperThread-compatible adapter running its function on the shared Scheduler.
+ *
+ * The function is called once per scheduled run instead of in a dedicated loop. `sleep`,
+ * `sleep_for` and `sleep_until` don't block: they record when the function should run next and
+ * must be the last thing it does. A run that doesn't call any of them is repeated immediately.
+ * `stop` signals `stop_source` before waiting for an in-flight run, so blocking reads in the job
+ * should wait on it.
+ */
+class PeriodicJob {
+ public:
+  /// See Scheduler::add for `blocking`
+  explicit PeriodicJob(bool blocking = false) : blocking_(blocking) {}
+  PeriodicJob(const PeriodicJob&) = delete;
+  PeriodicJob& operator=(const PeriodicJob&) = delete;
+
+  PeriodicJob& operator=(std::function<void()> func) {
+    stop();
+    auto& scheduler = Scheduler::instance();
+    stop_.emplace();
+    job_ = scheduler.add(std::move(func), blocking_);
+    scheduler.wake(job_);
+    if (connection_.empty()) {
+      connection_ = prepare_for_sleep().connect([this](bool sleep) {
+        if (not sleep) wake_up();
+      });
+    }
+    return *this;
+  }
+
+  bool isRunning() const { return job_ != nullptr; }
+
+  /// Only valid while the job is set, i.e. from within the job function
+  const StopSource& stop_source() const { return *stop_; }
+
+  void sleep() {
+    if (job_) Scheduler::instance().park(job_);
+  }
+
+  void sleep_for(std::chrono::system_clock::duration dur) {
+    if (job_) Scheduler::instance().arm(job_, dur);
+  }
+
+  void sleep_until(
+      std::chrono::time_point<std::chrono::system_clock, std::chrono::system_clock::duration>
+          time_point) {
+    sleep_for(time_point - std::chrono::system_clock::now());
+  }
+
+  void wake_up() {
+    if (job_) Scheduler::instance().wake(job_);
+  }
+
+  void stop() {
+    if (job_) {
+      stop_->request_stop();
+      Scheduler::instance().cancel(job_);
+      job_.reset();
+    }
+  }
+
+  ~PeriodicJob() {
+    connection_.disconnect();
+    stop();
+  }
+
+ private:
+  const bool blocking_;
+  Scheduler::JobPtr job_;
+  std::optional<StopSource> stop_;
+  sigc::connection connection_;
+};
+
+}  // namespace waybar::util
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <json/json.h>
+#include <sys/wait.h>
+
+#include <cerrno>
+#include <chrono>
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "scheduler.hpp"
+
+namespace waybar::util {
+
+/**
+ * Registry key for the part of a module config that affects what it samples.
+ * Formatting options are left out, so that bars only differing in how they display the data share
+ * a producer.
+ */
+inline std::string producerKey(const std::string& kind, const Json::Value& config,
+                               std::initializer_list<const char*> fields) {
+  Json::Value subtree(Json::objectValue);
+  for (const auto* field : fields) {
+    if (config.isMember(field)) {
+      subtree[field] = config[field];
+    }
+  }
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "";
+  return kind + ":" + Json::writeString(builder, subtree);
+}
+
+/**
+ * Data source shared by every module instance sampling the same thing.
+ *
+ * With one bar per output, each bar creates its own module instances. Output-independent modules
+ * `subscribe` to their producer by key: the first instance starts it, the others attach to the
+ * running one. A single PeriodicJob samples on behalf of all of them and notifies every
+ * subscriber; the modules only format `latest()` in their update. The producer is stopped when the
+ * last subscription is dropped.
+ */
+template <typename Sample>
+class SharedProducer {
+ public:
+  /// Returns std::nullopt to keep the previous sample, e.g. when interrupted by a stop request
+  using Sampler = std::function<std::optional<Sample>(const StopSource&)>;
+
+  /// RAII registration of a module with its producer
+  class Subscription {
+   public:
+    Subscription() = default;
+    Subscription(const Subscription&) = delete;
+    Subscription& operator=(const Subscription&) = delete;
+    Subscription(Subscription&& other) noexcept
+        : producer_(std::move(other.producer_)), id_(std::exchange(other.id_, 0)) {}
+    Subscription& operator=(Subscription&& other) noexcept {
+      reset();
+      producer_ = std::move(other.producer_);
+      id_ = std::exchange(other.id_, 0);
+      return *this;
+    }
+    ~Subscription() { reset(); }
+
+    void reset() {
+      if (producer_) {
+        producer_->unsubscribe(id_);
+        producer_.reset();
+      }
+    }
+
+    SharedProducer* operator->() const { return producer_.get(); }
+    explicit operator bool() const { return producer_ != nullptr; }
+
+   private:
+    friend class SharedProducer;
+    Subscription(std::shared_ptr<SharedProducer> producer, uint64_t id)
+        : producer_(std::move(producer)), id_(id) {}
+
+    std::shared_ptr<SharedProducer> producer_;
+    uint64_t id_ = 0;
+  };
+
+  /**
+   * Subscribe `notify` to the producer registered under `key`, starting one if there is none.
+   * `make_sampler` is only called when a new producer is started. A non-positive or maximal
+   * `interval` (i.e. "once") only samples once, then on `wake_up`.
+   * `notify` is called from the sampling thread after every sample, and right away if a sample is
+   * already available. A `blocking` sampler, e.g. running a command, is sampled outside of the
+   * scheduler's worker cap.
+   */
+  static Subscription subscribe(const std::string& key, std::chrono::milliseconds interval,
+                                const std::function<Sampler()>& make_sampler,
+                                std::function<void()> notify, bool blocking = false) {
+    return subscribe(
+        key, interval, [&make_sampler](SharedProducer&) { return make_sampler(); },
+        std::move(notify), blocking);
+  }
+
+  /**
+   * Same, for samplers that are also driven by events (e.g. fd watches): `make_sampler` gets the
+   * producer to `wake_up` from them. The sampler is destroyed when the producer stops, before the
+   * producer itself.
+   */
+  static Subscription subscribe(const std::string& key, std::chrono::milliseconds interval,
+                                const std::function<Sampler(SharedProducer&)>& make_sampler,
+                                std::function<void()> notify, bool blocking = false) {
+    std::shared_ptr<SharedProducer> producer;
+    {
+      std::lock_guard lock(registryMutex());
+      auto& entry = registry()[key];
+      producer = entry.lock();
+      if (!producer) {
+        producer = std::shared_ptr<SharedProducer>(new SharedProducer(key, interval, blocking));
+        entry = producer;
+        producer->start(make_sampler(*producer));
+      }
+    }
+    auto id = producer->addSubscriber(std::move(notify));
+    return Subscription(std::move(producer), id);
+  }
+
+  /// Number of running producers, for tests and debugging
+  static size_t count() {
+    std::lock_guard lock(registryMutex());
+    size_t n = 0;
+    for (const auto& [key, entry] : registry()) {
+      n += entry.expired() ? 0 : 1;
+    }
+    return n;
+  }
+
+  SharedProducer(const SharedProducer&) = delete;
+  SharedProducer& operator=(const SharedProducer&) = delete;
+
+  ~SharedProducer() {
+    job_.stop();
+    std::lock_guard lock(registryMutex());
+    auto it = registry().find(key_);
+    if (it != registry().end() && it->second.expired()) {
+      registry().erase(it);
+    }
+  }
+
+  /// Latest sample, nullptr until the first one is taken
+  std::shared_ptr<const Sample> latest() const {
+    std::lock_guard lock(mutex_);
+    return sample_;
+  }
+
+  /// Sample again now
+  void wake_up() { job_.wake_up(); }
+
+  /// Sample again once the given child processes have exited, e.g. click handlers
+  void wake_up_after(std::vector<int> pids) {
+    {
+      std::lock_guard lock(mutex_);
+      pending_pids_.insert(pending_pids_.end(), pids.begin(), pids.end());
+    }
+    job_.wake_up();
+  }
+
+ private:
+  using Registry = std::unordered_map<std::string, std::weak_ptr<SharedProducer>>;
+
+  static std::mutex& registryMutex() {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  static Registry& registry() {
+    static Registry registry;
+    return registry;
+  }
+
+  SharedProducer(std::string key, std::chrono::milliseconds interval, bool blocking)
+      : key_(std::move(key)), interval_(interval), job_(blocking) {}
+
+  void start(Sampler sampler) {
+    job_ = [this, sampler = std::move(sampler)] {
+      std::vector<int> pids;
+      {
+        std::lock_guard lock(mutex_);
+        pids.swap(pending_pids_);
+      }
+      for (int pid : pids) {
+        while (waitpid(pid, nullptr, 0) == -1 && errno == EINTR) {
+        }
+      }
+
+      if (auto sample = sampler(job_.stop_source())) {
+        std::lock_guard lock(mutex_);
+        sample_ = std::make_shared<const Sample>(std::move(*sample));
+        for (const auto& [id, notify] : subscribers_) {
+          notify();
+        }
+      }
+      if (interval_.count() > 0 && interval_ != std::chrono::milliseconds::max()) {
+        job_.sleep_for(interval_);
+      } else {
+        job_.sleep();
+      }
+    };
+  }
+
+  uint64_t addSubscriber(std::function<void()> notify) {
+    std::lock_guard lock(mutex_);
+    if (sample_) {
+      notify();
+    }
+    auto id = next_id_++;
+    subscribers_.emplace(id, std::move(notify));
+    return id;
+  }
+
+  void unsubscribe(uint64_t id) {
+    std::lock_guard lock(mutex_);
+    subscribers_.erase(id);
+  }
+
+  const std::string key_;
+  const std::chrono::milliseconds interval_;
+  mutable std::mutex mutex_;
+  std::shared_ptr<const Sample> sample_;
+  std::map<uint64_t, std::function<void()>> subscribers_;
+  std::vector<int> pending_pids_;
+  uint64_t next_id_ = 1;
+  // Declared last, so that it is stopped before the state it uses is destroyed
+  PeriodicJob job_;
+};
+
+}  // namespace waybar::util
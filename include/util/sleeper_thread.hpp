@@ -7,47 +7,30 @@
 #include <thread>
 
 #include "prepare_for_sleep.h"
+#include "stop_source.hpp"
 
 namespace waybar::util {
 
 /**
- * Defer pthread_cancel until the end of a current scope.
+ * Dedicated worker thread calling its function in a loop until stopped.
  *
- * Required to protect a scope where it's unsafe to raise `__forced_unwind` exception.
- * An example of these is a call of a method marked as `noexcept`; an attempt to cancel within such
- * a method may result in a `std::terminate` call.
+ * Stopping is cooperative: `stop` wakes up the `sleep*` functions and signals `stop_source`,
+ * which blocking reads in the worker must wait on (see `StopSource::wait` and `command::read`).
+ * The destructor joins the thread.
  */
-class CancellationGuard {
-  int oldstate;
-
- public:
-  CancellationGuard() { pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &oldstate); }
-  ~CancellationGuard() { pthread_setcancelstate(oldstate, &oldstate); }
-};
-
 class SleeperThread {
  public:
   SleeperThread() = default;
 
   SleeperThread(std::function<void()> func)
-      : thread_{[this, func] {
-          while (do_run_) {
-            signal_ = false;
-            func();
-          }
-        }} {
+      : thread_{[this, func] { run(func); }} {
     connection_ = prepare_for_sleep().connect([this](bool sleep) {
       if (not sleep) wake_up();
     });
   }
 
   SleeperThread& operator=(std::function<void()> func) {
-    thread_ = std::thread([this, func] {
-      while (do_run_) {
-        signal_ = false;
-        func();
-      }
-    });
+    thread_ = std::thread([this, func] { run(func); });
     if (connection_.empty()) {
       connection_ = prepare_for_sleep().connect([this](bool sleep) {
         if (not sleep) wake_up();
@@ -56,32 +39,31 @@ class SleeperThread {
     return *this;
   }
 
-  bool isRunning() const { return do_run_; }
+  bool isRunning() const { return !stop_.stop_requested(); }
+
+  const StopSource& stop_source() const { return stop_; }
 
   auto sleep() {
     std::unique_lock lk(mutex_);
-    CancellationGuard cancel_lock;
-    return condvar_.wait(lk, [this] { return signal_ || !do_run_; });
+    return condvar_.wait(lk, [this] { return signal_ || !isRunning(); });
   }
 
   auto sleep_for(std::chrono::system_clock::duration dur) {
     std::unique_lock lk(mutex_);
-    CancellationGuard cancel_lock;
     constexpr auto max_time_point = std::chrono::steady_clock::time_point::max();
     auto wait_end = max_time_point;
     auto now = std::chrono::steady_clock::now();
     if (now < max_time_point - dur) {
       wait_end = now + dur;
     }
-    return condvar_.wait_until(lk, wait_end, [this] { return signal_ || !do_run_; });
+    return condvar_.wait_until(lk, wait_end, [this] { return signal_ || !isRunning(); });
   }
 
   auto sleep_until(
       std::chrono::time_point<std::chrono::system_clock, std::chrono::system_clock::duration>
           time_point) {
     std::unique_lock lk(mutex_);
-    CancellationGuard cancel_lock;
-    return condvar_.wait_until(lk, time_point, [this] { return signal_ || !do_run_; });
+    return condvar_.wait_until(lk, time_point, [this] { return signal_ || !isRunning(); });
   }
 
   void wake_up() {
@@ -92,35 +74,50 @@ class SleeperThread {
     condvar_.notify_all();
   }
 
-  auto stop() {
+  /// Request the worker to stop, does not wait for it
+  void stop() {
     {
       std::lock_guard<std::mutex> lck(mutex_);
       signal_ = true;
-      do_run_ = false;
+      stop_.request_stop();
     }
     condvar_.notify_all();
-    auto handle = thread_.native_handle();
-    if (handle != 0) {
-      // TODO: find a proper way to terminate thread...
-      pthread_cancel(handle);
+  }
+
+  /// Wait for the worker to return, a no-op when called from the worker itself
+  void join() {
+    if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+      thread_.join();
     }
   }
 
   ~SleeperThread() {
     connection_.disconnect();
     stop();
+    join();
     if (thread_.joinable()) {
-      thread_.join();
+      thread_.detach();
     }
   }
 
  private:
-  std::thread thread_;
+  void run(const std::function<void()>& func) {
+    while (isRunning()) {
+      {
+        std::lock_guard<std::mutex> lck(mutex_);
+        signal_ = false;
+      }
+      func();
+    }
+  }
+
   std::condition_variable condvar_;
   std::mutex mutex_;
-  bool do_run_ = true;
+  StopSource stop_;
   bool signal_ = false;
   sigc::connection connection_;
+  // Last, so that the worker only starts once the other members are initialized
+  std::thread thread_;
 };
 
 }  // namespace waybar::util
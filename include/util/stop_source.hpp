@@ -0,0 +1,86 @@
+#pragma once
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <stop_token>
+
+namespace waybar::util {
+
+/**
+ * Cooperative stop request for worker threads.
+ *
+ * Pairs a std::stop_source, polled by worker loops, with a file descriptor that becomes readable
+ * once stop is requested (an eventfd, or a pipe where eventfd is not available). Blocking reads
+ * poll it next to their own fd instead of relying on thread cancellation.
+ */
+class StopSource {
+ public:
+  StopSource() {
+#ifdef __linux__
+    fds_[0] = fds_[1] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (fds_[0] == -1) {
+      throw std::runtime_error("Unable to create stop eventfd");
+    }
+#else
+    if (pipe2(fds_, O_CLOEXEC | O_NONBLOCK) == -1) {
+      throw std::runtime_error("Unable to create stop pipe");
+    }
+#endif
+  }
+  StopSource(const StopSource&) = delete;
+  StopSource& operator=(const StopSource&) = delete;
+
+  ~StopSource() {
+    ::close(fds_[0]);
+    if (fds_[1] != fds_[0]) {
+      ::close(fds_[1]);
+    }
+  }
+
+  std::stop_token get_token() const { return source_.get_token(); }
+  bool stop_requested() const { return source_.stop_requested(); }
+
+  /// Readable once stop has been requested, it is never drained
+  int fd() const { return fds_[0]; }
+
+  void request_stop() {
+    if (source_.request_stop()) {
+      uint64_t one = 1;
+      while (::write(fds_[1], &one, sizeof(one)) == -1 && errno == EINTR) {
+      }
+    }
+  }
+
+  /**
+   * Block until `fd` reports one of `events` (or an error/hangup, left for the caller's read to
+   * handle) or stop is requested. Returns false if stop was requested.
+   */
+  bool wait(int fd, short events = POLLIN) const {
+    struct pollfd pfds[2] = {{fd, events, 0}, {fds_[0], POLLIN, 0}};
+    while (!stop_requested()) {
+      if (::poll(pfds, 2, -1) == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+        // Let the caller's read report the error
+        return true;
+      }
+      return pfds[1].revents == 0;
+    }
+    return false;
+  }
+
+ private:
+  std::stop_source source_;
+  int fds_[2] = {-1, -1};
+};
+
+}  // namespace waybar::util
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <glibmm/main.h>
+#include <gtkmm/widget.h>
+#include <json/json.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace waybar {
+class AModule;
+}
+
+namespace waybar::util {
+
+/**
+ * Coalesces module updates of a bar.
+ *
+ * Modules marked dirty are updated once per GdkFrameClock tick of the bar window, no matter how
+ * many times their dispatcher was emitted in between. With a positive "update-coalescing" the
+ * updates are flushed once per window of that many milliseconds instead, and with 0 every
+ * update runs immediately as before.
+ * While the window is not mapped its frame clock doesn't tick, updates then run on idle, and a
+ * tick that doesn't come in time (e.g. on a hidden output) is replaced with a timeout.
+ */
+class UpdateBatcher {
+ public:
+  UpdateBatcher(Gtk::Widget& window, const Json::Value& config);
+  UpdateBatcher(const UpdateBatcher&) = delete;
+  UpdateBatcher& operator=(const UpdateBatcher&) = delete;
+  ~UpdateBatcher();
+
+  /// Mark `module` dirty, its update() runs at the next flush. `name` is used for error logs.
+  void schedule(AModule* module, const std::string& name);
+  /// Drop a pending update, for modules destroyed before the next flush
+  void cancel(AModule* module);
+
+ private:
+  enum class Mode { Immediate, FrameClock, Window };
+
+  void requestFlush();
+  void flushOnIdle();
+  void onUnmap();
+  void removeTick();
+  void flush();
+  static void runUpdate(AModule* module, const std::string& name);
+
+  Gtk::Widget& window_;
+  Mode mode_ = Mode::FrameClock;
+  std::chrono::milliseconds window_length_{0};
+
+  std::vector<std::pair<AModule*, std::string>> pending_;
+  std::unordered_set<AModule*> dirty_;
+  bool flush_requested_ = false;
+  guint tick_id_ = 0;
+  // Window flush, idle flush, or the timeout of a pending tick
+  sigc::connection timer_;
+  sigc::connection unmap_;
+
+  // Updates requested and updates merged into an already pending one
+  uint64_t requested_ = 0;
+  uint64_t merged_ = 0;
+};
+
+}  // namespace waybar::util
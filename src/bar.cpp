@@ -3,6 +3,9 @@
 #include <gtk-layer-shell.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <array>
+#include <set>
 #include <type_traits>
 
 #include "client.hpp"
@@ -142,7 +145,8 @@ waybar::Bar::Bar(struct waybar_output* w_output, const Json::Value& w_config)
       left_(Gtk::ORIENTATION_HORIZONTAL, 0),
       center_(Gtk::ORIENTATION_HORIZONTAL, 0),
       right_(Gtk::ORIENTATION_HORIZONTAL, 0),
-      box_(Gtk::ORIENTATION_HORIZONTAL, 0) {
+      box_(Gtk::ORIENTATION_HORIZONTAL, 0),
+      update_batcher_(window, config) {
   window.set_title("waybar");
   window.set_name("waybar");
   window.set_decorated(false);
@@ -465,7 +469,7 @@ void waybar::Bar::show() { setVisible(true); }
 void waybar::Bar::hide() { setVisible(false); }
 
 // Converting string to button code rn as to avoid doing it later
-void waybar::Bar::setupAltFormatKeyForModule(const std::string& module_name) {
+void waybar::Bar::setupAltFormatKeyForModule(Json::Value& config, const std::string& module_name) {
   if (config.isMember(module_name)) {
     Json::Value& module = config[module_name];
     if (module.isMember("format-alt")) {
@@ -493,7 +497,8 @@ void waybar::Bar::setupAltFormatKeyForModule(const std::string& module_name) {
   }
 }
 
-void waybar::Bar::setupAltFormatKeyForModuleList(const char* module_list_name) {
+void waybar::Bar::setupAltFormatKeyForModuleList(Json::Value& config,
+                                                 const char* module_list_name) {
   if (config.isMember(module_list_name)) {
     Json::Value& modules = config[module_list_name];
     for (const Json::Value& module_name : modules) {
@@ -503,11 +508,11 @@ void waybar::Bar::setupAltFormatKeyForModuleList(const char* module_list_name) {
           Json::Value& group_modules = config[ref]["modules"];
           for (const Json::Value& module_name : group_modules) {
             if (module_name.isString()) {
-              setupAltFormatKeyForModule(module_name.asString());
+              setupAltFormatKeyForModule(config, module_name.asString());
             }
           }
         } else {
-          setupAltFormatKeyForModule(ref);
+          setupAltFormatKeyForModule(config, ref);
         }
       }
     }
@@ -523,56 +528,51 @@ void waybar::Bar::handleSignal(int signal) {
 waybar::util::KillSignalAction waybar::Bar::getOnSigusr1Action() { return this->onSigusr1; }
 waybar::util::KillSignalAction waybar::Bar::getOnSigusr2Action() { return this->onSigusr2; }
 
-void waybar::Bar::getModules(const Factory& factory, const std::string& pos,
-                             waybar::Group* group = nullptr) {
-  auto module_list = group != nullptr ? config[pos]["modules"] : config[pos];
-  if (module_list.isArray()) {
-    for (const auto& name : module_list) {
-      try {
-        auto ref = name.asString();
-        AModule* module;
+waybar::AModule* waybar::Bar::createModule(const Factory& factory, const std::string& ref,
+                                            const std::string& pos, bool vertical,
+                                            std::vector<std::shared_ptr<AModule>>& owned) {
+  AModule* module;
 
-        if (ref.compare(0, 6, "group/") == 0 && ref.size() > 6) {
-          auto hash_pos = ref.find('#');
-          auto id_name = ref.substr(6, hash_pos - 6);
-          auto class_name = hash_pos != std::string::npos ? ref.substr(hash_pos + 1) : "";
+  if (ref.compare(0, 6, "group/") == 0 && ref.size() > 6) {
+    auto hash_pos = ref.find('#');
+    auto id_name = ref.substr(6, hash_pos - 6);
+    auto class_name = hash_pos != std::string::npos ? ref.substr(hash_pos + 1) : "";
 
-          auto vertical = (group != nullptr ? group->getBox().get_orientation()
-                                            : box_.get_orientation()) == Gtk::ORIENTATION_VERTICAL;
+    const auto& group_config = config[ref];
+    if (group_config["modules"].isNull()) {
+      spdlog::warn("Group definition '{}' has not been found, group will be hidden", ref);
+    }
+    auto* group_module = new waybar::Group(id_name, class_name, group_config, vertical);
+    owned.emplace_back(group_module);
+    for (const auto& name : group_config["modules"]) {
+      try {
+        auto* child = createModule(
+            factory, name.asString(), ref,
+            group_module->getBox().get_orientation() == Gtk::ORIENTATION_VERTICAL, owned);
+        group_module->addWidget(*child);
+      } catch (const std::exception& e) {
+        spdlog::warn("module {}: {}", name.asString(), e.what());
+      }
+    }
+    module = group_module;
+  } else {
+    module = factory.makeModule(ref, pos);
+    owned.emplace_back(module);
+  }
 
-          auto group_config = config[ref];
-          if (group_config["modules"].isNull()) {
-            spdlog::warn("Group definition '{}' has not been found, group will be hidden", ref);
-          }
-          auto* group_module = new waybar::Group(id_name, class_name, group_config, vertical);
-          getModules(factory, ref, group_module);
-          module = group_module;
-        } else {
-          module = factory.makeModule(ref, pos);
-        }
+  module->dp.connect([this, module, ref] { update_batcher_.schedule(module, ref); });
+  return module;
+}
 
-        std::shared_ptr<AModule> module_sp(module);
-        modules_all_.emplace_back(module_sp);
-        if (group != nullptr) {
-          group->addWidget(*module);
-        } else {
-          if (pos == "modules-left") {
-            modules_left_.emplace_back(module_sp);
-          }
-          if (pos == "modules-center") {
-            modules_center_.emplace_back(module_sp);
-          }
-          if (pos == "modules-right") {
-            modules_right_.emplace_back(module_sp);
-          }
-        }
-        module->dp.connect([module, ref] {
-          try {
-            module->update();
-          } catch (const std::exception& e) {
-            spdlog::error("{}: {}", ref, e.what());
-          }
-        });
+void waybar::Bar::getModules(const Factory& factory, const std::string& pos) {
+  auto module_list = config[pos];
+  if (module_list.isArray()) {
+    for (const auto& name : module_list) {
+      try {
+        ModuleSlot slot{pos, name.asString(), {}};
+        createModule(factory, slot.ref, pos, orientation == Gtk::ORIENTATION_VERTICAL,
+                     slot.modules);
+        module_slots_.emplace_back(std::move(slot));
       } catch (const std::exception& e) {
         spdlog::warn("module {}: {}", name.asString(), e.what());
       }
@@ -580,6 +580,44 @@ void waybar::Bar::getModules(const Factory& factory, const std::string& pos,
   }
 }
 
+void waybar::Bar::rebuildModuleLists() {
+  modules_left_.clear();
+  modules_center_.clear();
+  modules_right_.clear();
+  modules_all_.clear();
+  for (const auto& slot : module_slots_) {
+    if (slot.pos == "modules-left") {
+      modules_left_.emplace_back(slot.modules.front());
+    } else if (slot.pos == "modules-center") {
+      modules_center_.emplace_back(slot.modules.front());
+    } else if (slot.pos == "modules-right") {
+      modules_right_.emplace_back(slot.modules.front());
+    }
+    modules_all_.insert(modules_all_.end(), slot.modules.begin(), slot.modules.end());
+  }
+}
+
+void waybar::Bar::packModules() {
+  for (auto* box : {&left_, &center_, &right_}) {
+    for (auto* child : box->get_children()) {
+      box->remove(*child);
+    }
+  }
+
+  for (auto const& module : modules_left_) {
+    left_.pack_start(*module, module->expandEnabled(), module->expandEnabled());
+  }
+
+  for (auto const& module : modules_center_) {
+    center_.pack_start(*module, module->expandEnabled(), module->expandEnabled());
+  }
+
+  for (auto it = modules_right_.rbegin(); it != modules_right_.rend(); ++it) {
+    auto const& module = *it;
+    right_.pack_end(*module, module->expandEnabled(), module->expandEnabled());
+  }
+}
+
 auto waybar::Bar::setupWidgets() -> void {
   window.add(box_);
 
@@ -599,9 +637,9 @@ auto waybar::Bar::setupWidgets() -> void {
   box_.pack_end(right_, expand_right, expand_right);
 
   // Convert to button code for every module that is used.
-  setupAltFormatKeyForModuleList("modules-left");
-  setupAltFormatKeyForModuleList("modules-right");
-  setupAltFormatKeyForModuleList("modules-center");
+  setupAltFormatKeyForModuleList(config, "modules-left");
+  setupAltFormatKeyForModuleList(config, "modules-right");
+  setupAltFormatKeyForModuleList(config, "modules-center");
 
   Factory factory(*this, config);
   getModules(factory, "modules-left");
@@ -610,20 +648,148 @@ auto waybar::Bar::setupWidgets() -> void {
   }
   getModules(factory, "modules-right");
 
-  for (auto const& module : modules_left_) {
-    left_.pack_start(*module, module->expandEnabled(), module->expandEnabled());
+  rebuildModuleLists();
+  packModules();
+}
+
+namespace {
+
+const std::array<std::string, 3> MODULE_LISTS = {"modules-left", "modules-center",
+                                                 "modules-right"};
+
+bool isGroup(const std::string& ref) { return ref.compare(0, 6, "group/") == 0 && ref.size() > 6; }
+
+/// Collect the modules referenced by the module lists of `config`, including group children
+void collectModuleRefs(const Json::Value& config, const Json::Value& list,
+                       std::set<std::string>& refs) {
+  for (const auto& name : list) {
+    if (name.isString() && refs.insert(name.asString()).second && isGroup(name.asString())) {
+      collectModuleRefs(config, config[name.asString()]["modules"], refs);
+    }
   }
+}
 
-  if (!no_center) {
-    for (auto const& module : modules_center_) {
-      center_.pack_start(*module, module->expandEnabled(), module->expandEnabled());
+/// Whether `ref` and, for a group, all of its children have the same config in `a` and `b`
+bool sameModuleConfig(const Json::Value& a, const Json::Value& b, const std::string& ref) {
+  if (a.isMember(ref) != b.isMember(ref) || a[ref] != b[ref]) {
+    return false;
+  }
+  if (isGroup(ref)) {
+    for (const auto& name : b[ref]["modules"]) {
+      if (name.isString() && !sameModuleConfig(a, b, name.asString())) {
+        return false;
+      }
     }
   }
+  return true;
+}
 
-  std::reverse(modules_right_.begin(), modules_right_.end());
-  for (auto const& module : modules_right_) {
-    right_.pack_end(*module, module->expandEnabled(), module->expandEnabled());
+}  // namespace
+
+bool waybar::Bar::reload(const Json::Value& new_config) {
+  Json::Value next = new_config;
+  for (const auto& list : MODULE_LISTS) {
+    setupAltFormatKeyForModuleList(next, list.c_str());
+  }
+
+  // Bar options are everything that is neither a module list nor a module definition
+  const Json::Value& current = config;
+  std::set<std::string> refs;
+  std::set<std::string> next_refs;
+  for (const auto& list : MODULE_LISTS) {
+    collectModuleRefs(current, current[list], refs);
+    collectModuleRefs(next, next[list], next_refs);
+  }
+  refs.merge(next_refs);
+  auto bar_options = [&refs](Json::Value options) {
+    for (const auto& list : MODULE_LISTS) {
+      options.removeMember(list);
+    }
+    for (const auto& ref : refs) {
+      options.removeMember(ref);
+    }
+    return options;
+  };
+  if (bar_options(config) != bar_options(next)) {
+    return false;
+  }
+
+  // Lay out the new slots, taking over the previous modules whose config is unchanged
+  auto previous = std::move(module_slots_);
+  module_slots_.clear();
+  bool no_center = config["no-center"].isBool() ? config["no-center"].asBool() : false;
+  for (const auto& list : MODULE_LISTS) {
+    if (no_center && list == "modules-center") {
+      continue;
+    }
+    for (const auto& name : next[list]) {
+      if (!name.isString()) {
+        spdlog::warn("module {}: invalid module name", name.toStyledString());
+        continue;
+      }
+      ModuleSlot slot{list, name.asString(), {}};
+      auto it = std::find_if(previous.begin(), previous.end(), [&](const ModuleSlot& old) {
+        return old.pos == slot.pos && old.ref == slot.ref && !old.modules.empty() &&
+               sameModuleConfig(config, next, slot.ref);
+      });
+      if (it != previous.end()) {
+        slot.modules = std::move(it->modules);
+        it->modules.clear();
+      }
+      module_slots_.emplace_back(std::move(slot));
+    }
   }
+
+  // Destroy the remaining modules before their config nodes are replaced
+  modules_left_.clear();
+  modules_center_.clear();
+  modules_right_.clear();
+  modules_all_.clear();
+  packModules();
+  size_t removed = 0;
+  for (auto& slot : previous) {
+    for (auto& module : slot.modules) {
+      update_batcher_.cancel(module.get());
+      removed++;
+    }
+  }
+  previous.clear();
+
+  // Apply the new config in place: unchanged subtrees keep their address for reused modules
+  for (const auto& key : config.getMemberNames()) {
+    if (!next.isMember(key)) {
+      config.removeMember(key);
+    }
+  }
+  for (const auto& key : next.getMemberNames()) {
+    if (!config.isMember(key) || config[key] != next[key]) {
+      config[key] = next[key];
+    }
+  }
+
+  Factory factory(*this, config);
+  size_t created = 0;
+  for (auto& slot : module_slots_) {
+    if (!slot.modules.empty()) {
+      continue;
+    }
+    try {
+      auto* module = createModule(factory, slot.ref, slot.pos,
+                                  orientation == Gtk::ORIENTATION_VERTICAL, slot.modules);
+      static_cast<Gtk::Widget&>(*module).show_all();
+      created += slot.modules.size();
+    } catch (const std::exception& e) {
+      spdlog::warn("module {}: {}", slot.ref, e.what());
+      slot.modules.clear();
+    }
+  }
+  std::erase_if(module_slots_, [](const ModuleSlot& slot) { return slot.modules.empty(); });
+
+  rebuildModuleLists();
+  packModules();
+  spdlog::info("Bar reloaded on {}: {} modules kept, {} removed, {} created", output->name,
+               modules_all_.size() - created, removed, created);
+  return true;
 }
 
 void waybar::Bar::onConfigure(GdkEventConfigure* ev) {
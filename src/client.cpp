@@ -203,6 +203,24 @@ auto waybar::Client::setupCss(const std::string &css_file) -> void {
                                              GTK_STYLE_PROVIDER_PRIORITY_USER);
 }
 
+void waybar::Client::setupStyle() {
+  m_cssFile = getStyle(style_opt_);
+  setupCss(m_cssFile);
+  m_cssReloadHelper = std::make_unique<CssReloadHelper>(m_cssFile, [&]() { setupCss(m_cssFile); });
+
+  auto m_config = config.getConfig();
+  if (m_config.isObject() && m_config["reload_style_on_change"].asBool()) {
+    m_cssReloadHelper->monitorChanges();
+  } else if (m_config.isArray()) {
+    for (const auto &conf : m_config) {
+      if (conf["reload_style_on_change"].asBool()) {
+        m_cssReloadHelper->monitorChanges();
+        break;
+      }
+    }
+  }
+}
+
 void waybar::Client::bindInterfaces() {
   registry = wl_display_get_registry(wl_display);
   static const struct wl_registry_listener registry_listener = {
@@ -232,13 +250,11 @@ void waybar::Client::bindInterfaces() {
 int waybar::Client::main(int argc, char *argv[]) {
   bool show_help = false;
   bool show_version = false;
-  std::string config_opt;
-  std::string style_opt;
   std::string log_level;
   auto cli = clara::detail::Help(show_help) |
              clara::detail::Opt(show_version)["-v"]["--version"]("Show version") |
-             clara::detail::Opt(config_opt, "config")["-c"]["--config"]("Config path") |
-             clara::detail::Opt(style_opt, "style")["-s"]["--style"]("Style path") |
+             clara::detail::Opt(config_opt_, "config")["-c"]["--config"]("Config path") |
+             clara::detail::Opt(style_opt_, "style")["-s"]["--style"]("Style path") |
              clara::detail::Opt(
                  log_level,
                  "trace|debug|info|warning|error|critical|off")["-l"]["--log-level"]("Log level") |
@@ -274,30 +290,16 @@ int waybar::Client::main(int argc, char *argv[]) {
     throw std::runtime_error("Bar need to run under Wayland");
   }
   wl_display = gdk_wayland_display_get_wl_display(gdk_display->gobj());
-  config.load(config_opt);
+  config.load(config_opt_);
   if (!portal) {
     portal = std::make_unique<waybar::Portal>();
   }
-  m_cssFile = getStyle(style_opt);
-  setupCss(m_cssFile);
-  m_cssReloadHelper = std::make_unique<CssReloadHelper>(m_cssFile, [&]() { setupCss(m_cssFile); });
+  setupStyle();
   portal->signal_appearance_changed().connect([&](waybar::Appearance appearance) {
-    auto css_file = getStyle(style_opt, appearance);
+    auto css_file = getStyle(style_opt_, appearance);
     setupCss(css_file);
   });
 
-  auto m_config = config.getConfig();
-  if (m_config.isObject() && m_config["reload_style_on_change"].asBool()) {
-    m_cssReloadHelper->monitorChanges();
-  } else if (m_config.isArray()) {
-    for (const auto &conf : m_config) {
-      if (conf["reload_style_on_change"].asBool()) {
-        m_cssReloadHelper->monitorChanges();
-        break;
-      }
-    }
-  }
-
   bindInterfaces();
   gtk_app->hold();
   gtk_app->run();
@@ -306,6 +308,65 @@ int waybar::Client::main(int argc, char *argv[]) {
   return 0;
 }
 
+bool waybar::Client::reload() {
+  Config next;
+  try {
+    next.load(config_opt_);
+  } catch (const std::exception &e) {
+    spdlog::error("Unable to reload the configuration, keeping the current one: {}", e.what());
+    return true;
+  }
+
+  try {
+    config = std::move(next);
+    // Style changes only need the CSS provider to be replaced
+    setupStyle();
+
+    std::vector<std::unique_ptr<Bar>> reloaded;
+    for (auto &output : outputs_) {
+      if (output.xdg_output) {
+        // Output detection is still in progress, its bars will use the new config
+        continue;
+      }
+      std::vector<std::unique_ptr<Bar>> current;
+      for (auto &bar : bars) {
+        if (bar && bar->output == &output) {
+          current.emplace_back(std::move(bar));
+        }
+      }
+      auto configs = getOutputConfigs(output);
+      for (size_t i = 0; i < configs.size(); i++) {
+        if (i < current.size() && current[i]->reload(configs[i])) {
+          reloaded.emplace_back(std::move(current[i]));
+        } else {
+          if (i < current.size()) {
+            removeBar(std::move(current[i]));
+          }
+          reloaded.emplace_back(std::make_unique<Bar>(&output, configs[i]));
+        }
+      }
+      for (size_t i = configs.size(); i < current.size(); i++) {
+        removeBar(std::move(current[i]));
+      }
+    }
+    for (auto &bar : bars) {
+      if (bar) {
+        reloaded.emplace_back(std::move(bar));
+      }
+    }
+    bars = std::move(reloaded);
+  } catch (const std::exception &e) {
+    spdlog::error("In-place reload failed: {}", e.what());
+    return false;
+  }
+  return true;
+}
+
+void waybar::Client::removeBar(std::unique_ptr<Bar> bar) {
+  bar->window.hide();
+  gtk_app->remove_window(bar->window);
+}
+
 void waybar::Client::reset() {
   gtk_app->quit();
   // delete signal handler for css changes
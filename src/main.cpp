@@ -101,8 +101,11 @@ void handleUserSignal(int signal, bool& reload) {
         break;
       case waybar::util::KillSignalAction::RELOAD:
         spdlog::info("Reloading...");
-        reload = true;
-        waybar::Client::inst()->reset();
+        if (!waybar::Client::inst()->reload()) {
+          // Fall back to a full restart
+          reload = true;
+          waybar::Client::inst()->reset();
+        }
         return;
       case waybar::util::KillSignalAction::NOOP:
         break;
@@ -11,13 +11,29 @@
 
 waybar::modules::Battery::Battery(const std::string& id, const Bar& bar, const Json::Value& config)
     : ALabel(config, "battery", id, "{capacity}%", 60), last_event_(""), bar_(bar) {
+  spdlog::debug("battery: worker interval is {}", interval_.count());
+  producer_ = util::SharedProducer<Sample>::subscribe(
+      util::producerKey("battery", config_,
+                        {"bat", "adapter", "bat-compatibility", "full-at", "weighted-average",
+                         "design-capacity", "interval"}),
+      interval_,
+      [this](util::SharedProducer<Sample>& producer) {
+        auto source = std::make_shared<Source>(config_, producer);
+        return [source](const util::StopSource&) { return std::optional(source->sample()); };
+      },
+      [this] { dp.emit(); });
+}
+
+waybar::modules::Battery::Source::Source(const Json::Value& config,
+                                         util::SharedProducer<Sample>& producer)
+    : config_(config), producer_(producer) {
 #if defined(__linux__)
-  battery_watch_fd_ = inotify_init1(IN_CLOEXEC);
+  battery_watch_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
   if (battery_watch_fd_ == -1) {
     throw std::runtime_error("Unable to listen batteries.");
   }
 
-  global_watch_fd_ = inotify_init1(IN_CLOEXEC);
+  global_watch_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
   if (global_watch_fd_ == -1) {
     throw std::runtime_error("Unable to listen batteries.");
   }
@@ -28,13 +44,13 @@ waybar::modules::Battery::Battery(const std::string& id, const Bar& bar, const J
     throw std::runtime_error("Could not watch for battery plug/unplug");
   }
 #endif
-  spdlog::debug("battery: worker interval is {}", interval_.count());
   worker();
 }
 
-waybar::modules::Battery::~Battery() {
+waybar::modules::Battery::Source::~Source() {
 #if defined(__linux__)
-  std::lock_guard<std::mutex> guard(battery_list_mutex_);
+  battery_watch_.reset();
+  global_watch_.reset();
 
   if (global_watch >= 0) {
     inotify_rm_watch(global_watch_fd_, global_watch);
@@ -53,45 +69,68 @@ waybar::modules::Battery::~Battery() {
 #endif
 }
 
-void waybar::modules::Battery::worker() {
-#if defined(__FreeBSD__)
-  thread_timer_ = [this] {
-    dp.emit();
-    thread_timer_.sleep_for(interval_);
-  };
-#else
-  thread_timer_ = [this] {
-    // Make sure we eventually update the list of batteries even if we miss an
-    // inotify event for some reason
-    refreshBatteries();
-    dp.emit();
-    thread_timer_.sleep_for(interval_);
-  };
-  thread_ = [this] {
-    struct inotify_event event = {0};
-    int nbytes = read(battery_watch_fd_, &event, sizeof(event));
-    if (nbytes != sizeof(event) || event.mask & IN_IGNORED) {
-      thread_.stop();
-      return;
-    }
-    dp.emit();
-  };
-  thread_battery_update_ = [this] {
-    struct inotify_event event = {0};
-    int nbytes = read(global_watch_fd_, &event, sizeof(event));
-    if (nbytes != sizeof(event) || event.mask & IN_IGNORED) {
-      thread_.stop();
-      return;
+#if defined(__linux__)
+// Consume the pending inotify events, returns false once the fd is no longer usable
+static bool drainInotify(int fd, uint32_t events) {
+  if (events & (EPOLLERR | EPOLLHUP)) {
+    return false;
+  }
+  alignas(struct inotify_event) char buf[4096];
+  while (true) {
+    auto nbytes = read(fd, buf, sizeof(buf));
+    if (nbytes > 0) {
+      continue;
     }
-    refreshBatteries();
-    dp.emit();
-  };
+    return nbytes == -1 && (errno == EAGAIN || errno == EINTR);
+  }
+}
+#endif
+
+void waybar::modules::Battery::Source::worker() {
+#if defined(__linux__)
+  // The batteries are only read by the producer: the watches just ask it for a sample
+  auto& reactor = util::Reactor::instance();
+  battery_watch_ = reactor.watch(
+      battery_watch_fd_, EPOLLIN,
+      [this](uint32_t events) {
+        if (!drainInotify(battery_watch_fd_, events)) {
+          return false;
+        }
+        producer_.wake_up();
+        return true;
+      },
+      "battery");
+  global_watch_ = reactor.watch(
+      global_watch_fd_, EPOLLIN,
+      [this](uint32_t events) {
+        if (!drainInotify(global_watch_fd_, events)) {
+          return false;
+        }
+        producer_.wake_up();
+        return true;
+      },
+      "battery-plug");
 #endif
 }
 
-void waybar::modules::Battery::refreshBatteries() {
+waybar::modules::Battery::Sample waybar::modules::Battery::Source::sample() {
+  // Make sure we eventually update the list of batteries even if we miss an
+  // inotify event for some reason
+  refreshBatteries();
+#if defined(__linux__)
+  if (batteries_.empty()) {
+    return {false, 0, 0, "Unknown", 0, 0, 0.0f};
+  }
+#endif
+  auto [capacity, time_remaining, status, power, cycles, health] = getInfos();
+  if (status == "Unknown") {
+    status = getAdapterStatus(capacity);
+  }
+  return {true, capacity, time_remaining, std::move(status), power, cycles, health};
+}
+
+void waybar::modules::Battery::Source::refreshBatteries() {
 #if defined(__linux__)
-  std::lock_guard<std::mutex> guard(battery_list_mutex_);
   // Mark existing list of batteries as not necessarily found
   std::map<fs::path, bool> check_map;
   for (auto const& bat : batteries_) {
@@ -185,9 +224,7 @@ static bool status_gt(const std::string& a, const std::string& b) {
 }
 
 std::tuple<uint8_t, float, std::string, float, uint16_t, float>
-waybar::modules::Battery::getInfos() {
-  std::lock_guard<std::mutex> guard(battery_list_mutex_);
-
+waybar::modules::Battery::Source::getInfos() {
   try {
 #if defined(__FreeBSD__)
     /* Allocate state of battery units reported via ACPI. */
@@ -622,7 +659,7 @@ waybar::modules::Battery::getInfos() {
   }
 }
 
-const std::string waybar::modules::Battery::getAdapterStatus(uint8_t capacity) const {
+const std::string waybar::modules::Battery::Source::getAdapterStatus(uint8_t capacity) const {
 #if defined(__FreeBSD__)
   int state;
   size_t size_state = sizeof state;
@@ -668,16 +705,15 @@ const std::string waybar::modules::Battery::formatTimeRemaining(float hoursRemai
 }
 
 auto waybar::modules::Battery::update() -> void {
-#if defined(__linux__)
-  if (batteries_.empty()) {
-    event_box_.hide();
+  auto sample = producer_->latest();
+  if (!sample) {
     return;
   }
-#endif
-  auto [capacity, time_remaining, status, power, cycles, health] = getInfos();
-  if (status == "Unknown") {
-    status = getAdapterStatus(capacity);
+  if (!sample->present) {
+    event_box_.hide();
+    return;
   }
+  auto [present, capacity, time_remaining, status, power, cycles, health] = *sample;
   auto status_pretty = status;
   // Transform to lowercase  and replace space with dash
   std::ranges::transform(status.begin(), status.end(), status.begin(),
@@ -111,16 +111,23 @@ waybar::modules::cava::CavaBackend::CavaBackend(const Json::Value& config) {
 }
 
 waybar::modules::cava::CavaBackend::~CavaBackend() {
+  // The cava input loop polls the terminate flag, both workers must be done before cleaning up.
+  // A suspended input waits on resumeCond and would never see it.
+  pthread_mutex_lock(&audio_data_.lock);
+  audio_data_.terminate = 1;
+  audio_data_.suspendFlag = false;
+  pthread_cond_broadcast(&audio_data_.resumeCond);
+  pthread_mutex_unlock(&audio_data_.lock);
   thread_.stop();
   read_thread_.stop();
+  thread_.join();
+  read_thread_.join();
   cava_destroy(plan_);
   delete plan_;
   plan_ = nullptr;
   audio_raw_clean(&audio_raw_);
-  pthread_mutex_lock(&audio_data_.lock);
-  audio_data_.terminate = 1;
-  pthread_mutex_unlock(&audio_data_.lock);
   config_clean(&prm_);
+  spdlog::debug("cava backend: {} frames dropped", m_signal_update_.dropped());
   free(audio_data_.source);
   free(audio_data_.cava_in);
 }
@@ -188,12 +195,12 @@ void waybar::modules::cava::CavaBackend::doPauseResume() {
   pthread_mutex_unlock(&audio_data_.lock);
 }
 
-waybar::modules::cava::CavaBackend::type_signal_update
+waybar::modules::cava::CavaBackend::type_signal_update&
 waybar::modules::cava::CavaBackend::signal_update() {
   return m_signal_update_;
 }
 
-waybar::modules::cava::CavaBackend::type_signal_silence
+waybar::modules::cava::CavaBackend::type_signal_silence&
 waybar::modules::cava::CavaBackend::signal_silence() {
   return m_signal_silence_;
 }
@@ -15,17 +15,28 @@
 
 waybar::modules::Cpu::Cpu(const std::string& id, const Json::Value& config)
     : ALabel(config, "cpu", id, "{usage}%", 10) {
-  thread_ = [this] {
-    dp.emit();
-    thread_.sleep_for(interval_);
-  };
+  producer_ = util::SharedProducer<Sample>::subscribe(
+      "cpu:" + std::to_string(interval_.count()), interval_,
+      [] {
+        return [prev_times = std::vector<std::tuple<size_t, size_t>>()](
+                   const util::StopSource&) mutable -> std::optional<Sample> {
+          auto [load1, load5, load15] = Load::getLoad();
+          auto [cpu_usage, tooltip] = CpuUsage::getCpuUsage(prev_times);
+          auto [max_frequency, min_frequency, avg_frequency] = CpuFrequency::getCpuFrequency();
+          return Sample{load1,         std::move(cpu_usage), std::move(tooltip),
+                        max_frequency, min_frequency,        avg_frequency};
+        };
+      },
+      [this] { dp.emit(); });
 }
 
 auto waybar::modules::Cpu::update() -> void {
+  auto sample = producer_->latest();
+  if (!sample) {
+    return;
+  }
   // TODO: as creating dynamic fmt::arg arrays is buggy we have to calc both
-  auto [load1, load5, load15] = Load::getLoad();
-  auto [cpu_usage, tooltip] = CpuUsage::getCpuUsage(prev_times_);
-  auto [max_frequency, min_frequency, avg_frequency] = CpuFrequency::getCpuFrequency();
+  const auto& [load1, cpu_usage, tooltip, max_frequency, min_frequency, avg_frequency] = *sample;
   if (tooltipEnabled()) {
     label_.set_tooltip_text(tooltip);
   }
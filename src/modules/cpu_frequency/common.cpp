@@ -11,15 +11,19 @@
 
 waybar::modules::CpuFrequency::CpuFrequency(const std::string& id, const Json::Value& config)
     : ALabel(config, "cpu_frequency", id, "{avg_frequency}", 10) {
-  thread_ = [this] {
-    dp.emit();
-    thread_.sleep_for(interval_);
-  };
+  producer_ = util::SharedProducer<Sample>::subscribe(
+      "cpu_frequency:" + std::to_string(interval_.count()), interval_,
+      [] { return [](const util::StopSource&) { return std::optional(getCpuFrequency()); }; },
+      [this] { dp.emit(); });
 }
 
 auto waybar::modules::CpuFrequency::update() -> void {
+  auto sample = producer_->latest();
+  if (!sample) {
+    return;
+  }
   // TODO: as creating dynamic fmt::arg arrays is buggy we have to calc both
-  auto [max_frequency, min_frequency, avg_frequency] = CpuFrequency::getCpuFrequency();
+  auto [max_frequency, min_frequency, avg_frequency] = *sample;
   if (tooltipEnabled()) {
     auto tooltip =
         fmt::format("Minimum frequency: {}\nAverage frequency: {}\nMaximum frequency: {}\n",
@@ -11,15 +11,24 @@
 
 waybar::modules::CpuUsage::CpuUsage(const std::string& id, const Json::Value& config)
     : ALabel(config, "cpu_usage", id, "{usage}%", 10) {
-  thread_ = [this] {
-    dp.emit();
-    thread_.sleep_for(interval_);
-  };
+  producer_ = util::SharedProducer<Sample>::subscribe(
+      "cpu_usage:" + std::to_string(interval_.count()), interval_,
+      [] {
+        return [prev_times = std::vector<std::tuple<size_t, size_t>>()](
+                   const util::StopSource&) mutable -> std::optional<Sample> {
+          return getCpuUsage(prev_times);
+        };
+      },
+      [this] { dp.emit(); });
 }
 
 auto waybar::modules::CpuUsage::update() -> void {
+  auto sample = producer_->latest();
+  if (!sample) {
+    return;
+  }
   // TODO: as creating dynamic fmt::arg arrays is buggy we have to calc both
-  auto [cpu_usage, tooltip] = CpuUsage::getCpuUsage(prev_times_);
+  const auto& [cpu_usage, tooltip] = *sample;
   if (tooltipEnabled()) {
     label_.set_tooltip_text(tooltip);
   }
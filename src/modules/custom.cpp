@@ -2,8 +2,6 @@
 
 #include <spdlog/spdlog.h>
 
-#include "util/scope_guard.hpp"
-
 waybar::modules::Custom::Custom(const std::string& name, const std::string& id,
                                 const Json::Value& config, const std::string& output_name)
     : ALabel(config, "custom-" + name, id, "{}"),
@@ -20,47 +18,56 @@ waybar::modules::Custom::Custom(const std::string& name, const std::string& id,
   dp.emit();
   if (!config_["signal"].empty() && config_["interval"].empty() &&
       config_["restart-interval"].empty()) {
-    waitingWorker();
+    sharedWorker(std::chrono::milliseconds::zero());
   } else if (interval_.count() > 0) {
-    delayWorker();
+    sharedWorker(interval_);
   } else if (config_["exec"].isString()) {
     continuousWorker();
   }
 }
 
 waybar::modules::Custom::~Custom() {
+  producer_.reset();
+  thread_.stop();
+  thread_.join();
   if (pid_ != -1) {
     killpg(pid_, SIGTERM);
     waitpid(pid_, NULL, 0);
     pid_ = -1;
   }
+  if (fp_) {
+    fclose(fp_);
+    fp_ = nullptr;
+  }
 }
 
-void waybar::modules::Custom::delayWorker() {
-  thread_ = [this] {
-    for (int i : this->pid_children_) {
-      int status;
-      waitpid(i, &status, 0);
-    }
-
-    this->pid_children_.clear();
-
-    bool can_update = true;
-    if (config_["exec-if"].isString()) {
-      output_ = util::command::execNoRead(config_["exec-if"].asString());
-      if (output_.exit_code != 0) {
-        can_update = false;
-        dp.emit();
+void waybar::modules::Custom::sharedWorker(std::chrono::milliseconds interval) {
+  auto key = util::producerKey("custom", config_, {"exec", "exec-if", "interval", "signal"});
+  // Scripts may depend on the output, only share them between bars when asked to
+  if (!config_["shared"].asBool()) {
+    key += "@" + output_name_;
+  }
+  auto make_sampler = [this] {
+    return [exec = config_["exec"], exec_if = config_["exec-if"], output_name = output_name_](
+               const util::StopSource& stop) -> std::optional<util::command::res> {
+      util::command::res output = {0, ""};
+      if (exec_if.isString()) {
+        output = util::command::execNoRead(exec_if.asString(), &stop);
+        if (output.exit_code != 0) {
+          return output;
+        }
       }
-    }
-    if (can_update) {
-      if (config_["exec"].isString()) {
-        output_ = util::command::exec(config_["exec"].asString(), output_name_);
+      if (exec.isString()) {
+        output = util::command::exec(exec.asString(), output_name, &stop);
       }
-      dp.emit();
-    }
-    thread_.sleep_for(interval_);
+      if (stop.stop_requested()) {
+        return std::nullopt;
+      }
+      return output;
+    };
   };
+  producer_ = util::SharedProducer<util::command::res>::subscribe(
+      key, interval, make_sampler, [this] { dp.emit(); }, true);
 }
 
 void waybar::modules::Custom::continuousWorker() {
@@ -71,18 +78,17 @@ void waybar::modules::Custom::continuousWorker() {
     throw std::runtime_error("Unable to open " + cmd);
   }
   thread_ = [this, cmd] {
-    char* buff = nullptr;
-    waybar::util::ScopeGuard buff_deleter([&buff]() {
-      if (buff) {
-        free(buff);
+    std::string output;
+    if (!util::command::readLine(fp_, line_buf_, output, &thread_.stop_source())) {
+      if (!thread_.isRunning()) {
+        // The child is terminated by the destructor
+        return;
       }
-    });
-    size_t len = 0;
-    if (getline(&buff, &len, fp_) == -1) {
       int exit_code = 1;
       if (fp_) {
-        exit_code = WEXITSTATUS(util::command::close(fp_, pid_));
+        exit_code = WEXITSTATUS(util::command::close(fp_, pid_, &thread_.stop_source()));
         fp_ = nullptr;
+        pid_ = -1;
       }
       if (exit_code != 0) {
         output_ = {exit_code, ""};
@@ -90,10 +96,12 @@ void waybar::modules::Custom::continuousWorker() {
         spdlog::error("{} stopped unexpectedly, is it endless?", name_);
       }
       if (config_["restart-interval"].isNumeric()) {
-        pid_ = -1;
         thread_.sleep_for(std::chrono::milliseconds(
             std::max(1L,  // Minimum 1ms due to millisecond precision
                      static_cast<long>(config_["restart-interval"].asDouble() * 1000))));
+        if (!thread_.isRunning()) {
+          return;
+        }
         fp_ = util::command::open(cmd, pid_, output_name_);
         if (!fp_) {
           throw std::runtime_error("Unable to open " + cmd);
@@ -103,46 +111,28 @@ void waybar::modules::Custom::continuousWorker() {
         return;
       }
     } else {
-      std::string output = buff;
-
-      // Remove last newline
-      if (!output.empty() && output[output.length() - 1] == '\n') {
-        output.erase(output.length() - 1);
-      }
       output_ = {0, output};
       dp.emit();
     }
   };
 }
 
-void waybar::modules::Custom::waitingWorker() {
-  thread_ = [this] {
-    bool can_update = true;
-    if (config_["exec-if"].isString()) {
-      output_ = util::command::execNoRead(config_["exec-if"].asString());
-      if (output_.exit_code != 0) {
-        can_update = false;
-        dp.emit();
-      }
-    }
-    if (can_update) {
-      if (config_["exec"].isString()) {
-        output_ = util::command::exec(config_["exec"].asString(), output_name_);
-      }
-      dp.emit();
-    }
-    thread_.sleep();
-  };
-}
-
 void waybar::modules::Custom::refresh(int sig) {
   if (sig == SIGRTMIN + config_["signal"].asInt()) {
+    if (producer_) {
+      producer_->wake_up();
+    }
     thread_.wake_up();
   }
 }
 
 void waybar::modules::Custom::handleEvent() {
   if (!config_["exec-on-event"].isBool() || config_["exec-on-event"].asBool()) {
+    if (producer_) {
+      // Let the click handlers finish before running the script again
+      producer_->wake_up_after(std::move(pid_children_));
+      pid_children_.clear();
+    }
     thread_.wake_up();
   }
 }
@@ -160,6 +150,11 @@ bool waybar::modules::Custom::handleToggle(GdkEventButton* const& e) {
 }
 
 auto waybar::modules::Custom::update() -> void {
+  if (producer_) {
+    if (auto sample = producer_->latest()) {
+      output_ = *sample;
+    }
+  }
   // Hide label if output is empty
   if ((config_["exec"].isString() || config_["exec-if"].isString()) &&
       (output_.out.empty() || output_.exit_code != 0)) {
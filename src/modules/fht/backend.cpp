@@ -1,120 +1,35 @@
 #include "modules/fht/backend.hpp"
 
-#include <netdb.h>
-#include <netinet/in.h>
 #include <spdlog/spdlog.h>
-#include <sys/socket.h>
-#include <sys/stat.h>
-#include <sys/types.h>
-#include <sys/un.h>
-#include <unistd.h>
 
-#include <iostream>
+#include <algorithm>
+#include <iterator>
 #include <string>
-#include <thread>
-
-#include "giomm/datainputstream.h"
-#include "giomm/dataoutputstream.h"
-#include "giomm/unixinputstream.h"
-#include "giomm/unixoutputstream.h"
 
 namespace waybar::modules::fht {
 
-int IPC::connectToSocket() {
-  const char *socket_path = getenv("FHTC_SOCKET_PATH");
-
-  if (socket_path == nullptr) {
-    spdlog::warn("Fht is not running, fht IPC will not be available.");
-    return -1;
-  }
-
-  struct sockaddr_un addr;
-  int socketfd = socket(AF_UNIX, SOCK_STREAM, 0);
-
-  if (socketfd == -1) {
-    throw std::runtime_error("socketfd failed");
-  }
-
-  addr.sun_family = AF_UNIX;
+namespace {
 
-  strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+// Fht starts sending events right after the subscription, without an acknowledgement
+const util::JsonLinesIpc::Protocol PROTOCOL = {
+    .name = "Fht",
+    .socketEnv = "FHTC_SOCKET_PATH",
+    .subscribe = "subscribe",
+};
 
-  addr.sun_path[sizeof(addr.sun_path) - 1] = 0;
+}  // namespace
 
-  int l = sizeof(struct sockaddr_un);
+IPC::IPC() : ipc_(PROTOCOL, [this](const Json::Value &ev) { return parseIPC(ev); }) {}
 
-  if (connect(socketfd, (struct sockaddr *)&addr, l) == -1) {
-    close(socketfd);
-    throw std::runtime_error("unable to connect");
-  }
-
-  return socketfd;
-}
-
-void IPC::startIPC() {
-  // will start IPC and relay events to parseIPC
-
-  std::thread([&]() {
-    int socketfd;
-    try {
-      socketfd = connectToSocket();
-    } catch (std::exception &e) {
-      spdlog::error("Fht IPC: failed to start, reason: {}", e.what());
-      return;
-    }
-    if (socketfd == -1) return;
-
-    spdlog::info("Fht IPC starting");
-
-    auto unix_istream = Gio::UnixInputStream::create(socketfd, true);
-    auto unix_ostream = Gio::UnixOutputStream::create(socketfd, false);
-    auto istream = Gio::DataInputStream::create(unix_istream);
-    auto ostream = Gio::DataOutputStream::create(unix_ostream);
-
-    // Subscribe to events
-    Json::Value subscribeRequest;
-    subscribeRequest = "subscribe";
-
-    Json::StreamWriterBuilder builder;
-    builder["indentation"] = "";
-    std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
-    std::ostringstream oss;
-    writer->write(subscribeRequest, &oss);
-    oss << '\n';
-
-    if (!ostream->put_string(oss.str()) || !ostream->flush()) {
-      spdlog::error("Fht IPC: failed to start event stream");
-      return;
-    }
-
-    // Fht compositor starts sending events immediately after subscription,
-    // no acknowledgement message is sent
-    spdlog::info("Fht IPC: subscription sent, listening for events");
-
-    std::string line;
-    while (istream->read_line(line)) {
-      spdlog::debug("Fht IPC: received {}", line);
-
-      try {
-        parseIPC(line);
-      } catch (std::exception &e) {
-        spdlog::warn("Failed to parse IPC message: {}, reason: {}", line, e.what());
-      } catch (...) {
-        throw;
-      }
-
-      std::this_thread::sleep_for(std::chrono::milliseconds(1));
-    }
-  }).detach();
+Json::Value IPC::send(const Json::Value &request) {
+  return util::JsonLinesIpc::send(PROTOCOL, request);
 }
 
-void IPC::parseIPC(const std::string &line) {
-  const auto ev = parser_.parse(line);
-
+std::string IPC::parseIPC(const Json::Value &ev) {
   // Fht events have format: {"event":"event-name","data":{...}}
   if (!ev.isMember("event") || !ev.isMember("data")) {
-    spdlog::warn("Fht IPC: invalid event format: {}", line);
-    return;
+    spdlog::warn("Fht IPC: invalid event format: {}", ev);
+    return "";
   }
 
   const auto eventName = ev["event"].asString();
@@ -268,69 +183,7 @@ void IPC::parseIPC(const std::string &line) {
     }
   }
 
-  // Notify event handlers
-  std::unique_lock lock(callbackMutex_);
-
-  for (auto &[name, handler] : callbacks_) {
-    if (name == eventName) {
-      handler->onEvent(ev);
-    }
-  }
-}
-
-void IPC::registerForIPC(const std::string &ev, EventHandler *ev_handler) {
-  if (ev_handler == nullptr) {
-    return;
-  }
-
-  std::unique_lock lock(callbackMutex_);
-  callbacks_.emplace_back(ev, ev_handler);
-}
-
-void IPC::unregisterForIPC(EventHandler *ev_handler) {
-  if (ev_handler == nullptr) {
-    return;
-  }
-
-  std::unique_lock lock(callbackMutex_);
-
-  for (auto it = callbacks_.begin(); it != callbacks_.end();) {
-    auto &[eventname, handler] = *it;
-    if (handler == ev_handler) {
-      it = callbacks_.erase(it);
-    } else {
-      ++it;
-    }
-  }
-}
-
-Json::Value IPC::send(const Json::Value &request) {
-  int socketfd = connectToSocket();
-  if (socketfd == -1) throw std::runtime_error("Fht is not running");
-
-  auto unix_istream = Gio::UnixInputStream::create(socketfd, true);
-  auto unix_ostream = Gio::UnixOutputStream::create(socketfd, false);
-  auto istream = Gio::DataInputStream::create(unix_istream);
-  auto ostream = Gio::DataOutputStream::create(unix_ostream);
-
-  // Fht needs the request on a single line.
-  Json::StreamWriterBuilder builder;
-  builder["indentation"] = "";
-  std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
-  std::ostringstream oss;
-  writer->write(request, &oss);
-  oss << '\n';
-
-  if (!ostream->put_string(oss.str()) || !ostream->flush())
-    throw std::runtime_error("error writing to fht socket");
-
-  std::string line;
-  if (!istream->read_line(line)) throw std::runtime_error("error reading from fht socket");
-
-  std::istringstream iss(std::move(line));
-  Json::Value response;
-  iss >> response;
-  return response;
+  return eventName;
 }
 
 }  // namespace waybar::modules::fht
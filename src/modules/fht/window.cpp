@@ -10,7 +10,9 @@
 namespace waybar::modules::fht {
 
 Window::Window(const std::string &id, const Bar &bar, const Json::Value &config)
-    : AAppIconLabel(config, "window", id, "{title}", 0, true), bar_(bar) {
+    : AAppIconLabel(config, "window", id, "{title}", 0, true),
+      bar_(bar),
+      rewriteRules_(config["rewrite"]) {
   if (!gIPC) gIPC = std::make_unique<IPC>();
 
   gIPC->registerForIPC("windows", this);
@@ -64,10 +66,9 @@ void Window::doUpdate() {
     const auto sanitizedAppId = waybar::util::sanitize_string(appId);
 
     label_.show();
-    label_.set_markup(waybar::util::rewriteString(
+    label_.set_markup(rewriteRules_.rewrite(
         fmt::format(fmt::runtime(format_), fmt::arg("title", sanitizedTitle),
-                    fmt::arg("app_id", sanitizedAppId)),
-        config_["rewrite"]));
+                    fmt::arg("app_id", sanitizedAppId))));
 
     updateAppIconName(appId, "");
 
@@ -138,7 +138,8 @@ Gtk::Button &Workspaces::addButton(const Json::Value &ws) {
         auto &focusWorkspace = (action["focus-workspace"] = Json::Value(Json::objectValue));
         focusWorkspace["workspace-id"] = id;
 
-        IPC::send(request);
+        // Clicking faster than the compositor switches only sends the last switch
+        gIPC->queue(std::move(request), "workspace");
       } catch (const std::exception &e) {
         spdlog::error("Error switching workspace: {}", e.what());
       }
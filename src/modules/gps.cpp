@@ -44,28 +44,36 @@ waybar::modules::Gps::Gps(const std::string& id, const Json::Value& config)
     hideNoFix = config_["hide-no-fix"].asBool();
   }
 
-  gps_thread_ = [this] {
-    dp.emit();
-    gps_stream(&gps_data_, WATCH_ENABLE, NULL);
-    int last_gps_mode = 0;
-
-    while (gps_waiting(&gps_data_, 5000000)) {
-      if (gps_read(&gps_data_, NULL, 0) == -1) {
-        throw std::runtime_error("Can't read data from gpsd.");
-      }
-
-      if (MODE_SET != (MODE_SET & gps_data_.set)) {
-        // did not even get mode, nothing to see here
-        continue;
-      }
-
-      if (gps_data_.fix.mode != last_gps_mode) {
-        // significant update
-        dp.emit();
-      }
-      last_gps_mode = gps_data_.fix.mode;
-    }
-  };
+  gps_stream(&gps_data_, WATCH_ENABLE, NULL);
+  gps_watch_ = util::Reactor::instance().watch(
+      gps_data_.gpsd_fd, EPOLLIN,
+      [this](uint32_t events) {
+        if (events & (EPOLLERR | EPOLLHUP)) {
+          spdlog::error("Lost connection to gpsd.");
+          return false;
+        }
+        // libgps may have buffered more than one report
+        do {
+          if (gps_read(&gps_data_, NULL, 0) == -1) {
+            spdlog::error("Can't read data from gpsd.");
+            return false;
+          }
+
+          if (MODE_SET != (MODE_SET & gps_data_.set)) {
+            // did not even get mode, nothing to see here
+            continue;
+          }
+
+          if (gps_data_.fix.mode != last_gps_mode_) {
+            // significant update
+            dp.emit();
+          }
+          last_gps_mode_ = gps_data_.fix.mode;
+        } while (gps_waiting(&gps_data_, 0));
+        return true;
+      },
+      "gps");
+  dp.emit();
 
 #ifdef WANT_RFKILL
   rfkill_.on_update.connect(sigc::hide(sigc::mem_fun(*this, &Gps::update)));
@@ -211,6 +219,7 @@ auto waybar::modules::Gps::update() -> void {
 }
 
 waybar::modules::Gps::~Gps() {
+  gps_watch_.reset();
   gps_stream(&gps_data_, WATCH_DISABLE, NULL);
   gps_close(&gps_data_);
 }
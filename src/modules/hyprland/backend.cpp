@@ -1,7 +1,9 @@
 #include "modules/hyprland/backend.hpp"
 
+#include <fcntl.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <spdlog/spdlog.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
@@ -9,11 +11,34 @@
 #include <sys/un.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
 #include <string>
+#include <string_view>
+
+#include "util/line_buffer.hpp"
 
 namespace waybar::modules::hyprland {
 
+namespace {
+
+// Upper bound on the lifetime of a cached reply, in case no event follows a change
+constexpr auto REPLY_CACHE_TTL = std::chrono::milliseconds(100);
+// Separator between the replies of a [[BATCH]] request
+constexpr std::string_view BATCH_DELIMITER = "\n\n\n";
+// Delay before reconnecting to socket2, doubled after every failed attempt
+constexpr auto RECONNECT_MIN = std::chrono::milliseconds(100);
+constexpr auto RECONNECT_MAX = std::chrono::milliseconds(5000);
+
+/// JSON replies start with an object or an array, errors are plain text
+bool looksLikeJson(std::string_view reply) {
+  auto start = reply.find_first_not_of(" \t\r\n");
+  return start != std::string_view::npos && (reply[start] == '{' || reply[start] == '[');
+}
+
+}  // namespace
+
 std::filesystem::path IPC::socketFolder_;
 
 std::filesystem::path IPC::getSocketFolder(const char* instanceSig) {
@@ -46,6 +71,15 @@ std::filesystem::path IPC::getSocketFolder(const char* instanceSig) {
 IPC::IPC() {
   // will start IPC and relay events to parseIPC
   ipcThread_ = std::thread([this]() { socketListener(); });
+  // The modules wait for the first sync, unless there is no compositor to sync from
+  eventThread_ = std::thread([this, sync = getenv("HYPRLAND_INSTANCE_SIGNATURE") != nullptr]() {
+    if (sync) {
+      state_.resync();
+    } else {
+      state_.disable();
+    }
+    dispatchEvents();
+  });
   socketOwnerPid_ = getpid();
 }
 
@@ -54,19 +88,14 @@ IPC::~IPC() {
   // failed exec()) exits.
   if (getpid() != socketOwnerPid_) return;
 
-  running_ = false;
   spdlog::info("Hyprland IPC stopping...");
-  if (socketfd_ != -1) {
-    spdlog::trace("Shutting down socket");
-    if (shutdown(socketfd_, SHUT_RDWR) == -1) {
-      spdlog::error("Hyprland IPC: Couldn't shutdown socket");
-    }
-    spdlog::trace("Closing socket");
-    if (close(socketfd_) == -1) {
-      spdlog::error("Hyprland IPC: Couldn't close socket");
-    }
+  stop_.request_stop();
+  {
+    std::lock_guard lock(eventMutex_);
   }
+  eventCv_.notify_all();
   ipcThread_.join();
+  eventThread_.join();
 }
 
 IPC& IPC::inst() {
@@ -74,6 +103,26 @@ IPC& IPC::inst() {
   return ipc;
 }
 
+int IPC::connectSocket2(const char* instanceSig) {
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd == -1) {
+    spdlog::error("Hyprland IPC: socketfd failed");
+    return -1;
+  }
+
+  struct sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  auto socketPath = IPC::getSocketFolder(instanceSig) / ".socket2.sock";
+  strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1 ||
+      fcntl(fd, F_SETFL, O_NONBLOCK) == -1) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
 void IPC::socketListener() {
   // check for hyprland
   const char* his = getenv("HYPRLAND_INSTANCE_SIGNATURE");
@@ -85,68 +134,119 @@ void IPC::socketListener() {
 
   spdlog::info("Hyprland IPC starting");
 
-  struct sockaddr_un addr;
-  socketfd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+  auto backoff = RECONNECT_MIN;
+  bool connected = true;
+  while (!stop_.stop_requested()) {
+    int fd = connectSocket2(his);
+    if (fd != -1) {
+      if (!connected) {
+        spdlog::info("Hyprland IPC: reconnected");
+        // Events were missed while disconnected
+        beginEvent("");
+        state_.invalidate();
+      }
+      connected = true;
+      backoff = RECONNECT_MIN;
+      readEvents(fd);
+      close(fd);
+      if (stop_.stop_requested()) {
+        break;
+      }
+      spdlog::warn("Hyprland IPC: socket2 closed, reconnecting");
+    } else if (connected) {
+      spdlog::error("Hyprland IPC: Unable to connect?");
+    }
+    connected = false;
 
-  if (socketfd_ == -1) {
-    spdlog::error("Hyprland IPC: socketfd failed");
-    return;
+    // Sleep until the next attempt, unless stopped
+    struct pollfd pfd = {stop_.fd(), POLLIN, 0};
+    poll(&pfd, 1, static_cast<int>(backoff.count()));
+    backoff = std::min(backoff * 2, RECONNECT_MAX);
   }
+  spdlog::debug("Hyprland IPC stopped");
+}
 
-  addr.sun_family = AF_UNIX;
-
-  auto socketPath = IPC::getSocketFolder(his) / ".socket2.sock";
-  strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
-
-  addr.sun_path[sizeof(addr.sun_path) - 1] = 0;
+void IPC::readEvents(int fd) {
+  util::LineBuffer buffer;
+  std::vector<std::string_view> events;
+
+  while (stop_.wait(fd)) {
+    // Drain everything available, so that a burst is dispatched as one batch
+    while (true) {
+      auto space = buffer.prepare();
+      auto n = read(fd, space.data(), space.size());
+      if (n > 0) {
+        buffer.commit(n);
+        continue;
+      }
+      if (n == -1 && errno == EINTR) {
+        continue;
+      }
+      if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        break;
+      }
+      if (n == -1) {
+        spdlog::error("Hyprland IPC: socket2 read failed: {}", strerror(errno));
+      }
+      // EOF or error, dispatch what was received
+      events.clear();
+      buffer.lines(events);
+      queueEvents(events);
+      return;
+    }
 
-  int l = sizeof(struct sockaddr_un);
+    events.clear();
+    buffer.lines(events);
+    queueEvents(events);
+  }
+}
 
-  if (connect(socketfd_, (struct sockaddr*)&addr, l) == -1) {
-    spdlog::error("Hyprland IPC: Unable to connect?");
+void IPC::queueEvents(std::span<const std::string_view> events) {
+  if (events.empty()) {
     return;
   }
-  auto* file = fdopen(socketfd_, "r");
-  if (file == nullptr) {
-    spdlog::error("Hyprland IPC: Couldn't open file descriptor");
-    return;
+  {
+    std::lock_guard lock(eventMutex_);
+    for (const auto& event : events) {
+      pendingEvents_.emplace_back(event);
+    }
   }
-  while (running_) {
-    std::array<char, 1024> buffer;  // Hyprland socket2 events are max 1024 bytes
-
-    auto* receivedCharPtr = fgets(buffer.data(), buffer.size(), file);
+  eventCv_.notify_one();
+}
 
-    if (receivedCharPtr == nullptr) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(1));
-      continue;
+void IPC::dispatchEvents() {
+  std::vector<std::string> events;
+  while (true) {
+    {
+      std::unique_lock lock(eventMutex_);
+      eventCv_.wait(lock, [this] { return !pendingEvents_.empty() || stop_.stop_requested(); });
+      if (stop_.stop_requested()) {
+        return;
+      }
+      events.swap(pendingEvents_);
     }
 
-    std::string messageReceived(buffer.data());
-    messageReceived = messageReceived.substr(0, messageReceived.find_first_of('\n'));
-    spdlog::debug("hyprland IPC received {}", messageReceived);
+    for (const auto& event : events) {
+      spdlog::debug("hyprland IPC received {}", event);
 
-    try {
-      parseIPC(messageReceived);
-    } catch (std::exception& e) {
-      spdlog::warn("Failed to parse IPC message: {}, reason: {}", messageReceived, e.what());
-    } catch (...) {
-      throw;
+      try {
+        parseIPC(event);
+      } catch (std::exception& e) {
+        spdlog::warn("Failed to parse IPC message: {}, reason: {}", event, e.what());
+      }
     }
-
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    events.clear();
   }
-  spdlog::debug("Hyprland IPC stopped");
 }
 
 void IPC::parseIPC(const std::string& ev) {
-  std::string request = ev.substr(0, ev.find_first_of('>'));
-  std::unique_lock lock(callbackMutex_);
+  std::string_view request = std::string_view(ev).substr(0, ev.find_first_of('>'));
+  beginEvent(request);
+  state_.apply(request,
+               request.size() + 2 <= ev.size() ? std::string_view(ev).substr(request.size() + 2)
+                                               : std::string_view());
 
-  for (auto& [eventname, handler] : callbacks_) {
-    if (eventname == request) {
-      handler->onEvent(ev);
-    }
-  }
+  handlers_.dispatch(request, [&ev](EventHandler& handler, auto) { handler.onEvent(ev); });
 }
 
 void IPC::registerForIPC(const std::string& ev, EventHandler* ev_handler) {
@@ -154,8 +254,7 @@ void IPC::registerForIPC(const std::string& ev, EventHandler* ev_handler) {
     return;
   }
 
-  std::unique_lock lock(callbackMutex_);
-  callbacks_.emplace_back(ev, ev_handler);
+  handlers_.add(ev, ev_handler);
 }
 
 void IPC::unregisterForIPC(EventHandler* ev_handler) {
@@ -163,16 +262,7 @@ void IPC::unregisterForIPC(EventHandler* ev_handler) {
     return;
   }
 
-  std::unique_lock lock(callbackMutex_);
-
-  for (auto it = callbacks_.begin(); it != callbacks_.end();) {
-    auto& [eventname, handler] = *it;
-    if (handler == ev_handler) {
-      callbacks_.erase(it++);
-    } else {
-      ++it;
-    }
-  }
+  handlers_.remove(ev_handler);
 }
 
 std::string IPC::getSocket1Reply(const std::string& rq) {
@@ -233,14 +323,143 @@ std::string IPC::getSocket1Reply(const std::string& rq) {
   return response;
 }
 
+void IPC::queueSocket1Command(std::string rq, std::string key,
+                              std::function<void(const std::string&)> done) {
+  commands_.push(
+      [rq = std::move(rq), done = std::move(done)] {
+        auto reply = getSocket1Reply(rq);
+        if (done) {
+          done(reply);
+        } else if (reply != "ok") {
+          spdlog::warn("Hyprland IPC: {}: {}", rq, reply);
+        }
+      },
+      std::move(key));
+}
+
+void IPC::beginEvent(std::string_view event) {
+  std::unique_lock lock(queryMutex_);
+  generation_++;
+  // The queries of the previous occurrence are replaced, so that the ones modules stopped
+  // issuing are not fetched forever
+  eventQueries_[generationEvent_] = std::move(currentQueries_);
+  currentQueries_.clear();
+  generationEvent_ = event;
+}
+
+bool IPC::isFresh(const CachedReply& reply) const {
+  return reply.generation == generation_ &&
+         std::chrono::steady_clock::now() - reply.time < REPLY_CACHE_TTL;
+}
+
 Json::Value IPC::getSocket1JsonReply(const std::string& rq) {
-  std::string reply = getSocket1Reply("j/" + rq);
+  auto reply = cachedReply(rq);
+  if (reply.value) {
+    return *reply.value;
+  }
 
-  if (reply.empty()) {
-    return {};
+  auto value = std::make_shared<const Json::Value>(
+      reply.text->empty() ? Json::Value() : parser_.parse(*reply.text));
+  std::unique_lock lock(queryMutex_);
+  // Keep it for the next callers, unless the reply was replaced meanwhile
+  if (auto it = replyCache_.find(rq); it != replyCache_.end() && it->second.text == reply.text) {
+    it->second.value = value;
   }
+  return *value;
+}
 
-  return parser_.parse(reply);
+std::shared_ptr<const std::string> IPC::getSocket1JsonText(const std::string& rq) {
+  return cachedReply(rq).text;
+}
+
+IPC::CachedReply IPC::cachedReply(const std::string& rq) {
+  std::unique_lock lock(queryMutex_);
+  currentQueries_.insert(rq);
+
+  while (true) {
+    if (auto it = replyCache_.find(rq); it != replyCache_.end() && isFresh(it->second)) {
+      return it->second;
+    }
+    if (!inFlight_.contains(rq)) {
+      break;
+    }
+    queryCv_.wait(lock);
+  }
+
+  std::vector<std::string> batch = {rq};
+  if (auto profile = eventQueries_.find(generationEvent_); profile != eventQueries_.end()) {
+    for (const auto& query : profile->second) {
+      auto it = replyCache_.find(query);
+      if (query != rq && !inFlight_.contains(query) &&
+          (it == replyCache_.end() || !isFresh(it->second))) {
+        batch.push_back(query);
+      }
+    }
+  }
+  inFlight_.insert(batch.begin(), batch.end());
+  auto generation = generation_;
+  lock.unlock();
+
+  std::vector<std::string> replies;
+  try {
+    replies = fetchJson(batch);
+  } catch (...) {
+    lock.lock();
+    for (const auto& query : batch) {
+      inFlight_.erase(query);
+    }
+    queryCv_.notify_all();
+    throw;
+  }
+
+  lock.lock();
+  auto now = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < batch.size(); i++) {
+    inFlight_.erase(batch[i]);
+    // A prefetched query that failed is fetched on its own when asked, and fails there
+    if (i > 0 && !looksLikeJson(replies[i])) {
+      continue;
+    }
+    replyCache_[batch[i]] = {generation, now,
+                             std::make_shared<const std::string>(std::move(replies[i])), nullptr};
+  }
+  queryCv_.notify_all();
+  return replyCache_[rq];
+}
+
+std::vector<std::string> IPC::fetchJson(const std::vector<std::string>& queries) {
+  std::vector<std::string> replies;
+  // Hyprland splits the batch on ';' and stops at the empty item after the last one. Each
+  // sub-request gets exactly one reply, an error message when it failed, so the replies stay
+  // aligned unless a query contains ';' itself.
+  if (queries.size() > 1 && std::ranges::none_of(queries, [](const auto& query) {
+        return query.find(';') != std::string::npos;
+      })) {
+    std::string request = "[[BATCH]]";
+    for (const auto& query : queries) {
+      request += "j/" + query + ";";
+    }
+    auto reply = getSocket1Reply(request);
+    size_t pos = 0;
+    while (true) {
+      auto next = reply.find(BATCH_DELIMITER, pos);
+      replies.push_back(reply.substr(pos, next - pos));
+      if (next == std::string::npos) {
+        break;
+      }
+      pos = next + BATCH_DELIMITER.size();
+    }
+    if (replies.size() != queries.size()) {
+      spdlog::debug("Hyprland IPC: unexpected batch reply, falling back to single requests");
+      replies.clear();
+    }
+  }
+  if (replies.empty()) {
+    for (const auto& query : queries) {
+      replies.push_back(getSocket1Reply("j/" + query));
+    }
+  }
+  return replies;
 }
 
 }  // namespace waybar::modules::hyprland
@@ -0,0 +1,625 @@
+#include "modules/hyprland/state.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <exception>
+
+#include "modules/hyprland/backend.hpp"
+#include "modules/hyprland/event.hpp"
+#include "util/json_reader.hpp"
+
+namespace waybar::modules::hyprland {
+
+namespace {
+
+std::string stripAddress(std::string address) {
+  if (address.starts_with("0x")) {
+    address.erase(0, 2);
+  }
+  return address;
+}
+
+void readAddress(std::string& out, util::JsonReader& json) {
+  out = stripAddress(json.readString());
+}
+
+// Only the fields used by the modules are decoded, the clients reply of a busy session is large
+const util::JsonSchema<ClientInfo> CLIENT_SCHEMA = {
+    {"address", [](ClientInfo& c, util::JsonReader& json) { readAddress(c.address, json); }},
+    {"workspace.id", &ClientInfo::workspaceId},
+    {"workspace.name", &ClientInfo::workspaceName},
+    {"monitor", &ClientInfo::monitor},
+    {"class", &ClientInfo::className},
+    {"initialClass", &ClientInfo::initialClassName},
+    {"title", &ClientInfo::title},
+    {"initialTitle", &ClientInfo::initialTitle},
+    {"mapped", &ClientInfo::mapped},
+    {"hidden", &ClientInfo::hidden},
+    {"floating", &ClientInfo::floating},
+    {"fullscreen", &ClientInfo::fullscreen},
+    {"grouped",
+     [](ClientInfo& c, util::JsonReader& json) { c.grouped = json.readArraySize() > 0; }},
+    {"swallowing",
+     [](ClientInfo& c, util::JsonReader& json) {
+       if (json.peek() == util::JsonReader::Type::String) {
+         c.swallowing = json.readString() != "0x0";
+       } else {
+         json.skip();
+       }
+     }},
+};
+
+const util::JsonSchema<WorkspaceInfo> WORKSPACE_SCHEMA = {
+    {"id", &WorkspaceInfo::id},
+    {"name", &WorkspaceInfo::name},
+    {"monitor", &WorkspaceInfo::monitor},
+    {"windows", &WorkspaceInfo::windows},
+    {"hasfullscreen", &WorkspaceInfo::hasFullscreen},
+    {"lastwindow",
+     [](WorkspaceInfo& w, util::JsonReader& json) { readAddress(w.lastWindow, json); }},
+    {"lastwindowtitle", &WorkspaceInfo::lastWindowTitle},
+};
+
+const util::JsonSchema<MonitorInfo> MONITOR_SCHEMA = {
+    {"id", &MonitorInfo::id},
+    {"name", &MonitorInfo::name},
+    {"activeWorkspace.id", &MonitorInfo::activeWorkspaceId},
+    {"specialWorkspace.id", &MonitorInfo::specialWorkspaceId},
+    {"specialWorkspace.name", &MonitorInfo::specialWorkspaceName},
+    {"focused", &MonitorInfo::focused},
+};
+
+struct ActiveWindow {
+  std::string address;
+};
+
+const util::JsonSchema<ActiveWindow> ACTIVE_WINDOW_SCHEMA = {
+    {"address", [](ActiveWindow& w, util::JsonReader& json) { readAddress(w.address, json); }},
+};
+
+}  // namespace
+
+std::vector<ClientInfo> ClientInfo::parseList(std::string_view json) {
+  return CLIENT_SCHEMA.readArray(json);
+}
+
+Json::Value ClientInfo::toJson() const {
+  Json::Value value;
+  value["address"] = "0x" + address;
+  value["workspace"]["id"] = workspaceId;
+  value["workspace"]["name"] = workspaceName;
+  value["monitor"] = monitor;
+  value["class"] = className;
+  value["initialClass"] = initialClassName;
+  value["title"] = title;
+  value["initialTitle"] = initialTitle;
+  value["mapped"] = mapped;
+  value["hidden"] = hidden;
+  value["floating"] = floating;
+  value["fullscreen"] = fullscreen;
+  return value;
+}
+
+std::vector<WorkspaceInfo> WorkspaceInfo::parseList(std::string_view json) {
+  return WORKSPACE_SCHEMA.readArray(json);
+}
+
+std::vector<MonitorInfo> MonitorInfo::parseList(std::string_view json) {
+  return MONITOR_SCHEMA.readArray(json);
+}
+
+HyprlandState::HyprlandState(IPC& ipc) : ipc_(ipc) {}
+
+void HyprlandState::addListener(StateListener* listener) {
+  if (listener == nullptr) {
+    return;
+  }
+  std::unique_lock lock(listenerMutex_);
+  listeners_.push_back(listener);
+}
+
+void HyprlandState::removeListener(StateListener* listener) {
+  std::unique_lock lock(listenerMutex_);
+  listeners_.remove(listener);
+}
+
+void HyprlandState::notify(const std::vector<StateDelta>& deltas) {
+  if (deltas.empty()) {
+    return;
+  }
+  std::unique_lock lock(listenerMutex_);
+  for (auto* listener : listeners_) {
+    listener->onStateChanged(deltas);
+  }
+}
+
+void HyprlandState::apply(std::string_view event, std::string_view payload) {
+  bool synced = false;
+  bool stale = false;
+  {
+    std::unique_lock lock(mutex_);
+    synced = synced_;
+    stale = stale_;
+  }
+  if (stale) {
+    // The snapshot includes this event
+    resync();
+    return;
+  }
+  if (!synced) {
+    return;
+  }
+
+  std::vector<StateDelta> deltas;
+  bool applied = false;
+  try {
+    auto fetched = fetchFor(event);
+    std::unique_lock lock(mutex_);
+    applied = applyLocked(event, payload, fetched, deltas);
+  } catch (const std::exception& e) {
+    spdlog::warn("Hyprland state: failed to apply {}>>{}: {}", event, payload, e.what());
+  }
+  if (!applied) {
+    spdlog::debug("Hyprland state: resync after {}>>{}", event, payload);
+    resync();
+    return;
+  }
+  notify(deltas);
+}
+
+void HyprlandState::resync() {
+  std::optional<Snapshot> snapshot;
+  try {
+    snapshot = fetchAll();
+  } catch (const std::exception& e) {
+    spdlog::error("Hyprland state: resync failed: {}", e.what());
+  }
+  {
+    std::unique_lock lock(mutex_);
+    if (snapshot) {
+      clients_.clear();
+      for (auto& client : snapshot->clients) {
+        clients_[client.address] = std::move(client);
+      }
+      monitors_.clear();
+      for (auto& monitor : snapshot->monitors) {
+        monitors_[monitor.name] = std::move(monitor);
+      }
+      activeWindow_ = std::move(snapshot->activeWindow);
+      setWorkspacesLocked(snapshot->workspaces);
+    }
+    synced_ = snapshot.has_value();
+    stale_ = !synced_;
+    ready_ = true;
+  }
+  readyCv_.notify_all();
+  if (snapshot) {
+    notify({{.kind = StateDelta::Kind::Resynced}});
+  }
+}
+
+void HyprlandState::invalidate() {
+  {
+    std::unique_lock lock(mutex_);
+    synced_ = false;
+    stale_ = true;
+    ready_ = true;
+  }
+  readyCv_.notify_all();
+}
+
+void HyprlandState::disable() {
+  {
+    std::unique_lock lock(mutex_);
+    ready_ = true;
+  }
+  readyCv_.notify_all();
+}
+
+HyprlandState::Snapshot HyprlandState::fetchAll() {
+  auto clientsJson = ipc_.getSocket1JsonText("clients");
+  auto monitorsJson = ipc_.getSocket1JsonText("monitors");
+  auto activeWindowJson = ipc_.getSocket1JsonText("activewindow");
+  auto workspacesJson = ipc_.getSocket1JsonText("workspaces");
+  return {
+      .clients = ClientInfo::parseList(*clientsJson),
+      .workspaces = WorkspaceInfo::parseList(*workspacesJson),
+      .monitors = MonitorInfo::parseList(*monitorsJson),
+      .activeWindow = ACTIVE_WINDOW_SCHEMA.read(*activeWindowJson).address,
+  };
+}
+
+HyprlandState::Snapshot HyprlandState::fetchFor(std::string_view event) {
+  Snapshot fetched;
+  if (event == "openwindow") {
+    // The event lacks the floating, fullscreen, group... state a window rule may have set
+    fetched.clients = ClientInfo::parseList(*ipc_.getSocket1JsonText("clients"));
+  } else if (event == "createworkspacev2") {
+    // It doesn't say on which monitor the workspace was created
+    fetched.workspaces = WorkspaceInfo::parseList(*ipc_.getSocket1JsonText("workspaces"));
+  }
+  return fetched;
+}
+
+void HyprlandState::waitReadyLocked(std::unique_lock<std::mutex>& lock) {
+  readyCv_.wait(lock, [this] { return ready_; });
+}
+
+void HyprlandState::setWorkspacesLocked(std::vector<WorkspaceInfo>& workspaces) {
+  workspaces_.clear();
+  for (auto& workspace : workspaces) {
+    workspaces_[workspace.id] = std::move(workspace);
+  }
+}
+
+void HyprlandState::countLocked(const ClientInfo& client, int change,
+                                std::vector<StateDelta>& deltas) {
+  auto it = workspaces_.find(client.workspaceId);
+  if (it == workspaces_.end() || !client.mapped) {
+    return;
+  }
+  it->second.windows += change;
+  if (client.fullscreen) {
+    // One fullscreen window per workspace
+    it->second.hasFullscreen = change > 0;
+  }
+  deltas.push_back({.kind = StateDelta::Kind::WorkspaceChanged, .workspaceId = client.workspaceId});
+}
+
+WorkspaceInfo* HyprlandState::findWorkspaceLocked(std::string_view name) {
+  for (auto& [id, workspace] : workspaces_) {
+    if (workspace.name == name) {
+      return &workspace;
+    }
+  }
+  return nullptr;
+}
+
+MonitorInfo* HyprlandState::focusedMonitorLocked() {
+  for (auto& [name, monitor] : monitors_) {
+    if (monitor.focused) {
+      return &monitor;
+    }
+  }
+  return nullptr;
+}
+
+bool HyprlandState::applyLocked(std::string_view event, std::string_view payload,
+                                Snapshot& fetched, std::vector<StateDelta>& deltas) {
+  using Kind = StateDelta::Kind;
+
+  if (event == "configreloaded" || event.starts_with("monitoradded") ||
+      event.starts_with("monitorremoved")) {
+    return false;
+  }
+
+  if (event == "openwindow") {
+    auto opened = OpenWindowEvent::parse(payload);
+    if (!opened) {
+      return false;
+    }
+    auto client = std::ranges::find(fetched.clients, opened->address, &ClientInfo::address);
+    if (client == fetched.clients.end()) {
+      // Closed already, closewindow follows
+      return true;
+    }
+    if (!workspaces_.contains(client->workspaceId)) {
+      return false;
+    }
+    deltas.push_back({.kind = Kind::ClientAdded, .address = client->address,
+                      .workspaceId = client->workspaceId});
+    countLocked(*client, 1, deltas);
+    clients_[client->address] = std::move(*client);
+  } else if (event == "closewindow") {
+    auto it = clients_.find(std::string(payload));
+    if (it == clients_.end()) {
+      return true;
+    }
+    auto workspaceId = it->second.workspaceId;
+    deltas.push_back(
+        {.kind = Kind::ClientRemoved, .address = it->first, .workspaceId = workspaceId});
+    if (auto ws = workspaces_.find(workspaceId);
+        ws != workspaces_.end() && ws->second.lastWindow == it->first) {
+      ws->second.lastWindow.clear();
+      ws->second.lastWindowTitle.clear();
+    }
+    if (activeWindow_ == it->first) {
+      activeWindow_.clear();
+    }
+    countLocked(it->second, -1, deltas);
+    clients_.erase(it);
+  } else if (event == "movewindowv2") {
+    auto moved = MoveWindowEvent::parse(payload);
+    auto workspaceId = moved ? parseInt(moved->workspaceId) : std::nullopt;
+    if (!workspaceId) {
+      return false;
+    }
+    auto it = clients_.find(std::string(moved->address));
+    if (it == clients_.end() || !workspaces_.contains(*workspaceId)) {
+      return false;
+    }
+    auto& workspace = workspaces_[*workspaceId];
+    countLocked(it->second, -1, deltas);
+    it->second.workspaceId = workspace.id;
+    it->second.workspaceName = workspace.name;
+    if (auto monitor = monitors_.find(workspace.monitor); monitor != monitors_.end()) {
+      it->second.monitor = monitor->second.id;
+    }
+    deltas.push_back(
+        {.kind = Kind::ClientChanged, .address = it->first, .workspaceId = workspace.id});
+    countLocked(it->second, 1, deltas);
+  } else if (event == "windowtitlev2") {
+    auto changed = WindowValueEvent::parse(payload);
+    auto it = changed ? clients_.find(std::string(changed->address)) : clients_.end();
+    if (it == clients_.end()) {
+      return false;
+    }
+    it->second.title = changed->value;
+    if (auto ws = workspaces_.find(it->second.workspaceId);
+        ws != workspaces_.end() && ws->second.lastWindow == it->first) {
+      ws->second.lastWindowTitle = it->second.title;
+    }
+    deltas.push_back({.kind = Kind::ClientChanged,
+                      .address = it->first,
+                      .workspaceId = it->second.workspaceId});
+  } else if (event == "activewindowv2") {
+    activeWindow_ = payload == "," ? "" : std::string(payload);
+    auto it = clients_.find(activeWindow_);
+    if (!activeWindow_.empty() && it == clients_.end()) {
+      return false;
+    }
+    int workspaceId = -1;
+    if (it != clients_.end()) {
+      workspaceId = it->second.workspaceId;
+      if (auto ws = workspaces_.find(workspaceId); ws != workspaces_.end()) {
+        ws->second.lastWindow = it->first;
+        ws->second.lastWindowTitle = it->second.title;
+      }
+    }
+    deltas.push_back(
+        {.kind = Kind::ActiveWindowChanged, .address = activeWindow_, .workspaceId = workspaceId});
+  } else if (event == "changefloatingmode") {
+    auto changed = WindowValueEvent::parse(payload);
+    auto it = changed ? clients_.find(std::string(changed->address)) : clients_.end();
+    if (it == clients_.end()) {
+      return false;
+    }
+    it->second.floating = changed->value == "1";
+    deltas.push_back({.kind = Kind::ClientChanged,
+                      .address = it->first,
+                      .workspaceId = it->second.workspaceId});
+  } else if (event == "fullscreen") {
+    // Reported for the focused window
+    auto it = clients_.find(activeWindow_);
+    if (it == clients_.end()) {
+      return true;
+    }
+    it->second.fullscreen = payload == "1";
+    deltas.push_back({.kind = Kind::ClientChanged,
+                      .address = it->first,
+                      .workspaceId = it->second.workspaceId});
+    if (auto ws = workspaces_.find(it->second.workspaceId);
+        ws != workspaces_.end() && it->second.mapped &&
+        ws->second.hasFullscreen != it->second.fullscreen) {
+      ws->second.hasFullscreen = it->second.fullscreen;
+      deltas.push_back({.kind = Kind::WorkspaceChanged, .workspaceId = ws->first});
+    }
+  } else if (event == "workspacev2") {
+    auto activated = WorkspaceEvent::parse(payload);
+    auto workspaceId = activated ? parseInt(activated->id) : std::nullopt;
+    auto* monitor = focusedMonitorLocked();
+    if (!workspaceId || monitor == nullptr || !workspaces_.contains(*workspaceId)) {
+      return false;
+    }
+    monitor->activeWorkspaceId = *workspaceId;
+    deltas.push_back({.kind = Kind::MonitorChanged,
+                      .workspaceId = *workspaceId,
+                      .monitor = monitor->name});
+  } else if (event == "focusedmonv2") {
+    auto focused = MonitorEvent::parseFocused(payload);
+    auto workspaceId = focused ? parseInt(focused->workspace) : std::nullopt;
+    auto it = focused ? monitors_.find(focused->monitor) : monitors_.end();
+    if (!workspaceId || it == monitors_.end()) {
+      return false;
+    }
+    for (auto& [name, monitor] : monitors_) {
+      monitor.focused = false;
+    }
+    it->second.focused = true;
+    it->second.activeWorkspaceId = *workspaceId;
+    deltas.push_back(
+        {.kind = Kind::MonitorChanged, .workspaceId = *workspaceId, .monitor = it->first});
+  } else if (event == "activespecial") {
+    auto special = MonitorEvent::parseSpecial(payload);
+    auto it = special ? monitors_.find(special->monitor) : monitors_.end();
+    if (it == monitors_.end()) {
+      return false;
+    }
+    auto* workspace =
+        special->workspace.empty() ? nullptr : findWorkspaceLocked(special->workspace);
+    it->second.specialWorkspaceName = special->workspace;
+    it->second.specialWorkspaceId = workspace != nullptr ? workspace->id : 0;
+    deltas.push_back({.kind = Kind::MonitorChanged,
+                      .workspaceId = it->second.specialWorkspaceId,
+                      .monitor = it->first});
+  } else if (event == "createworkspacev2") {
+    auto created = WorkspaceEvent::parse(payload);
+    auto workspaceId = created ? parseInt(created->id) : std::nullopt;
+    if (!workspaceId) {
+      return false;
+    }
+    setWorkspacesLocked(fetched.workspaces);
+    deltas.push_back({.kind = Kind::WorkspaceAdded, .workspaceId = *workspaceId});
+  } else if (event == "destroyworkspacev2") {
+    auto destroyed = WorkspaceEvent::parse(payload);
+    auto workspaceId = destroyed ? parseInt(destroyed->id) : std::nullopt;
+    if (!workspaceId) {
+      return false;
+    }
+    workspaces_.erase(*workspaceId);
+    deltas.push_back({.kind = Kind::WorkspaceRemoved, .workspaceId = *workspaceId});
+  } else if (event == "moveworkspacev2") {
+    auto moved = MoveWorkspaceEvent::parse(payload);
+    auto workspaceId = moved ? parseInt(moved->id) : std::nullopt;
+    if (!workspaceId || !workspaces_.contains(*workspaceId) ||
+        !monitors_.contains(moved->monitor)) {
+      return false;
+    }
+    auto& workspace = workspaces_[*workspaceId];
+    workspace.monitor = moved->monitor;
+    auto monitorId = monitors_.find(moved->monitor)->second.id;
+    for (auto& [address, client] : clients_) {
+      if (client.workspaceId == workspace.id) {
+        client.monitor = monitorId;
+      }
+    }
+    deltas.push_back({.kind = Kind::WorkspaceChanged, .workspaceId = *workspaceId});
+  } else if (event == "renameworkspace") {
+    auto renamed = WorkspaceEvent::parse(payload);
+    auto workspaceId = renamed ? parseInt(renamed->id) : std::nullopt;
+    if (!workspaceId || !workspaces_.contains(*workspaceId)) {
+      return false;
+    }
+    auto& workspace = workspaces_[*workspaceId];
+    workspace.name = renamed->name;
+    for (auto& [address, client] : clients_) {
+      if (client.workspaceId == workspace.id) {
+        client.workspaceName = workspace.name;
+      }
+    }
+    deltas.push_back({.kind = Kind::WorkspaceChanged, .workspaceId = *workspaceId});
+  }
+  return true;
+}
+
+std::optional<ClientInfo> HyprlandState::client(std::string_view address) {
+  std::unique_lock lock(mutex_);
+  waitReadyLocked(lock);
+  if (address.starts_with("0x")) {
+    address.remove_prefix(2);
+  }
+  auto it = clients_.find(std::string(address));
+  if (it == clients_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+std::vector<ClientInfo> HyprlandState::clients() {
+  std::unique_lock lock(mutex_);
+  waitReadyLocked(lock);
+  std::vector<ClientInfo> result;
+  result.reserve(clients_.size());
+  for (const auto& [address, client] : clients_) {
+    result.push_back(client);
+  }
+  return result;
+}
+
+std::vector<ClientInfo> HyprlandState::clientsOnWorkspace(int workspaceId) {
+  std::unique_lock lock(mutex_);
+  waitReadyLocked(lock);
+  std::vector<ClientInfo> result;
+  for (const auto& [address, client] : clients_) {
+    if (client.workspaceId == workspaceId) {
+      result.push_back(client);
+    }
+  }
+  return result;
+}
+
+Json::Value HyprlandState::clientsJson() {
+  Json::Value result(Json::arrayValue);
+  for (const auto& client : clients()) {
+    result.append(client.toJson());
+  }
+  return result;
+}
+
+std::optional<WorkspaceInfo> HyprlandState::workspace(int id) {
+  std::unique_lock lock(mutex_);
+  waitReadyLocked(lock);
+  auto it = workspaces_.find(id);
+  if (it == workspaces_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+std::optional<WorkspaceInfo> HyprlandState::workspaceByName(std::string_view name) {
+  std::unique_lock lock(mutex_);
+  waitReadyLocked(lock);
+  if (auto* workspace = findWorkspaceLocked(name)) {
+    return *workspace;
+  }
+  return std::nullopt;
+}
+
+std::vector<WorkspaceInfo> HyprlandState::workspaces() {
+  std::unique_lock lock(mutex_);
+  waitReadyLocked(lock);
+  std::vector<WorkspaceInfo> result;
+  result.reserve(workspaces_.size());
+  for (const auto& [id, workspace] : workspaces_) {
+    result.push_back(workspace);
+  }
+  return result;
+}
+
+std::optional<WorkspaceInfo> HyprlandState::activeWorkspace() {
+  std::unique_lock lock(mutex_);
+  waitReadyLocked(lock);
+  auto* monitor = focusedMonitorLocked();
+  if (monitor == nullptr) {
+    return std::nullopt;
+  }
+  auto it = workspaces_.find(monitor->activeWorkspaceId);
+  if (it == workspaces_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+std::optional<WorkspaceInfo> HyprlandState::activeWorkspace(std::string_view monitorName) {
+  std::unique_lock lock(mutex_);
+  waitReadyLocked(lock);
+  auto monitor = monitors_.find(monitorName);
+  if (monitor == monitors_.end()) {
+    return std::nullopt;
+  }
+  auto it = workspaces_.find(monitor->second.activeWorkspaceId);
+  if (it == workspaces_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+std::optional<MonitorInfo> HyprlandState::monitor(std::string_view name) {
+  std::unique_lock lock(mutex_);
+  waitReadyLocked(lock);
+  auto it = monitors_.find(name);
+  if (it == monitors_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+std::vector<MonitorInfo> HyprlandState::monitors() {
+  std::unique_lock lock(mutex_);
+  waitReadyLocked(lock);
+  std::vector<MonitorInfo> result;
+  result.reserve(monitors_.size());
+  for (const auto& [name, monitor] : monitors_) {
+    result.push_back(monitor);
+  }
+  return result;
+}
+
+std::string HyprlandState::activeWindow() {
+  std::unique_lock lock(mutex_);
+  waitReadyLocked(lock);
+  return activeWindow_;
+}
+
+}  // namespace waybar::modules::hyprland
@@ -18,19 +18,13 @@ namespace waybar::modules::hyprland {
 std::shared_mutex windowIpcSmtx;
 
 Window::Window(const std::string& id, const Bar& bar, const Json::Value& config)
-    : AAppIconLabel(config, "window", id, "{title}", 0, true), bar_(bar), m_ipc(IPC::inst()) {
-  std::unique_lock<std::shared_mutex> windowIpcUniqueLock(windowIpcSmtx);
-
+    : AAppIconLabel(config, "window", id, "{title}", 0, true), bar_(bar),
+      rewriteRules_(config["rewrite"]),
+      m_ipc(IPC::inst()) {
   separateOutputs_ = config["separate-outputs"].asBool();
 
-  // register for hyprland ipc
-  m_ipc.registerForIPC("activewindow", this);
-  m_ipc.registerForIPC("closewindow", this);
-  m_ipc.registerForIPC("movewindow", this);
-  m_ipc.registerForIPC("changefloatingmode", this);
-  m_ipc.registerForIPC("fullscreen", this);
-
-  windowIpcUniqueLock.unlock();
+  // get the state deltas from hyprland ipc
+  m_ipc.state().addListener(this);
 
   queryActiveWorkspace();
   update();
@@ -38,8 +32,8 @@ Window::Window(const std::string& id, const Bar& bar, const Json::Value& config)
 }
 
 Window::~Window() {
-  std::unique_lock<std::shared_mutex> windowIpcUniqueLock(windowIpcSmtx);
-  m_ipc.unregisterForIPC(this);
+  // waits for a running onStateChanged
+  m_ipc.state().removeListener(this);
 }
 
 auto Window::update() -> void {
@@ -53,12 +47,11 @@ auto Window::update() -> void {
   std::string label_text;
   if (!format_.empty()) {
     label_.show();
-    label_text = waybar::util::rewriteString(
+    label_text = rewriteRules_.rewrite(
         fmt::format(fmt::runtime(format_), fmt::arg("title", windowName),
                     fmt::arg("initialTitle", windowData_.initial_title),
                     fmt::arg("class", windowData_.class_name),
-                    fmt::arg("initialClass", windowData_.initial_class_name)),
-        config_["rewrite"]);
+                    fmt::arg("initialClass", windowData_.initial_class_name)));
     label_.set_markup(label_text);
   } else {
     label_.hide();
@@ -109,69 +102,49 @@ auto Window::update() -> void {
 }
 
 auto Window::getActiveWorkspace() -> Workspace {
-  const auto workspace = IPC::inst().getSocket1JsonReply("activeworkspace");
-
-  if (workspace.isObject()) {
-    return Workspace::parse(workspace);
-  }
-
-  return {};
+  return Workspace::from(IPC::inst().state().activeWorkspace());
 }
 
 auto Window::getActiveWorkspace(const std::string& monitorName) -> Workspace {
-  const auto monitors = IPC::inst().getSocket1JsonReply("monitors");
-  if (monitors.isArray()) {
-    auto monitor = std::ranges::find_if(
-        monitors, [&](Json::Value monitor) { return monitor["name"] == monitorName; });
-    if (monitor == std::end(monitors)) {
-      spdlog::warn("Monitor not found: {}", monitorName);
-      return Workspace{
-          .id = -1,
-          .windows = 0,
-          .last_window = "",
-          .last_window_title = "",
-      };
-    }
-    const int id = (*monitor)["activeWorkspace"]["id"].asInt();
-
-    const auto workspaces = IPC::inst().getSocket1JsonReply("workspaces");
-    if (workspaces.isArray()) {
-      auto workspace = std::ranges::find_if(
-          workspaces, [&](Json::Value workspace) { return workspace["id"] == id; });
-      if (workspace == std::end(workspaces)) {
-        spdlog::warn("No workspace with id {}", id);
-        return Workspace{
-            .id = -1,
-            .windows = 0,
-            .last_window = "",
-            .last_window_title = "",
-        };
-      }
-      return Workspace::parse(*workspace);
+  auto& state = IPC::inst().state();
+  if (!state.monitor(monitorName)) {
+    spdlog::warn("Monitor not found: {}", monitorName);
+    return Workspace{
+        .id = -1,
+        .windows = 0,
+        .last_window = "",
+        .last_window_title = "",
     };
-  };
-
-  return {};
+  }
+  return Workspace::from(state.activeWorkspace(monitorName));
 }
 
-auto Window::Workspace::parse(const Json::Value& value) -> Window::Workspace {
+auto Window::Workspace::from(const std::optional<WorkspaceInfo>& info) -> Window::Workspace {
+  if (!info) {
+    return Workspace{
+        .id = -1,
+        .windows = 0,
+        .last_window = "",
+        .last_window_title = "",
+    };
+  }
   return Workspace{
-      .id = value["id"].asInt(),
-      .windows = value["windows"].asInt(),
-      .last_window = value["lastwindow"].asString(),
-      .last_window_title = value["lastwindowtitle"].asString(),
+      .id = info->id,
+      .windows = info->windows,
+      .last_window = info->lastWindow,
+      .last_window_title = info->lastWindowTitle,
   };
 }
 
-auto Window::WindowData::parse(const Json::Value& value) -> Window::WindowData {
-  return WindowData{.floating = value["floating"].asBool(),
-                    .monitor = value["monitor"].asInt(),
-                    .class_name = value["class"].asString(),
-                    .initial_class_name = value["initialClass"].asString(),
-                    .title = value["title"].asString(),
-                    .initial_title = value["initialTitle"].asString(),
-                    .fullscreen = value["fullscreen"].asBool(),
-                    .grouped = !value["grouped"].empty()};
+auto Window::WindowData::from(const ClientInfo& client) -> Window::WindowData {
+  return WindowData{.floating = client.floating,
+                    .monitor = client.monitor,
+                    .class_name = client.className,
+                    .initial_class_name = client.initialClassName,
+                    .title = client.title,
+                    .initial_title = client.initialTitle,
+                    .fullscreen = client.fullscreen,
+                    .grouped = client.grouped};
 }
 
 void Window::queryActiveWorkspace() {
@@ -185,44 +158,39 @@ void Window::queryActiveWorkspace() {
 
   focused_ = true;
   if (workspace_.windows > 0) {
-    const auto clients = m_ipc.getSocket1JsonReply("clients");
-    if (clients.isArray()) {
-      auto activeWindow = std::ranges::find_if(
-          clients, [&](Json::Value window) { return window["address"] == workspace_.last_window; });
-
-      if (activeWindow == std::end(clients)) {
-        focused_ = false;
-        return;
-      }
-
-      windowData_ = WindowData::parse(*activeWindow);
-      updateAppIconName(windowData_.class_name, windowData_.initial_class_name);
-      std::vector<Json::Value> workspaceWindows;
-      std::ranges::copy_if(clients, std::back_inserter(workspaceWindows), [&](Json::Value window) {
-        return window["workspace"]["id"] == workspace_.id && window["mapped"].asBool();
-      });
-      swallowing_ = std::ranges::any_of(workspaceWindows, [&](Json::Value window) {
-        return !window["swallowing"].isNull() && window["swallowing"].asString() != "0x0";
-      });
-      std::vector<Json::Value> visibleWindows;
-      std::ranges::copy_if(workspaceWindows, std::back_inserter(visibleWindows),
-                           [&](Json::Value window) { return !window["hidden"].asBool(); });
-      solo_ = 1 == std::count_if(visibleWindows.begin(), visibleWindows.end(),
-                                 [&](Json::Value window) { return !window["floating"].asBool(); });
-      allFloating_ = std::ranges::all_of(
-          visibleWindows, [&](Json::Value window) { return window["floating"].asBool(); });
-      fullscreen_ = windowData_.fullscreen;
-
-      // Fullscreen windows look like they are solo
-      if (fullscreen_) {
-        solo_ = true;
-      }
-
-      if (solo_) {
-        soloClass_ = windowData_.class_name;
-      } else {
-        soloClass_ = "";
-      }
+    auto& state = m_ipc.state();
+    auto activeWindow = state.client(workspace_.last_window);
+    if (!activeWindow) {
+      focused_ = false;
+      return;
+    }
+
+    windowData_ = WindowData::from(*activeWindow);
+    updateAppIconName(windowData_.class_name, windowData_.initial_class_name);
+    std::vector<ClientInfo> workspaceWindows;
+    std::ranges::copy_if(state.clientsOnWorkspace(workspace_.id),
+                         std::back_inserter(workspaceWindows),
+                         [](const ClientInfo& window) { return window.mapped; });
+    swallowing_ = std::ranges::any_of(workspaceWindows,
+                                      [](const ClientInfo& window) { return window.swallowing; });
+    std::vector<ClientInfo> visibleWindows;
+    std::ranges::copy_if(workspaceWindows, std::back_inserter(visibleWindows),
+                         [](const ClientInfo& window) { return !window.hidden; });
+    solo_ = 1 == std::ranges::count_if(visibleWindows,
+                                       [](const ClientInfo& window) { return !window.floating; });
+    allFloating_ = std::ranges::all_of(visibleWindows,
+                                       [](const ClientInfo& window) { return window.floating; });
+    fullscreen_ = windowData_.fullscreen;
+
+    // Fullscreen windows look like they are solo
+    if (fullscreen_) {
+      solo_ = true;
+    }
+
+    if (solo_) {
+      soloClass_ = windowData_.class_name;
+    } else {
+      soloClass_ = "";
     }
   } else {
     focused_ = false;
@@ -235,7 +203,7 @@ void Window::queryActiveWorkspace() {
   }
 }
 
-void Window::onEvent(const std::string& ev) {
+void Window::onStateChanged(const std::vector<StateDelta>& deltas) {
   queryActiveWorkspace();
 
   dp.emit();
@@ -21,17 +21,12 @@ WindowCount::WindowCount(const std::string& id, const Bar& bar, const Json::Valu
   update();
   dp.emit();
 
-  // register for hyprland ipc
-  m_ipc.registerForIPC("fullscreen", this);
-  m_ipc.registerForIPC("workspace", this);
-  m_ipc.registerForIPC("focusedmon", this);
-  m_ipc.registerForIPC("openwindow", this);
-  m_ipc.registerForIPC("closewindow", this);
-  m_ipc.registerForIPC("movewindow", this);
+  // get the state deltas from hyprland ipc
+  m_ipc.state().addListener(this);
 }
 
 WindowCount::~WindowCount() {
-  m_ipc.unregisterForIPC(this);
+  m_ipc.state().removeListener(this);
   // wait for possible event handler to finish
   std::lock_guard<std::mutex> lg(mutex_);
 }
@@ -64,54 +59,35 @@ auto WindowCount::update() -> void {
 }
 
 auto WindowCount::getActiveWorkspace() -> Workspace {
-  const auto workspace = m_ipc.getSocket1JsonReply("activeworkspace");
-
-  if (workspace.isObject()) {
-    return Workspace::parse(workspace);
-  }
-
-  return {};
+  return Workspace::from(m_ipc.state().activeWorkspace());
 }
 
 auto WindowCount::getActiveWorkspace(const std::string& monitorName) -> Workspace {
-  const auto monitors = m_ipc.getSocket1JsonReply("monitors");
-  if (monitors.isArray()) {
-    auto monitor = std::ranges::find_if(
-        monitors, [&](Json::Value monitor) { return monitor["name"] == monitorName; });
-    if (monitor == std::end(monitors)) {
-      spdlog::warn("Monitor not found: {}", monitorName);
-      return Workspace{
-          .id = -1,
-          .windows = 0,
-          .hasfullscreen = false,
-      };
-    }
-    const int id = (*monitor)["activeWorkspace"]["id"].asInt();
-
-    const auto workspaces = m_ipc.getSocket1JsonReply("workspaces");
-    if (workspaces.isArray()) {
-      auto workspace = std::ranges::find_if(
-          workspaces, [&](Json::Value workspace) { return workspace["id"] == id; });
-      if (workspace == std::end(workspaces)) {
-        spdlog::warn("No workspace with id {}", id);
-        return Workspace{
-            .id = -1,
-            .windows = 0,
-            .hasfullscreen = false,
-        };
-      }
-      return Workspace::parse(*workspace);
+  auto& state = m_ipc.state();
+  if (!state.monitor(monitorName)) {
+    spdlog::warn("Monitor not found: {}", monitorName);
+    return Workspace{
+        .id = -1,
+        .windows = 0,
+        .hasfullscreen = false,
     };
-  };
-
-  return {};
+  }
+  return Workspace::from(state.activeWorkspace(monitorName));
 }
 
-auto WindowCount::Workspace::parse(const Json::Value& value) -> WindowCount::Workspace {
+auto WindowCount::Workspace::from(const std::optional<WorkspaceInfo>& info)
+    -> WindowCount::Workspace {
+  if (!info) {
+    return Workspace{
+        .id = -1,
+        .windows = 0,
+        .hasfullscreen = false,
+    };
+  }
   return Workspace{
-      .id = value["id"].asInt(),
-      .windows = value["windows"].asInt(),
-      .hasfullscreen = value["hasfullscreen"].asBool(),
+      .id = info->id,
+      .windows = info->windows,
+      .hasfullscreen = info->hasFullscreen,
   };
 }
 
@@ -125,7 +101,14 @@ void WindowCount::queryActiveWorkspace() {
   }
 }
 
-void WindowCount::onEvent(const std::string& ev) {
+void WindowCount::onStateChanged(const std::vector<StateDelta>& deltas) {
+  bool relevant = std::ranges::any_of(deltas, [](const StateDelta& delta) {
+    return delta.kind != StateDelta::Kind::ActiveWindowChanged &&
+           delta.kind != StateDelta::Kind::ClientChanged;
+  });
+  if (!relevant) {
+    return;
+  }
   queryActiveWorkspace();
   dp.emit();
 }
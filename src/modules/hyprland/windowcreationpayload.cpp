@@ -39,6 +39,15 @@ WindowCreationPayload::WindowCreationPayload(std::string workspace_name,
   clearWorkspaceName();
 }
 
+WindowCreationPayload::WindowCreationPayload(OpenWindowEvent const &event, bool is_active)
+    : m_window(std::make_pair(std::string(event.windowClass), std::string(event.title))),
+      m_windowAddress(event.address),
+      m_workspaceName(event.workspaceName),
+      m_isActive(is_active) {
+  clearAddr();
+  clearWorkspaceName();
+}
+
 void WindowCreationPayload::clearAddr() {
   // substr(2, ...) is necessary because Hyprland's JSON follows this format:
   // 0x{ADDR}
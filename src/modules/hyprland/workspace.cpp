@@ -68,28 +68,28 @@ std::optional<WindowRepr> Workspace::closeWindow(WindowAddress const &addr) {
 
 bool Workspace::handleClicked(GdkEventButton *bt) const {
   if (bt->type == GDK_BUTTON_PRESS) {
-    try {
-      if (id() > 0) {  // normal
-        if (m_workspaceManager.moveToMonitor()) {
-          m_ipc.getSocket1Reply("dispatch focusworkspaceoncurrentmonitor " + std::to_string(id()));
-        } else {
-          m_ipc.getSocket1Reply("dispatch workspace " + std::to_string(id()));
-        }
-      } else if (!isSpecial()) {  // named (this includes persistent)
-        if (m_workspaceManager.moveToMonitor()) {
-          m_ipc.getSocket1Reply("dispatch focusworkspaceoncurrentmonitor name:" + name());
-        } else {
-          m_ipc.getSocket1Reply("dispatch workspace name:" + name());
-        }
-      } else if (id() != -99) {  // named special
-        m_ipc.getSocket1Reply("dispatch togglespecialworkspace " + name());
-      } else {  // special
-        m_ipc.getSocket1Reply("dispatch togglespecialworkspace");
+    std::string request;
+    if (id() > 0) {  // normal
+      if (m_workspaceManager.moveToMonitor()) {
+        request = "dispatch focusworkspaceoncurrentmonitor " + std::to_string(id());
+      } else {
+        request = "dispatch workspace " + std::to_string(id());
+      }
+    } else if (!isSpecial()) {  // named (this includes persistent)
+      if (m_workspaceManager.moveToMonitor()) {
+        request = "dispatch focusworkspaceoncurrentmonitor name:" + name();
+      } else {
+        request = "dispatch workspace name:" + name();
       }
-      return true;
-    } catch (const std::exception &e) {
-      spdlog::error("Failed to dispatch workspace: {}", e.what());
+    } else if (id() != -99) {  // named special
+      request = "dispatch togglespecialworkspace " + name();
+    } else {  // special
+      request = "dispatch togglespecialworkspace";
     }
+    // Clicking faster than Hyprland switches only sends the last switch. Toggles are not
+    // coalesced: dropping one of two would leave the special workspace in the other state.
+    m_ipc.queueSocket1Command(std::move(request), isSpecial() ? "" : "workspace");
+    return true;
   }
   return false;
 }
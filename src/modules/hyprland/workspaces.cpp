@@ -40,7 +40,8 @@ Workspaces::~Workspaces() {
 }
 
 void Workspaces::init() {
-  m_activeWorkspaceId = m_ipc.getSocket1JsonReply("activeworkspace")["id"].asInt();
+  auto activeWorkspace = m_ipc.state().activeWorkspace();
+  m_activeWorkspaceId = activeWorkspace ? activeWorkspace->id : 0;
 
   initializeWorkspaces();
   dp.emit();
@@ -99,20 +100,32 @@ void Workspaces::createWorkspace(Json::Value const &workspace_data,
   }
 
   // create new workspace
-  m_workspaces.emplace_back(std::make_unique<Workspace>(workspace_data, *this, clients_data));
-  Gtk::Button &newWorkspaceButton = m_workspaces.back()->button();
+  auto newWorkspace = std::make_unique<Workspace>(workspace_data, *this, clients_data);
+  Gtk::Button &newWorkspaceButton = newWorkspace->button();
   m_box.pack_start(newWorkspaceButton, false, false);
-  sortWorkspaces();
+  insertWorkspace(std::move(newWorkspace));
   newWorkspaceButton.show_all();
 }
 
+void Workspaces::queueWorkspace(Json::Value const &workspace_data,
+                                Json::Value const &clients_data) {
+  // Hand the UI thread the clients of this workspace only, not the whole client list
+  Json::Value clients(Json::arrayValue);
+  auto id = workspace_data["id"].asInt();
+  for (const auto &client : clients_data) {
+    if (client["workspace"]["id"].asInt() == id) {
+      clients.append(client);
+    }
+  }
+  m_workspacesToCreate.emplace_back(workspace_data, std::move(clients));
+}
+
 void Workspaces::createWorkspacesToCreate() {
   for (const auto &[workspaceData, clientsData] : m_workspacesToCreate) {
     createWorkspace(workspaceData, clientsData);
   }
   if (!m_workspacesToCreate.empty()) {
     updateWindowCount();
-    sortWorkspaces();
   }
   m_workspacesToCreate.clear();
 }
@@ -128,9 +141,13 @@ void Workspaces::doUpdate() {
 
   removeWorkspacesToRemove();
   createWorkspacesToCreate();
+  repositionRenamedWorkspaces();
   updateWorkspaceStates();
   updateWindowCount();
-  sortWorkspaces();
+  if (m_sortBy == SortMethod::SPECIAL_CENTERED) {
+    // depends on the visibility of the buttons
+    sortWorkspaces();
+  }
 
   bool anyWindowCreated = updateWindowsToCreate();
 
@@ -162,16 +179,10 @@ std::string Workspaces::getRewrite(std::string window_class, std::string window_
 
 std::vector<int> Workspaces::getVisibleWorkspaces() {
   std::vector<int> visibleWorkspaces;
-  auto monitors = IPC::inst().getSocket1JsonReply("monitors");
-  for (const auto &monitor : monitors) {
-    auto ws = monitor["activeWorkspace"];
-    if (ws.isObject() && ws["id"].isInt()) {
-      visibleWorkspaces.push_back(ws["id"].asInt());
-    }
-    auto sws = monitor["specialWorkspace"];
-    auto name = sws["name"].asString();
-    if (sws.isObject() && sws["id"].isInt() && !name.empty()) {
-      visibleWorkspaces.push_back(sws["id"].asInt());
+  for (const auto &monitor : IPC::inst().state().monitors()) {
+    visibleWorkspaces.push_back(monitor.activeWorkspaceId);
+    if (!monitor.specialWorkspaceName.empty()) {
+      visibleWorkspaces.push_back(monitor.specialWorkspaceId);
     }
   }
   return visibleWorkspaces;
@@ -187,14 +198,14 @@ void Workspaces::initializeWorkspaces() {
 
   // get all current workspaces
   auto const workspacesJson = m_ipc.getSocket1JsonReply("workspaces");
-  auto const clientsJson = m_ipc.getSocket1JsonReply("clients");
+  auto const clientsJson = m_ipc.state().clientsJson();
 
   for (Json::Value workspaceJson : workspacesJson) {
     std::string workspaceName = workspaceJson["name"].asString();
     if ((allOutputs() || m_bar.output->name == workspaceJson["monitor"].asString()) &&
         (!workspaceName.starts_with("special") || showSpecial()) &&
         !isWorkspaceIgnored(workspaceName)) {
-      m_workspacesToCreate.emplace_back(workspaceJson, clientsJson);
+      queueWorkspace(workspaceJson, clientsJson);
     } else {
       extendOrphans(workspaceJson["id"].asInt(), clientsJson);
     }
@@ -209,12 +220,12 @@ void Workspaces::initializeWorkspaces() {
   loadPersistentWorkspacesFromWorkspaceRules(clientsJson);
 }
 
-bool isDoubleSpecial(std::string const &workspace_name) {
+bool isDoubleSpecial(std::string_view workspace_name) {
   // Hyprland's IPC sometimes reports the creation of workspaces strangely named
   // `special:special:<some_name>`. This function checks for that and is used
   // to avoid creating (and then removing) such workspaces.
   // See hyprwm/Hyprland#3424 for more info.
-  return workspace_name.find("special:special:") != std::string::npos;
+  return workspace_name.find("special:special:") != std::string_view::npos;
 }
 
 bool Workspaces::isWorkspaceIgnored(std::string const &name) {
@@ -277,7 +288,7 @@ void Workspaces::loadPersistentWorkspacesFromConfig(Json::Value const &clientsJs
   for (auto const &workspace : persistentWorkspacesToCreate) {
     auto workspaceData = createMonitorWorkspaceData(workspace, m_bar.output->name);
     workspaceData["persistent-config"] = true;
-    m_workspacesToCreate.emplace_back(workspaceData, clientsJson);
+    queueWorkspace(workspaceData, clientsJson);
   }
 }
 
@@ -309,7 +320,7 @@ void Workspaces::loadPersistentWorkspacesFromWorkspaceRules(const Json::Value &c
       // => persistent workspace should be shown on this monitor
       auto workspaceData = createMonitorWorkspaceData(workspace, m_bar.output->name);
       workspaceData["persistent-rule"] = true;
-      m_workspacesToCreate.emplace_back(workspaceData, clientsJson);
+      queueWorkspace(workspaceData, clientsJson);
     } else {
       // This can be any workspace selector.
       m_workspacesToRemove.emplace_back(workspace);
@@ -319,8 +330,7 @@ void Workspaces::loadPersistentWorkspacesFromWorkspaceRules(const Json::Value &c
 
 void Workspaces::onEvent(const std::string &ev) {
   std::lock_guard<std::mutex> lock(m_mutex);
-  std::string eventName(begin(ev), begin(ev) + ev.find_first_of('>'));
-  std::string payload = ev.substr(eventName.size() + 2);
+  const auto [eventName, payload] = Event::parse(ev);
 
   if (eventName == "workspacev2") {
     onWorkspaceActivated(payload);
@@ -337,17 +347,17 @@ void Workspaces::onEvent(const std::string &ev) {
   } else if (eventName == "openwindow") {
     onWindowOpened(payload);
   } else if (eventName == "closewindow") {
-    onWindowClosed(payload);
+    onWindowClosed(std::string(payload));
   } else if (eventName == "movewindowv2") {
     onWindowMoved(payload);
   } else if (eventName == "urgent") {
-    setUrgentWorkspace(payload);
+    setUrgentWorkspace(std::string(payload));
   } else if (eventName == "renameworkspace") {
     onWorkspaceRenamed(payload);
   } else if (eventName == "windowtitlev2") {
     onWindowTitleEvent(payload);
   } else if (eventName == "activewindowv2") {
-    onActiveWindowChanged(payload);
+    onActiveWindowChanged(std::string(payload));
   } else if (eventName == "configreloaded") {
     onConfigReloaded();
   }
@@ -355,32 +365,36 @@ void Workspaces::onEvent(const std::string &ev) {
   dp.emit();
 }
 
-void Workspaces::onWorkspaceActivated(std::string const &payload) {
-  const auto [workspaceIdStr, workspaceName] = splitDoublePayload(payload);
-  const auto workspaceId = parseWorkspaceId(workspaceIdStr);
+void Workspaces::onWorkspaceActivated(std::string_view payload) {
+  const auto activated = WorkspaceEvent::parse(payload);
+  const auto workspaceId =
+      activated ? parseWorkspaceId(std::string(activated->id)) : std::nullopt;
   if (workspaceId.has_value()) {
     m_activeWorkspaceId = *workspaceId;
   }
 }
 
-void Workspaces::onSpecialWorkspaceActivated(std::string const &payload) {
-  std::string name(begin(payload), begin(payload) + payload.find_first_of(','));
-  m_activeSpecialWorkspaceName = (!name.starts_with("special:") ? name : name.substr(8));
+void Workspaces::onSpecialWorkspaceActivated(std::string_view payload) {
+  const auto special = MonitorEvent::parseSpecial(payload);
+  std::string_view name = special ? special->workspace : payload;
+  if (name.starts_with("special:")) {
+    name.remove_prefix(8);
+  }
+  m_activeSpecialWorkspaceName = name;
 }
 
-void Workspaces::onWorkspaceDestroyed(std::string const &payload) {
-  const auto [workspaceId, workspaceName] = splitDoublePayload(payload);
-  if (!isDoubleSpecial(workspaceName)) {
-    m_workspacesToRemove.push_back(workspaceId);
+void Workspaces::onWorkspaceDestroyed(std::string_view payload) {
+  const auto destroyed = WorkspaceEvent::parse(payload);
+  if (destroyed && !isDoubleSpecial(destroyed->name)) {
+    m_workspacesToRemove.emplace_back(destroyed->id);
   }
 }
 
-void Workspaces::onWorkspaceCreated(std::string const &payload, Json::Value const &clientsData) {
+void Workspaces::onWorkspaceCreated(std::string_view payload, Json::Value const &clientsData) {
   spdlog::debug("Workspace created: {}", payload);
 
-  const auto [workspaceIdStr, _] = splitDoublePayload(payload);
-
-  const auto workspaceId = parseWorkspaceId(workspaceIdStr);
+  const auto created = WorkspaceEvent::parse(payload);
+  const auto workspaceId = created ? parseWorkspaceId(std::string(created->id)) : std::nullopt;
   if (!workspaceId.has_value()) {
     return;
   }
@@ -412,7 +426,7 @@ void Workspaces::onWorkspaceCreated(std::string const &payload, Json::Value cons
           }
         }
 
-        m_workspacesToCreate.emplace_back(workspaceJson, clientsData);
+        queueWorkspace(workspaceJson, clientsData);
         break;
       }
     } else {
@@ -421,84 +435,77 @@ void Workspaces::onWorkspaceCreated(std::string const &payload, Json::Value cons
   }
 }
 
-void Workspaces::onWorkspaceMoved(std::string const &payload) {
+void Workspaces::onWorkspaceMoved(std::string_view payload) {
   spdlog::debug("Workspace moved: {}", payload);
 
   // Update active workspace
-  m_activeWorkspaceId = (m_ipc.getSocket1JsonReply("activeworkspace"))["id"].asInt();
+  if (auto activeWorkspace = m_ipc.state().activeWorkspace()) {
+    m_activeWorkspaceId = activeWorkspace->id;
+  }
 
   if (allOutputs()) return;
 
-  const auto [workspaceIdStr, workspaceName, monitorName] = splitTriplePayload(payload);
+  const auto moved = MoveWorkspaceEvent::parse(payload);
+  if (!moved) {
+    return;
+  }
 
-  const auto subPayload = makePayload(workspaceIdStr, workspaceName);
+  const auto subPayload = makePayload(moved->id, moved->name);
 
-  if (m_bar.output->name == monitorName) {
-    Json::Value clientsData = m_ipc.getSocket1JsonReply("clients");
-    onWorkspaceCreated(subPayload, clientsData);
+  if (m_bar.output->name == moved->monitor) {
+    onWorkspaceCreated(subPayload, m_ipc.state().clientsJson());
   } else {
     spdlog::debug("Removing workspace because it was moved to another monitor: {}", subPayload);
     onWorkspaceDestroyed(subPayload);
   }
 }
 
-void Workspaces::onWorkspaceRenamed(std::string const &payload) {
+void Workspaces::onWorkspaceRenamed(std::string_view payload) {
   spdlog::debug("Workspace renamed: {}", payload);
-  const auto [workspaceIdStr, newName] = splitDoublePayload(payload);
-
-  const auto workspaceId = parseWorkspaceId(workspaceIdStr);
+  const auto renamed = WorkspaceEvent::parse(payload);
+  const auto workspaceId = renamed ? parseWorkspaceId(std::string(renamed->id)) : std::nullopt;
   if (!workspaceId.has_value()) {
     return;
   }
 
   for (auto &workspace : m_workspaces) {
     if (workspace->id() == *workspaceId) {
-      workspace->setName(newName);
+      workspace->setName(std::string(renamed->name));
+      // the name may be the sort key, the button is moved in doUpdate
+      m_workspacesToReposition.push_back(*workspaceId);
       break;
     }
   }
-  sortWorkspaces();
 }
 
-void Workspaces::onMonitorFocused(std::string const &payload) {
+void Workspaces::onMonitorFocused(std::string_view payload) {
   spdlog::trace("Monitor focused: {}", payload);
 
-  const auto [monitorName, workspaceIdStr] = splitDoublePayload(payload);
-
-  const auto workspaceId = parseWorkspaceId(workspaceIdStr);
+  const auto focused = MonitorEvent::parseFocused(payload);
+  const auto workspaceId =
+      focused ? parseWorkspaceId(std::string(focused->workspace)) : std::nullopt;
   if (!workspaceId.has_value()) {
     return;
   }
 
   m_activeWorkspaceId = *workspaceId;
 
-  for (Json::Value &monitor : m_ipc.getSocket1JsonReply("monitors")) {
-    if (monitor["name"].asString() == monitorName) {
-      const auto name = monitor["specialWorkspace"]["name"].asString();
-      m_activeSpecialWorkspaceName = !name.starts_with("special:") ? name : name.substr(8);
-    }
+  if (auto monitor = m_ipc.state().monitor(focused->monitor)) {
+    const auto &name = monitor->specialWorkspaceName;
+    m_activeSpecialWorkspaceName = !name.starts_with("special:") ? name : name.substr(8);
   }
 }
 
-void Workspaces::onWindowOpened(std::string const &payload) {
+void Workspaces::onWindowOpened(std::string_view payload) {
   spdlog::trace("Window opened: {}", payload);
   updateWindowCount();
-  size_t lastCommaIdx = 0;
-  size_t nextCommaIdx = payload.find(',');
-  std::string windowAddress = payload.substr(lastCommaIdx, nextCommaIdx - lastCommaIdx);
-
-  lastCommaIdx = nextCommaIdx;
-  nextCommaIdx = payload.find(',', nextCommaIdx + 1);
-  std::string workspaceName = payload.substr(lastCommaIdx + 1, nextCommaIdx - lastCommaIdx - 1);
-
-  lastCommaIdx = nextCommaIdx;
-  nextCommaIdx = payload.find(',', nextCommaIdx + 1);
-  std::string windowClass = payload.substr(lastCommaIdx + 1, nextCommaIdx - lastCommaIdx - 1);
-
-  std::string windowTitle = payload.substr(nextCommaIdx + 1, payload.length() - nextCommaIdx);
+  const auto opened = OpenWindowEvent::parse(payload);
+  if (!opened) {
+    return;
+  }
 
-  bool isActive = m_currentActiveWindowAddress == windowAddress;
-  m_windowsToCreate.emplace_back(workspaceName, windowAddress, windowClass, windowTitle, isActive);
+  bool isActive = m_currentActiveWindowAddress == opened->address;
+  m_windowsToCreate.emplace_back(*opened, isActive);
 }
 
 void Workspaces::onWindowClosed(std::string const &addr) {
@@ -512,10 +519,15 @@ void Workspaces::onWindowClosed(std::string const &addr) {
   }
 }
 
-void Workspaces::onWindowMoved(std::string const &payload) {
+void Workspaces::onWindowMoved(std::string_view payload) {
   spdlog::trace("Window moved: {}", payload);
   updateWindowCount();
-  auto [windowAddress, _, workspaceName] = splitTriplePayload(payload);
+  const auto moved = MoveWindowEvent::parse(payload);
+  if (!moved) {
+    return;
+  }
+  const WindowAddress windowAddress(moved->address);
+  std::string workspaceName(moved->workspaceName);
 
   WindowRepr windowRepr;
 
@@ -548,11 +560,15 @@ void Workspaces::onWindowMoved(std::string const &payload) {
   }
 }
 
-void Workspaces::onWindowTitleEvent(std::string const &payload) {
+void Workspaces::onWindowTitleEvent(std::string_view payload) {
   spdlog::trace("Window title changed: {}", payload);
   std::optional<std::function<void(WindowCreationPayload)>> inserter;
 
-  const auto [windowAddress, _] = splitDoublePayload(payload);
+  const auto changed = WindowValueEvent::parse(payload);
+  if (!changed) {
+    return;
+  }
+  const auto windowAddress = changed->address;
 
   // If the window was an orphan, rename it at the orphan's vector
   if (m_orphanWindowMap.contains(windowAddress)) {
@@ -582,15 +598,8 @@ void Workspaces::onWindowTitleEvent(std::string const &payload) {
   }
 
   if (inserter.has_value()) {
-    Json::Value clientsData = m_ipc.getSocket1JsonReply("clients");
-    std::string jsonWindowAddress = fmt::format("0x{}", windowAddress);
-
-    auto client = std::ranges::find_if(clientsData, [jsonWindowAddress](auto &client) {
-      return client["address"].asString() == jsonWindowAddress;
-    });
-
-    if (client != clientsData.end() && !client->empty()) {
-      (*inserter)({*client});
+    if (auto client = m_ipc.state().client(windowAddress)) {
+      (*inserter)({client->toJson()});
     }
   }
 }
@@ -873,14 +882,11 @@ void Workspaces::removeWorkspace(std::string const &workspaceString) {
 void Workspaces::setCurrentMonitorId() {
   // get monitor ID from name (used by persistent workspaces)
   m_monitorId = 0;
-  auto monitors = m_ipc.getSocket1JsonReply("monitors");
-  auto currentMonitor = std::ranges::find_if(monitors, [this](const Json::Value &m) {
-    return m["name"].asString() == m_bar.output->name;
-  });
-  if (currentMonitor == monitors.end()) {
+  auto currentMonitor = m_ipc.state().monitor(m_bar.output->name);
+  if (!currentMonitor) {
     spdlog::error("Monitor '{}' does not have an ID? Using 0", m_bar.output->name);
   } else {
-    m_monitorId = (*currentMonitor)["id"].asInt();
+    m_monitorId = currentMonitor->id;
     spdlog::trace("Current monitor ID: {}", m_monitorId);
   }
 }
@@ -919,64 +925,98 @@ void Workspaces::sortSpecialCentered() {
                       std::make_move_iterator(hiddenWorkspaces.end()));
 }
 
-void Workspaces::sortWorkspaces() {
-  std::ranges::sort(  //
-      m_workspaces, [&](std::unique_ptr<Workspace> &a, std::unique_ptr<Workspace> &b) {
-        // Helper comparisons
-        auto isIdLess = a->id() < b->id();
-        auto isNameLess = a->name() < b->name();
-
-        switch (m_sortBy) {
-          case SortMethod::ID:
-            return isIdLess;
-          case SortMethod::NAME:
-            return isNameLess;
-          case SortMethod::NUMBER:
-            try {
-              return std::stoi(a->name()) < std::stoi(b->name());
-            } catch (const std::invalid_argument &) {
-              // Handle the exception if necessary.
-              break;
-            }
-          case SortMethod::DEFAULT:
-          default:
-            // Handle the default case here.
-            // normal -> named persistent -> named -> special -> named special
-
-            // both normal (includes numbered persistent) => sort by ID
-            if (a->id() > 0 && b->id() > 0) {
-              return isIdLess;
-            }
-
-            // one normal, one special => normal first
-            if ((a->isSpecial()) ^ (b->isSpecial())) {
-              return b->isSpecial();
-            }
-
-            // only one normal, one named
-            if ((a->id() > 0) ^ (b->id() > 0)) {
-              return a->id() > 0;
-            }
-
-            // both special
-            if (a->isSpecial() && b->isSpecial()) {
-              // if one is -99 => put it last
-              if (a->id() == -99 || b->id() == -99) {
-                return b->id() == -99;
-              }
-              // both are 0 (not yet named persistents) / named specials
-              // (-98 <= ID <= -1)
-              return isNameLess;
-            }
-
-            // sort non-special named workspaces by name (ID <= -1377)
-            return isNameLess;
-            break;
+bool Workspaces::isWorkspaceBefore(Workspace const &a, Workspace const &b) const {
+  // Helper comparisons
+  auto isIdLess = a.id() < b.id();
+  auto isNameLess = a.name() < b.name();
+
+  switch (m_sortBy) {
+    case SortMethod::ID:
+      return isIdLess;
+    case SortMethod::NAME:
+      return isNameLess;
+    case SortMethod::NUMBER:
+      try {
+        return std::stoi(a.name()) < std::stoi(b.name());
+      } catch (const std::invalid_argument &) {
+        // Handle the exception if necessary.
+        break;
+      }
+    case SortMethod::DEFAULT:
+    default:
+      // Handle the default case here.
+      // normal -> named persistent -> named -> special -> named special
+
+      // both normal (includes numbered persistent) => sort by ID
+      if (a.id() > 0 && b.id() > 0) {
+        return isIdLess;
+      }
+
+      // one normal, one special => normal first
+      if ((a.isSpecial()) ^ (b.isSpecial())) {
+        return b.isSpecial();
+      }
+
+      // only one normal, one named
+      if ((a.id() > 0) ^ (b.id() > 0)) {
+        return a.id() > 0;
+      }
+
+      // both special
+      if (a.isSpecial() && b.isSpecial()) {
+        // if one is -99 => put it last
+        if (a.id() == -99 || b.id() == -99) {
+          return b.id() == -99;
         }
+        // both are 0 (not yet named persistents) / named specials
+        // (-98 <= ID <= -1)
+        return isNameLess;
+      }
+
+      // sort non-special named workspaces by name (ID <= -1377)
+      return isNameLess;
+      break;
+  }
+
+  // Return a default value if none of the cases match.
+  return isNameLess;  // You can adjust this to your specific needs.
+}
+
+void Workspaces::insertWorkspace(std::unique_ptr<Workspace> workspace) {
+  if (m_sortBy == SortMethod::SPECIAL_CENTERED) {
+    m_workspaces.push_back(std::move(workspace));
+    sortWorkspaces();
+    return;
+  }
+
+  // m_workspaces is kept sorted, only the new button has to move
+  auto position = std::upper_bound(m_workspaces.begin(), m_workspaces.end(), workspace,
+                                   [this](auto const &a, auto const &b) {
+                                     return isWorkspaceBefore(*a, *b);
+                                   });
+  auto index = position - m_workspaces.begin();
+  auto &inserted = *m_workspaces.insert(position, std::move(workspace));
+  m_box.reorder_child(inserted->button(), index);
+}
 
-        // Return a default value if none of the cases match.
-        return isNameLess;  // You can adjust this to your specific needs.
-      });
+void Workspaces::repositionRenamedWorkspaces() {
+  for (int workspaceId : m_workspacesToReposition) {
+    auto workspace = std::ranges::find_if(
+        m_workspaces, [&](std::unique_ptr<Workspace> const &w) { return w->id() == workspaceId; });
+    if (workspace != m_workspaces.end()) {
+      auto renamed = std::move(*workspace);
+      m_workspaces.erase(workspace);
+      insertWorkspace(std::move(renamed));
+    }
+  }
+  m_workspacesToReposition.clear();
+}
+
+void Workspaces::sortWorkspaces() {
+  std::ranges::stable_sort(m_workspaces,
+                           [this](std::unique_ptr<Workspace> &a, std::unique_ptr<Workspace> &b) {
+                             return isWorkspaceBefore(*a, *b);
+                           });
   if (m_sortBy == SortMethod::SPECIAL_CENTERED) {
     this->sortSpecialCentered();
   }
@@ -987,15 +1027,8 @@ void Workspaces::sortWorkspaces() {
 }
 
 void Workspaces::setUrgentWorkspace(std::string const &windowaddress) {
-  const Json::Value clientsJson = m_ipc.getSocket1JsonReply("clients");
-  int workspaceId = -1;
-
-  for (Json::Value clientJson : clientsJson) {
-    if (clientJson["address"].asString().ends_with(windowaddress)) {
-      workspaceId = clientJson["workspace"]["id"].asInt();
-      break;
-    }
-  }
+  auto client = m_ipc.state().client(windowaddress);
+  int workspaceId = client ? client->workspaceId : -1;
 
   auto workspace = std::ranges::find_if(m_workspaces, [workspaceId](std::unique_ptr<Workspace> &x) {
     return x->id() == workspaceId;
@@ -1011,21 +1044,13 @@ auto Workspaces::update() -> void {
 }
 
 void Workspaces::updateWindowCount() {
-  const Json::Value workspacesJson = m_ipc.getSocket1JsonReply("workspaces");
+  const auto workspaces = m_ipc.state().workspaces();
   for (auto const &workspace : m_workspaces) {
-    auto workspaceJson = std::ranges::find_if(workspacesJson, [&](Json::Value const &x) {
-      return x["name"].asString() == workspace->name() ||
-             (workspace->isSpecial() && x["name"].asString() == "special:" + workspace->name());
+    auto info = std::ranges::find_if(workspaces, [&](WorkspaceInfo const &x) {
+      return x.name == workspace->name() ||
+             (workspace->isSpecial() && x.name == "special:" + workspace->name());
     });
-    uint32_t count = 0;
-    if (workspaceJson != workspacesJson.end()) {
-      try {
-        count = (*workspaceJson)["windows"].asUInt();
-      } catch (const std::exception &e) {
-        spdlog::error("Failed to update window count: {}", e.what());
-      }
-    }
-    workspace->setWindows(count);
+    workspace->setWindows(info != workspaces.end() ? info->windows : 0);
   }
 }
 
@@ -1057,11 +1082,10 @@ bool Workspaces::updateWindowsToCreate() {
 
 void Workspaces::updateWorkspaceStates() {
   const std::vector<int> visibleWorkspaces = getVisibleWorkspaces();
-  auto updatedWorkspaces = m_ipc.getSocket1JsonReply("workspaces");
+  const auto updatedWorkspaces = m_ipc.state().workspaces();
 
-  auto currentWorkspace = m_ipc.getSocket1JsonReply("activeworkspace");
-  std::string currentWorkspaceName =
-      currentWorkspace.isMember("name") ? currentWorkspace["name"].asString() : "";
+  auto currentWorkspace = m_ipc.state().activeWorkspace();
+  std::string currentWorkspaceName = currentWorkspace ? currentWorkspace->name : "";
 
   for (auto &workspace : m_workspaces) {
     bool isActiveByName =
@@ -1080,12 +1104,11 @@ void Workspaces::updateWorkspaceStates() {
       workspaceIcon = workspace->selectIcon(m_iconsMap);
     }
     auto updatedWorkspace = std::ranges::find_if(updatedWorkspaces, [&workspace](const auto &w) {
-      auto wNameRaw = w["name"].asString();
-      auto wName = wNameRaw.starts_with("special:") ? wNameRaw.substr(8) : wNameRaw;
+      auto wName = w.name.starts_with("special:") ? w.name.substr(8) : w.name;
       return wName == workspace->name();
     });
     if (updatedWorkspace != updatedWorkspaces.end()) {
-      workspace->setOutput((*updatedWorkspace)["monitor"].asString());
+      workspace->setOutput(updatedWorkspace->monitor);
     }
     workspace->update(workspaceIcon);
   }
@@ -1119,24 +1142,6 @@ std::string Workspaces::makePayload(Args const &...args) {
   return result.str();
 }
 
-std::pair<std::string, std::string> Workspaces::splitDoublePayload(std::string const &payload) {
-  const std::string part1 = payload.substr(0, payload.find(','));
-  const std::string part2 = payload.substr(part1.size() + 1);
-  return {part1, part2};
-}
-
-std::tuple<std::string, std::string, std::string> Workspaces::splitTriplePayload(
-    std::string const &payload) {
-  const size_t firstComma = payload.find(',');
-  const size_t secondComma = payload.find(',', firstComma + 1);
-
-  const std::string part1 = payload.substr(0, firstComma);
-  const std::string part2 = payload.substr(firstComma + 1, secondComma - (firstComma + 1));
-  const std::string part3 = payload.substr(secondComma + 1);
-
-  return {part1, part2, part3};
-}
-
 std::optional<int> Workspaces::parseWorkspaceId(std::string const &workspaceIdStr) {
   try {
     return workspaceIdStr == "special" ? -99 : std::stoi(workspaceIdStr);
@@ -10,7 +10,6 @@ extern "C" {
 #include <fcntl.h>
 #include <libinput.h>
 #include <linux/input-event-codes.h>
-#include <poll.h>
 #include <sys/inotify.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -173,78 +172,86 @@ waybar::modules::KeyboardState::KeyboardState(const std::string& id, const Bar&
     throw errno_error(errno, "Failed to find keyboard device");
   }
 
-  libinput_thread_ = [this] {
-    dp.emit();
-    while (1) {
-      struct pollfd fd = {libinput_get_fd(libinput_), POLLIN, 0};
-      poll(&fd, 1, -1);
-      libinput_dispatch(libinput_);
-      struct libinput_event* event;
-      while ((event = libinput_get_event(libinput_))) {
-        auto type = libinput_event_get_type(event);
-        if (type == LIBINPUT_EVENT_KEYBOARD_KEY) {
-          auto keyboard_event = libinput_event_get_keyboard_event(event);
-          auto state = libinput_event_keyboard_get_key_state(keyboard_event);
-          if (state == LIBINPUT_KEY_STATE_RELEASED) {
-            uint32_t key = libinput_event_keyboard_get_key(keyboard_event);
-            if (binding_keys.contains(key)) {
-              dp.emit();
+  auto& reactor = util::Reactor::instance();
+  libinput_watch_ = reactor.watch(
+      libinput_get_fd(libinput_), EPOLLIN,
+      [this](uint32_t) {
+        libinput_dispatch(libinput_);
+        struct libinput_event* event;
+        while ((event = libinput_get_event(libinput_))) {
+          auto type = libinput_event_get_type(event);
+          if (type == LIBINPUT_EVENT_KEYBOARD_KEY) {
+            auto keyboard_event = libinput_event_get_keyboard_event(event);
+            auto state = libinput_event_keyboard_get_key_state(keyboard_event);
+            if (state == LIBINPUT_KEY_STATE_RELEASED) {
+              uint32_t key = libinput_event_keyboard_get_key(keyboard_event);
+              if (binding_keys.contains(key)) {
+                dp.emit();
+              }
             }
           }
+          libinput_event_destroy(event);
         }
-        libinput_event_destroy(event);
-      }
-    }
-  };
+        return true;
+      },
+      "keyboard-state");
 
-  hotplug_thread_ = [this] {
-    int fd;
-    fd = inotify_init();
-    if (fd < 0) {
-      spdlog::error("Failed to initialize inotify: {}", strerror(errno));
-      return;
-    }
-    inotify_add_watch(fd, devices_path_.c_str(), IN_CREATE | IN_DELETE);
-    while (1) {
-      int BUF_LEN = 1024 * (sizeof(struct inotify_event) + 16);
-      char buf[BUF_LEN];
-      int length = read(fd, buf, 1024);
-      if (length < 0) {
+  hotplug_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (hotplug_fd_ < 0) {
+    spdlog::error("Failed to initialize inotify: {}", strerror(errno));
+  } else {
+    inotify_add_watch(hotplug_fd_, devices_path_.c_str(), IN_CREATE | IN_DELETE | IN_ATTRIB);
+    hotplug_watch_ = reactor.watch(
+        hotplug_fd_, EPOLLIN, [this](uint32_t) { return handleHotplug(); },
+        "keyboard-state-hotplug");
+  }
+  dp.emit();
+}
+
+auto waybar::modules::KeyboardState::handleHotplug() -> bool {
+  alignas(struct inotify_event) char buf[1024 * (sizeof(struct inotify_event) + 16)];
+  while (true) {
+    int length = read(hotplug_fd_, buf, sizeof(buf));
+    if (length < 0) {
+      if (errno != EAGAIN && errno != EINTR) {
         spdlog::error("Failed to read inotify: {}", strerror(errno));
-        return;
+        return false;
       }
-      for (int i = 0; i < length;) {
-        struct inotify_event* event = (struct inotify_event*)&buf[i];
-        std::string dev_path = devices_path_ + event->name;
-        if (event->mask & IN_CREATE) {
-          // Wait for device setup
-          int timeout = 10;
-          while (timeout--) {
-            try {
-              int fd = openFile(dev_path, O_NONBLOCK | O_CLOEXEC | O_RDONLY);
-              closeFile(fd);
-              break;
-            } catch (const errno_error& e) {
-              if (e.code == EACCES) {
-                sleep(1);
-              }
-            }
-          }
-          tryAddDevice(dev_path);
-        } else if (event->mask & IN_DELETE) {
-          auto it = libinput_devices_.find(dev_path);
-          if (it != libinput_devices_.end()) {
-            spdlog::info("Keyboard {} has been removed.", dev_path);
-            libinput_devices_.erase(it);
+      return true;
+    }
+    for (int i = 0; i < length;) {
+      struct inotify_event* event = (struct inotify_event*)&buf[i];
+      std::string dev_path = devices_path_ + event->name;
+      if (event->mask & (IN_CREATE | IN_ATTRIB)) {
+        // A new device node is usually not accessible until udev has set its permissions, wait
+        // for the attribute change instead of polling it
+        if (event->mask & IN_CREATE || pending_devices_.contains(dev_path)) {
+          if (access(dev_path.c_str(), R_OK) == 0) {
+            pending_devices_.erase(dev_path);
+            tryAddDevice(dev_path);
+          } else if (errno == EACCES) {
+            pending_devices_.insert(dev_path);
           }
         }
-        i += sizeof(struct inotify_event) + event->len;
+      } else if (event->mask & IN_DELETE) {
+        pending_devices_.erase(dev_path);
+        auto it = libinput_devices_.find(dev_path);
+        if (it != libinput_devices_.end()) {
+          spdlog::info("Keyboard {} has been removed.", dev_path);
+          libinput_devices_.erase(it);
+        }
       }
+      i += sizeof(struct inotify_event) + event->len;
     }
-  };
+  }
 }
 
 waybar::modules::KeyboardState::~KeyboardState() {
+  libinput_watch_.reset();
+  hotplug_watch_.reset();
+  if (hotplug_fd_ >= 0) {
+    close(hotplug_fd_);
+  }
   for (const auto& [_, dev_ptr] : libinput_devices_) {
     libinput_path_remove_device(dev_ptr);
   }
@@ -11,15 +11,19 @@
 
 waybar::modules::Load::Load(const std::string& id, const Json::Value& config)
     : ALabel(config, "load", id, "{load1}", 10) {
-  thread_ = [this] {
-    dp.emit();
-    thread_.sleep_for(interval_);
-  };
+  producer_ = util::SharedProducer<Sample>::subscribe(
+      "load:" + std::to_string(interval_.count()), interval_,
+      [] { return [](const util::StopSource&) { return std::optional(getLoad()); }; },
+      [this] { dp.emit(); });
 }
 
 auto waybar::modules::Load::update() -> void {
+  auto sample = producer_->latest();
+  if (!sample) {
+    return;
+  }
   // TODO: as creating dynamic fmt::arg arrays is buggy we have to calc both
-  auto [load1, load5, load15] = Load::getLoad();
+  auto [load1, load5, load15] = *sample;
   if (tooltipEnabled()) {
     auto tooltip = fmt::format("Load 1: {}\nLoad 5: {}\nLoad 15: {}", load1, load5, load15);
     label_.set_tooltip_text(tooltip);
@@ -2,14 +2,18 @@
 
 waybar::modules::Memory::Memory(const std::string& id, const Json::Value& config)
     : ALabel(config, "memory", id, "{}%", 30) {
-  thread_ = [this] {
-    dp.emit();
-    thread_.sleep_for(interval_);
-  };
+  producer_ = util::SharedProducer<Meminfo>::subscribe(
+      "memory:" + std::to_string(interval_.count()), interval_,
+      [] { return [](const util::StopSource&) { return std::optional(parseMeminfo()); }; },
+      [this] { dp.emit(); });
 }
 
 auto waybar::modules::Memory::update() -> void {
-  parseMeminfo();
+  auto sample = producer_->latest();
+  if (!sample) {
+    return;
+  }
+  meminfo_ = *sample;
 
   unsigned long memtotal = meminfo_["MemTotal"];
   unsigned long swaptotal = 0;
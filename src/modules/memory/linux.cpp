@@ -21,12 +21,13 @@ static unsigned zfsArcSize() {
   return 0;
 }
 
-void waybar::modules::Memory::parseMeminfo() {
+auto waybar::modules::Memory::parseMeminfo() -> Meminfo {
   const std::string data_dir_ = "/proc/meminfo";
   std::ifstream info(data_dir_);
   if (!info.is_open()) {
     throw std::runtime_error("Can't open " + data_dir_);
   }
+  Meminfo meminfo;
   std::string line;
   while (getline(info, line)) {
     auto posDelim = line.find(':');
@@ -36,8 +37,9 @@ void waybar::modules::Memory::parseMeminfo() {
 
     std::string name = line.substr(0, posDelim);
     int64_t value = std::stol(line.substr(posDelim + 1));
-    meminfo_[name] = value;
+    meminfo[name] = value;
   }
 
-  meminfo_["zfs_size"] = zfsArcSize();
+  meminfo["zfs_size"] = zfsArcSize();
+  return meminfo;
 }
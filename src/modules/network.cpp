@@ -4,7 +4,6 @@
 #include <linux/if_link.h>
 #include <netlink/netlink.h>
 #include <spdlog/spdlog.h>
-#include <sys/eventfd.h>
 
 #include <cassert>
 #include <cstring>
@@ -22,12 +21,22 @@
 namespace {
 using namespace waybar::util;
 constexpr const char *DEFAULT_FORMAT = "{ifname}";
+
+ip_addr_pref addrPref(const Json::Value &config) {
+  if (config["family"] == "ipv6") {
+    return IPV6;
+  }
+  if (config["family"] == "ipv4_6") {
+    return IPV4_6;
+  }
+  return IPV4;
+}
 }  // namespace
 
 constexpr const char *NETDEV_FILE =
     "/proc/net/dev";  // std::ifstream does not take std::string_view as param
 std::optional<std::pair<unsigned long long, unsigned long long>>
-waybar::modules::Network::readBandwidthUsage() {
+waybar::modules::Network::Source::readBandwidthUsage() {
   std::ifstream netdev(NETDEV_FILE);
   if (!netdev) {
     spdlog::warn("Failed to open netdev file {}", NETDEV_FILE);
@@ -83,19 +92,25 @@ waybar::modules::Network::readBandwidthUsage() {
 }
 
 waybar::modules::Network::Network(const std::string &id, const Json::Value &config)
-    : ALabel(config, "network", id, DEFAULT_FORMAT, 60) {
+    : ALabel(config, "network", id, DEFAULT_FORMAT, 60), addr_pref_(addrPref(config)) {
   // Start with some "text" in the module's label_. update() will then
   // update it. Since the text should be different, update() will be able
   // to show or hide the event_box_. This is to work around the case where
   // the module start with no text, but the event_box_ is shown.
   label_.set_markup("<s></s>");
 
-  if (config_["family"] == "ipv6") {
-    addr_pref_ = IPV6;
-  } else if (config["family"] == "ipv4_6") {
-    addr_pref_ = IPV4_6;
-  }
+  producer_ = util::SharedProducer<Sample>::subscribe(
+      util::producerKey("network", config_, {"interface", "family", "interval"}), interval_,
+      [this](util::SharedProducer<Sample> &producer) {
+        auto source = std::make_shared<Source>(config_, producer);
+        return [source](const util::StopSource &) { return std::optional(source->sample()); };
+      },
+      [this] { dp.emit(); });
+}
 
+waybar::modules::Network::Source::Source(const Json::Value &config,
+                                         util::SharedProducer<Sample> &producer)
+    : config_(config), producer_(producer), addr_pref_(addrPref(config)) {
   auto bandwidth = readBandwidthUsage();
   if (bandwidth.has_value()) {
     bandwidth_down_total_ = (*bandwidth).first;
@@ -119,7 +134,6 @@ waybar::modules::Network::Network(const std::string &id, const Json::Value &conf
   createEventSocket();
   createInfoSocket();
 
-  dp.emit();
   // Ask for a dump of interfaces and then addresses to populate our
   // information. First the interface dump, and once done, the callback
   // will be called again which will ask for addresses dump.
@@ -127,13 +141,8 @@ waybar::modules::Network::Network(const std::string &id, const Json::Value &conf
   worker();
 }
 
-waybar::modules::Network::~Network() {
-  if (ev_fd_ > -1) {
-    close(ev_fd_);
-  }
-  if (efd_ > -1) {
-    close(efd_);
-  }
+waybar::modules::Network::Source::~Source() {
+  ev_watch_.reset();
   if (ev_sock_ != nullptr) {
     nl_socket_drop_memberships(ev_sock_, RTNLGRP_LINK, RTNLGRP_IPV4_IFADDR, RTNLGRP_IPV6_IFADDR);
     nl_close(ev_sock_);
@@ -145,7 +154,7 @@ waybar::modules::Network::~Network() {
   }
 }
 
-void waybar::modules::Network::createEventSocket() {
+void waybar::modules::Network::Source::createEventSocket() {
   ev_sock_ = nl_socket_alloc();
   nl_socket_disable_seq_check(ev_sock_);
   nl_socket_modify_cb(ev_sock_, NL_CB_VALID, NL_CB_CUSTOM, handleEvents, this);
@@ -162,34 +171,9 @@ void waybar::modules::Network::createEventSocket() {
   if (!config_["interface"].isString()) {
     nl_socket_add_memberships(ev_sock_, RTNLGRP_IPV4_ROUTE, RTNLGRP_IPV6_ROUTE, 0);
   }
-
-  efd_ = epoll_create1(EPOLL_CLOEXEC);
-  if (efd_ < 0) {
-    throw std::runtime_error("Can't create epoll");
-  }
-  {
-    ev_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
-    struct epoll_event event;
-    memset(&event, 0, sizeof(event));
-    event.events = EPOLLIN | EPOLLET;
-    event.data.fd = ev_fd_;
-    if (epoll_ctl(efd_, EPOLL_CTL_ADD, ev_fd_, &event) == -1) {
-      throw std::runtime_error("Can't add epoll event");
-    }
-  }
-  {
-    auto fd = nl_socket_get_fd(ev_sock_);
-    struct epoll_event event;
-    memset(&event, 0, sizeof(event));
-    event.events = EPOLLIN | EPOLLET | EPOLLRDHUP;
-    event.data.fd = fd;
-    if (epoll_ctl(efd_, EPOLL_CTL_ADD, fd, &event) == -1) {
-      throw std::runtime_error("Can't add epoll event");
-    }
-  }
 }
 
-void waybar::modules::Network::createInfoSocket() {
+void waybar::modules::Network::Source::createInfoSocket() {
   sock_ = nl_socket_alloc();
   if (genl_connect(sock_) != 0) {
     throw std::runtime_error("Can't connect to netlink socket");
@@ -203,79 +187,43 @@ void waybar::modules::Network::createInfoSocket() {
   }
 }
 
-void waybar::modules::Network::worker() {
-  // update via here not working
-  thread_timer_ = [this] {
-    {
-      std::lock_guard<std::mutex> lock(mutex_);
-      if (ifid_ > 0) {
-        getInfo();
-      }
-      dp.emit();
-    }
-    thread_timer_.sleep_for(interval_);
-  };
+void waybar::modules::Network::Source::worker() {
+  // The state is only sampled by the producer: events just ask it for a sample
 #ifdef WANT_RFKILL
-  rfkill_.on_update.connect([this](auto &) {
-    /* If we are here, it's likely that the network thread already holds the mutex and will be
-     * holding it for a next few seconds.
-     * Let's delegate the update to the timer thread instead of blocking the main thread.
-     */
-    thread_timer_.wake_up();
-  });
+  rfkill_.on_update.connect([this](auto &) { producer_.wake_up(); });
 #else
   spdlog::warn("Waybar has been built without rfkill support.");
 #endif
-  thread_ = [this] {
-    std::array<struct epoll_event, EPOLL_MAX> events{};
-
-    int ec = epoll_wait(efd_, events.data(), EPOLL_MAX, -1);
-    if (ec > 0) {
-      for (auto i = 0; i < ec; i++) {
-        if (events[i].data.fd == nl_socket_get_fd(ev_sock_)) {
-          int rc = 0;
-          // Read as many message as possible, until the socket blocks
-          while (true) {
-            errno = 0;
-            rc = nl_recvmsgs_default(ev_sock_);
-            if (rc == -NLE_AGAIN || errno == EAGAIN) {
-              rc = 0;
-              break;
-            }
-          }
-          if (rc < 0) {
-            spdlog::error("nl_recvmsgs_default error: {}", nl_geterror(-rc));
-            thread_.stop();
+  ev_watch_ = util::Reactor::instance().watch(
+      nl_socket_get_fd(ev_sock_), EPOLLIN | EPOLLRDHUP,
+      [this](uint32_t events) {
+        if (events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
+          return false;
+        }
+        int rc = 0;
+        // Read as many message as possible, until the socket blocks
+        while (true) {
+          errno = 0;
+          rc = nl_recvmsgs_default(ev_sock_);
+          if (rc == -NLE_AGAIN || errno == EAGAIN) {
+            rc = 0;
             break;
           }
-        } else {
-          thread_.stop();
-          break;
         }
-      }
-    }
-  };
-}
-
-const std::string waybar::modules::Network::getNetworkState() const {
-  if (ifid_ == -1 || !carrier_) {
-#ifdef WANT_RFKILL
-    bool display_rfkill = true;
-    if (config_["rfkill"].isBool()) {
-      display_rfkill = config_["rfkill"].asBool();
-    }
-    if (rfkill_.getState() && display_rfkill) return "disabled";
-#endif
-    return "disconnected";
-  }
-  if (ipaddr_.empty() && ipaddr6_.empty()) return "linked";
-  if (essid_.empty()) return "ethernet";
-  return "wifi";
+        if (rc < 0) {
+          spdlog::error("nl_recvmsgs_default error: {}", nl_geterror(-rc));
+          return false;
+        }
+        return true;
+      },
+      "network");
 }
 
-auto waybar::modules::Network::update() -> void {
+waybar::modules::Network::Sample waybar::modules::Network::Source::sample() {
   std::lock_guard<std::mutex> lock(mutex_);
-  std::string tooltip_format;
+  if (ifid_ > 0) {
+    getInfo();
+  }
 
   auto bandwidth = readBandwidthUsage();
   auto bandwidth_down = 0ull;
@@ -291,8 +239,44 @@ auto waybar::modules::Network::update() -> void {
     bandwidth_up_total_ = up_octets;
   }
 
+#ifdef WANT_RFKILL
+  bool rfkill = rfkill_.getState();
+#else
+  bool rfkill = false;
+#endif
+  return {ifid_, carrier_, ifname_, essid_, bssid_, ipaddr_, ipaddr6_, gwaddr_, netmask_,
+          netmask6_, cidr_, cidr6_, signal_strength_dbm_, signal_strength_, signal_strength_app_,
+          frequency_, rfkill, bandwidth_down, bandwidth_up};
+}
+
+const std::string waybar::modules::Network::getNetworkState(const Sample &info) const {
+  if (info.ifid == -1 || !info.carrier) {
+#ifdef WANT_RFKILL
+    bool display_rfkill = true;
+    if (config_["rfkill"].isBool()) {
+      display_rfkill = config_["rfkill"].asBool();
+    }
+    if (info.rfkill && display_rfkill) return "disabled";
+#endif
+    return "disconnected";
+  }
+  if (info.ipaddr.empty() && info.ipaddr6.empty()) return "linked";
+  if (info.essid.empty()) return "ethernet";
+  return "wifi";
+}
+
+auto waybar::modules::Network::update() -> void {
+  auto sample = producer_->latest();
+  if (!sample) {
+    return;
+  }
+  const auto &info = *sample;
+  const auto bandwidth_down = info.bandwidth_down;
+  const auto bandwidth_up = info.bandwidth_up;
+  std::string tooltip_format;
+
   if (!alt_) {
-    auto state = getNetworkState();
+    auto state = getNetworkState(info);
     if (!state_.empty() && label_.get_style_context()->has_class(state_)) {
       label_.get_style_context()->remove_class(state_);
     }
@@ -312,27 +296,29 @@ auto waybar::modules::Network::update() -> void {
     format_ = default_format_;
     state_ = state;
   }
-  getState(signal_strength_);
+  getState(info.signal_strength);
 
   std::string final_ipaddr_;
   if (addr_pref_ == ip_addr_pref::IPV4) {
-    final_ipaddr_ = ipaddr_;
+    final_ipaddr_ = info.ipaddr;
   } else if (addr_pref_ == ip_addr_pref::IPV6) {
-    final_ipaddr_ = ipaddr6_;
+    final_ipaddr_ = info.ipaddr6;
   } else if (addr_pref_ == ip_addr_pref::IPV4_6) {
-    final_ipaddr_ = ipaddr_;
+    final_ipaddr_ = info.ipaddr;
     final_ipaddr_ += '\n';
-    final_ipaddr_ += ipaddr6_;
+    final_ipaddr_ += info.ipaddr6;
   }
 
   auto text = fmt::format(
-      fmt::runtime(format_), fmt::arg("essid", essid_), fmt::arg("bssid", bssid_),
-      fmt::arg("signaldBm", signal_strength_dbm_), fmt::arg("signalStrength", signal_strength_),
-      fmt::arg("signalStrengthApp", signal_strength_app_), fmt::arg("ifname", ifname_),
-      fmt::arg("netmask", netmask_), fmt::arg("netmask6", netmask6_),
-      fmt::arg("ipaddr", final_ipaddr_), fmt::arg("gwaddr", gwaddr_), fmt::arg("cidr", cidr_),
-      fmt::arg("cidr6", cidr6_), fmt::arg("frequency", fmt::format("{:.1f}", frequency_)),
-      fmt::arg("icon", getIcon(signal_strength_, state_)),
+      fmt::runtime(format_), fmt::arg("essid", info.essid), fmt::arg("bssid", info.bssid),
+      fmt::arg("signaldBm", info.signal_strength_dbm),
+      fmt::arg("signalStrength", info.signal_strength),
+      fmt::arg("signalStrengthApp", info.signal_strength_app), fmt::arg("ifname", info.ifname),
+      fmt::arg("netmask", info.netmask), fmt::arg("netmask6", info.netmask6),
+      fmt::arg("ipaddr", final_ipaddr_), fmt::arg("gwaddr", info.gwaddr),
+      fmt::arg("cidr", info.cidr), fmt::arg("cidr6", info.cidr6),
+      fmt::arg("frequency", fmt::format("{:.1f}", info.frequency)),
+      fmt::arg("icon", getIcon(info.signal_strength, state_)),
       fmt::arg("bandwidthDownBits",
                pow_format(bandwidth_down * 8ull / (interval_.count() / 1000.0), "b/s")),
       fmt::arg("bandwidthUpBits",
@@ -364,13 +350,15 @@ auto waybar::modules::Network::update() -> void {
     }
     if (!tooltip_format.empty()) {
       auto tooltip_text = fmt::format(
-          fmt::runtime(tooltip_format), fmt::arg("essid", essid_), fmt::arg("bssid", bssid_),
-          fmt::arg("signaldBm", signal_strength_dbm_), fmt::arg("signalStrength", signal_strength_),
-          fmt::arg("signalStrengthApp", signal_strength_app_), fmt::arg("ifname", ifname_),
-          fmt::arg("netmask", netmask_), fmt::arg("netmask6", netmask6_),
-          fmt::arg("ipaddr", final_ipaddr_), fmt::arg("gwaddr", gwaddr_), fmt::arg("cidr", cidr_),
-          fmt::arg("cidr6", cidr6_), fmt::arg("frequency", fmt::format("{:.1f}", frequency_)),
-          fmt::arg("icon", getIcon(signal_strength_, state_)),
+          fmt::runtime(tooltip_format), fmt::arg("essid", info.essid),
+          fmt::arg("bssid", info.bssid), fmt::arg("signaldBm", info.signal_strength_dbm),
+          fmt::arg("signalStrength", info.signal_strength),
+          fmt::arg("signalStrengthApp", info.signal_strength_app), fmt::arg("ifname", info.ifname),
+          fmt::arg("netmask", info.netmask), fmt::arg("netmask6", info.netmask6),
+          fmt::arg("ipaddr", final_ipaddr_), fmt::arg("gwaddr", info.gwaddr),
+          fmt::arg("cidr", info.cidr), fmt::arg("cidr6", info.cidr6),
+          fmt::arg("frequency", fmt::format("{:.1f}", info.frequency)),
+          fmt::arg("icon", getIcon(info.signal_strength, state_)),
           fmt::arg("bandwidthDownBits",
                    pow_format(bandwidth_down * 8ull / interval_.count(), "b/s")),
           fmt::arg("bandwidthUpBits", pow_format(bandwidth_up * 8ull / interval_.count(), "b/s")),
@@ -435,7 +423,7 @@ static bool wildcardMatch(const std::string &pattern, const std::string &text) {
   return p == P;
 }
 
-bool waybar::modules::Network::matchInterface(const std::string &ifname,
+bool waybar::modules::Network::Source::matchInterface(const std::string &ifname,
                                               const std::vector<std::string> &altnames,
                                               std::string &matched) const {
   if (!config_["interface"].isString()) {
@@ -458,7 +446,7 @@ bool waybar::modules::Network::matchInterface(const std::string &ifname,
   return false;
 }
 
-void waybar::modules::Network::clearIface() {
+void waybar::modules::Network::Source::clearIface() {
   ifid_ = -1;
   ifname_.clear();
   essid_.clear();
@@ -478,8 +466,8 @@ void waybar::modules::Network::clearIface() {
   frequency_ = 0.0;
 }
 
-int waybar::modules::Network::handleEvents(struct nl_msg *msg, void *data) {
-  auto net = static_cast<waybar::modules::Network *>(data);
+int waybar::modules::Network::Source::handleEvents(struct nl_msg *msg, void *data) {
+  auto net = static_cast<waybar::modules::Network::Source *>(data);
   std::lock_guard<std::mutex> lock(net->mutex_);
   auto nh = nlmsg_hdr(msg);
   bool is_del_event = false;
@@ -510,7 +498,7 @@ int waybar::modules::Network::handleEvents(struct nl_msg *msg, void *data) {
         // it have been deleted, so start looking for a new default route.
         spdlog::debug("network: if{} down", net->ifid_);
         net->clearIface();
-        net->dp.emit();
+        net->producer_.wake_up();
         net->want_route_dump_ = true;
         net->askForStateDump();
         return NL_OK;
@@ -548,7 +536,7 @@ int waybar::modules::Network::handleEvents(struct nl_msg *msg, void *data) {
           if (net->carrier_ != *carrier) {
             if (*carrier) {
               // Ask for WiFi information
-              net->thread_timer_.wake_up();
+              net->producer_.wake_up();
             } else {
               // clear state related to WiFi connection
               net->essid_.clear();
@@ -585,7 +573,7 @@ int waybar::modules::Network::handleEvents(struct nl_msg *msg, void *data) {
           if (carrier.has_value()) {
             net->carrier_ = carrier.value();
           }
-          net->thread_timer_.wake_up();
+          net->producer_.wake_up();
           /* An address for this new interface should be received via an
            * RTM_NEWADDR event either because we ask for a dump of both links
            * and addrs, or because this interface has just been created and
@@ -597,7 +585,7 @@ int waybar::modules::Network::handleEvents(struct nl_msg *msg, void *data) {
         spdlog::debug("network: interface {}/{} deleted", net->ifname_, net->ifid_);
 
         net->clearIface();
-        net->dp.emit();
+        net->producer_.wake_up();
       }
       break;
     }
@@ -668,7 +656,7 @@ int waybar::modules::Network::handleEvents(struct nl_msg *msg, void *data) {
                             inet_ntop(ifa->ifa_family, RTA_DATA(ifa_rta), ipaddr, sizeof(ipaddr)),
                             ifa->ifa_prefixlen);
             }
-            net->dp.emit();
+            net->producer_.wake_up();
             break;
         }
       }
@@ -779,13 +767,13 @@ int waybar::modules::Network::handleEvents(struct nl_msg *msg, void *data) {
            * addresses. */
           net->want_addr_dump_ = true;
           net->askForStateDump();
-          net->thread_timer_.wake_up();
+          net->producer_.wake_up();
         } else if (is_del_event && temp_idx == net->ifid_ && net->route_priority == priority) {
           spdlog::debug("network: default route deleted {}/if{} metric {}", net->ifname_, temp_idx,
                         priority);
 
           net->clearIface();
-          net->dp.emit();
+          net->producer_.wake_up();
           /* Ask for a dump of all routes in case another one is already
            * setup. If there's none, there'll be an event with new one
            * later. */
@@ -800,7 +788,7 @@ int waybar::modules::Network::handleEvents(struct nl_msg *msg, void *data) {
   return NL_OK;
 }
 
-void waybar::modules::Network::askForStateDump(void) {
+void waybar::modules::Network::Source::askForStateDump(void) {
   /* We need to wait until the current dump is done before sending new
    * messages. handleEventsDone() is called when a dump is done. */
   if (dump_in_progress_) return;
@@ -826,15 +814,15 @@ void waybar::modules::Network::askForStateDump(void) {
   }
 }
 
-int waybar::modules::Network::handleEventsDone(struct nl_msg *msg, void *data) {
-  auto net = static_cast<waybar::modules::Network *>(data);
+int waybar::modules::Network::Source::handleEventsDone(struct nl_msg *msg, void *data) {
+  auto net = static_cast<waybar::modules::Network::Source *>(data);
   net->dump_in_progress_ = false;
   net->askForStateDump();
   return NL_OK;
 }
 
-int waybar::modules::Network::handleScan(struct nl_msg *msg, void *data) {
-  auto net = static_cast<waybar::modules::Network *>(data);
+int waybar::modules::Network::Source::handleScan(struct nl_msg *msg, void *data) {
+  auto net = static_cast<waybar::modules::Network::Source *>(data);
   auto gnlh = static_cast<genlmsghdr *>(nlmsg_data(nlmsg_hdr(msg)));
   struct nlattr *tb[NL80211_ATTR_MAX + 1];
   struct nlattr *bss[NL80211_BSS_MAX + 1];
@@ -869,7 +857,7 @@ int waybar::modules::Network::handleScan(struct nl_msg *msg, void *data) {
   return NL_OK;
 }
 
-void waybar::modules::Network::parseEssid(struct nlattr **bss) {
+void waybar::modules::Network::Source::parseEssid(struct nlattr **bss) {
   if (bss[NL80211_BSS_INFORMATION_ELEMENTS] != nullptr) {
     auto ies = static_cast<char *>(nla_data(bss[NL80211_BSS_INFORMATION_ELEMENTS]));
     auto ies_len = nla_len(bss[NL80211_BSS_INFORMATION_ELEMENTS]);
@@ -888,7 +876,7 @@ void waybar::modules::Network::parseEssid(struct nlattr **bss) {
   }
 }
 
-void waybar::modules::Network::parseSignal(struct nlattr **bss) {
+void waybar::modules::Network::Source::parseSignal(struct nlattr **bss) {
   if (bss[NL80211_BSS_SIGNAL_MBM] != nullptr) {
     // signalstrength in dBm from mBm
     signal_strength_dbm_ = nla_get_s32(bss[NL80211_BSS_SIGNAL_MBM]) / 100;
@@ -924,14 +912,14 @@ void waybar::modules::Network::parseSignal(struct nlattr **bss) {
   }
 }
 
-void waybar::modules::Network::parseFreq(struct nlattr **bss) {
+void waybar::modules::Network::Source::parseFreq(struct nlattr **bss) {
   if (bss[NL80211_BSS_FREQUENCY] != nullptr) {
     // in GHz
     frequency_ = (double)nla_get_u32(bss[NL80211_BSS_FREQUENCY]) / 1000;
   }
 }
 
-void waybar::modules::Network::parseBssid(struct nlattr **bss) {
+void waybar::modules::Network::Source::parseBssid(struct nlattr **bss) {
   if (bss[NL80211_BSS_BSSID] != nullptr) {
     auto bssid = static_cast<uint8_t *>(nla_data(bss[NL80211_BSS_BSSID]));
     auto bssid_len = nla_len(bss[NL80211_BSS_BSSID]);
@@ -942,7 +930,7 @@ void waybar::modules::Network::parseBssid(struct nlattr **bss) {
   }
 }
 
-bool waybar::modules::Network::associatedOrJoined(struct nlattr **bss) {
+bool waybar::modules::Network::Source::associatedOrJoined(struct nlattr **bss) {
   if (bss[NL80211_BSS_STATUS] == nullptr) {
     return false;
   }
@@ -957,7 +945,7 @@ bool waybar::modules::Network::associatedOrJoined(struct nlattr **bss) {
   }
 }
 
-auto waybar::modules::Network::getInfo() -> void {
+auto waybar::modules::Network::Source::getInfo() -> void {
   struct nl_msg *nl_msg = nlmsg_alloc();
   if (nl_msg == nullptr) {
     return;
@@ -32,9 +32,10 @@ void Language::updateFromIPC() {
   auto ipcLock = gIPC->lockData();
 
   layouts_.clear();
-  for (const auto &fullName : gIPC->keyboardLayoutNames()) layouts_.push_back(getLayout(fullName));
+  const auto &state = gIPC->state();
+  for (const auto &fullName : state.keyboardLayoutNames()) layouts_.push_back(getLayout(fullName));
 
-  current_idx_ = gIPC->keyboardLayoutCurrent();
+  current_idx_ = state.keyboardLayoutCurrent();
 }
 
 /**
@@ -103,7 +104,7 @@ void Language::onEvent(const Json::Value &ev) {
   } else if (ev["KeyboardLayoutSwitched"]) {
     std::lock_guard<std::mutex> lock(mutex_);
     auto ipcLock = gIPC->lockData();
-    current_idx_ = gIPC->keyboardLayoutCurrent();
+    current_idx_ = gIPC->state().keyboardLayoutCurrent();
   }
 
   dp.emit();
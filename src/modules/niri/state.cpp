@@ -0,0 +1,298 @@
+#include "modules/niri/state.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <unordered_set>
+#include <utility>
+
+namespace waybar::modules::niri {
+
+namespace {
+
+WorkspaceKey keyOf(const Json::Value& ws) {
+  return {ws["output"].asString(), ws["idx"].asUInt(), ws["id"].asUInt64()};
+}
+
+/// Workspace of a window, 0 for none
+uint64_t workspaceOf(const Json::Value& window) {
+  const auto& id = window["workspace_id"];
+  return id.isNull() ? 0 : id.asUInt64();
+}
+
+}  // namespace
+
+bool NiriState::apply(const std::string& event, const Json::Value& payload,
+                      std::vector<StateDelta>& deltas) {
+  if (event == "WorkspacesChanged") {
+    setWorkspaces(payload["workspaces"], deltas);
+  } else if (event == "WorkspaceActivated") {
+    activateWorkspace(payload, deltas);
+  } else if (event == "WorkspaceActiveWindowChanged") {
+    const auto id = payload["workspace_id"].asUInt64();
+    auto* ws = findWorkspace(id);
+    if (ws == nullptr) {
+      spdlog::error("Active window changed on unknown workspace");
+    } else if ((*ws)["active_window_id"] != payload["active_window_id"]) {
+      (*ws)["active_window_id"] = payload["active_window_id"];
+      deltas.push_back({StateDelta::Kind::WorkspaceChanged, id});
+    }
+  } else if (event == "WorkspaceUrgencyChanged") {
+    const auto id = payload["id"].asUInt64();
+    auto* ws = findWorkspace(id);
+    if (ws == nullptr) {
+      spdlog::error("Urgency changed for unknown workspace");
+    } else if ((*ws)["is_urgent"].asBool() != payload["urgent"].asBool()) {
+      (*ws)["is_urgent"] = payload["urgent"].asBool();
+      deltas.push_back({StateDelta::Kind::WorkspaceChanged, id});
+    }
+  } else if (event == "KeyboardLayoutsChanged") {
+    const auto& layouts = payload["keyboard_layouts"];
+    keyboardLayoutCurrent_ = layouts["current_idx"].asUInt();
+    keyboardLayoutNames_.clear();
+    for (const auto& fullName : layouts["names"]) {
+      keyboardLayoutNames_.push_back(fullName.asString());
+    }
+    deltas.push_back({StateDelta::Kind::KeyboardLayoutChanged});
+  } else if (event == "KeyboardLayoutSwitched") {
+    keyboardLayoutCurrent_ = payload["idx"].asUInt();
+    deltas.push_back({StateDelta::Kind::KeyboardLayoutChanged});
+  } else if (event == "WindowsChanged") {
+    setWindows(payload["windows"], deltas);
+  } else if (event == "WindowOpenedOrChanged") {
+    updateWindow(payload["window"], deltas);
+  } else if (event == "WindowClosed") {
+    removeWindow(payload["id"].asUInt64(), deltas);
+  } else if (event == "WindowFocusChanged") {
+    focusWindow(payload["id"].isNull() ? std::nullopt : std::optional(payload["id"].asUInt64()),
+                deltas);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const Json::Value* NiriState::workspace(uint64_t id) const {
+  auto it = workspaceIndex_.find(id);
+  return it == workspaceIndex_.end() ? nullptr : &it->second->second;
+}
+
+Json::Value* NiriState::findWorkspace(uint64_t id) {
+  auto it = workspaceIndex_.find(id);
+  return it == workspaceIndex_.end() ? nullptr : &it->second->second;
+}
+
+const Json::Value* NiriState::focusedWorkspace() const {
+  return focusedWorkspace_ ? workspace(*focusedWorkspace_) : nullptr;
+}
+
+const Json::Value* NiriState::activeWorkspace(const std::string& output) const {
+  auto it = activeWorkspaces_.find(output);
+  return it == activeWorkspaces_.end() ? nullptr : workspace(it->second);
+}
+
+void NiriState::setWorkspaces(const Json::Value& workspaces, std::vector<StateDelta>& deltas) {
+  std::unordered_set<uint64_t> seen;
+  activeWorkspaces_.clear();
+  focusedWorkspace_.reset();
+
+  for (const auto& ws : workspaces) {
+    const auto id = ws["id"].asUInt64();
+    seen.insert(id);
+    if (ws["is_active"].asBool()) activeWorkspaces_[ws["output"].asString()] = id;
+    if (ws["is_focused"].asBool()) focusedWorkspace_ = id;
+
+    auto it = workspaceIndex_.find(id);
+    if (it == workspaceIndex_.end()) {
+      workspaceIndex_.emplace(id, workspaces_.emplace(keyOf(ws), ws).first);
+      deltas.push_back({StateDelta::Kind::WorkspaceAdded, id});
+      continue;
+    }
+
+    auto& current = it->second;
+    auto key = keyOf(ws);
+    if (current->first != key) {
+      // Reinsert at its new position, reusing the node
+      auto node = workspaces_.extract(current);
+      node.key() = std::move(key);
+      node.mapped() = ws;
+      current = workspaces_.insert(std::move(node)).position;
+      deltas.push_back({StateDelta::Kind::WorkspaceMoved, id});
+    } else if (current->second != ws) {
+      const auto activated = current->second["is_active"] != ws["is_active"] ||
+                             current->second["is_focused"] != ws["is_focused"];
+      current->second = ws;
+      deltas.push_back(
+          {activated ? StateDelta::Kind::WorkspaceActivated : StateDelta::Kind::WorkspaceChanged,
+           id});
+    }
+  }
+
+  for (auto it = workspaceIndex_.begin(); it != workspaceIndex_.end();) {
+    if (seen.contains(it->first)) {
+      ++it;
+      continue;
+    }
+    deltas.push_back({StateDelta::Kind::WorkspaceRemoved, it->first});
+    workspaces_.erase(it->second);
+    it = workspaceIndex_.erase(it);
+  }
+}
+
+void NiriState::activateWorkspace(const Json::Value& payload, std::vector<StateDelta>& deltas) {
+  const auto id = payload["id"].asUInt64();
+  const auto* ws = workspace(id);
+  if (ws == nullptr) {
+    spdlog::error("Activated unknown workspace");
+    return;
+  }
+
+  // Only the previously active and focused workspaces change along with it. The new one is
+  // updated last, so that it is reported once.
+  const auto focused = payload["focused"].asBool();
+  auto& active = activeWorkspaces_[(*ws)["output"].asString()];
+  if (active != id) {
+    setWorkspaceFlag(active, "is_active", false, deltas);
+    active = id;
+  }
+  if (focused && focusedWorkspace_ && *focusedWorkspace_ != id) {
+    setWorkspaceFlag(*focusedWorkspace_, "is_focused", false, deltas);
+  }
+  setWorkspaceFlag(id, "is_active", true, deltas);
+  if (focused) {
+    focusedWorkspace_ = id;
+    setWorkspaceFlag(id, "is_focused", true, deltas);
+  }
+}
+
+void NiriState::setWorkspaceFlag(uint64_t id, const char* flag, bool value,
+                                 std::vector<StateDelta>& deltas) {
+  auto* ws = findWorkspace(id);
+  if (ws == nullptr || (*ws)[flag].asBool() == value) {
+    return;
+  }
+  (*ws)[flag] = value;
+  if (deltas.empty() || deltas.back().kind != StateDelta::Kind::WorkspaceActivated ||
+      deltas.back().id != id) {
+    deltas.push_back({StateDelta::Kind::WorkspaceActivated, id});
+  }
+}
+
+const Json::Value* NiriState::window(uint64_t id) const {
+  auto it = windows_.find(id);
+  return it == windows_.end() ? nullptr : &it->second;
+}
+
+size_t NiriState::windowCount(uint64_t workspaceId) const {
+  auto it = windowCounts_.find(workspaceId);
+  return it == windowCounts_.end() ? 0 : it->second;
+}
+
+void NiriState::countWindow(const Json::Value& window, int n) {
+  const auto workspaceId = workspaceOf(window);
+  if (workspaceId == 0) {
+    return;
+  }
+  auto& count = windowCounts_[workspaceId];
+  count += n;
+  if (count == 0) {
+    windowCounts_.erase(workspaceId);
+  }
+}
+
+void NiriState::setWindows(const Json::Value& windows, std::vector<StateDelta>& deltas) {
+  std::unordered_set<uint64_t> seen;
+  focusedWindow_.reset();
+
+  for (const auto& window : windows) {
+    const auto id = window["id"].asUInt64();
+    seen.insert(id);
+    if (window["is_focused"].asBool()) focusedWindow_ = id;
+
+    auto it = windows_.find(id);
+    if (it == windows_.end()) {
+      windows_.emplace(id, window);
+      countWindow(window, 1);
+      deltas.push_back({StateDelta::Kind::WindowAdded, id, workspaceOf(window)});
+    } else if (workspaceOf(it->second) != workspaceOf(window)) {
+      deltas.push_back({StateDelta::Kind::WindowRemoved, id, workspaceOf(it->second)});
+      countWindow(it->second, -1);
+      it->second = window;
+      countWindow(window, 1);
+      deltas.push_back({StateDelta::Kind::WindowAdded, id, workspaceOf(window)});
+    } else if (it->second != window) {
+      it->second = window;
+      deltas.push_back({StateDelta::Kind::WindowChanged, id, workspaceOf(window)});
+    }
+  }
+
+  for (auto it = windows_.begin(); it != windows_.end();) {
+    if (seen.contains(it->first)) {
+      ++it;
+      continue;
+    }
+    deltas.push_back({StateDelta::Kind::WindowRemoved, it->first, workspaceOf(it->second)});
+    countWindow(it->second, -1);
+    it = windows_.erase(it);
+  }
+}
+
+void NiriState::updateWindow(const Json::Value& window, std::vector<StateDelta>& deltas) {
+  const auto id = window["id"].asUInt64();
+  auto it = windows_.find(id);
+  if (it == windows_.end()) {
+    windows_.emplace(id, window);
+    countWindow(window, 1);
+    deltas.push_back({StateDelta::Kind::WindowAdded, id, workspaceOf(window)});
+  } else {
+    if (workspaceOf(it->second) != workspaceOf(window)) {
+      deltas.push_back({StateDelta::Kind::WindowRemoved, id, workspaceOf(it->second)});
+      countWindow(it->second, -1);
+      countWindow(window, 1);
+      deltas.push_back({StateDelta::Kind::WindowAdded, id, workspaceOf(window)});
+    } else {
+      deltas.push_back({StateDelta::Kind::WindowChanged, id, workspaceOf(window)});
+    }
+    it->second = window;
+  }
+
+  if (window["is_focused"].asBool() && focusedWindow_ != id) {
+    focusWindow(id, deltas);
+  } else if (!window["is_focused"].asBool() && focusedWindow_ == id) {
+    focusedWindow_.reset();
+  }
+}
+
+void NiriState::removeWindow(uint64_t id, std::vector<StateDelta>& deltas) {
+  auto it = windows_.find(id);
+  if (it == windows_.end()) {
+    spdlog::error("Unknown window closed");
+    return;
+  }
+  deltas.push_back({StateDelta::Kind::WindowRemoved, id, workspaceOf(it->second)});
+  countWindow(it->second, -1);
+  windows_.erase(it);
+  if (focusedWindow_ == id) {
+    focusedWindow_.reset();
+  }
+}
+
+void NiriState::focusWindow(std::optional<uint64_t> id, std::vector<StateDelta>& deltas) {
+  // Only the previously focused window changes along with the new one
+  if (focusedWindow_) {
+    if (auto it = windows_.find(*focusedWindow_); it != windows_.end()) {
+      it->second["is_focused"] = false;
+    }
+  }
+  focusedWindow_.reset();
+  uint64_t workspaceId = 0;
+  if (id) {
+    if (auto it = windows_.find(*id); it != windows_.end()) {
+      it->second["is_focused"] = true;
+      focusedWindow_ = id;
+      workspaceId = workspaceOf(it->second);
+    }
+  }
+  deltas.push_back({StateDelta::Kind::WindowFocusChanged, id.value_or(0), workspaceId});
+}
+
+}  // namespace waybar::modules::niri
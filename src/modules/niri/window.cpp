@@ -4,76 +4,88 @@
 #include <gtkmm/label.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+
 #include "util/rewrite_string.hpp"
 #include "util/sanitize_str.hpp"
 
 namespace waybar::modules::niri {
 
 Window::Window(const std::string &id, const Bar &bar, const Json::Value &config)
-    : AAppIconLabel(config, "window", id, "{title}", 0, true), bar_(bar) {
+    : AAppIconLabel(config, "window", id, "{title}", 0, true),
+      bar_(bar),
+      rewriteRules_(config["rewrite"]) {
   if (!gIPC) gIPC = std::make_unique<IPC>();
 
-  gIPC->registerForIPC("WindowsChanged", this);
-  gIPC->registerForIPC("WindowOpenedOrChanged", this);
-  gIPC->registerForIPC("WindowClosed", this);
-  gIPC->registerForIPC("WindowFocusChanged", this);
+  gIPC->addListener(this);
 
   dp.emit();
 }
 
-Window::~Window() { gIPC->unregisterForIPC(this); }
+Window::~Window() {
+  // waits for a running onStateChanged
+  gIPC->removeListener(this);
+}
 
-void Window::onEvent(const Json::Value &ev) { dp.emit(); }
+void Window::onStateChanged(const std::vector<StateDelta> &deltas) {
+  if (std::any_of(deltas.cbegin(), deltas.cend(),
+                  [this](const auto &delta) { return isRelevant(delta); })) {
+    dp.emit();
+  }
+}
+
+bool Window::isRelevant(const StateDelta &delta) const {
+  switch (delta.kind) {
+    case StateDelta::Kind::WorkspaceAdded:
+    case StateDelta::Kind::WorkspaceRemoved:
+    case StateDelta::Kind::WorkspaceMoved:
+    case StateDelta::Kind::WorkspaceActivated:
+      // The shown workspace may be another one now
+      return true;
+    case StateDelta::Kind::WorkspaceChanged:
+      return delta.id == shownWorkspace_;
+    case StateDelta::Kind::WindowChanged:
+      return delta.id == shownWindow_;
+    case StateDelta::Kind::WindowAdded:
+    case StateDelta::Kind::WindowRemoved:
+    case StateDelta::Kind::WindowFocusChanged:
+      // The active window or the solo class of the shown workspace
+      return delta.id == shownWindow_ || delta.workspaceId == shownWorkspace_;
+    default:
+      return false;
+  }
+}
 
 void Window::doUpdate() {
   auto ipcLock = gIPC->lockData();
 
-  const auto &windows = gIPC->windows();
-  const auto &workspaces = gIPC->workspaces();
-
-  const auto separateOutputs = config_["separate-outputs"].asBool();
-  const auto ws_it = std::find_if(workspaces.cbegin(), workspaces.cend(), [&](const auto &ws) {
-    if (separateOutputs) {
-      return ws["is_active"].asBool() && ws["output"].asString() == bar_.output->name;
-    }
-
-    return ws["is_focused"].asBool();
-  });
-
-  std::vector<Json::Value>::const_iterator it;
-  if (ws_it == workspaces.cend() || (*ws_it)["active_window_id"].isNull()) {
-    it = windows.cend();
-  } else {
-    const auto id = (*ws_it)["active_window_id"].asUInt64();
-    it = std::find_if(windows.cbegin(), windows.cend(),
-                      [id](const auto &win) { return win["id"].asUInt64() == id; });
-  }
+  const auto &state = gIPC->state();
 
-  setClass("empty", ws_it == workspaces.cend() || (*ws_it)["active_window_id"].isNull());
+  const auto *ws = config_["separate-outputs"].asBool() ? state.activeWorkspace(bar_.output->name)
+                                                        : state.focusedWorkspace();
+  const auto empty = ws == nullptr || (*ws)["active_window_id"].isNull();
+  const auto *window = empty ? nullptr : state.window((*ws)["active_window_id"].asUInt64());
+  shownWorkspace_ = ws == nullptr ? 0 : (*ws)["id"].asUInt64();
+  shownWindow_ = window == nullptr ? 0 : (*window)["id"].asUInt64();
 
-  if (it != windows.cend()) {
-    const auto &window = *it;
+  setClass("empty", empty);
 
-    const auto title = window["title"].asString();
-    const auto appId = window["app_id"].asString();
+  if (window != nullptr) {
+    const auto title = (*window)["title"].asString();
+    const auto appId = (*window)["app_id"].asString();
     const auto sanitizedTitle = waybar::util::sanitize_string(title);
     const auto sanitizedAppId = waybar::util::sanitize_string(appId);
 
     label_.show();
-    label_.set_markup(waybar::util::rewriteString(
+    label_.set_markup(rewriteRules_.rewrite(
         fmt::format(fmt::runtime(format_), fmt::arg("title", sanitizedTitle),
-                    fmt::arg("app_id", sanitizedAppId)),
-        config_["rewrite"]));
+                    fmt::arg("app_id", sanitizedAppId))));
 
     updateAppIconName(appId, "");
 
     if (tooltipEnabled()) label_.set_tooltip_text(title);
 
-    const auto id = window["id"].asUInt64();
-    const auto workspaceId = window["workspace_id"].asUInt64();
-    const auto isSolo = std::none_of(windows.cbegin(), windows.cend(), [&](const auto &win) {
-      return win["id"].asUInt64() != id && win["workspace_id"].asUInt64() == workspaceId;
-    });
+    const auto isSolo = state.windowCount((*window)["workspace_id"].asUInt64()) <= 1;
     setClass("solo", isSolo);
     if (!appId.empty()) setClass(appId, isSolo);
 
@@ -4,6 +4,8 @@
 #include <gtkmm/label.h>
 #include <spdlog/spdlog.h>
 
+#include <utility>
+
 namespace waybar::modules::niri {
 
 Workspaces::Workspaces(const std::string &id, const Bar &bar, const Json::Value &config)
@@ -17,117 +19,158 @@ Workspaces::Workspaces(const std::string &id, const Bar &bar, const Json::Value
 
   if (!gIPC) gIPC = std::make_unique<IPC>();
 
-  gIPC->registerForIPC("WorkspacesChanged", this);
-  gIPC->registerForIPC("WorkspaceActivated", this);
-  gIPC->registerForIPC("WorkspaceActiveWindowChanged", this);
-  gIPC->registerForIPC("WorkspaceUrgencyChanged", this);
+  gIPC->addListener(this);
 
   dp.emit();
 }
 
-Workspaces::~Workspaces() { gIPC->unregisterForIPC(this); }
+Workspaces::~Workspaces() {
+  // waits for a running onStateChanged
+  gIPC->removeListener(this);
+}
 
-void Workspaces::onEvent(const Json::Value &ev) { dp.emit(); }
+void Workspaces::onStateChanged(const std::vector<StateDelta> &deltas) {
+  bool changed = false;
+  {
+    std::lock_guard lock(mutex_);
+    for (const auto &delta : deltas) {
+      switch (delta.kind) {
+        case StateDelta::Kind::WorkspaceAdded:
+        case StateDelta::Kind::WorkspaceRemoved:
+        case StateDelta::Kind::WorkspaceMoved:
+          rebuild_ = true;
+          changed = true;
+          break;
+        case StateDelta::Kind::WorkspaceChanged:
+        case StateDelta::Kind::WorkspaceActivated:
+          changed_.insert(delta.id);
+          changed = true;
+          break;
+        default:
+          break;
+      }
+    }
+  }
+  if (changed) dp.emit();
+}
+
+bool Workspaces::isShown(const Json::Value &ws) const {
+  return config_["all-outputs"].asBool() || ws["output"].asString() == bar_.output->name;
+}
 
 void Workspaces::doUpdate() {
+  bool full;
+  std::unordered_set<uint64_t> changed;
+  {
+    std::lock_guard lock(mutex_);
+    full = std::exchange(rebuild_, false);
+    changed.swap(changed_);
+  }
+
   auto ipcLock = gIPC->lockData();
+  const auto &state = gIPC->state();
+  if (full) {
+    rebuild(state);
+    return;
+  }
 
+  // Only the buttons of the workspaces that changed
+  for (auto id : changed) {
+    const auto *ws = state.workspace(id);
+    auto bit = buttons_.find(id);
+    if (ws != nullptr && bit != buttons_.end()) updateButton(bit->second, *ws);
+  }
+}
+
+void Workspaces::rebuild(const NiriState &state) {
   const auto alloutputs = config_["all-outputs"].asBool();
-  std::vector<Json::Value> my_workspaces;
-  const auto &workspaces = gIPC->workspaces();
-  std::copy_if(workspaces.cbegin(), workspaces.cend(), std::back_inserter(my_workspaces),
-               [&](const auto &ws) {
-                 if (alloutputs) return true;
-                 return ws["output"].asString() == bar_.output->name;
-               });
 
   // Remove buttons for removed workspaces.
   for (auto it = buttons_.begin(); it != buttons_.end();) {
-    auto ws = std::find_if(my_workspaces.begin(), my_workspaces.end(),
-                           [it](const auto &ws) { return ws["id"].asUInt64() == it->first; });
-    if (ws == my_workspaces.end()) {
+    const auto *ws = state.workspace(it->first);
+    if (ws == nullptr || !isShown(*ws)) {
       it = buttons_.erase(it);
     } else {
       ++it;
     }
   }
 
-  // Add buttons for new workspaces, update existing ones.
-  for (const auto &ws : my_workspaces) {
-    auto bit = buttons_.find(ws["id"].asUInt64());
-    auto &button = bit == buttons_.end() ? addButton(ws) : bit->second;
-    auto style_context = button.get_style_context();
+  // Add buttons for new workspaces, update existing ones, and refresh the button order.
+  unsigned ordinal = 0;
+  for (const auto &[key, ws] : state.workspaces()) {
+    if (!isShown(ws)) continue;
 
-    if (ws["is_focused"].asBool())
-      style_context->add_class("focused");
-    else
-      style_context->remove_class("focused");
+    auto bit = buttons_.find(key.id);
+    auto &button = bit == buttons_.end() ? addButton(ws) : bit->second;
+    updateButton(button, ws);
 
-    if (ws["is_active"].asBool())
-      style_context->add_class("active");
-    else
-      style_context->remove_class("active");
+    auto pos = alloutputs ? ordinal : key.idx - 1;
+    box_.reorder_child(button, pos);
+    ordinal++;
+  }
+}
 
-    if (ws["is_urgent"].asBool())
-      style_context->add_class("urgent");
-    else
-      style_context->remove_class("urgent");
+void Workspaces::updateButton(Gtk::Button &button, const Json::Value &ws) {
+  auto style_context = button.get_style_context();
 
-    if (ws["output"]) {
-      if (ws["output"].asString() == bar_.output->name)
-        style_context->add_class("current_output");
-      else
-        style_context->remove_class("current_output");
-    } else {
-      style_context->remove_class("current_output");
-    }
+  if (ws["is_focused"].asBool())
+    style_context->add_class("focused");
+  else
+    style_context->remove_class("focused");
 
-    if (ws["active_window_id"].isNull())
-      style_context->add_class("empty");
-    else
-      style_context->remove_class("empty");
+  if (ws["is_active"].asBool())
+    style_context->add_class("active");
+  else
+    style_context->remove_class("active");
 
-    std::string name;
-    if (ws["name"]) {
-      name = ws["name"].asString();
-    } else {
-      name = std::to_string(ws["idx"].asUInt());
-    }
-    button.set_name("niri-workspace-" + name);
-
-    if (config_["format"].isString()) {
-      auto format = config_["format"].asString();
-      name = fmt::format(fmt::runtime(format), fmt::arg("icon", getIcon(name, ws)),
-                         fmt::arg("value", name), fmt::arg("name", ws["name"].asString()),
-                         fmt::arg("index", ws["idx"].asUInt()),
-                         fmt::arg("output", ws["output"].asString()));
-    }
-    if (!config_["disable-markup"].asBool()) {
-      static_cast<Gtk::Label *>(button.get_children()[0])->set_markup(name);
-    } else {
-      button.set_label(name);
-    }
+  if (ws["is_urgent"].asBool())
+    style_context->add_class("urgent");
+  else
+    style_context->remove_class("urgent");
 
-    if (config_["current-only"].asBool()) {
-      const auto *property = alloutputs ? "is_focused" : "is_active";
-      if (ws[property].asBool())
-        button.show();
-      else
-        button.hide();
-    } else {
-      button.show();
-    }
+  if (ws["output"]) {
+    if (ws["output"].asString() == bar_.output->name)
+      style_context->add_class("current_output");
+    else
+      style_context->remove_class("current_output");
+  } else {
+    style_context->remove_class("current_output");
   }
 
-  // Refresh the button order.
-  for (auto it = my_workspaces.cbegin(); it != my_workspaces.cend(); ++it) {
-    const auto &ws = *it;
+  if (ws["active_window_id"].isNull())
+    style_context->add_class("empty");
+  else
+    style_context->remove_class("empty");
 
-    auto pos = ws["idx"].asUInt() - 1;
-    if (alloutputs) pos = it - my_workspaces.cbegin();
+  std::string name;
+  if (ws["name"]) {
+    name = ws["name"].asString();
+  } else {
+    name = std::to_string(ws["idx"].asUInt());
+  }
+  button.set_name("niri-workspace-" + name);
+
+  if (config_["format"].isString()) {
+    auto format = config_["format"].asString();
+    name = fmt::format(fmt::runtime(format), fmt::arg("icon", getIcon(name, ws)),
+                       fmt::arg("value", name), fmt::arg("name", ws["name"].asString()),
+                       fmt::arg("index", ws["idx"].asUInt()),
+                       fmt::arg("output", ws["output"].asString()));
+  }
+  if (!config_["disable-markup"].asBool()) {
+    static_cast<Gtk::Label *>(button.get_children()[0])->set_markup(name);
+  } else {
+    button.set_label(name);
+  }
 
-    auto &button = buttons_[ws["id"].asUInt64()];
-    box_.reorder_child(button, pos);
+  if (config_["current-only"].asBool()) {
+    const auto *property = config_["all-outputs"].asBool() ? "is_focused" : "is_active";
+    if (ws[property].asBool())
+      button.show();
+    else
+      button.hide();
+  } else {
+    button.show();
   }
 }
 
@@ -159,7 +202,8 @@ Gtk::Button &Workspaces::addButton(const Json::Value &ws) {
         auto &reference = (focusWorkspace["reference"] = Json::Value(Json::objectValue));
         reference["Id"] = id;
 
-        IPC::send(request);
+        // Clicking faster than the compositor switches only sends the last switch
+        gIPC->queue(std::move(request), "workspace");
       } catch (const std::exception &e) {
         spdlog::error("Error switching workspace: {}", e.what());
       }
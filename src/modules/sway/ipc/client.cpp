@@ -14,20 +14,15 @@ Ipc::Ipc() {
 }
 
 Ipc::~Ipc() {
+  // The worker waits on the stop source while receiving, the sockets can be closed once it's done
   thread_.stop();
+  thread_.join();
 
   if (fd_ > 0) {
-    // To fail the IPC header
-    if (write(fd_, "close-sway-ipc", 14) == -1) {
-      spdlog::error("Failed to close sway IPC");
-    }
     close(fd_);
     fd_ = -1;
   }
   if (fd_event_ > 0) {
-    if (write(fd_event_, "close-sway-ipc", 14) == -1) {
-      spdlog::error("Failed to close sway IPC event handler");
-    }
     close(fd_event_);
     fd_event_ = -1;
   }
@@ -88,11 +83,14 @@ struct Ipc::ipc_response Ipc::recv(int fd) {
   size_t total = 0;
 
   while (total < ipc_header_size_) {
-    auto res = ::recv(fd, header.data() + total, ipc_header_size_ - total, 0);
-    if (fd_event_ == -1 || fd_ == -1) {
-      // IPC is closed so just return an empty response
+    if (!thread_.stop_source().wait(fd)) {
+      // IPC is closing so just return an empty response
       return {0, 0, ""};
     }
+    auto res = ::recv(fd, header.data() + total, ipc_header_size_ - total, 0);
+    if (res < 0 && errno == EINTR) {
+      continue;
+    }
     if (res <= 0) {
       throw std::runtime_error("Unable to receive IPC header");
     }
@@ -120,6 +118,11 @@ struct Ipc::ipc_response Ipc::recv(int fd) {
 }
 
 struct Ipc::ipc_response Ipc::send(int fd, uint32_t type, const std::string& payload) {
+  Ipc::write(fd, type, payload);
+  return Ipc::recv(fd);
+}
+
+void Ipc::write(int fd, uint32_t type, const std::string& payload) {
   std::string header;
   header.resize(ipc_header_size_);
   auto data32 = reinterpret_cast<uint32_t*>(header.data() + ipc_magic_.size());
@@ -133,7 +136,6 @@ struct Ipc::ipc_response Ipc::send(int fd, uint32_t type, const std::string& pay
   if (::send(fd, payload.c_str(), payload.size(), 0) == -1) {
     throw std::runtime_error("Unable to send IPC payload");
   }
-  return Ipc::recv(fd);
 }
 
 void Ipc::sendCmd(uint32_t type, const std::string& payload) {
@@ -151,7 +153,9 @@ void Ipc::subscribe(const std::string& payload) {
 
 void Ipc::handleEvent() {
   const auto res = Ipc::recv(fd_event_);
-  signal_event.emit(res);
+  if (thread_.isRunning()) {
+    signal_event.emit(res);
+  }
 }
 
 }  // namespace waybar::modules::sway
@@ -0,0 +1,251 @@
+#include "modules/sway/ipc/hub.hpp"
+
+#include <poll.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace waybar::modules::sway {
+
+namespace {
+
+constexpr std::array<std::pair<uint32_t, const char*>, 10> EVENT_NAMES = {{
+    {IPC_EVENT_WORKSPACE, "workspace"},
+    {IPC_EVENT_OUTPUT, "output"},
+    {IPC_EVENT_MODE, "mode"},
+    {IPC_EVENT_WINDOW, "window"},
+    {IPC_EVENT_BARCONFIG_UPDATE, "barconfig_update"},
+    {IPC_EVENT_BINDING, "binding"},
+    {IPC_EVENT_SHUTDOWN, "shutdown"},
+    {IPC_EVENT_TICK, "tick"},
+    {IPC_EVENT_BAR_STATE_UPDATE, "bar_state_update"},
+    {IPC_EVENT_INPUT, "input"},
+}};
+
+// Events the tree is kept up to date with
+constexpr uint32_t TREE_EVENTS =
+    event_mask(IPC_EVENT_WINDOW) | event_mask(IPC_EVENT_WORKSPACE) | event_mask(IPC_EVENT_OUTPUT);
+
+/// IPC_SUBSCRIBE payload for the events in `mask`, e.g. ["window","workspace"]
+std::string subscribePayload(uint32_t mask) {
+  std::string payload = "[";
+  for (const auto& [type, name] : EVENT_NAMES) {
+    if ((mask & event_mask(type)) != 0) {
+      payload += payload.size() > 1 ? ",\"" : "\"";
+      payload += name;
+      payload += '"';
+    }
+  }
+  return payload + "]";
+}
+
+/// Log the commands of an IPC_COMMAND reply that failed, e.g. [{"success":false,"error":"..."}]
+void logFailures(const std::string& payload) {
+  for (const auto& result : util::JsonParser().parse(payload)) {
+    if (!result["success"].asBool()) {
+      spdlog::warn("Sway IPC: command failed: {}", result["error"].asString());
+    }
+  }
+}
+
+}  // namespace
+
+IpcHub::IpcHub() {
+  setWorker([this] { handleBurst(); });
+}
+
+IpcHub::~IpcHub() {
+  // The worker uses the members of the hub, stop it before they go away
+  thread_.stop();
+  thread_.join();
+}
+
+IpcHub& IpcHub::inst() {
+  static IpcHub hub;
+  return hub;
+}
+
+void IpcHub::registerForEvents(IpcHandler* handler, std::initializer_list<uint32_t> events) {
+  if (handler == nullptr) {
+    return;
+  }
+  uint32_t mask = 0;
+  for (auto event : events) {
+    mask |= event_mask(event);
+  }
+  subscribe(mask);
+  for (auto event : events) {
+    handlers_.add(event, handler);
+  }
+}
+
+void IpcHub::registerForTree(IpcHandler* handler, std::initializer_list<uint32_t> events) {
+  if (handler == nullptr) {
+    return;
+  }
+  uint32_t mask = 0;
+  for (auto event : events) {
+    mask |= event_mask(event);
+  }
+  subscribe(mask | TREE_EVENTS);
+  handlers_.add(TREE_HANDLERS, handler, mask);
+}
+
+void IpcHub::subscribe(uint32_t events) {
+  std::lock_guard lock(subscribeMutex_);
+  auto missing = events & ~subscribed_;
+  if (missing == 0) {
+    return;
+  }
+  // Subscriptions add up, the worker reads the reply along with the events
+  Ipc::write(fd_event_, IPC_SUBSCRIBE, subscribePayload(missing));
+  subscribed_ |= missing;
+  if ((missing & TREE_EVENTS) != 0) {
+    // Events were missed until now
+    std::lock_guard treeLock(treeMutex_);
+    synced_ = false;
+  }
+}
+
+void IpcHub::unregister(IpcHandler* handler) {
+  if (handler != nullptr) {
+    handlers_.remove(handler);
+  }
+}
+
+struct Ipc::ipc_response IpcHub::sendCmd(uint32_t type, const std::string& payload) {
+  std::lock_guard lock(mutex_);
+  return Ipc::send(fd_, type, payload);
+}
+
+void IpcHub::queueCmd(uint32_t type, std::string payload, std::string key, CmdCallback done) {
+  commands_.push(
+      [this, type, payload = std::move(payload), done = std::move(done)] {
+        auto res = sendCmd(type, payload);
+        if (done) {
+          done(res);
+        } else if (type == IPC_COMMAND) {
+          logFailures(res.payload);
+        }
+      },
+      std::move(key));
+}
+
+IpcHub::Tree IpcHub::tree() {
+  std::lock_guard lock(treeMutex_);
+  if (!synced_) {
+    resyncTreeLocked();
+  }
+  return tree_;
+}
+
+void IpcHub::resyncTreeLocked() {
+  auto root = parser_.parse(sendCmd(IPC_GET_TREE).payload);
+  if (tree_.use_count() > 1) {
+    tree_ = std::make_shared<SwayTree>();
+  }
+  tree_->reset(std::move(root));
+  synced_ = true;
+}
+
+void IpcHub::applyToTree(const std::vector<struct ipc_response>& events,
+                         std::vector<TreeDelta>& deltas) {
+  std::lock_guard lock(treeMutex_);
+  if (synced_) {
+    if (tree_.use_count() > 1) {
+      tree_ = std::make_shared<SwayTree>(*tree_);
+    }
+    try {
+      for (const auto& event : events) {
+        if ((event_mask(event.type) & TREE_EVENTS) == 0) {
+          continue;
+        }
+        if (!tree_->apply(event.type, parser_.parse(event.payload), deltas)) {
+          synced_ = false;
+          break;
+        }
+      }
+    } catch (const std::exception& e) {
+      spdlog::warn("Sway IPC: {}", e.what());
+      synced_ = false;
+    }
+  }
+  if (!synced_) {
+    // Fetched again when a handler needs it
+    deltas.assign({{TreeDelta::Kind::Resynced}});
+  }
+}
+
+bool IpcHub::hasPendingEvent() const {
+  struct pollfd pfd = {fd_event_, POLLIN, 0};
+  return ::poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN) != 0;
+}
+
+void IpcHub::handleBurst() {
+  std::vector<struct ipc_response> events;
+  try {
+    do {
+      auto res = Ipc::recv(fd_event_);
+      if (!thread_.isRunning()) {
+        return;
+      }
+      if ((res.type & IPC_EVENT_WORKSPACE) == 0) {
+        // The reply to a subscription
+        if (res.type == IPC_SUBSCRIBE && res.payload != "{\"success\": true}") {
+          spdlog::error("Sway IPC: unable to subscribe to events: {}", res.payload);
+        }
+        continue;
+      }
+      events.push_back(std::move(res));
+    } while (hasPendingEvent());
+  } catch (const std::exception& e) {
+    // The event socket is unusable, there is nothing left to wait for
+    spdlog::error("Sway IPC: {}", e.what());
+    thread_.stop();
+  }
+
+  if (events.empty()) {
+    return;
+  }
+  std::vector<TreeDelta> deltas;
+  if (std::ranges::any_of(events, [](const auto& event) {
+        return (event_mask(event.type) & TREE_EVENTS) != 0;
+      })) {
+    applyToTree(events, deltas);
+  }
+  dispatch(events, deltas);
+}
+
+void IpcHub::dispatch(const std::vector<struct ipc_response>& events,
+                      const std::vector<TreeDelta>& deltas) {
+  uint32_t burst = 0;
+  for (const auto& event : events) {
+    burst |= event_mask(event.type);
+    handlers_.dispatch(event.type, [&event](IpcHandler& handler, auto) { handler.onEvent(event); });
+  }
+  if (deltas.empty()) {
+    return;
+  }
+
+  Tree tree;
+  bool failed = false;
+  handlers_.dispatch(TREE_HANDLERS, [&](IpcHandler& handler, uint32_t registered) {
+    if (failed || (registered & burst) == 0) {
+      return;
+    }
+    if (!tree) {
+      try {
+        tree = this->tree();
+      } catch (const std::exception& e) {
+        spdlog::error("Sway IPC: {}", e.what());
+        failed = true;
+        return;
+      }
+    }
+    handler.onTree(*tree, deltas);
+  });
+}
+
+}  // namespace waybar::modules::sway
@@ -0,0 +1,241 @@
+#include "modules/sway/ipc/tree.hpp"
+
+#include <utility>
+
+#include "modules/sway/ipc/ipc.hpp"
+
+namespace waybar::modules::sway {
+
+namespace {
+
+constexpr const char* CHILDREN[] = {"nodes", "floating_nodes"};
+
+}  // namespace
+
+SwayTree::SwayTree(const SwayTree& other) : root_(other.root_) { index(root_, -1); }
+
+void SwayTree::reset(Json::Value root) {
+  nodes_.clear();
+  focused_ = -1;
+  root_ = std::move(root);
+  index(root_, -1);
+}
+
+const Json::Value* SwayTree::node(int64_t id) const {
+  auto it = nodes_.find(id);
+  return it == nodes_.end() ? nullptr : it->second.node;
+}
+
+const Json::Value* SwayTree::workspaceOf(int64_t id) const {
+  for (auto it = nodes_.find(id); it != nodes_.end(); it = nodes_.find(it->second.parent)) {
+    const auto& type = (*it->second.node)["type"];
+    if (type == "workspace") {
+      return it->second.node;
+    }
+    if (type == "output") {
+      return nullptr;
+    }
+  }
+  return nullptr;
+}
+
+bool SwayTree::apply(uint32_t type, const Json::Value& event, std::vector<TreeDelta>& deltas) {
+  switch (type) {
+    case IPC_EVENT_WINDOW:
+      return applyWindow(event, deltas);
+    case IPC_EVENT_WORKSPACE:
+      return applyWorkspace(event, deltas);
+    default:
+      return false;
+  }
+}
+
+bool SwayTree::applyWindow(const Json::Value& event, std::vector<TreeDelta>& deltas) {
+  const auto& container = event["container"];
+  const auto id = container["id"].asInt64();
+  const auto change = event["change"].asString();
+
+  if (change == "title") {
+    deltas.push_back({TreeDelta::Kind::TitleChanged, id});
+    return replace(container);
+  }
+  if (change == "urgent" || change == "mark" || change == "fullscreen_mode") {
+    deltas.push_back({TreeDelta::Kind::NodeChanged, id});
+    return replace(container);
+  }
+  if (change == "close") {
+    deltas.push_back({TreeDelta::Kind::NodeRemoved, id});
+    return remove(id);
+  }
+  if (change == "focus") {
+    if (auto it = nodes_.find(focused_); it != nodes_.end()) {
+      (*it->second.node)["focused"] = false;
+    }
+    deltas.push_back({TreeDelta::Kind::FocusChanged, id});
+    if (!replace(container)) {
+      return false;
+    }
+    (*nodes_.at(id).node)["focused"] = true;
+    focused_ = id;
+    return true;
+  }
+  // "new", "move" and "floating" don't tell the new parent of the container
+  return false;
+}
+
+bool SwayTree::applyWorkspace(const Json::Value& event, std::vector<TreeDelta>& deltas) {
+  const auto& current = event["current"];
+  const auto id = current["id"].asInt64();
+  const auto change = event["change"].asString();
+
+  if (change == "init") {
+    deltas.push_back({TreeDelta::Kind::WorkspaceAdded, id});
+    if (nodes_.contains(id)) {
+      return replace(current);
+    }
+    auto* parent = output(current["output"].asString());
+    if (parent == nullptr) {
+      return false;
+    }
+    // Arrays are maps in jsoncpp, appending doesn't move the other children
+    index((*parent)["nodes"].append(current), (*parent)["id"].asInt64());
+    return true;
+  }
+  if (change == "empty") {
+    deltas.push_back({TreeDelta::Kind::WorkspaceRemoved, id});
+    return remove(id);
+  }
+  if (change == "focus") {
+    deltas.push_back({TreeDelta::Kind::FocusChanged, id});
+    const auto& old = event["old"];
+    if (old.isObject() && nodes_.contains(old["id"].asInt64()) && !replace(old)) {
+      return false;
+    }
+    auto* parent = output(current["output"].asString());
+    if (parent == nullptr || !replace(current)) {
+      return false;
+    }
+    (*parent)["current_workspace"] = current["name"];
+    // When the focus comes from another output, "old" is the workspace there: the one that was
+    // visible on this output is only hidden by sway, without an event of its own
+    for (auto& workspace : (*parent)["nodes"]) {
+      const auto visible = workspace["name"] == current["name"];
+      if (workspace["visible"].asBool() != visible) {
+        workspace["visible"] = visible;
+        deltas.push_back({TreeDelta::Kind::WorkspaceChanged, workspace["id"].asInt64()});
+      }
+    }
+    return true;
+  }
+  if (change == "rename") {
+    deltas.push_back({TreeDelta::Kind::WorkspaceChanged, id});
+    const auto* workspace = node(id);
+    if (workspace == nullptr) {
+      return false;
+    }
+    auto oldName = (*workspace)["name"].asString();
+    auto* parent = output(current["output"].asString());
+    if (parent == nullptr || !replace(current)) {
+      return false;
+    }
+    if ((*parent)["current_workspace"].asString() == oldName) {
+      (*parent)["current_workspace"] = current["name"];
+    }
+    return true;
+  }
+  if (change == "urgent") {
+    deltas.push_back({TreeDelta::Kind::WorkspaceChanged, id});
+    return replace(current);
+  }
+  // "move" changes the output and "reload" may change anything
+  return false;
+}
+
+void SwayTree::index(Json::Value& node, int64_t parent) {
+  const auto id = node["id"].asInt64();
+  nodes_[id] = {&node, parent};
+  if (node["focused"].asBool()) {
+    focused_ = id;
+  }
+  for (const auto* key : CHILDREN) {
+    if (!node.isMember(key)) {
+      continue;
+    }
+    for (auto& child : node[key]) {
+      index(child, id);
+    }
+  }
+}
+
+void SwayTree::unindex(const Json::Value& node) {
+  const auto id = node["id"].asInt64();
+  nodes_.erase(id);
+  if (focused_ == id) {
+    focused_ = -1;
+  }
+  for (const auto* key : CHILDREN) {
+    for (const auto& child : node[key]) {
+      unindex(child);
+    }
+  }
+}
+
+bool SwayTree::replace(const Json::Value& container) {
+  auto it = nodes_.find(container["id"].asInt64());
+  if (it == nodes_.end()) {
+    return false;
+  }
+  auto [node, parent] = it->second;
+  unindex(*node);
+  *node = container;
+  index(*node, parent);
+  return true;
+}
+
+bool SwayTree::remove(int64_t id) {
+  auto it = nodes_.find(id);
+  if (it == nodes_.end()) {
+    return false;
+  }
+  const auto parentId = it->second.parent;
+  auto parentIt = nodes_.find(parentId);
+  if (parentIt == nodes_.end()) {
+    return false;
+  }
+  auto [parent, grandParent] = parentIt->second;
+
+  for (const auto* key : CHILDREN) {
+    if (!parent->isMember(key)) {
+      continue;
+    }
+    auto& children = (*parent)[key];
+    for (Json::ArrayIndex i = 0; i < children.size(); i++) {
+      if (children[i]["id"].asInt64() != id) {
+        continue;
+      }
+      // Removing shifts the next children into other values, index the parent again
+      unindex(*parent);
+      children.removeIndex(i, nullptr);
+      index(*parent, grandParent);
+      // Sway reaps the split containers left empty, without an event
+      const auto& container = *parent;
+      if ((container["type"] == "con" || container["type"] == "floating_con") &&
+          container["nodes"].empty() && container["floating_nodes"].empty()) {
+        return remove(parentId);
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+Json::Value* SwayTree::output(const std::string& name) {
+  for (auto& output : root_["nodes"]) {
+    if (output["name"].asString() == name) {
+      return &output;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace waybar::modules::sway
@@ -18,7 +18,7 @@ const std::string Language::XKB_LAYOUT_NAMES_KEY = "xkb_layout_names";
 const std::string Language::XKB_ACTIVE_LAYOUT_NAME_KEY = "xkb_active_layout_name";
 
 Language::Language(const std::string& id, const Json::Value& config)
-    : ALabel(config, "language", id, "{}", 0, true) {
+    : ALabel(config, "language", id, "{}", 0, true), ipc_(IpcHub::inst()) {
   hide_single_ = config["hide-single-layout"].isBool() && config["hide-single-layout"].asBool();
   is_variant_displayed = format_.find("{variant}") != std::string::npos;
   if (format_.find("{}") != std::string::npos || format_.find("{short}") != std::string::npos) {
@@ -30,21 +30,13 @@ Language::Language(const std::string& id, const Json::Value& config)
   if (config.isMember("tooltip-format")) {
     tooltip_format_ = config["tooltip-format"].asString();
   }
-  ipc_.subscribe(R"(["input"])");
-  ipc_.signal_event.connect(sigc::mem_fun(*this, &Language::onEvent));
-  ipc_.signal_cmd.connect(sigc::mem_fun(*this, &Language::onCmd));
-  ipc_.sendCmd(IPC_GET_INPUTS);
-  // Launch worker
-  ipc_.setWorker([this] {
-    try {
-      ipc_.handleEvent();
-    } catch (const std::exception& e) {
-      spdlog::error("Language: {}", e.what());
-    }
-  });
+  onCmd(ipc_.sendCmd(IPC_GET_INPUTS));
+  ipc_.registerForEvents(this, {IPC_EVENT_INPUT});
   dp.emit();
 }
 
+Language::~Language() { ipc_.unregister(this); }
+
 void Language::onCmd(const struct Ipc::ipc_response& res) {
   if (res.type != IPC_GET_INPUTS) {
     return;
@@ -5,20 +5,13 @@
 namespace waybar::modules::sway {
 
 Mode::Mode(const std::string& id, const Json::Value& config)
-    : ALabel(config, "mode", id, "{}", 0, true) {
-  ipc_.subscribe(R"(["mode"])");
-  ipc_.signal_event.connect(sigc::mem_fun(*this, &Mode::onEvent));
-  // Launch worker
-  ipc_.setWorker([this] {
-    try {
-      ipc_.handleEvent();
-    } catch (const std::exception& e) {
-      spdlog::error("Mode: {}", e.what());
-    }
-  });
+    : ALabel(config, "mode", id, "{}", 0, true), ipc_(IpcHub::inst()) {
+  ipc_.registerForEvents(this, {IPC_EVENT_MODE});
   dp.emit();
 }
 
+Mode::~Mode() { ipc_.unregister(this); }
+
 void Mode::onEvent(const struct Ipc::ipc_response& res) {
   try {
     std::lock_guard<std::mutex> lock(mutex_);
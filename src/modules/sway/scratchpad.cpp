@@ -2,6 +2,7 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <string>
 
 namespace waybar::modules::sway {
@@ -13,21 +14,19 @@ Scratchpad::Scratchpad(const std::string& id, const Json::Value& config)
       show_empty_(config_["show-empty"].isBool() ? config_["show-empty"].asBool() : false),
       tooltip_enabled_(config_["tooltip"].isBool() ? config_["tooltip"].asBool() : true),
       tooltip_text_(""),
-      count_(0) {
-  ipc_.subscribe(R"(["window"])");
-  ipc_.signal_event.connect(sigc::mem_fun(*this, &Scratchpad::onEvent));
-  ipc_.signal_cmd.connect(sigc::mem_fun(*this, &Scratchpad::onCmd));
+      count_(0),
+      ipc_(IpcHub::inst()) {
+  ipc_.registerForTree(this, {IPC_EVENT_WINDOW});
 
-  getTree();
-
-  ipc_.setWorker([this] {
-    try {
-      ipc_.handleEvent();
-    } catch (const std::exception& e) {
-      spdlog::error("Scratchpad: {}", e.what());
-    }
-  });
+  try {
+    onTree(*ipc_.tree(), {{TreeDelta::Kind::Resynced}});
+  } catch (const std::exception& e) {
+    spdlog::error("Scratchpad: {}", e.what());
+  }
 }
+
+Scratchpad::~Scratchpad() { ipc_.unregister(this); }
+
 auto Scratchpad::update() -> void {
   if (count_ || show_empty_) {
     event_box_.show();
@@ -49,22 +48,23 @@ auto Scratchpad::update() -> void {
   ALabel::update();
 }
 
-auto Scratchpad::getTree() -> void {
-  try {
-    ipc_.sendCmd(IPC_GET_TREE);
-  } catch (const std::exception& e) {
-    spdlog::error("Scratchpad: {}", e.what());
+auto Scratchpad::onTree(const SwayTree& tree, const std::vector<TreeDelta>& deltas) -> void {
+  const auto& scratchpad = tree.root()["nodes"][0]["nodes"][0];
+  // Only the windows in the scratchpad show, and not whether they are focused
+  if (std::all_of(deltas.begin(), deltas.end(), [&](const auto& delta) {
+        return (delta.kind == TreeDelta::Kind::TitleChanged ||
+                delta.kind == TreeDelta::Kind::NodeChanged ||
+                delta.kind == TreeDelta::Kind::FocusChanged) &&
+               tree.workspaceOf(delta.id) != &scratchpad;
+      })) {
+    return;
   }
-}
-
-auto Scratchpad::onCmd(const struct Ipc::ipc_response& res) -> void {
   try {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto tree = parser_.parse(res.payload);
-    count_ = tree["nodes"][0]["nodes"][0]["floating_nodes"].size();
+    count_ = scratchpad["floating_nodes"].size();
     if (tooltip_enabled_) {
       tooltip_text_.clear();
-      for (const auto& window : tree["nodes"][0]["nodes"][0]["floating_nodes"]) {
+      for (const auto& window : scratchpad["floating_nodes"]) {
         tooltip_text_.append(fmt::format(fmt::runtime(tooltip_format_ + '\n'),
                                          fmt::arg("app", window["app_id"].asString()),
                                          fmt::arg("title", window["name"].asString())));
@@ -78,6 +78,4 @@ auto Scratchpad::onCmd(const struct Ipc::ipc_response& res) -> void {
     spdlog::error("Scratchpad: {}", e.what());
   }
 }
-
-auto Scratchpad::onEvent(const struct Ipc::ipc_response& res) -> void { getTree(); }
 }  // namespace waybar::modules::sway
\ No newline at end of file
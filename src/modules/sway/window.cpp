@@ -7,6 +7,7 @@
 #include <gtkmm/enums.h>
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <regex>
 #include <string>
@@ -17,37 +18,42 @@
 namespace waybar::modules::sway {
 
 Window::Window(const std::string& id, const Bar& bar, const Json::Value& config)
-    : AAppIconLabel(config, "window", id, "{}", 0, true), bar_(bar), windowId_(-1) {
-  ipc_.subscribe(R"(["window","workspace"])");
-  ipc_.signal_event.connect(sigc::mem_fun(*this, &Window::onEvent));
-  ipc_.signal_cmd.connect(sigc::mem_fun(*this, &Window::onCmd));
+    : AAppIconLabel(config, "window", id, "{}", 0, true),
+      bar_(bar),
+      rewrite_rules_(config["rewrite"]),
+      windowId_(-1),
+      ipc_(IpcHub::inst()) {
+  ipc_.registerForTree(this, {IPC_EVENT_WINDOW, IPC_EVENT_WORKSPACE});
   // Get Initial focused window
-  getTree();
-  // Launch worker
-  ipc_.setWorker([this] {
-    try {
-      ipc_.handleEvent();
-    } catch (const std::exception& e) {
-      spdlog::error("Window: {}", e.what());
-      spdlog::trace("Window::Window exception");
-    }
-  });
+  try {
+    onTree(*ipc_.tree(), {{TreeDelta::Kind::Resynced}});
+  } catch (const std::exception& e) {
+    spdlog::error("Window: {}", e.what());
+    spdlog::trace("Window::Window exception");
+  }
 }
 
-void Window::onEvent(const struct Ipc::ipc_response& res) { getTree(); }
+Window::~Window() { ipc_.unregister(this); }
 
-void Window::onCmd(const struct Ipc::ipc_response& res) {
+void Window::onTree(const SwayTree& tree, const std::vector<TreeDelta>& deltas) {
+  // Other windows changing don't show, e.g. the title updates of background terminals
+  auto focused = tree.focusedId();
+  if (std::all_of(deltas.begin(), deltas.end(), [focused](const auto& delta) {
+        return delta.kind == TreeDelta::Kind::TitleChanged && delta.id != focused;
+      })) {
+    return;
+  }
   try {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto payload = parser_.parse(res.payload);
-    auto output = payload["output"].isString() ? payload["output"].asString() : "";
+    const auto& root = tree.root();
+    auto output = root["output"].isString() ? root["output"].asString() : "";
     std::tie(app_nb_, floating_count_, windowId_, window_, app_id_, app_class_, shell_, layout_,
-             marks_) = getFocusedNode(payload["nodes"], output);
+             marks_) = getFocusedNode(root["nodes"], output);
     updateAppIconName(app_id_, app_class_);
     dp.emit();
   } catch (const std::exception& e) {
     spdlog::error("Window: {}", e.what());
-    spdlog::trace("Window::onCmd exception");
+    spdlog::trace("Window::onTree exception");
   }
 }
 
@@ -94,10 +100,9 @@ auto Window::update() -> void {
     old_app_id_ = app_id_;
   }
 
-  label_.set_markup(waybar::util::rewriteString(
+  label_.set_markup(rewrite_rules_.rewrite(
       fmt::format(fmt::runtime(format_), fmt::arg("title", window_), fmt::arg("app_id", app_id_),
-                  fmt::arg("shell", shell_), fmt::arg("marks", marks_)),
-      config_["rewrite"]));
+                  fmt::arg("shell", shell_), fmt::arg("marks", marks_))));
   if (tooltipEnabled()) {
     label_.set_tooltip_text(window_);
   }
@@ -306,13 +311,4 @@ Window::getFocusedNode(const Json::Value& nodes, std::string& output) {
   return gfnWithWorkspace(nodes, output, config_, bar_, placeholder, placeholder);
 }
 
-void Window::getTree() {
-  try {
-    ipc_.sendCmd(IPC_GET_TREE);
-  } catch (const std::exception& e) {
-    spdlog::error("Window: {}", e.what());
-    spdlog::trace("Window::getTree exception");
-  }
-}
-
 }  // namespace waybar::modules::sway
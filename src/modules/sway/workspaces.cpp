@@ -44,7 +44,8 @@ int Workspaces::windowRewritePriorityFunction(std::string const &window_rule) {
 Workspaces::Workspaces(const std::string &id, const Bar &bar, const Json::Value &config)
     : AModule(config, "workspaces", id, false, !config["disable-scroll"].asBool()),
       bar_(bar),
-      box_(bar.orientation, 0) {
+      box_(bar.orientation, 0),
+      ipc_(IpcHub::inst()) {
   if (config["format-icons"]["high-priority-named"].isArray()) {
     for (const auto &it : config["format-icons"]["high-priority-named"]) {
       high_priority_named_.push_back(it.asString());
@@ -69,167 +70,174 @@ Workspaces::Workspaces(const std::string &id, const Bar &bar, const Json::Value
     m_windowRewriteRules = waybar::util::RegexCollection(
         windowRewrite, std::move(windowRewriteDefault), windowRewritePriorityFunction);
   }
-  ipc_.subscribe(R"(["workspace"])");
-  ipc_.subscribe(R"(["window"])");
-  ipc_.signal_event.connect(sigc::mem_fun(*this, &Workspaces::onEvent));
-  ipc_.signal_cmd.connect(sigc::mem_fun(*this, &Workspaces::onCmd));
-  ipc_.sendCmd(IPC_GET_TREE);
+  ipc_.registerForTree(this, {IPC_EVENT_WORKSPACE, IPC_EVENT_WINDOW});
+  {
+    // Registered first so that no event is missed. The snapshot is taken under digestMutex_: a
+    // burst dispatched meanwhile is digested after it, not overwritten by it.
+    std::lock_guard<std::mutex> lock(digestMutex_);
+    digestTree(*ipc_.tree());
+  }
   if (config["enable-bar-scroll"].asBool()) {
     auto &window = const_cast<Bar &>(bar_).window;
     window.add_events(Gdk::SCROLL_MASK | Gdk::SMOOTH_SCROLL_MASK);
     window.signal_scroll_event().connect(sigc::mem_fun(*this, &Workspaces::handleScroll));
   }
-  // Launch worker
-  ipc_.setWorker([this] {
-    try {
-      ipc_.handleEvent();
-    } catch (const std::exception &e) {
-      spdlog::error("Workspaces: {}", e.what());
-    }
-  });
 }
 
-void Workspaces::onEvent(const struct Ipc::ipc_response &res) {
-  try {
-    ipc_.sendCmd(IPC_GET_TREE);
-  } catch (const std::exception &e) {
-    spdlog::error("Workspaces: {}", e.what());
+Workspaces::~Workspaces() { ipc_.unregister(this); }
+
+void Workspaces::onTree(const SwayTree &tree, const std::vector<TreeDelta> &deltas) {
+  // Window titles only show in the window-format
+  if (!config_["window-format"].isString() &&
+      std::all_of(deltas.begin(), deltas.end(), [](const auto &delta) {
+        return delta.kind == TreeDelta::Kind::TitleChanged;
+      })) {
+    return;
   }
+  std::lock_guard<std::mutex> lock(digestMutex_);
+  digestTree(tree);
 }
 
-void Workspaces::onCmd(const struct Ipc::ipc_response &res) {
-  if (res.type == IPC_GET_TREE) {
-    try {
-      {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto payload = parser_.parse(res.payload);
-        workspaces_.clear();
-        std::vector<Json::Value> outputs;
-        bool alloutputs = config_["all-outputs"].asBool();
-        std::copy_if(payload["nodes"].begin(), payload["nodes"].end(), std::back_inserter(outputs),
-                     [&](const auto &output) {
-                       if (alloutputs && output["name"].asString() != "__i3") {
-                         return true;
-                       }
-                       if (output["name"].asString() == bar_.output->name) {
-                         return true;
-                       }
-                       return false;
-                     });
-
-        for (auto &output : outputs) {
-          std::copy(output["nodes"].begin(), output["nodes"].end(),
-                    std::back_inserter(workspaces_));
-          std::copy(output["floating_nodes"].begin(), output["floating_nodes"].end(),
-                    std::back_inserter(workspaces_));
-        }
+void Workspaces::digestTree(const SwayTree &tree) {
+  try {
+    const auto *focused = tree.workspaceOf(tree.focusedId());
+    auto focusedId = focused != nullptr ? (*focused)["id"].asInt64() : -1;
+    const auto &root = tree.root();
+    std::vector<Json::Value> workspaces;
+    std::vector<Json::Value> outputs;
+    bool alloutputs = config_["all-outputs"].asBool();
+    std::copy_if(root["nodes"].begin(), root["nodes"].end(), std::back_inserter(outputs),
+                 [&](const auto &output) {
+                   if (alloutputs && output["name"].asString() != "__i3") {
+                     return true;
+                   }
+                   if (output["name"].asString() == bar_.output->name) {
+                     return true;
+                   }
+                   return false;
+                 });
+
+    for (auto &output : outputs) {
+      std::copy(output["nodes"].begin(), output["nodes"].end(), std::back_inserter(workspaces));
+      std::copy(output["floating_nodes"].begin(), output["floating_nodes"].end(),
+                std::back_inserter(workspaces));
+    }
 
-        // adding persistent workspaces (as per the config file)
-        if (config_["persistent-workspaces"].isObject()) {
-          const Json::Value &p_workspaces = config_["persistent-workspaces"];
-          const std::vector<std::string> p_workspaces_names = p_workspaces.getMemberNames();
+    // adding persistent workspaces (as per the config file)
+    if (config_["persistent-workspaces"].isObject()) {
+      const Json::Value &p_workspaces = config_["persistent-workspaces"];
+      const std::vector<std::string> p_workspaces_names = p_workspaces.getMemberNames();
 
-          for (const std::string &p_w_name : p_workspaces_names) {
-            const Json::Value &p_w = p_workspaces[p_w_name];
-            auto it = std::find_if(workspaces_.begin(), workspaces_.end(),
-                                   [&p_w_name](const Json::Value &node) {
-                                     return node["name"].asString() == p_w_name;
-                                   });
+      for (const std::string &p_w_name : p_workspaces_names) {
+        const Json::Value &p_w = p_workspaces[p_w_name];
+        auto it = std::find_if(workspaces.begin(), workspaces.end(),
+                               [&p_w_name](const Json::Value &node) {
+                                 return node["name"].asString() == p_w_name;
+                               });
 
-            if (it != workspaces_.end()) {
-              continue;  // already displayed by some bar
-            }
+        if (it != workspaces.end()) {
+          continue;  // already displayed by some bar
+        }
 
-            if (p_w.isArray() && !p_w.empty()) {
-              // Adding to target outputs
-              for (const Json::Value &output : p_w) {
-                if (output.asString() == bar_.output->name) {
-                  Json::Value v;
-                  v["name"] = p_w_name;
-                  v["target_output"] = bar_.output->name;
-                  v["num"] = convertWorkspaceNameToNum(p_w_name);
-                  workspaces_.emplace_back(std::move(v));
-                  break;
-                }
-              }
-            } else {
-              // Adding to all outputs
+        if (p_w.isArray() && !p_w.empty()) {
+          // Adding to target outputs
+          for (const Json::Value &output : p_w) {
+            if (output.asString() == bar_.output->name) {
               Json::Value v;
               v["name"] = p_w_name;
-              v["target_output"] = "";
+              v["target_output"] = bar_.output->name;
               v["num"] = convertWorkspaceNameToNum(p_w_name);
-              workspaces_.emplace_back(std::move(v));
+              workspaces.emplace_back(std::move(v));
+              break;
             }
           }
+        } else {
+          // Adding to all outputs
+          Json::Value v;
+          v["name"] = p_w_name;
+          v["target_output"] = "";
+          v["num"] = convertWorkspaceNameToNum(p_w_name);
+          workspaces.emplace_back(std::move(v));
         }
+      }
+    }
 
-        // sway has a defined ordering of workspaces that should be preserved in
-        // the representation displayed by waybar to ensure that commands such
-        // as "workspace prev" or "workspace next" make sense when looking at
-        // the workspace representation in the bar.
-        // Due to waybar's own feature of persistent workspaces unknown to sway,
-        // custom sorting logic is necessary to make these workspaces appear
-        // naturally in the list of workspaces without messing up sway's
-        // sorting. For this purpose, a custom numbering property is created
-        // that preserves the order provided by sway while inserting numbered
-        // persistent workspaces at their natural positions.
-        //
-        // All of this code assumes that sway provides numbered workspaces first
-        // and other workspaces are sorted by their creation time.
-        //
-        // In a first pass, the maximum "num" value is computed to enqueue
-        // unnumbered workspaces behind numbered ones when computing the sort
-        // attribute.
-        //
-        // Note: if the 'alphabetical_sort' option is true, the user is in
-        // agreement that the "workspace prev/next" commands may not follow
-        // the order displayed in Waybar.
-        int max_num = -1;
-        for (auto &workspace : workspaces_) {
-          max_num = std::max(workspace["num"].asInt(), max_num);
-        }
-        for (auto &workspace : workspaces_) {
-          auto workspace_num = workspace["num"].asInt();
-          if (workspace_num > -1) {
-            workspace["sort"] = workspace_num;
-          } else {
-            workspace["sort"] = ++max_num;
-          }
-        }
-        std::sort(workspaces_.begin(), workspaces_.end(),
-                  [this](const Json::Value &lhs, const Json::Value &rhs) {
-                    auto lname = lhs["name"].asString();
-                    auto rname = rhs["name"].asString();
-                    int l = lhs["sort"].asInt();
-                    int r = rhs["sort"].asInt();
-
-                    if (l == r || config_["alphabetical_sort"].asBool()) {
-                      // In case both integers are the same, lexicographical
-                      // sort. The code above already ensure that this will only
-                      // happened in case of explicitly numbered workspaces.
-                      //
-                      // Additionally, if the config specifies to sort workspaces
-                      // alphabetically do this here.
-                      return lname < rname;
-                    }
-
-                    return l < r;
-                  });
+    // sway has a defined ordering of workspaces that should be preserved in
+    // the representation displayed by waybar to ensure that commands such
+    // as "workspace prev" or "workspace next" make sense when looking at
+    // the workspace representation in the bar.
+    // Due to waybar's own feature of persistent workspaces unknown to sway,
+    // custom sorting logic is necessary to make these workspaces appear
+    // naturally in the list of workspaces without messing up sway's
+    // sorting. For this purpose, a custom numbering property is created
+    // that preserves the order provided by sway while inserting numbered
+    // persistent workspaces at their natural positions.
+    //
+    // All of this code assumes that sway provides numbered workspaces first
+    // and other workspaces are sorted by their creation time.
+    //
+    // In a first pass, the maximum "num" value is computed to enqueue
+    // unnumbered workspaces behind numbered ones when computing the sort
+    // attribute.
+    //
+    // Note: if the 'alphabetical_sort' option is true, the user is in
+    // agreement that the "workspace prev/next" commands may not follow
+    // the order displayed in Waybar.
+    int max_num = -1;
+    for (auto &workspace : workspaces) {
+      max_num = std::max(workspace["num"].asInt(), max_num);
+    }
+    for (auto &workspace : workspaces) {
+      auto workspace_num = workspace["num"].asInt();
+      if (workspace_num > -1) {
+        workspace["sort"] = workspace_num;
+      } else {
+        workspace["sort"] = ++max_num;
       }
-      dp.emit();
-    } catch (const std::exception &e) {
-      spdlog::error("Workspaces: {}", e.what());
     }
+    std::sort(workspaces.begin(), workspaces.end(),
+              [this](const Json::Value &lhs, const Json::Value &rhs) {
+                auto lname = lhs["name"].asString();
+                auto rname = rhs["name"].asString();
+                int l = lhs["sort"].asInt();
+                int r = rhs["sort"].asInt();
+
+                if (l == r || config_["alphabetical_sort"].asBool()) {
+                  // In case both integers are the same, lexicographical
+                  // sort. The code above already ensure that this will only
+                  // happened in case of explicitly numbered workspaces.
+                  //
+                  // Additionally, if the config specifies to sort workspaces
+                  // alphabetically do this here.
+                  return lname < rname;
+                }
+
+                return l < r;
+              });
+
+    // Digested here, update() only has the widgets to change
+    auto states = std::make_shared<WorkspaceStates>();
+    states->reserve(workspaces.size());
+    for (auto &workspace : workspaces) {
+      states->push_back(digest(std::move(workspace), focusedId));
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      workspaces_ = std::move(states);
+    }
+    dp.emit();
+  } catch (const std::exception &e) {
+    spdlog::error("Workspaces: {}", e.what());
   }
 }
 
-bool Workspaces::filterButtons() {
+bool Workspaces::filterButtons(const WorkspaceStates &workspaces) {
   bool needReorder = false;
   for (auto it = buttons_.begin(); it != buttons_.end();) {
-    auto ws = std::find_if(workspaces_.begin(), workspaces_.end(),
-                           [it](const auto &node) { return node["name"].asString() == it->first; });
-    if (ws == workspaces_.end() ||
-        (!config_["all-outputs"].asBool() && (*ws)["output"].asString() != bar_.output->name)) {
+    auto ws = std::find_if(workspaces.begin(), workspaces.end(),
+                           [it](const auto &workspace) { return workspace.name == it->first; });
+    if (ws == workspaces.end() ||
+        (!config_["all-outputs"].asBool() && ws->node["output"].asString() != bar_.output->name)) {
       it = buttons_.erase(it);
       needReorder = true;
     } else {
@@ -282,71 +290,75 @@ void Workspaces::updateWindows(const Json::Value &node, std::string &windows) {
   }
 }
 
+Workspaces::WorkspaceState Workspaces::digest(Json::Value node, int64_t focused) {
+  WorkspaceState state;
+  state.name = node["name"].asString();
+  // Persistent workspaces not created yet have no id
+  state.focused = node.isMember("id") && node["id"].asInt64() == focused;
+  state.empty = node["nodes"].empty() && node["floating_nodes"].empty();
+  state.visible = hasFlag(node, "visible") || (node["output"].isString() && state.empty);
+  state.urgent = hasFlag(node, "urgent");
+  std::string windows = "";
+  if (config_["window-format"].isString()) {
+    updateWindows(node, windows);
+  }
+  // The containers are not needed past this point
+  node.removeMember("nodes");
+  node.removeMember("floating_nodes");
+  state.node = std::move(node);
+
+  state.label = state.name;
+  if (config_["format"].isString()) {
+    auto format = config_["format"].asString();
+    state.label = fmt::format(
+        fmt::runtime(format), fmt::arg("icon", getIcon(state)), fmt::arg("value", state.name),
+        fmt::arg("name", trimWorkspaceName(state.name)),
+        fmt::arg("index", state.node["num"].asString()),
+        fmt::arg("windows", windows.substr(0, windows.length() - m_formatWindowSeparator.length())),
+        fmt::arg("output", state.node["output"].asString()));
+  }
+  return state;
+}
+
+void Workspaces::setClass(Gtk::Button &button, const std::string &classname, bool enable) {
+  if (enable) {
+    button.get_style_context()->add_class(classname);
+  } else {
+    button.get_style_context()->remove_class(classname);
+  }
+}
+
 auto Workspaces::update() -> void {
-  std::lock_guard<std::mutex> lock(mutex_);
-  bool needReorder = filterButtons();
-  for (auto it = workspaces_.begin(); it != workspaces_.end(); ++it) {
-    auto bit = buttons_.find((*it)["name"].asString());
-    if (bit == buttons_.end()) {
+  std::shared_ptr<const WorkspaceStates> workspaces;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    workspaces = workspaces_;
+  }
+  bool needReorder = filterButtons(*workspaces);
+  for (auto it = workspaces->begin(); it != workspaces->end(); ++it) {
+    auto bit = buttons_.find(it->name);
+    bool added = bit == buttons_.end();
+    if (added) {
       needReorder = true;
     }
-    auto &button = bit == buttons_.end() ? addButton(*it) : bit->second;
+    auto &button = added ? addButton(it->node) : bit->second;
     if (needReorder) {
-      box_.reorder_child(button, it - workspaces_.begin());
-    }
-    bool noNodes = (*it)["nodes"].empty() && (*it)["floating_nodes"].empty();
-    if (hasFlag((*it), "focused")) {
-      button.get_style_context()->add_class("focused");
-    } else {
-      button.get_style_context()->remove_class("focused");
-    }
-    if (hasFlag((*it), "visible") || ((*it)["output"].isString() && noNodes)) {
-      button.get_style_context()->add_class("visible");
-    } else {
-      button.get_style_context()->remove_class("visible");
-    }
-    if (hasFlag((*it), "urgent")) {
-      button.get_style_context()->add_class("urgent");
-    } else {
-      button.get_style_context()->remove_class("urgent");
-    }
-    if ((*it)["target_output"].isString()) {
-      button.get_style_context()->add_class("persistent");
-    } else {
-      button.get_style_context()->remove_class("persistent");
-    }
-    if (noNodes) {
-      button.get_style_context()->add_class("empty");
-    } else {
-      button.get_style_context()->remove_class("empty");
-    }
-    if ((*it)["output"].isString()) {
-      if (((*it)["output"].asString()) == bar_.output->name) {
-        button.get_style_context()->add_class("current_output");
-      } else {
-        button.get_style_context()->remove_class("current_output");
-      }
-    } else {
-      button.get_style_context()->remove_class("current_output");
-    }
-    std::string output = (*it)["name"].asString();
-    std::string windows = "";
-    if (config_["window-format"].isString()) {
-      updateWindows((*it), windows);
-    }
-    if (config_["format"].isString()) {
-      auto format = config_["format"].asString();
-      output = fmt::format(
-          fmt::runtime(format), fmt::arg("icon", getIcon(output, *it)), fmt::arg("value", output),
-          fmt::arg("name", trimWorkspaceName(output)), fmt::arg("index", (*it)["num"].asString()),
-          fmt::arg("windows",
-                   windows.substr(0, windows.length() - m_formatWindowSeparator.length())),
-          fmt::arg("output", (*it)["output"].asString()));
+      box_.reorder_child(button, it - workspaces->begin());
     }
+    setClass(button, "focused", it->focused);
+    setClass(button, "visible", it->visible);
+    setClass(button, "urgent", it->urgent);
+    setClass(button, "persistent", it->node["target_output"].isString());
+    setClass(button, "empty", it->empty);
+    const auto &output = it->node["output"];
+    setClass(button, "current_output", output.isString() && output.asString() == bar_.output->name);
     if (!config_["disable-markup"].asBool()) {
-      static_cast<Gtk::Label *>(button.get_children()[0])->set_markup(output);
-    } else {
-      button.set_label(output);
+      auto *label = static_cast<Gtk::Label *>(button.get_children()[0]);
+      if (added || label->get_label() != it->label) {
+        label->set_markup(it->label);
+      }
+    } else if (added || button.get_label() != it->label) {
+      button.set_label(it->label);
     }
     onButtonReady(*it, button);
   }
@@ -362,28 +374,25 @@ Gtk::Button &Workspaces::addButton(const Json::Value &node) {
   button.set_relief(Gtk::RELIEF_NONE);
   if (!config_["disable-click"].asBool()) {
     button.signal_pressed().connect([this, node] {
-      try {
-        if (node["target_output"].isString()) {
-          ipc_.sendCmd(IPC_COMMAND,
-                       fmt::format(persistent_workspace_switch_cmd_, "--no-auto-back-and-forth",
-                                   node["name"].asString(), node["target_output"].asString(),
-                                   "--no-auto-back-and-forth", node["name"].asString()));
-        } else {
-          ipc_.sendCmd(IPC_COMMAND, fmt::format("workspace {} \"{}\"",
-                                                config_["disable-auto-back-and-forth"].asBool()
-                                                    ? "--no-auto-back-and-forth"
-                                                    : "",
-                                                node["name"].asString()));
-        }
-      } catch (const std::exception &e) {
-        spdlog::error("Workspaces: {}", e.what());
+      std::string cmd;
+      if (node["target_output"].isString()) {
+        cmd = fmt::format(persistent_workspace_switch_cmd_, "--no-auto-back-and-forth",
+                          node["name"].asString(), node["target_output"].asString(),
+                          "--no-auto-back-and-forth", node["name"].asString());
+      } else {
+        cmd = fmt::format(
+            "workspace {} \"{}\"",
+            config_["disable-auto-back-and-forth"].asBool() ? "--no-auto-back-and-forth" : "",
+            node["name"].asString());
       }
+      ipc_.queueCmd(IPC_COMMAND, std::move(cmd), std::string(workspace_switch_key_));
     });
   }
   return button;
 }
 
-std::string Workspaces::getIcon(const std::string &name, const Json::Value &node) {
+std::string Workspaces::getIcon(const WorkspaceState &workspace) {
+  const auto &name = workspace.name;
   std::vector<std::string> keys = {"high-priority-named", "urgent", "focused", name, "default"};
   for (auto const &key : keys) {
     if (key == "high-priority-named") {
@@ -402,11 +411,12 @@ std::string Workspaces::getIcon(const std::string &name, const Json::Value &node
       }
     }
     if (key == "focused" || key == "urgent") {
-      if (config_["format-icons"][key].isString() && hasFlag(node, key)) {
+      bool flag = key == "focused" ? workspace.focused : workspace.urgent;
+      if (config_["format-icons"][key].isString() && flag) {
         return config_["format-icons"][key].asString();
       }
     } else if (config_["format-icons"]["persistent"].isString() &&
-               node["target_output"].isString()) {
+               workspace.node["target_output"].isString()) {
       return config_["format-icons"]["persistent"].asString();
     } else if (config_["format-icons"][key].isString()) {
       return config_["format-icons"][key].asString();
@@ -428,63 +438,57 @@ bool Workspaces::handleScroll(GdkEventScroll *e) {
   if (dir == SCROLL_DIR::NONE) {
     return true;
   }
-  std::string name;
+  std::shared_ptr<const WorkspaceStates> workspaces;
   {
-    bool alloutputs = config_["all-outputs"].asBool();
     std::lock_guard<std::mutex> lock(mutex_);
-    auto it =
-        std::find_if(workspaces_.begin(), workspaces_.end(), [alloutputs](const auto &workspace) {
-          if (alloutputs) {
-            return hasFlag(workspace, "focused");
-          }
-          bool noNodes = workspace["nodes"].empty() && workspace["floating_nodes"].empty();
-          return hasFlag(workspace, "visible") || (workspace["output"].isString() && noNodes);
-        });
-    if (it == workspaces_.end()) {
-      return true;
-    }
-    bool reverse_scroll = config_["reverse-scroll"].isBool() && config_["reverse-scroll"].asBool();
-    if (dir == SCROLL_DIR::DOWN || dir == SCROLL_DIR::RIGHT) {
-      name = getCycleWorkspace(it, reverse_scroll ? true : false);
-    } else if (dir == SCROLL_DIR::UP || dir == SCROLL_DIR::LEFT) {
-      name = getCycleWorkspace(it, reverse_scroll ? false : true);
-    } else {
-      return true;
-    }
-    if (name == (*it)["name"].asString()) {
-      return true;
-    }
+    workspaces = workspaces_;
   }
-  if (!config_["warp-on-scroll"].isNull() && !config_["warp-on-scroll"].asBool()) {
-    ipc_.sendCmd(IPC_COMMAND, fmt::format("mouse_warping none"));
+  bool alloutputs = config_["all-outputs"].asBool();
+  auto it = std::find_if(workspaces->begin(), workspaces->end(), [&](const auto &workspace) {
+    return alloutputs ? workspace.focused : workspace.visible;
+  });
+  if (it == workspaces->end()) {
+    return true;
   }
-  try {
-    ipc_.sendCmd(IPC_COMMAND, fmt::format(workspace_switch_cmd_, "--no-auto-back-and-forth", name));
-  } catch (const std::exception &e) {
-    spdlog::error("Workspaces: {}", e.what());
+  bool reverse_scroll = config_["reverse-scroll"].isBool() && config_["reverse-scroll"].asBool();
+  std::string name;
+  if (dir == SCROLL_DIR::DOWN || dir == SCROLL_DIR::RIGHT) {
+    name = getCycleWorkspace(*workspaces, it, reverse_scroll ? true : false);
+  } else if (dir == SCROLL_DIR::UP || dir == SCROLL_DIR::LEFT) {
+    name = getCycleWorkspace(*workspaces, it, reverse_scroll ? false : true);
+  } else {
+    return true;
   }
+  if (name == it->name) {
+    return true;
+  }
+  auto cmd = fmt::format(workspace_switch_cmd_, "--no-auto-back-and-forth", name);
   if (!config_["warp-on-scroll"].isNull() && !config_["warp-on-scroll"].asBool()) {
-    ipc_.sendCmd(IPC_COMMAND, fmt::format("mouse_warping container"));
+    // Sway runs the commands of one message in order
+    cmd = fmt::format("mouse_warping none; {}; mouse_warping container", cmd);
   }
+  // Scrolling faster than sway switches only sends the last switch
+  ipc_.queueCmd(IPC_COMMAND, std::move(cmd), std::string(workspace_switch_key_));
   return true;
 }
 
-std::string Workspaces::getCycleWorkspace(std::vector<Json::Value>::iterator it, bool prev) const {
-  if (prev && it == workspaces_.begin() && !config_["disable-scroll-wraparound"].asBool()) {
-    return (*(--workspaces_.end()))["name"].asString();
+std::string Workspaces::getCycleWorkspace(const WorkspaceStates &workspaces,
+                                          WorkspaceStates::const_iterator it, bool prev) const {
+  if (prev && it == workspaces.begin() && !config_["disable-scroll-wraparound"].asBool()) {
+    return (--workspaces.end())->name;
   }
-  if (prev && it != workspaces_.begin())
+  if (prev && it != workspaces.begin())
     --it;
-  else if (!prev && it != workspaces_.end())
+  else if (!prev && it != workspaces.end())
     ++it;
-  if (!prev && it == workspaces_.end()) {
+  if (!prev && it == workspaces.end()) {
     if (config_["disable-scroll-wraparound"].asBool()) {
       --it;
     } else {
-      return (*(workspaces_.begin()))["name"].asString();
+      return workspaces.begin()->name;
     }
   }
-  return (*it)["name"].asString();
+  return it->name;
 }
 
 std::string Workspaces::trimWorkspaceName(std::string name) {
@@ -495,34 +499,9 @@ std::string Workspaces::trimWorkspaceName(std::string name) {
   return name;
 }
 
-bool is_focused_recursive(const Json::Value &node) {
-  // If a workspace has a focused container then get_tree will say
-  // that the workspace itself isn't focused.  Therefore we need to
-  // check if any of its nodes are focused as well.
-  // some layouts like tabbed have many nested nodes
-  // all nested nodes must be checked for focused flag
-  if (node["focused"].asBool()) {
-    return true;
-  }
-
-  for (const auto &child : node["nodes"]) {
-    if (is_focused_recursive(child)) {
-      return true;
-    }
-  }
-
-  for (const auto &child : node["floating_nodes"]) {
-    if (is_focused_recursive(child)) {
-      return true;
-    }
-  }
-
-  return false;
-}
-
-void Workspaces::onButtonReady(const Json::Value &node, Gtk::Button &button) {
+void Workspaces::onButtonReady(const WorkspaceState &workspace, Gtk::Button &button) {
   if (config_["current-only"].asBool()) {
-    if (is_focused_recursive(node)) {
+    if (workspace.focused) {
       button.show();
     } else {
       button.hide();
@@ -2,6 +2,7 @@
 
 #include <json/json.h>
 #include <spdlog/spdlog.h>
+#include <fcntl.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 
@@ -9,9 +10,9 @@
 #include <bit>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <exception>
 #include <ranges>
-#include <thread>
 
 namespace waybar::modules::wayfire {
 
@@ -115,20 +116,23 @@ auto IPC::connect() -> Sock {
   return {sock};
 }
 
-auto IPC::receive(Sock& sock) -> Json::Value {
-  auto len = *reinterpret_cast<uint32_t*>(read_exact(sock, 4).data());
-  if constexpr (std::endian::native != std::endian::little) len = byteswap(len);
-  auto buf = read_exact(sock, len);
-
+auto IPC::parse(const char* begin, const char* end) -> Json::Value {
   Json::Value json;
   std::string err;
-  auto* reader = reader_builder.newCharReader();
-  if (!reader->parse(&*buf.begin(), &*buf.end(), &json, &err)) {
+  std::unique_ptr<Json::CharReader> reader{reader_builder.newCharReader()};
+  if (!reader->parse(begin, end, &json, &err)) {
     throw std::runtime_error{"Wayfire IPC: parse json failed: " + err};
   }
   return json;
 }
 
+auto IPC::receive(Sock& sock) -> Json::Value {
+  auto len = *reinterpret_cast<uint32_t*>(read_exact(sock, 4).data());
+  if constexpr (std::endian::native != std::endian::little) len = byteswap(len);
+  auto buf = read_exact(sock, len);
+  return parse(buf.data(), buf.data() + buf.size());
+}
+
 auto IPC::send(const std::string& method, Json::Value&& data) -> Json::Value {
   spdlog::debug("Wayfire IPC: send method \"{}\"", method);
   auto sock = connect();
@@ -153,28 +157,65 @@ auto IPC::start() -> void {
   send("window-rules/get-focused-view", {});
   send("window-rules/get-focused-output", {});
 
-  std::thread([&] {
-    auto sock = connect();
+  auto sock = connect();
+  {
+    Json::Value json;
+    json["method"] = "window-rules/events/watch";
+
+    pack_and_write(sock, Json::writeString(writer_builder, json));
+    if (receive(sock)["result"] != "ok") {
+      spdlog::error(
+          "Wayfire IPC: method \"window-rules/events/watch\""
+          " have failed");
+      return;
+    }
+  }
 
-    {
-      Json::Value json;
-      json["method"] = "window-rules/events/watch";
+  fcntl(sock.fd, F_SETFL, fcntl(sock.fd, F_GETFL) | O_NONBLOCK);
+  event_sock_.emplace(std::move(sock));
+  event_watch_ = util::Reactor::instance().watch(
+      event_sock_->fd, EPOLLIN, [this](uint32_t) { return receive_events(); }, "wayfire");
+}
 
-      pack_and_write(sock, Json::writeString(writer_builder, json));
-      if (receive(sock)["result"] != "ok") {
-        spdlog::error(
-            "Wayfire IPC: method \"window-rules/events/watch\""
-            " have failed");
-        return;
-      }
+auto IPC::receive_events() -> bool {
+  char buf[4096];
+  bool closed = false;
+  while (true) {
+    auto n = read(event_sock_->fd, buf, sizeof(buf));
+    if (n > 0) {
+      event_buf_.append(buf, n);
+    } else {
+      closed = n == 0 || (errno != EAGAIN && errno != EINTR);
+      break;
     }
+  }
 
-    while (auto json = receive(sock)) {
+  // Dispatch every complete message, keep the incomplete tail for the next wakeup
+  size_t pos = 0;
+  while (event_buf_.size() - pos >= 4) {
+    uint32_t len;
+    std::memcpy(&len, event_buf_.data() + pos, 4);
+    if constexpr (std::endian::native != std::endian::little) len = byteswap(len);
+    if (event_buf_.size() - pos - 4 < len) {
+      break;
+    }
+    const auto* begin = event_buf_.data() + pos + 4;
+    pos += 4 + len;
+    try {
+      auto json = parse(begin, begin + len);
       auto ev = json["event"].asString();
       spdlog::debug("Wayfire IPC: received event \"{}\"", ev);
       root_event_handler(ev, json);
+    } catch (const std::exception& e) {
+      spdlog::error("{}", e.what());
     }
-  }).detach();
+  }
+  event_buf_.erase(0, pos);
+
+  if (closed) {
+    spdlog::error("Wayfire IPC: event socket closed");
+  }
+  return !closed;
 }
 
 auto IPC::register_handler(const std::string& event, const EventHandler& handler) -> void {
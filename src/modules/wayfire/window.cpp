@@ -13,7 +13,8 @@ Window::Window(const std::string& id, const Bar& bar, const Json::Value& config)
     : AAppIconLabel(config, "window", id, "{title}", 0, true),
       ipc{IPC::get_instance()},
       handler{[this](const auto&) { dp.emit(); }},
-      bar_{bar} {
+      bar_{bar},
+      rewrite_rules_{config["rewrite"]} {
   ipc->register_handler("view-unmapped", handler);
   ipc->register_handler("view-focused", handler);
   ipc->register_handler("view-title-changed", handler);
@@ -45,10 +46,9 @@ auto Window::update_icon_label() -> void {
     auto app_id = view["app-id"].asString();
 
     // update label
-    label_.set_markup(waybar::util::rewriteString(
+    label_.set_markup(rewrite_rules_.rewrite(
         fmt::format(fmt::runtime(format_), fmt::arg("title", waybar::util::sanitize_string(title)),
-                    fmt::arg("app_id", waybar::util::sanitize_string(app_id))),
-        config_["rewrite"]));
+                    fmt::arg("app_id", waybar::util::sanitize_string(app_id)))));
 
     // update window#waybar.solo
     if (wset.locate_ws(view["geometry"]).num_views > 1)
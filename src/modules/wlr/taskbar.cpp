@@ -475,7 +475,7 @@ void Task::update() {
                     fmt::arg("app_id", app_id), fmt::arg("state", state_string()),
                     fmt::arg("short_state", state_string(true)));
 
-    txt = waybar::util::rewriteString(txt, config_["rewrite"]);
+    txt = tbar_->rewrite_rules().rewrite(txt);
 
     if (markup)
       text_before_.set_markup(txt);
@@ -489,7 +489,7 @@ void Task::update() {
                     fmt::arg("app_id", app_id), fmt::arg("state", state_string()),
                     fmt::arg("short_state", state_string(true)));
 
-    txt = waybar::util::rewriteString(txt, config_["rewrite"]);
+    txt = tbar_->rewrite_rules().rewrite(txt);
 
     if (markup)
       text_after_.set_markup(txt);
@@ -504,7 +504,7 @@ void Task::update() {
                     fmt::arg("app_id", app_id), fmt::arg("state", state_string()),
                     fmt::arg("short_state", state_string(true)));
 
-    txt = waybar::util::rewriteString(txt, config_["rewrite"]);
+    txt = tbar_->rewrite_rules().rewrite(txt);
 
     if (markup)
       button.set_tooltip_markup(txt);
@@ -565,6 +565,7 @@ Taskbar::Taskbar(const std::string &id, const waybar::Bar &bar, const Json::Valu
     : waybar::AModule(config, "taskbar", id, false, false),
       bar_(bar),
       box_{bar.orientation, 0},
+      rewrite_rules_{config["rewrite"]},
       manager_{nullptr},
       seat_{nullptr} {
   box_.set_name("taskbar");
@@ -757,4 +758,6 @@ const std::map<std::string, std::string> &Taskbar::app_ids_replace_map() const {
   return app_ids_replace_map_;
 }
 
+util::RewriteRuleSet &Taskbar::rewrite_rules() { return rewrite_rules_; }
+
 } /* namespace waybar::modules::wlr */
@@ -9,30 +9,6 @@
 #include <utility>
 
 namespace {
-class FileDescriptor {
- public:
-  explicit FileDescriptor(int fd) : fd_(fd) {}
-  FileDescriptor(const FileDescriptor &other) = delete;
-  FileDescriptor(FileDescriptor &&other) noexcept = delete;
-  FileDescriptor &operator=(const FileDescriptor &other) = delete;
-  FileDescriptor &operator=(FileDescriptor &&other) noexcept = delete;
-  ~FileDescriptor() {
-    if (fd_ != -1) {
-      if (close(fd_) != 0) {
-        fmt::print(stderr, "Failed to close fd: {}\n", errno);
-      }
-    }
-  }
-  int get() const { return fd_; }
-
- private:
-  int fd_;
-};
-
-struct UdevDeleter {
-  void operator()(udev *ptr) { udev_unref(ptr); }
-};
-
 struct UdevDeviceDeleter {
   void operator()(udev_device *ptr) { udev_device_unref(ptr); }
 };
@@ -41,24 +17,6 @@ struct UdevEnumerateDeleter {
   void operator()(udev_enumerate *ptr) { udev_enumerate_unref(ptr); }
 };
 
-struct UdevMonitorDeleter {
-  void operator()(udev_monitor *ptr) { udev_monitor_unref(ptr); }
-};
-
-void check_eq(int rc, int expected, const char *message = "eq, rc was: ") {
-  if (rc != expected) {
-    throw std::runtime_error(fmt::format(fmt::runtime(message), rc));
-  }
-}
-
-void check_neq(int rc, int bad_rc, const char *message = "neq, rc was: ") {
-  if (rc == bad_rc) {
-    throw std::runtime_error(fmt::format(fmt::runtime(message), rc));
-  }
-}
-
-void check0(int rc, const char *message = "rc wasn't 0") { check_eq(rc, 0, message); }
-
 void check_gte(int rc, int gte, const char *message = "rc was: ") {
   if (rc < gte) {
     throw std::runtime_error(fmt::format(fmt::runtime(message), rc));
@@ -143,9 +101,9 @@ void BacklightDevice::set_powered(bool powered) { powered_ = powered; }
 BacklightBackend::BacklightBackend(std::chrono::milliseconds interval,
                                    std::function<void()> on_updated_cb)
     : on_updated_cb_(std::move(on_updated_cb)), polling_interval_(interval), previous_best_({}) {
-  std::unique_ptr<udev, UdevDeleter> udev_check{udev_new()};
-  check_nn(udev_check.get(), "Udev check new failed");
-  enumerate_devices(devices_, udev_check.get());
+  udev_.reset(udev_new());
+  check_nn(udev_.get(), "Udev new failed");
+  enumerate_devices(devices_, udev_.get());
   if (devices_.empty()) {
     throw std::runtime_error("No backlight found");
   }
@@ -163,61 +121,53 @@ BacklightBackend::BacklightBackend(std::chrono::milliseconds interval,
   }
 #endif
 
-  udev_thread_ = [this] {
-    std::unique_ptr<udev, UdevDeleter> udev{udev_new()};
-    check_nn(udev.get(), "Udev new failed");
-
-    std::unique_ptr<udev_monitor, UdevMonitorDeleter> mon{
-        udev_monitor_new_from_netlink(udev.get(), "udev")};
-    check_nn(mon.get(), "udev monitor new failed");
-    check_gte(udev_monitor_filter_add_match_subsystem_devtype(mon.get(), "backlight", nullptr), 0,
-              "udev failed to add monitor filter: ");
-    udev_monitor_enable_receiving(mon.get());
-
-    auto udev_fd = udev_monitor_get_fd(mon.get());
-
-    auto epoll_fd = FileDescriptor{epoll_create1(EPOLL_CLOEXEC)};
-    check_neq(epoll_fd.get(), -1, "epoll init failed: ");
-    epoll_event ctl_event{};
-    ctl_event.events = EPOLLIN;
-    ctl_event.data.fd = udev_fd;
-
-    check0(epoll_ctl(epoll_fd.get(), EPOLL_CTL_ADD, ctl_event.data.fd, &ctl_event),
-           "epoll_ctl failed: {}");
-    epoll_event events[EPOLL_MAX_EVENTS];
-
-    while (udev_thread_.isRunning()) {
-      const int event_count =
-          epoll_wait(epoll_fd.get(), events, EPOLL_MAX_EVENTS, this->polling_interval_.count());
-      if (!udev_thread_.isRunning()) {
-        break;
-      }
-      decltype(devices_) devices;
-      {
-        std::scoped_lock<std::mutex> lock(udev_thread_mutex_);
-        devices = devices_;
-      }
-      for (int i = 0; i < event_count; ++i) {
-        const auto &event = events[i];
-        check_eq(event.data.fd, udev_fd, "unexpected udev fd");
-        std::unique_ptr<udev_device, UdevDeviceDeleter> dev{udev_monitor_receive_device(mon.get())};
-        if (!dev) {
-          continue;
-        }
-        upsert_device(devices, dev.get());
-      }
+  udev_monitor_.reset(udev_monitor_new_from_netlink(udev_.get(), "udev"));
+  check_nn(udev_monitor_.get(), "udev monitor new failed");
+  check_gte(
+      udev_monitor_filter_add_match_subsystem_devtype(udev_monitor_.get(), "backlight", nullptr),
+      0, "udev failed to add monitor filter: ");
+  udev_monitor_enable_receiving(udev_monitor_.get());
+
+  udev_watch_ = util::Reactor::instance().watch(
+      udev_monitor_get_fd(udev_monitor_.get()), EPOLLIN,
+      [this](uint32_t) {
+        refresh_devices(false);
+        return true;
+      },
+      "backlight");
+
+  // Refresh state periodically in case we missed an udev event
+  poll_job_ = [this] {
+    refresh_devices(true);
+    poll_job_.sleep_for(polling_interval_);
+  };
+}
 
-      // Refresh state if timed out
-      if (event_count == 0) {
-        enumerate_devices(devices, udev.get());
-      }
-      {
-        std::scoped_lock<std::mutex> lock(udev_thread_mutex_);
-        devices_ = devices;
+void BacklightBackend::refresh_devices(bool enumerate) {
+  std::scoped_lock<std::mutex> refresh_lock(refresh_mutex_);
+  decltype(devices_) devices;
+  {
+    std::scoped_lock<std::mutex> lock(udev_thread_mutex_);
+    devices = devices_;
+  }
+  if (enumerate) {
+    enumerate_devices(devices, udev_.get());
+  } else {
+    // The monitor socket is non-blocking, drain all the pending events
+    while (true) {
+      std::unique_ptr<udev_device, UdevDeviceDeleter> dev{
+          udev_monitor_receive_device(udev_monitor_.get())};
+      if (!dev) {
+        break;
       }
-      this->on_updated_cb_();
+      upsert_device(devices, dev.get());
     }
-  };
+  }
+  {
+    std::scoped_lock<std::mutex> lock(udev_thread_mutex_);
+    devices_ = devices;
+  }
+  this->on_updated_cb_();
 }
 
 const BacklightDevice *BacklightBackend::best_device(const std::vector<BacklightDevice> &devices,
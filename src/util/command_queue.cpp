@@ -0,0 +1,44 @@
+#include "util/command_queue.hpp"
+
+#include <spdlog/spdlog.h>
+
+namespace waybar::util {
+
+// Commands wait for a script or a compositor, without a timeout
+CommandQueue::CommandQueue() : job_(Scheduler::instance().add([this] { run(); }, true)) {}
+
+CommandQueue::~CommandQueue() { Scheduler::instance().cancel(job_); }
+
+void CommandQueue::push(Command command, std::string key) {
+  {
+    std::lock_guard lock(mutex_);
+    if (!key.empty()) {
+      std::erase_if(commands_, [&key](const auto& queued) { return queued.first == key; });
+    }
+    commands_.emplace_back(std::move(key), std::move(command));
+  }
+  Scheduler::instance().wake(job_);
+}
+
+void CommandQueue::run() {
+  while (true) {
+    Command command;
+    {
+      std::lock_guard lock(mutex_);
+      if (commands_.empty()) {
+        break;
+      }
+      command = std::move(commands_.front().second);
+      commands_.pop_front();
+    }
+    try {
+      command();
+    } catch (const std::exception& e) {
+      spdlog::error("Command failed: {}", e.what());
+    }
+  }
+  // A push racing with the end of the loop wakes the job again
+  Scheduler::instance().park(job_);
+}
+
+}  // namespace waybar::util
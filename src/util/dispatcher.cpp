@@ -0,0 +1,116 @@
+#include "util/dispatcher.hpp"
+
+#include <fcntl.h>
+#include <glibmm/main.h>
+#include <spdlog/spdlog.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace waybar::util {
+
+namespace {
+
+/// The process-wide queue and its wakeup fd, attached to the default main context
+class WakeupChannel {
+ public:
+  static WakeupChannel& instance() {
+    // Intentionally leaked: worker threads may still emit during static destruction
+    static auto* channel = new WakeupChannel();
+    return *channel;
+  }
+
+  void post(std::shared_ptr<Dispatcher::State> state) {
+    bool wake;
+    {
+      std::lock_guard lock(mutex_);
+      wake = queue_.empty();
+      queue_.push_back(std::move(state));
+    }
+    // Only the first post of a batch pays for the syscall
+    if (wake) {
+      uint64_t one = 1;
+      while (::write(fds_[1], &one, sizeof(one)) == -1 && errno == EINTR) {
+      }
+    }
+  }
+
+ private:
+  WakeupChannel() {
+#ifdef __linux__
+    fds_[0] = fds_[1] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (fds_[0] == -1) {
+      throw std::runtime_error("Unable to create dispatcher eventfd: " +
+                               std::string(strerror(errno)));
+    }
+#else
+    if (pipe2(fds_, O_CLOEXEC | O_NONBLOCK) == -1) {
+      throw std::runtime_error("Unable to create dispatcher pipe: " +
+                               std::string(strerror(errno)));
+    }
+#endif
+    Glib::signal_io().connect(
+        [this](Glib::IOCondition) {
+          drain();
+          return true;
+        },
+        fds_[0], Glib::IO_IN);
+  }
+
+  void drain() {
+    // Reset the fd before taking the queue, a post racing with us at worst causes an extra wakeup
+    uint64_t buf[8];
+    while (::read(fds_[0], buf, sizeof(buf)) > 0) {
+    }
+
+    std::vector<std::shared_ptr<Dispatcher::State>> batch;
+    {
+      std::lock_guard lock(mutex_);
+      batch.swap(queue_);
+    }
+    for (auto& state : batch) {
+      // Cleared first, so that a slot emitting again is queued for the next wakeup
+      state->queued = false;
+      if (state->alive) {
+        try {
+          state->signal.emit();
+        } catch (const std::exception& e) {
+          spdlog::error("Dispatcher slot failed: {}", e.what());
+        }
+      }
+    }
+  }
+
+  int fds_[2] = {-1, -1};
+  std::mutex mutex_;
+  std::vector<std::shared_ptr<Dispatcher::State>> queue_;
+};
+
+}  // namespace
+
+Dispatcher::Dispatcher() : state_(std::make_shared<State>()) {
+  // Create the channel from the main thread, before any worker can emit
+  WakeupChannel::instance();
+}
+
+Dispatcher::~Dispatcher() { state_->alive = false; }
+
+void Dispatcher::emit() {
+  if (!state_->queued.exchange(true)) {
+    WakeupChannel::instance().post(state_);
+  }
+}
+
+sigc::connection Dispatcher::connect(const sigc::slot<void()>& slot) {
+  return state_->signal.connect(slot);
+}
+
+}  // namespace waybar::util
@@ -0,0 +1,274 @@
+#include "util/json_lines_ipc.hpp"
+
+#include <fcntl.h>
+#include <spdlog/spdlog.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+namespace waybar::util {
+
+namespace {
+
+// Delay before reconnecting, doubled after every failed attempt or stream that closed before
+// delivering an event
+constexpr auto RECONNECT_MIN = std::chrono::milliseconds(100);
+constexpr auto RECONNECT_MAX = std::chrono::milliseconds(5000);
+
+/// Write all of `data` to a blocking socket
+bool writeAll(int fd, std::string_view data) {
+  while (!data.empty()) {
+    auto n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+    if (n == -1 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    data.remove_prefix(n);
+  }
+  return true;
+}
+
+}  // namespace
+
+JsonLinesIpc::JsonLinesIpc(Protocol protocol, Reducer reducer)
+    : protocol_(std::move(protocol)),
+      reducer_(std::move(reducer)),
+      backoff_(RECONNECT_MIN),
+      connectJob_(Scheduler::instance().add([this] { connect(); })) {
+  Scheduler::instance().wake(connectJob_);
+}
+
+JsonLinesIpc::~JsonLinesIpc() {
+  // The reactor callback may arm the job again until the watch is gone, cancel it first so that
+  // it ignores that
+  Scheduler::instance().cancel(connectJob_);
+  watch_.reset();
+  if (fd_ != -1) {
+    close(fd_);
+  }
+}
+
+int JsonLinesIpc::connectToSocket(const Protocol& protocol) {
+  const char* socketPath = getenv(protocol.socketEnv.c_str());
+  if (socketPath == nullptr) {
+    return -1;
+  }
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd == -1) {
+    throw std::runtime_error(std::string("socket failed: ") + strerror(errno));
+  }
+
+  struct sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, socketPath, sizeof(addr.sun_path) - 1);
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) {
+    auto err = errno;
+    close(fd);
+    throw std::runtime_error(std::string("unable to connect: ") + strerror(err));
+  }
+  return fd;
+}
+
+std::string JsonLinesIpc::toLine(const Json::Value& value) {
+  // The compositors need each request on a single line
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "";
+  std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
+  std::ostringstream oss;
+  writer->write(value, &oss);
+  oss << '\n';
+  return oss.str();
+}
+
+Json::Value JsonLinesIpc::send(const Protocol& protocol, const Json::Value& request) {
+  int fd = connectToSocket(protocol);
+  if (fd == -1) {
+    throw std::runtime_error(protocol.name + " is not running");
+  }
+
+  LineBuffer buffer(1024);
+  std::vector<std::string_view> lines;
+  bool ok = writeAll(fd, toLine(request));
+  while (ok && lines.empty()) {
+    auto space = buffer.prepare(1024);
+    auto n = read(fd, space.data(), space.size());
+    if (n == -1 && errno == EINTR) {
+      continue;
+    }
+    ok = n > 0;
+    if (ok) {
+      buffer.commit(n);
+      buffer.lines(lines);
+    }
+  }
+  close(fd);
+  if (!ok) {
+    throw std::runtime_error("error talking to the " + protocol.name + " socket");
+  }
+  return JsonParser().parse(lines.front());
+}
+
+void JsonLinesIpc::queue(Json::Value request, std::string key) {
+  commands_.push(
+      [this, request = std::move(request)] {
+        auto reply = send(protocol_, request);
+        // Niri replies {"Err": "..."} to a request that failed
+        if (reply.isObject() && reply.isMember("Err")) {
+          spdlog::warn("{} IPC: request failed: {}", protocol_.name, reply["Err"].asString());
+        } else {
+          spdlog::debug("{} IPC: reply {}", protocol_.name, reply);
+        }
+      },
+      std::move(key));
+}
+
+void JsonLinesIpc::connect() {
+  // The previous stream's fd is only closed once the reactor dropped it: closing it first would
+  // let the reactor deregister a reused fd number
+  watch_.reset();
+  if (fd_ != -1) {
+    close(std::exchange(fd_, -1));
+  }
+
+  int fd = -1;
+  try {
+    fd = connectToSocket(protocol_);
+  } catch (const std::exception& e) {
+    if (connected_) {
+      spdlog::error("{} IPC: failed to start, reason: {}", protocol_.name, e.what());
+    }
+    connected_ = false;
+    Scheduler::instance().arm(connectJob_, backoff_);
+    backoff_ = std::min(backoff_ * 2, RECONNECT_MAX);
+    return;
+  }
+  Scheduler::instance().park(connectJob_);
+  if (fd == -1) {
+    spdlog::warn("{} is not running, {} IPC will not be available.", protocol_.name,
+                 protocol_.name);
+    return;
+  }
+
+  if (!writeAll(fd, toLine(protocol_.subscribe)) || fcntl(fd, F_SETFL, O_NONBLOCK) == -1) {
+    spdlog::error("{} IPC: failed to start event stream", protocol_.name);
+    close(fd);
+    return;
+  }
+  if (connected_) {
+    spdlog::info("{} IPC starting", protocol_.name);
+  } else {
+    spdlog::info("{} IPC: reconnected", protocol_.name);
+  }
+  connected_ = true;
+
+  fd_ = fd;
+  acked_ = protocol_.ack.empty();
+  buffer_.clear();
+  try {
+    watch_ = Reactor::instance().watch(
+        fd_, EPOLLIN, [this](uint32_t events) { return receive(events); }, protocol_.name);
+  } catch (const std::exception& e) {
+    spdlog::error("{} IPC: {}", protocol_.name, e.what());
+    close(std::exchange(fd_, -1));
+  }
+}
+
+bool JsonLinesIpc::receive(uint32_t events) {
+  bool closed = (events & EPOLLERR) != 0;
+  while (!closed) {
+    auto space = buffer_.prepare();
+    auto n = read(fd_, space.data(), space.size());
+    if (n > 0) {
+      buffer_.commit(n);
+      continue;
+    }
+    if (n == -1 && errno == EINTR) {
+      continue;
+    }
+    if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    }
+    if (n == -1) {
+      spdlog::error("{} IPC: read failed: {}", protocol_.name, strerror(errno));
+    }
+    closed = true;
+  }
+
+  lines_.clear();
+  buffer_.lines(lines_);
+  for (auto line : lines_) {
+    if (!acked_) {
+      if (line != protocol_.ack) {
+        spdlog::error("{} IPC: failed to start event stream: {}", protocol_.name, line);
+        disconnect();
+        return false;
+      }
+      acked_ = true;
+      continue;
+    }
+    handleLine(line);
+  }
+
+  if (closed) {
+    disconnect();
+    return false;
+  }
+  return true;
+}
+
+void JsonLinesIpc::handleLine(std::string_view line) {
+  spdlog::debug("{} IPC: received {}", protocol_.name, line);
+
+  Json::Value ev;
+  std::string name;
+  try {
+    ev = parser_.parse(line);
+    name = reducer_(ev);
+  } catch (const std::exception& e) {
+    spdlog::warn("Failed to parse IPC message: {}, reason: {}", line, e.what());
+    return;
+  }
+  // The stream works, the next disconnection is retried quickly
+  backoff_ = RECONNECT_MIN;
+
+  handlers_.dispatch(name, [&ev](JsonEventHandler& handler, auto) { handler.onEvent(ev); });
+}
+
+void JsonLinesIpc::disconnect() {
+  spdlog::warn("{} IPC: event stream closed, reconnecting", protocol_.name);
+  // fd_ stays open until the connect job resets the watch, see connect()
+  connected_ = false;
+  // A compositor refusing the stream, or closing it right away, is not retried in a busy loop
+  auto delay = std::exchange(backoff_, std::min(backoff_ * 2, RECONNECT_MAX));
+  // Last, the connect job may run as soon as it is armed
+  Scheduler::instance().arm(connectJob_, delay);
+}
+
+void JsonLinesIpc::registerForIPC(const std::string& ev, JsonEventHandler* handler) {
+  if (handler == nullptr) {
+    return;
+  }
+
+  handlers_.add(ev, handler);
+}
+
+void JsonLinesIpc::unregisterForIPC(JsonEventHandler* handler) {
+  if (handler == nullptr) {
+    return;
+  }
+
+  handlers_.remove(handler);
+}
+
+}  // namespace waybar::util
@@ -0,0 +1,373 @@
+#include "util/json_reader.hpp"
+
+#include <charconv>
+#include <stdexcept>
+
+namespace waybar::util {
+
+namespace {
+
+void appendUtf8(std::string& out, uint32_t codepoint) {
+  if (codepoint < 0x80) {
+    out += static_cast<char>(codepoint);
+  } else if (codepoint < 0x800) {
+    out += static_cast<char>(0xC0 | (codepoint >> 6));
+    out += static_cast<char>(0x80 | (codepoint & 0x3F));
+  } else if (codepoint < 0x10000) {
+    out += static_cast<char>(0xE0 | (codepoint >> 12));
+    out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (codepoint & 0x3F));
+  } else {
+    out += static_cast<char>(0xF0 | (codepoint >> 18));
+    out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (codepoint & 0x3F));
+  }
+}
+
+bool isNumberChar(char c) {
+  return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+}  // namespace
+
+char JsonReader::skipWhitespace() {
+  while (pos_ < json_.size()) {
+    char c = json_[pos_];
+    if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+      return c;
+    }
+    pos_++;
+  }
+  return '\0';
+}
+
+void JsonReader::expect(char c) {
+  if (skipWhitespace() != c) {
+    fail("unexpected character");
+  }
+  pos_++;
+}
+
+void JsonReader::fail(const char* what) const {
+  throw std::runtime_error("Error parsing JSON: " + std::string(what) + " at offset " +
+                           std::to_string(pos_));
+}
+
+JsonReader::Type JsonReader::peek() {
+  char c = skipWhitespace();
+  switch (c) {
+    case '\0':
+      if (pos_ >= json_.size()) {
+        return Type::End;
+      }
+      break;
+    case '{':
+      return Type::Object;
+    case '[':
+      return Type::Array;
+    case '"':
+      return Type::String;
+    case 't':
+    case 'f':
+      return Type::Bool;
+    case 'n':
+      return Type::Null;
+    default:
+      if (c == '-' || (c >= '0' && c <= '9')) {
+        return Type::Number;
+      }
+  }
+  fail("unexpected character");
+}
+
+bool JsonReader::beginObject() {
+  auto type = peek();
+  if (type == Type::Object) {
+    pos_++;
+    return true;
+  }
+  skip();
+  return false;
+}
+
+bool JsonReader::nextMember(std::string_view& key) {
+  char c = skipWhitespace();
+  if (c == '}') {
+    pos_++;
+    return false;
+  }
+  if (c == ',') {
+    pos_++;
+    c = skipWhitespace();
+  }
+  if (c != '"') {
+    fail("expected a member name");
+  }
+  key = readRawString(key_);
+  expect(':');
+  return true;
+}
+
+bool JsonReader::beginArray() {
+  auto type = peek();
+  if (type == Type::Array) {
+    pos_++;
+    return true;
+  }
+  skip();
+  return false;
+}
+
+bool JsonReader::nextElement() {
+  char c = skipWhitespace();
+  if (c == ']') {
+    pos_++;
+    return false;
+  }
+  if (c == ',') {
+    pos_++;
+  }
+  if (peek() == Type::End) {
+    fail("unterminated array");
+  }
+  return true;
+}
+
+std::string_view JsonReader::readRawString(std::string& scratch) {
+  pos_++;  // opening quote
+  auto start = pos_;
+  auto special = json_.find_first_of("\"\\", pos_);
+  if (special == std::string_view::npos) {
+    fail("unterminated string");
+  }
+  if (json_[special] == '"') {
+    // nothing to unescape, hand out the document itself
+    pos_ = special + 1;
+    return json_.substr(start, special - start);
+  }
+
+  scratch.assign(json_.substr(start, special - start));
+  pos_ = special;
+  while (true) {
+    if (pos_ >= json_.size()) {
+      fail("unterminated string");
+    }
+    char c = json_[pos_++];
+    if (c == '"') {
+      return scratch;
+    }
+    if (c != '\\') {
+      scratch += c;
+      continue;
+    }
+    if (pos_ >= json_.size()) {
+      fail("unterminated string");
+    }
+    c = json_[pos_++];
+    switch (c) {
+      case 'b':
+        scratch += '\b';
+        break;
+      case 'f':
+        scratch += '\f';
+        break;
+      case 'n':
+        scratch += '\n';
+        break;
+      case 'r':
+        scratch += '\r';
+        break;
+      case 't':
+        scratch += '\t';
+        break;
+      case 'u':
+      case 'x': {
+        // "\x" isn't JSON, but is sent by some compositors, read as "\u00"
+        size_t digits = c == 'u' ? 4 : 2;
+        uint32_t codepoint = 0;
+        auto hex = json_.substr(pos_, digits);
+        auto [ptr, ec] = std::from_chars(hex.data(), hex.data() + hex.size(), codepoint, 16);
+        if (hex.size() != digits || ec != std::errc() || ptr != hex.data() + hex.size()) {
+          fail("invalid escape");
+        }
+        pos_ += digits;
+        // surrogate pair
+        if (codepoint >= 0xD800 && codepoint < 0xDC00 && json_.substr(pos_, 2) == "\\u") {
+          uint32_t low = 0;
+          auto lowHex = json_.substr(pos_ + 2, 4);
+          auto [lowPtr, lowEc] =
+              std::from_chars(lowHex.data(), lowHex.data() + lowHex.size(), low, 16);
+          if (lowEc == std::errc() && lowPtr == lowHex.data() + 4 && low >= 0xDC00 &&
+              low < 0xE000) {
+            codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+            pos_ += 6;
+          }
+        }
+        appendUtf8(scratch, codepoint);
+        break;
+      }
+      default:
+        // \" \\ \/
+        scratch += c;
+    }
+  }
+}
+
+std::string_view JsonReader::readNumberToken() {
+  auto start = pos_;
+  while (pos_ < json_.size() && isNumberChar(json_[pos_])) {
+    pos_++;
+  }
+  return json_.substr(start, pos_ - start);
+}
+
+void JsonReader::skipString() {
+  pos_++;  // opening quote
+  while (true) {
+    auto special = json_.find_first_of("\"\\", pos_);
+    if (special == std::string_view::npos) {
+      fail("unterminated string");
+    }
+    if (json_[special] == '"') {
+      pos_ = special + 1;
+      return;
+    }
+    pos_ = special + 2;
+  }
+}
+
+std::string JsonReader::readString() {
+  switch (peek()) {
+    case Type::String: {
+      std::string scratch;
+      auto value = readRawString(scratch);
+      if (value.data() == scratch.data()) {
+        return scratch;
+      }
+      return std::string(value);
+    }
+    case Type::Number:
+      return std::string(readNumberToken());
+    case Type::Bool:
+      return readBool() ? "true" : "false";
+    default:
+      skip();
+      return {};
+  }
+}
+
+int64_t JsonReader::readInt() {
+  switch (peek()) {
+    case Type::Number: {
+      auto token = readNumberToken();
+      int64_t value = 0;
+      auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), value);
+      if (ec == std::errc() && ptr == token.data() + token.size()) {
+        return value;
+      }
+      double real = 0;
+      std::from_chars(token.data(), token.data() + token.size(), real);
+      return static_cast<int64_t>(real);
+    }
+    case Type::Bool:
+      return readBool() ? 1 : 0;
+    default:
+      skip();
+      return 0;
+  }
+}
+
+double JsonReader::readDouble() {
+  switch (peek()) {
+    case Type::Number: {
+      auto token = readNumberToken();
+      double value = 0;
+      std::from_chars(token.data(), token.data() + token.size(), value);
+      return value;
+    }
+    case Type::Bool:
+      return readBool() ? 1 : 0;
+    default:
+      skip();
+      return 0;
+  }
+}
+
+bool JsonReader::readBool() {
+  switch (peek()) {
+    case Type::Bool:
+      if (json_.substr(pos_, 4) == "true") {
+        pos_ += 4;
+        return true;
+      }
+      if (json_.substr(pos_, 5) == "false") {
+        pos_ += 5;
+        return false;
+      }
+      fail("invalid literal");
+    case Type::Number:
+      return readDouble() != 0;
+    default:
+      skip();
+      return false;
+  }
+}
+
+size_t JsonReader::readArraySize() {
+  if (!beginArray()) {
+    return 0;
+  }
+  size_t size = 0;
+  while (nextElement()) {
+    skip();
+    size++;
+  }
+  return size;
+}
+
+void JsonReader::skip() {
+  switch (peek()) {
+    case Type::End:
+      return;
+    case Type::String:
+      skipString();
+      return;
+    case Type::Number:
+      readNumberToken();
+      return;
+    case Type::Bool:
+      readBool();
+      return;
+    case Type::Null:
+      if (json_.substr(pos_, 4) != "null") {
+        fail("invalid literal");
+      }
+      pos_ += 4;
+      return;
+    case Type::Object:
+    case Type::Array:
+      break;
+  }
+
+  // Containers are skipped by matching brackets, only strings need to be looked into
+  size_t depth = 0;
+  while (pos_ < json_.size()) {
+    char c = json_[pos_];
+    if (c == '"') {
+      skipString();
+      continue;
+    }
+    pos_++;
+    if (c == '{' || c == '[') {
+      depth++;
+    } else if (c == '}' || c == ']') {
+      if (--depth == 0) {
+        return;
+      }
+    }
+  }
+  fail("unterminated container");
+}
+
+}  // namespace waybar::util
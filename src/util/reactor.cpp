@@ -0,0 +1,141 @@
+#include "util/reactor.hpp"
+
+#include <spdlog/spdlog.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace waybar::util {
+
+namespace {
+
+constexpr int EPOLL_MAX_EVENTS = 32;
+
+}  // namespace
+
+Reactor& Reactor::instance() {
+  // Intentionally leaked, like the Scheduler: static owners of watches (e.g. the niri and fht
+  // IPC) are destroyed after a function-local static would be
+  static auto* reactor = new Reactor();
+  return *reactor;
+}
+
+Reactor::Reactor() {
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd_ == -1) {
+    throw std::runtime_error(fmt::format("Reactor: epoll_create1 failed: {}", strerror(errno)));
+  }
+  wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wakeup_fd_ == -1) {
+    close(epoll_fd_);
+    throw std::runtime_error(fmt::format("Reactor: eventfd failed: {}", strerror(errno)));
+  }
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.u64 = 0;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &event);
+  thread_ = std::thread(&Reactor::run, this);
+}
+
+Reactor::~Reactor() {
+  {
+    std::lock_guard lock(mutex_);
+    running_ = false;
+  }
+  uint64_t one = 1;
+  (void)write(wakeup_fd_, &one, sizeof(one));
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  close(wakeup_fd_);
+  close(epoll_fd_);
+}
+
+Reactor::Watch Reactor::watch(int fd, uint32_t events, Callback callback, std::string name) {
+  std::lock_guard lock(mutex_);
+  auto id = next_id_++;
+  epoll_event event{};
+  event.events = events;
+  event.data.u64 = id;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) == -1) {
+    throw std::runtime_error(
+        fmt::format("Reactor: can't watch fd {} ({}): {}", fd, name, strerror(errno)));
+  }
+  registrations_.emplace(
+      id, std::make_shared<Registration>(Registration{fd, std::move(name), std::move(callback)}));
+  return Watch{id};
+}
+
+void Reactor::remove(uint64_t id) {
+  std::unique_lock lock(mutex_);
+  removeLocked(id);
+  if (std::this_thread::get_id() != thread_.get_id()) {
+    done_cv_.wait(lock, [this, id] { return dispatching_ != id; });
+  }
+}
+
+void Reactor::removeLocked(uint64_t id) {
+  auto it = registrations_.find(id);
+  if (it == registrations_.end()) {
+    return;
+  }
+  // The fd may already be closed, in which case the kernel has dropped it from the set
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, it->second->fd, nullptr);
+  spdlog::debug("Reactor: removing {} (fd {}) after {} wakeups, {} in total", it->second->name,
+                it->second->fd, it->second->wakeups, total_wakeups_);
+  registrations_.erase(it);
+}
+
+void Reactor::run() {
+  std::array<epoll_event, EPOLL_MAX_EVENTS> events;
+  while (true) {
+    int count = epoll_wait(epoll_fd_, events.data(), events.size(), -1);
+    if (count == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      spdlog::error("Reactor: epoll_wait failed: {}", strerror(errno));
+      return;
+    }
+
+    std::unique_lock lock(mutex_);
+    if (!running_) {
+      return;
+    }
+    total_wakeups_++;
+    for (int i = 0; i < count; i++) {
+      auto id = events[i].data.u64;
+      if (id == 0) {
+        uint64_t value;
+        (void)read(wakeup_fd_, &value, sizeof(value));
+        continue;
+      }
+      // A previous callback of this batch may have removed the registration
+      auto it = registrations_.find(id);
+      if (it == registrations_.end()) {
+        continue;
+      }
+      auto registration = it->second;
+      registration->wakeups++;
+      dispatching_ = id;
+      lock.unlock();
+      bool keep = true;
+      try {
+        keep = registration->callback(events[i].events);
+      } catch (const std::exception& e) {
+        spdlog::error("Reactor: {} callback failed: {}", registration->name, e.what());
+      }
+      lock.lock();
+      if (!keep) {
+        removeLocked(id);
+      }
+      dispatching_ = 0;
+      done_cv_.notify_all();
+    }
+  }
+}
+
+}  // namespace waybar::util
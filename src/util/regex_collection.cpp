@@ -11,61 +11,65 @@ namespace waybar::util {
 int default_priority_function(std::string& key) { return 0; }
 
 RegexCollection::RegexCollection(const Json::Value& map, std::string default_repr,
-                                 const std::function<int(std::string&)>& priority_function)
-    : default_repr(std::move(default_repr)) {
+                                 const std::function<int(std::string&)>& priority_function,
+                                 size_t cache_capacity)
+    : regex_cache(cache_capacity), default_repr(std::move(default_repr)) {
   if (!map.isObject()) {
     spdlog::warn("Mapping is not an object");
     return;
   }
 
+  std::vector<Rule> sorted;
   for (auto it = map.begin(); it != map.end(); ++it) {
     if (it.key().isString() && it->isString()) {
       std::string key = it.key().asString();
       int priority = priority_function(key);
-      try {
-        const std::regex rule{key, std::regex_constants::icase};
-        rules.emplace_back(rule, it->asString(), priority);
-      } catch (const std::regex_error& e) {
-        spdlog::error("Invalid rule '{}': {}", key, e.what());
-      }
+      sorted.emplace_back(key, it->asString(), priority);
     }
   }
 
-  std::sort(rules.begin(), rules.end(), [](Rule& a, Rule& b) { return a.priority > b.priority; });
-}
+  // Rules of equal priority keep a stable order
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const Rule& a, const Rule& b) { return a.priority > b.priority; });
 
-std::string RegexCollection::find_match(std::string& value, bool& matched_any) {
-  for (auto& rule : rules) {
-    std::smatch match;
-    if (std::regex_search(value, match, rule.rule)) {
-      matched_any = true;
-      return match.format(rule.repr.data());
+  for (auto& rule : sorted) {
+    try {
+      rules.add(rule.rule);
+      reprs.push_back(std::move(rule.repr));
+    } catch (const std::regex_error& e) {
+      spdlog::error("Invalid rule '{}': {}", rule.rule, e.what());
     }
   }
-
-  return value;
 }
 
-std::string& RegexCollection::get(std::string& value, bool& matched_any) {
-  if (regex_cache.contains(value)) {
-    return regex_cache[value];
+std::string RegexCollection::find_match(std::string_view value, bool& matched_any) {
+  auto match = rules.search(value);
+  if (match) {
+    matched_any = true;
+    return match->format(reprs[match->pattern()]);
   }
 
-  // std::string repr =
-  // waybar::util::find_match(value, window_rewrite_rules_, matched_any);
-
-  std::string repr = find_match(value, matched_any);
+  return std::string(value);
+}
 
-  if (!matched_any) {
-    repr = default_repr;
+const std::string& RegexCollection::get(std::string_view value, bool& matched_any) {
+  auto hash = LruCache<Result>::hash(value);
+  if (const auto* cached = regex_cache.find(value, hash)) {
+    matched_any = cached->matched_any;
+    return cached->repr;
   }
 
-  regex_cache.emplace(value, repr);
+  Result result;
+  result.repr = find_match(value, result.matched_any);
+  if (!result.matched_any) {
+    result.repr = default_repr;
+  }
+  matched_any = result.matched_any;
 
-  return regex_cache[value];  // Necessary in order to return a reference to the heap
+  return regex_cache.insert(value, hash, std::move(result)).repr;
 }
 
-std::string& RegexCollection::get(std::string& value) {
+const std::string& RegexCollection::get(std::string_view value) {
   bool matched_any = false;
   return get(value, matched_any);
 }
@@ -0,0 +1,1019 @@
+#include "util/regex_set.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <limits>
+
+namespace waybar::util {
+
+namespace {
+
+constexpr size_t INFINITE = std::numeric_limits<size_t>::max();
+constexpr uint32_t NO_START = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t NO_PATTERN = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t UNKNOWN = std::numeric_limits<uint32_t>::max();
+// Bound the size of counted repetitions like "a{1000}", which are expanded
+constexpr size_t MAX_INSTS = 10000;
+constexpr size_t MAX_DFA_STATES = 4096;
+
+// Context of a DFA state
+constexpr uint32_t BEGINNING = 1;
+constexpr uint32_t PREVIOUS_WORD = 2;
+
+// Thrown when a pattern uses syntax the VM doesn't implement, it's then left to std::regex.
+// Malformed patterns end up there too, so that std::regex reports them.
+struct Unsupported {};
+
+enum Assertion : uint32_t { BEGIN, END, WORD_BOUNDARY, NOT_WORD_BOUNDARY };
+
+struct Node {
+  enum class Type { Empty, Class, Concat, Alternate, Repeat, Group, Assert };
+
+  Type type = Type::Empty;
+  std::bitset<256> set{};
+  std::vector<Node> children{};
+  // Repeat
+  size_t min = 0;
+  size_t max = 0;
+  bool greedy = true;
+  // Group: capture index, 0 for non-capturing groups. Assert: the assertion.
+  uint32_t value = 0;
+};
+
+// \w and \b only know about ASCII, like std::regex with byte strings
+bool isWord(unsigned char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+std::bitset<256> makeSet(int (*predicate)(int)) {
+  std::bitset<256> set;
+  for (int c = 0; c < 128; c++) {
+    if (predicate(c) != 0) {
+      set.set(c);
+    }
+  }
+  return set;
+}
+
+int isWordChar(int c) { return static_cast<int>(isWord(c)); }
+
+// ECMAScript whitespace, restricted to single bytes
+int isSpace(int c) { return static_cast<int>(c == ' ' || (c >= '\t' && c <= '\r')); }
+
+int isDigit(int c) { return std::isdigit(c); }
+
+int hexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+bool assertionHolds(uint32_t assertion, bool beginning, bool end, bool before, bool after) {
+  switch (assertion) {
+    case BEGIN:
+      return beginning;
+    case END:
+      return end;
+    case WORD_BOUNDARY:
+      return before != after;
+    default:
+      return before == after;
+  }
+}
+
+/// Recursive descent parser for the subset of ECMAScript regexes run by the VM
+class Parser {
+ public:
+  Parser(std::string_view pattern, bool icase) : pattern_(pattern), icase_(icase) {}
+
+  Node parse() {
+    auto node = parseAlternation();
+    if (pos_ != pattern_.size()) {
+      throw Unsupported{};
+    }
+    return node;
+  }
+
+  /// Number of capture groups, the whole match included
+  size_t groups() const { return groups_ + 1; }
+
+ private:
+  bool atEnd() const { return pos_ >= pattern_.size(); }
+  char peek() const { return atEnd() ? '\0' : pattern_[pos_]; }
+  char next() {
+    if (atEnd()) {
+      throw Unsupported{};
+    }
+    return pattern_[pos_++];
+  }
+
+  Node parseAlternation() {
+    Node node{.type = Node::Type::Alternate};
+    node.children.push_back(parseConcat());
+    while (!atEnd() && peek() == '|') {
+      pos_++;
+      node.children.push_back(parseConcat());
+    }
+    if (node.children.size() == 1) {
+      return std::move(node.children.front());
+    }
+    return node;
+  }
+
+  Node parseConcat() {
+    Node node{.type = Node::Type::Concat};
+    while (!atEnd() && peek() != '|' && peek() != ')') {
+      node.children.push_back(parseRepeat());
+    }
+    return node;
+  }
+
+  Node parseRepeat() {
+    auto atom = parseAtom();
+    size_t min = 0;
+    size_t max = 0;
+    switch (peek()) {
+      case '*':
+        max = INFINITE;
+        break;
+      case '+':
+        min = 1;
+        max = INFINITE;
+        break;
+      case '?':
+        max = 1;
+        break;
+      case '{':
+        parseCount(min, max);
+        break;
+      default:
+        return atom;
+    }
+    pos_++;
+    if (atom.type == Node::Type::Assert) {
+      throw Unsupported{};
+    }
+    Node node{.type = Node::Type::Repeat, .min = min, .max = max};
+    if (peek() == '?') {
+      node.greedy = false;
+      pos_++;
+    }
+    // "a**" is an error, let std::regex say so
+    if (peek() == '*' || peek() == '+' || peek() == '?' || peek() == '{') {
+      throw Unsupported{};
+    }
+    node.children.push_back(std::move(atom));
+    return node;
+  }
+
+  // {n}, {n,} and {n,m}, leaves pos_ on the closing brace
+  void parseCount(size_t& min, size_t& max) {
+    pos_++;
+    min = parseNumber();
+    max = min;
+    if (peek() == ',') {
+      pos_++;
+      max = peek() == '}' ? INFINITE : parseNumber();
+    }
+    if (peek() != '}' || max < min || (max != INFINITE && max > 1000)) {
+      throw Unsupported{};
+    }
+  }
+
+  size_t parseNumber() {
+    size_t value = 0;
+    auto start = pos_;
+    while (std::isdigit(static_cast<unsigned char>(peek())) != 0 && pos_ - start < 4) {
+      value = value * 10 + (next() - '0');
+    }
+    if (pos_ == start || std::isdigit(static_cast<unsigned char>(peek())) != 0) {
+      throw Unsupported{};
+    }
+    return value;
+  }
+
+  Node parseAtom() {
+    char c = next();
+    switch (c) {
+      case '.': {
+        std::bitset<256> set;
+        set.set();
+        set.reset('\n');
+        set.reset('\r');
+        return classNode(set);
+      }
+      case '(':
+        return parseGroup();
+      case '[':
+        return parseClass();
+      case '\\':
+        return parseEscape();
+      case '^':
+        return Node{.type = Node::Type::Assert, .value = BEGIN};
+      case '$':
+        return Node{.type = Node::Type::Assert, .value = END};
+      case '*':
+      case '+':
+      case '?':
+      case '{':
+      case '}':
+      case ']':
+        throw Unsupported{};
+      default:
+        return literal(static_cast<unsigned char>(c));
+    }
+  }
+
+  Node parseGroup() {
+    uint32_t index = 0;
+    if (peek() == '?') {
+      // Only non-capturing groups, lookaheads are left to std::regex
+      pos_++;
+      if (next() != ':') {
+        throw Unsupported{};
+      }
+    } else {
+      index = ++groups_;
+    }
+    Node node{.type = Node::Type::Group, .value = index};
+    node.children.push_back(parseAlternation());
+    if (next() != ')') {
+      throw Unsupported{};
+    }
+    return node;
+  }
+
+  Node parseEscape() {
+    char c = next();
+    switch (c) {
+      case 'b':
+        return Node{.type = Node::Type::Assert, .value = WORD_BOUNDARY};
+      case 'B':
+        return Node{.type = Node::Type::Assert, .value = NOT_WORD_BOUNDARY};
+      default:
+        break;
+    }
+    std::bitset<256> set;
+    if (parseClassEscape(c, set)) {
+      return classNode(set);
+    }
+    return literal(parseCharEscape(c));
+  }
+
+  // \d, \w, \s and their negations
+  static bool parseClassEscape(char c, std::bitset<256>& set) {
+    switch (std::tolower(static_cast<unsigned char>(c))) {
+      case 'd':
+        set = makeSet(isDigit);
+        break;
+      case 'w':
+        set = makeSet(isWordChar);
+        break;
+      case 's':
+        set = makeSet(isSpace);
+        break;
+      default:
+        return false;
+    }
+    if (std::isupper(static_cast<unsigned char>(c)) != 0) {
+      set.flip();
+    }
+    return true;
+  }
+
+  // The byte of a character escape, the backslash and `c` already consumed
+  unsigned char parseCharEscape(char c) {
+    switch (c) {
+      case 'n':
+        return '\n';
+      case 'r':
+        return '\r';
+      case 't':
+        return '\t';
+      case 'f':
+        return '\f';
+      case 'v':
+        return '\v';
+      case '0':
+        if (std::isdigit(static_cast<unsigned char>(peek())) != 0) {
+          throw Unsupported{};
+        }
+        return '\0';
+      case 'x':
+        return parseHex(2);
+      case 'u':
+        return parseHex(4);
+      default:
+        // Backreferences, control escapes and unknown escapes
+        if (std::isalnum(static_cast<unsigned char>(c)) != 0) {
+          throw Unsupported{};
+        }
+        return static_cast<unsigned char>(c);
+    }
+  }
+
+  unsigned char parseHex(size_t digits) {
+    int value = 0;
+    for (size_t i = 0; i < digits; i++) {
+      int digit = hexValue(next());
+      if (digit < 0) {
+        throw Unsupported{};
+      }
+      value = value * 16 + digit;
+    }
+    // Code points above a byte aren't matched bytewise
+    if (value > (digits == 2 ? 0xFF : 0x7F)) {
+      throw Unsupported{};
+    }
+    return static_cast<unsigned char>(value);
+  }
+
+  Node parseClass() {
+    bool negate = peek() == '^';
+    if (negate) {
+      pos_++;
+    }
+    // "[]" and "[^]" are special in ECMAScript
+    if (peek() == ']') {
+      throw Unsupported{};
+    }
+    std::bitset<256> set;
+    while (true) {
+      char c = next();
+      if (c == ']') {
+        break;
+      }
+      // POSIX classes, collating elements and equivalence classes
+      if (c == '[' && (peek() == ':' || peek() == '.' || peek() == '=')) {
+        throw Unsupported{};
+      }
+      unsigned char low = c;
+      if (c == '\\') {
+        c = next();
+        std::bitset<256> escaped;
+        if (parseClassEscape(c, escaped)) {
+          if (peek() == '-' && pos_ + 1 < pattern_.size() && pattern_[pos_ + 1] != ']') {
+            throw Unsupported{};
+          }
+          set |= escaped;
+          continue;
+        }
+        low = c == 'b' ? '\b' : parseCharEscape(c);
+      }
+      unsigned char high = low;
+      if (peek() == '-' && pos_ + 1 < pattern_.size() && pattern_[pos_ + 1] != ']') {
+        pos_++;
+        c = next();
+        if (c == '\\') {
+          c = next();
+          std::bitset<256> escaped;
+          if (parseClassEscape(c, escaped)) {
+            throw Unsupported{};
+          }
+          high = c == 'b' ? '\b' : parseCharEscape(c);
+        } else if (c == '[') {
+          throw Unsupported{};
+        } else {
+          high = c;
+        }
+        if (high < low) {
+          throw Unsupported{};
+        }
+      }
+      for (unsigned c = low; c <= high; c++) {
+        set.set(c);
+      }
+    }
+    if (icase_) {
+      fold(set);
+    }
+    if (negate) {
+      set.flip();
+    }
+    return Node{.type = Node::Type::Class, .set = set};
+  }
+
+  Node literal(unsigned char c) {
+    std::bitset<256> set;
+    set.set(c);
+    if (icase_) {
+      fold(set);
+    }
+    return Node{.type = Node::Type::Class, .set = set};
+  }
+
+  Node classNode(const std::bitset<256>& set) const {
+    return Node{.type = Node::Type::Class, .set = set};
+  }
+
+  // Case insensitivity only applies to ASCII, like std::regex with byte strings
+  static void fold(std::bitset<256>& set) {
+    for (int c = 'a'; c <= 'z'; c++) {
+      if (set.test(c) || set.test(std::toupper(c))) {
+        set.set(c);
+        set.set(std::toupper(c));
+      }
+    }
+  }
+
+  std::string_view pattern_;
+  bool icase_;
+  size_t pos_ = 0;
+  uint32_t groups_ = 0;
+};
+
+/// Bytes a match of `node` can start with, returns whether it can also be empty
+bool firstBytes(const Node& node, std::bitset<256>& out) {
+  switch (node.type) {
+    case Node::Type::Empty:
+    case Node::Type::Assert:
+      return true;
+    case Node::Type::Class:
+      out |= node.set;
+      return false;
+    case Node::Type::Concat:
+      for (const auto& child : node.children) {
+        if (!firstBytes(child, out)) {
+          return false;
+        }
+      }
+      return true;
+    case Node::Type::Alternate: {
+      bool nullable = false;
+      for (const auto& child : node.children) {
+        nullable = firstBytes(child, out) || nullable;
+      }
+      return nullable;
+    }
+    case Node::Type::Repeat:
+      return firstBytes(node.children.front(), out) || node.min == 0;
+    case Node::Type::Group:
+      return firstBytes(node.children.front(), out);
+  }
+  return true;
+}
+
+}  // namespace
+
+/// Emits the program of a parsed pattern at the end of the set's program
+class RegexSet::Compiler {
+ public:
+  Compiler(RegexSet& set, uint32_t pattern)
+      : set_(set), pattern_(pattern), start_(set.insts_.size()) {}
+
+  void compile(const Node& node) {
+    emit({.op = Inst::Op::Save, .x = 0});
+    emitNode(node);
+    emit({.op = Inst::Op::Save, .x = 1});
+    emit({.op = Inst::Op::Match});
+  }
+
+ private:
+  uint32_t pc() const { return set_.insts_.size(); }
+
+  uint32_t emit(Inst inst) {
+    if (pc() - start_ >= MAX_INSTS) {
+      throw Unsupported{};
+    }
+    inst.pattern = pattern_;
+    set_.insts_.push_back(inst);
+    return set_.insts_.size() - 1;
+  }
+
+  void emitNode(const Node& node) {
+    switch (node.type) {
+      case Node::Type::Empty:
+        break;
+      case Node::Type::Class:
+        emitClass(node.set);
+        break;
+      case Node::Type::Concat:
+        for (const auto& child : node.children) {
+          emitNode(child);
+        }
+        break;
+      case Node::Type::Alternate: {
+        std::vector<uint32_t> jumps;
+        for (size_t i = 0; i + 1 < node.children.size(); i++) {
+          auto split = emit({.op = Inst::Op::Split, .x = pc() + 1});
+          emitNode(node.children[i]);
+          jumps.push_back(emit({.op = Inst::Op::Jmp}));
+          set_.insts_[split].y = pc();
+        }
+        emitNode(node.children.back());
+        for (auto jump : jumps) {
+          set_.insts_[jump].x = pc();
+        }
+        break;
+      }
+      case Node::Type::Repeat:
+        emitRepeat(node);
+        break;
+      case Node::Type::Group:
+        if (node.value != 0) {
+          emit({.op = Inst::Op::Save, .x = node.value * 2});
+        }
+        emitNode(node.children.front());
+        if (node.value != 0) {
+          emit({.op = Inst::Op::Save, .x = node.value * 2 + 1});
+        }
+        break;
+      case Node::Type::Assert:
+        emit({.op = Inst::Op::Assert, .x = node.value});
+        break;
+    }
+  }
+
+  void emitClass(const std::bitset<256>& set) {
+    if (set.count() == 1) {
+      for (uint32_t c = 0; c < 256; c++) {
+        if (set.test(c)) {
+          emit({.op = Inst::Op::Byte, .x = c});
+          return;
+        }
+      }
+    }
+    auto it = std::find(set_.classes_.begin(), set_.classes_.end(), set);
+    uint32_t index = it - set_.classes_.begin();
+    if (it == set_.classes_.end()) {
+      set_.classes_.push_back(set);
+    }
+    emit({.op = Inst::Op::Class, .x = index});
+  }
+
+  // The preferred branch of a split is x, the body for greedy repetitions
+  uint32_t emitSplit(bool greedy) {
+    return emit({.op = Inst::Op::Split, .x = greedy ? pc() + 1 : 0, .y = greedy ? 0 : pc() + 1});
+  }
+
+  void patchSplit(uint32_t split, bool greedy, uint32_t target) {
+    (greedy ? set_.insts_[split].y : set_.insts_[split].x) = target;
+  }
+
+  void emitRepeat(const Node& node) {
+    const auto& body = node.children.front();
+    // Past the minimum, ECMAScript rejects an iteration matching the empty string, which changes
+    // the match and the groups, e.g. "(.*?)*" on "c". The VM doesn't, leave those to std::regex.
+    std::bitset<256> first;
+    if (node.max > node.min && firstBytes(body, first)) {
+      throw Unsupported{};
+    }
+    for (size_t i = 0; i < node.min; i++) {
+      emitNode(body);
+    }
+    if (node.max == INFINITE) {
+      auto split = emitSplit(node.greedy);
+      emitNode(body);
+      emit({.op = Inst::Op::Jmp, .x = split});
+      patchSplit(split, node.greedy, pc());
+      return;
+    }
+    // x{1,3} is xx?x? nested as x(x(x)?)?, every split skipping to the end
+    std::vector<uint32_t> splits;
+    for (size_t i = node.min; i < node.max; i++) {
+      splits.push_back(emitSplit(node.greedy));
+      emitNode(body);
+    }
+    for (auto split : splits) {
+      patchSplit(split, node.greedy, pc());
+    }
+  }
+
+  RegexSet& set_;
+  uint32_t pattern_;
+  size_t start_;
+};
+
+std::string_view RegexMatch::operator[](size_t group) const {
+  if (!matched(group)) {
+    return {};
+  }
+  return input_.substr(slots_[group * 2], slots_[group * 2 + 1] - slots_[group * 2]);
+}
+
+std::string RegexMatch::format(std::string_view fmt) const {
+  std::string out;
+  out.reserve(fmt.size());
+  size_t pos = 0;
+  while (pos < fmt.size()) {
+    auto dollar = fmt.find('$', pos);
+    if (dollar == std::string_view::npos || dollar + 1 == fmt.size()) {
+      break;
+    }
+    out.append(fmt.substr(pos, dollar - pos));
+    pos = dollar + 1;
+    char c = fmt[pos];
+    if (c == '$') {
+      out += '$';
+      pos++;
+    } else if (c == '&') {
+      out.append((*this)[0]);
+      pos++;
+    } else if (c == '`') {
+      out.append(prefix());
+      pos++;
+    } else if (c == '\'') {
+      out.append(suffix());
+      pos++;
+    } else if (std::isdigit(static_cast<unsigned char>(c)) != 0) {
+      size_t group = c - '0';
+      pos++;
+      if (pos < fmt.size() && std::isdigit(static_cast<unsigned char>(fmt[pos])) != 0) {
+        group = group * 10 + (fmt[pos++] - '0');
+      }
+      out.append((*this)[group]);
+    } else {
+      out += '$';
+    }
+  }
+  out.append(fmt.substr(pos));
+  return out;
+}
+
+/// Threads of one step, in priority order, each with its capture slots
+struct RegexSet::Threads {
+  Threads(size_t insts, size_t slots) : visited(insts), slots(slots) {}
+
+  /// Mark `pc` as reached during this step, false if it already was
+  bool visit(uint32_t pc) {
+    if (visited[pc] == generation) {
+      return false;
+    }
+    visited[pc] = generation;
+    return true;
+  }
+
+  void push(uint32_t pc, const ptrdiff_t* captures) {
+    pcs.push_back(pc);
+    data.insert(data.end(), captures, captures + slots);
+  }
+
+  void clear() {
+    generation++;
+    pcs.clear();
+    data.clear();
+  }
+
+  std::vector<uint32_t> visited;
+  uint32_t generation = 1;
+  size_t slots;
+  std::vector<uint32_t> pcs;
+  std::vector<ptrdiff_t> data;
+};
+
+/// Pending work of addThread: a pc to follow, or a capture slot to restore
+struct RegexSet::Frame {
+  static constexpr uint32_t NO_SLOT = std::numeric_limits<uint32_t>::max();
+
+  uint32_t pc;
+  uint32_t slot;
+  ptrdiff_t value;
+};
+
+RegexSet::RegexSet(std::regex_constants::syntax_option_type flags) : flags_(flags) {}
+
+size_t RegexSet::add(std::string_view pattern) {
+  const auto index = size();
+  const auto insts = insts_.size();
+  const auto classes = classes_.size();
+  try {
+    Parser parser(pattern, (flags_ & std::regex_constants::icase) != 0);
+    auto node = parser.parse();
+    Compiler(*this, index).compile(node);
+    Pattern compiled{.start = static_cast<uint32_t>(insts), .groups = parser.groups()};
+    compiled.nullable = firstBytes(node, compiled.first);
+    patterns_.push_back(compiled);
+    slots_ = std::max(slots_, compiled.groups * 2);
+  } catch (const Unsupported&) {
+    insts_.resize(insts);
+    classes_.resize(classes);
+    // Throws std::regex_error for invalid patterns
+    std::regex regex(pattern.begin(), pattern.end(), flags_);
+    patterns_.push_back({.start = NO_START, .groups = regex.mark_count() + 1});
+    fallback_.emplace_back(index, std::move(regex));
+  }
+  // The DFA is rebuilt on the next search
+  numByteClasses_ = 0;
+  return index;
+}
+
+void RegexSet::addThread(Threads& list, uint32_t pc, std::string_view input, size_t pos,
+                         ptrdiff_t* slots, std::vector<Frame>& stack) const {
+  stack.push_back({pc, Frame::NO_SLOT, 0});
+  while (!stack.empty()) {
+    auto frame = stack.back();
+    stack.pop_back();
+    if (frame.slot != Frame::NO_SLOT) {
+      slots[frame.slot] = frame.value;
+      continue;
+    }
+    pc = frame.pc;
+    // Follow the preferred branch, queueing the other ones
+    bool alive = true;
+    while (alive && list.visit(pc)) {
+      const auto& inst = insts_[pc];
+      switch (inst.op) {
+        case Inst::Op::Jmp:
+          pc = inst.x;
+          break;
+        case Inst::Op::Split:
+          stack.push_back({inst.y, Frame::NO_SLOT, 0});
+          pc = inst.x;
+          break;
+        case Inst::Op::Save:
+          stack.push_back({0, inst.x, slots[inst.x]});
+          slots[inst.x] = static_cast<ptrdiff_t>(pos);
+          pc++;
+          break;
+        case Inst::Op::Assert:
+          alive = assertionHolds(inst.x, pos == 0, pos == input.size(),
+                                 pos > 0 && isWord(input[pos - 1]),
+                                 pos < input.size() && isWord(input[pos]));
+          pc++;
+          break;
+        default:
+          list.push(pc, slots);
+          alive = false;
+      }
+    }
+  }
+}
+
+void RegexSet::buildByteClasses() {
+  // Split the bytes on every set an instruction tests
+  std::vector<std::bitset<256>> sets = classes_;
+  std::bitset<256> literals;
+  for (const auto& inst : insts_) {
+    if (inst.op == Inst::Op::Byte && !literals.test(inst.x)) {
+      literals.set(inst.x);
+      sets.emplace_back().set(inst.x);
+    }
+  }
+  sets.push_back(makeSet(isWordChar));
+
+  byteClasses_.fill(0);
+  numByteClasses_ = 1;
+  std::vector<int> split;
+  for (const auto& set : sets) {
+    split.assign(numByteClasses_ * 2, -1);
+    size_t count = 0;
+    for (size_t c = 0; c < 256; c++) {
+      auto& target = split[byteClasses_[c] * 2 + (set.test(c) ? 1 : 0)];
+      if (target < 0) {
+        target = static_cast<int>(count++);
+      }
+      byteClasses_[c] = target;
+    }
+    numByteClasses_ = count;
+  }
+  for (size_t c = 256; c-- > 0;) {
+    classBytes_[byteClasses_[c]] = c;
+  }
+
+  resetDfa();
+  visited_.assign(insts_.size(), 0);
+  generation_ = 0;
+}
+
+void RegexSet::resetDfa() {
+  dfa_.clear();
+  dfaIndex_.clear();
+  matchSets_.assign(1, {});
+  matchSetIndex_.clear();
+  dfaState({}, BEGINNING);
+}
+
+uint32_t RegexSet::dfaState(std::vector<uint32_t>&& pcs, uint32_t context) {
+  std::string key(reinterpret_cast<const char*>(pcs.data()), pcs.size() * sizeof(uint32_t));
+  key += static_cast<char>(context);
+  auto [it, inserted] = dfaIndex_.try_emplace(std::move(key), dfa_.size());
+  if (inserted) {
+    dfa_.push_back({std::move(pcs), context, {}});
+    dfa_.back().next.assign(numByteClasses_ + 1, {UNKNOWN, 0});
+  }
+  return it->second;
+}
+
+std::pair<uint32_t, uint32_t> RegexSet::dfaStep(uint32_t state, size_t byteClass) {
+  const bool end = byteClass == numByteClasses_;
+  const unsigned char byte = end ? 0 : classBytes_[byteClass];
+  const uint32_t context = dfa_[state].context;
+  const bool before = (context & PREVIOUS_WORD) != 0;
+  const bool after = !end && isWord(byte);
+
+  // Follow the empty transitions from the state and from every pattern able to start here, as
+  // the search is unanchored
+  std::vector<uint32_t> stack = dfa_[state].pcs;
+  for (const auto& pattern : patterns_) {
+    if (pattern.start != NO_START && (pattern.nullable || (!end && pattern.first.test(byte)))) {
+      stack.push_back(pattern.start);
+    }
+  }
+  if (++generation_ == 0) {
+    std::fill(visited_.begin(), visited_.end(), 0);
+    generation_ = 1;
+  }
+
+  std::vector<uint32_t> matched;
+  std::vector<uint32_t> next;
+  while (!stack.empty()) {
+    auto pc = stack.back();
+    stack.pop_back();
+    if (visited_[pc] == generation_) {
+      continue;
+    }
+    visited_[pc] = generation_;
+    const auto& inst = insts_[pc];
+    switch (inst.op) {
+      case Inst::Op::Byte:
+        if (!end && byte == inst.x) {
+          next.push_back(pc + 1);
+        }
+        break;
+      case Inst::Op::Class:
+        if (!end && classes_[inst.x].test(byte)) {
+          next.push_back(pc + 1);
+        }
+        break;
+      case Inst::Op::Split:
+        stack.push_back(inst.y);
+        stack.push_back(inst.x);
+        break;
+      case Inst::Op::Jmp:
+        stack.push_back(inst.x);
+        break;
+      case Inst::Op::Save:
+        stack.push_back(pc + 1);
+        break;
+      case Inst::Op::Assert:
+        if (assertionHolds(inst.x, (context & BEGINNING) != 0, end, before, after)) {
+          stack.push_back(pc + 1);
+        }
+        break;
+      case Inst::Op::Match:
+        matched.push_back(inst.pattern);
+        break;
+    }
+  }
+
+  uint32_t matches = 0;
+  if (!matched.empty()) {
+    std::sort(matched.begin(), matched.end());
+    auto [it, inserted] = matchSetIndex_.try_emplace(matched, matchSets_.size());
+    if (inserted) {
+      matchSets_.push_back(std::move(matched));
+    }
+    matches = it->second;
+  }
+  if (end) {
+    return {0, matches};
+  }
+  std::sort(next.begin(), next.end());
+  next.erase(std::unique(next.begin(), next.end()), next.end());
+  return {dfaState(std::move(next), after ? PREVIOUS_WORD : 0), matches};
+}
+
+template <typename F>
+void RegexSet::dfaRun(std::string_view input, F&& onMatch) {
+  if (insts_.empty()) {
+    return;
+  }
+  if (numByteClasses_ == 0) {
+    buildByteClasses();
+  }
+
+  uint32_t state = 0;
+  for (size_t pos = 0; pos <= input.size(); pos++) {
+    size_t byteClass =
+        pos < input.size() ? byteClasses_[static_cast<unsigned char>(input[pos])] : numByteClasses_;
+    if (dfa_[state].next[byteClass].first == UNKNOWN) {
+      if (dfa_.size() >= MAX_DFA_STATES) {
+        // Start over rather than growing without bounds on adversarial patterns
+        auto pcs = std::move(dfa_[state].pcs);
+        auto context = dfa_[state].context;
+        resetDfa();
+        state = dfaState(std::move(pcs), context);
+      }
+      auto transition = dfaStep(state, byteClass);
+      dfa_[state].next[byteClass] = transition;
+    }
+    auto [next, matches] = dfa_[state].next[byteClass];
+    if (matches != 0 && !onMatch(matchSets_[matches])) {
+      return;
+    }
+    state = next;
+  }
+}
+
+size_t RegexSet::dfaSearch(std::string_view input) {
+  uint32_t best = NO_PATTERN;
+  dfaRun(input, [&best](const std::vector<uint32_t>& matched) {
+    best = std::min(best, matched.front());
+    return best != 0;
+  });
+  return best == NO_PATTERN ? size() : best;
+}
+
+std::vector<ptrdiff_t> RegexSet::capture(std::string_view input, size_t pattern) const {
+  const auto& compiled = patterns_[pattern];
+  Threads current(insts_.size(), slots_);
+  Threads next(insts_.size(), slots_);
+  std::vector<ptrdiff_t> scratch(slots_);
+  std::vector<Frame> stack;
+  std::vector<ptrdiff_t> best;
+
+  for (size_t pos = 0; pos <= input.size(); pos++) {
+    // Start a thread behind the running ones until the leftmost match is found
+    if (best.empty() &&
+        (compiled.nullable ||
+         (pos < input.size() && compiled.first.test(static_cast<unsigned char>(input[pos]))))) {
+      std::fill(scratch.begin(), scratch.end(), -1);
+      addThread(current, compiled.start, input, pos, scratch.data(), stack);
+    }
+
+    for (size_t i = 0; i < current.pcs.size(); i++) {
+      const auto& inst = insts_[current.pcs[i]];
+      const auto* slots = current.data.data() + i * slots_;
+      bool advance = false;
+      switch (inst.op) {
+        case Inst::Op::Byte:
+          advance = pos < input.size() && static_cast<unsigned char>(input[pos]) == inst.x;
+          break;
+        case Inst::Op::Class:
+          advance =
+              pos < input.size() && classes_[inst.x].test(static_cast<unsigned char>(input[pos]));
+          break;
+        default:
+          break;
+      }
+      if (advance) {
+        std::copy(slots, slots + slots_, scratch.begin());
+        addThread(next, current.pcs[i] + 1, input, pos + 1, scratch.data(), stack);
+      } else if (inst.op == Inst::Op::Match) {
+        // Threads after this one have a lower priority
+        best.assign(slots, slots + slots_);
+        break;
+      }
+    }
+
+    std::swap(current, next);
+    next.clear();
+    if (!best.empty() && current.pcs.empty()) {
+      break;
+    }
+  }
+  best.resize(compiled.groups * 2, -1);
+  return best;
+}
+
+std::optional<RegexMatch> RegexSet::search(std::string_view input) {
+  auto best = dfaSearch(input);
+
+  for (const auto& [index, regex] : fallback_) {
+    if (index >= best) {
+      break;
+    }
+    std::match_results<std::string_view::const_iterator> match;
+    if (std::regex_search(input.begin(), input.end(), match, regex)) {
+      std::vector<ptrdiff_t> slots;
+      for (const auto& group : match) {
+        slots.push_back(group.matched ? group.first - input.begin() : -1);
+        slots.push_back(group.matched ? group.second - input.begin() : -1);
+      }
+      return RegexMatch(input, index, std::move(slots));
+    }
+  }
+
+  if (best == size()) {
+    return std::nullopt;
+  }
+  return RegexMatch(input, best, capture(input, best));
+}
+
+std::vector<size_t> RegexSet::matchAll(std::string_view input) {
+  std::vector<bool> found(size());
+  dfaRun(input, [&found](const std::vector<uint32_t>& matched) {
+    for (auto pattern : matched) {
+      found[pattern] = true;
+    }
+    return true;
+  });
+  for (const auto& [index, regex] : fallback_) {
+    found[index] = std::regex_search(input.begin(), input.end(), regex);
+  }
+
+  std::vector<size_t> indices;
+  for (size_t i = 0; i < found.size(); i++) {
+    if (found[i]) {
+      indices.push_back(i);
+    }
+  }
+  return indices;
+}
+
+}  // namespace waybar::util
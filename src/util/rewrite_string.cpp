@@ -29,4 +29,43 @@ std::string rewriteString(const std::string& value, const Json::Value& rules) {
 
   return res;
 }
+
+RewriteRuleSet::RewriteRuleSet(const Json::Value& rules, size_t cacheCapacity)
+    : cache_(cacheCapacity) {
+  if (!rules.isObject()) {
+    return;
+  }
+
+  for (auto it = rules.begin(); it != rules.end(); ++it) {
+    if (it.key().isString() && it->isString()) {
+      auto key = it.key().asString();
+      try {
+        std::regex rule{key, std::regex_constants::icase};
+        matcher_.add("^(?:" + key + ")$");
+        rules_.push_back({std::move(rule), it->asString()});
+      } catch (const std::regex_error& e) {
+        spdlog::error("Invalid rule {}: {}", key, e.what());
+      }
+    }
+  }
+}
+
+std::string RewriteRuleSet::rewrite(std::string_view value) {
+  if (rules_.empty()) {
+    return std::string(value);
+  }
+
+  auto hash = LruCache<std::string>::hash(value);
+  if (const auto* cached = cache_.find(value, hash)) {
+    return *cached;
+  }
+
+  std::string res(value);
+  for (auto index : matcher_.matchAll(value)) {
+    const auto& rule = rules_[index];
+    res = std::regex_replace(res, rule.regex, rule.replacement);
+  }
+  return cache_.insert(value, hash, std::move(res));
+}
+
 }  // namespace waybar::util
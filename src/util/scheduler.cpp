@@ -0,0 +1,385 @@
+#include "util/scheduler.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace waybar::util {
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Resolution of the timer wheel
+constexpr std::chrono::nanoseconds TICK = 10ms;
+// Alignment grids, from the coarsest. A delay of at least 4 grid units is snapped to the grid
+constexpr std::array<std::chrono::nanoseconds, 3> ALIGN_GRIDS = {1s, 500ms, 100ms};
+// Workers kept alive when idle; more are spawned when jobs block for a long time. Workers running
+// a blocking job don't count against the cap.
+constexpr unsigned CORE_WORKERS = 2;
+constexpr unsigned MAX_WORKERS = 16;
+constexpr auto WORKER_IDLE_TIMEOUT = 10s;
+// Retry delay of a failed job that never asked for one, and bound of its backoff
+constexpr auto RETRY_MIN = 1s;
+constexpr auto RETRY_MAX = 60s;
+
+}  // namespace
+
+struct Scheduler::Job {
+  enum class Next { Repeat, Delay, Park };
+
+  Job(std::function<void()> func, bool blocking) : func(std::move(func)), blocking(blocking) {}
+
+  std::function<void()> func;
+  const bool blocking;
+  // Bumped every time the job is rescheduled, invalidates entries left in the wheel
+  uint64_t generation = 0;
+  bool queued = false;
+  bool running = false;
+  bool cancelled = false;
+  bool wake_pending = false;
+  std::thread::id worker;
+  Next next = Next::Repeat;
+  // Last delay the job asked for
+  duration delay{};
+  // Runs in a row that threw
+  unsigned failures = 0;
+
+  /// The last delay, doubled after every failure in a row
+  duration retryDelay() const {
+    duration retry = delay > duration::zero() ? delay : RETRY_MIN;
+    auto limit = std::max<duration>(retry, RETRY_MAX);
+    for (unsigned i = 1; i < failures && retry < limit; i++) {
+      retry *= 2;
+    }
+    return std::min(retry, limit);
+  }
+};
+
+/**
+ * Hierarchical timer wheel with 4 levels of 64 slots.
+ * Level N slot covers 64^N ticks, entries are cascaded down when the lower level wraps around.
+ * Not thread-safe, guarded by the scheduler mutex.
+ */
+class Scheduler::TimerWheel {
+ public:
+  struct Entry {
+    uint64_t expires;
+    JobPtr job;
+    uint64_t generation;
+
+    bool valid() const { return !job->cancelled && job->generation == generation; }
+  };
+
+  explicit TimerWheel(uint64_t now) : now_(now) {}
+
+  void insert(Entry entry) {
+    if (entry.expires <= now_) {
+      entry.expires = now_ + 1;
+    }
+    auto delta = entry.expires - now_;
+    size_t level = 0;
+    while (level < LEVELS - 1 && delta >= levelRange(level)) {
+      level++;
+    }
+    // Entries beyond the wheel range are parked in the farthest slot and re-inserted later
+    auto at = std::min(entry.expires, now_ + levelRange(LEVELS - 1) - 1);
+    slots_[level][(at >> (BITS * level)) & MASK].push_back(std::move(entry));
+  }
+
+  /// Move the wheel to `target`, collecting the entries that expired on the way
+  void advance(uint64_t target, std::vector<Entry>& expired) {
+    while (now_ < target) {
+      now_ = nextStep(target);
+      for (size_t level = LEVELS - 1; level > 0; level--) {
+        if ((now_ & (levelRange(level - 1) - 1)) == 0) {
+          collect(slots_[level][(now_ >> (BITS * level)) & MASK], expired);
+        }
+      }
+      collect(slots_[0][now_ & MASK], expired);
+    }
+  }
+
+  /// Earliest tick a valid entry expires at
+  std::optional<uint64_t> nextExpiry() {
+    std::optional<uint64_t> result;
+    for (size_t level = 0; level < LEVELS; level++) {
+      auto base = now_ >> (BITS * level);
+      for (uint64_t i = 1; i <= SLOTS; i++) {
+        auto& slot = slots_[level][(base + i) & MASK];
+        std::erase_if(slot, [](const Entry& e) { return !e.valid(); });
+        if (!slot.empty()) {
+          auto it = std::ranges::min_element(slot, {}, &Entry::expires);
+          if (!result || it->expires < *result) {
+            result = it->expires;
+          }
+          break;
+        }
+      }
+    }
+    return result;
+  }
+
+ private:
+  static constexpr size_t LEVELS = 4;
+  static constexpr size_t BITS = 6;
+  static constexpr uint64_t SLOTS = 1 << BITS;
+  static constexpr uint64_t MASK = SLOTS - 1;
+
+  static constexpr uint64_t levelRange(size_t level) {
+    return uint64_t{1} << (BITS * (level + 1));
+  }
+
+  /// First tick in (now, target] where a slot has to be processed
+  uint64_t nextStep(uint64_t target) const {
+    auto best = target;
+    for (uint64_t i = 1; i <= SLOTS && now_ + i < best; i++) {
+      if (!slots_[0][(now_ + i) & MASK].empty()) {
+        best = now_ + i;
+      }
+    }
+    for (size_t level = 1; level < LEVELS; level++) {
+      auto base = now_ >> (BITS * level);
+      for (uint64_t i = 1; i <= SLOTS; i++) {
+        auto tick = (base + i) << (BITS * level);
+        if (tick >= best) {
+          break;
+        }
+        if (!slots_[level][(base + i) & MASK].empty()) {
+          best = tick;
+          break;
+        }
+      }
+    }
+    return best;
+  }
+
+  void collect(std::vector<Entry>& slot, std::vector<Entry>& expired) {
+    auto entries = std::move(slot);
+    slot.clear();
+    for (auto& entry : entries) {
+      if (!entry.valid()) {
+        continue;
+      }
+      if (entry.expires <= now_) {
+        expired.push_back(std::move(entry));
+      } else {
+        insert(std::move(entry));
+      }
+    }
+  }
+
+  uint64_t now_;
+  std::array<std::array<std::vector<Entry>, SLOTS>, LEVELS> slots_;
+};
+
+Scheduler& Scheduler::instance() {
+  // Intentionally leaked: jobs are cancelled by their owners, workers must outlive static
+  // destructors
+  static auto* scheduler = new Scheduler();
+  return *scheduler;
+}
+
+Scheduler::Scheduler() : epoch_(clock::now()) { wheel_ = std::make_unique<TimerWheel>(0); }
+
+Scheduler::JobPtr Scheduler::add(std::function<void()> func, bool blocking) {
+  std::lock_guard lock(mutex_);
+  if (!driver_started_) {
+    driver_started_ = true;
+    std::thread(&Scheduler::driverLoop, this).detach();
+  }
+  return std::make_shared<Job>(std::move(func), blocking);
+}
+
+void Scheduler::wake(const JobPtr& job) {
+  std::lock_guard lock(mutex_);
+  if (job->cancelled) {
+    return;
+  }
+  if (job->running) {
+    job->wake_pending = true;
+    return;
+  }
+  job->generation++;
+  enqueueLocked(job);
+}
+
+void Scheduler::arm(const JobPtr& job, duration delay) {
+  std::lock_guard lock(mutex_);
+  if (job->running && job->worker == std::this_thread::get_id()) {
+    job->next = Job::Next::Delay;
+    job->delay = delay;
+    return;
+  }
+  armLocked(job, delay);
+}
+
+void Scheduler::park(const JobPtr& job) {
+  std::lock_guard lock(mutex_);
+  if (job->running && job->worker == std::this_thread::get_id()) {
+    job->next = Job::Next::Park;
+    return;
+  }
+  job->generation++;
+}
+
+void Scheduler::cancel(const JobPtr& job) {
+  std::unique_lock lock(mutex_);
+  job->cancelled = true;
+  job->generation++;
+  if (job->worker == std::this_thread::get_id()) {
+    return;
+  }
+  done_cv_.wait(lock, [&job] { return !job->running; });
+  // The timer wheel may hold on to the job for a while: release the captured state (e.g. fd
+  // watches) now, and outside of the lock
+  auto func = std::exchange(job->func, nullptr);
+  lock.unlock();
+}
+
+void Scheduler::enqueueLocked(const JobPtr& job) {
+  if (job->queued || job->cancelled) {
+    return;
+  }
+  job->queued = true;
+  queue_.push_back(job);
+  // A worker that was just spawned counts as idle, but only takes one of the queued jobs
+  if (queue_.size() > idle_workers_ &&
+      (job->blocking || workers_ - blocking_workers_ < MAX_WORKERS)) {
+    // The new worker is accounted as idle until it picks up a job
+    workers_++;
+    idle_workers_++;
+    std::thread(&Scheduler::workerLoop, this).detach();
+  } else {
+    worker_cv_.notify_one();
+  }
+}
+
+void Scheduler::armLocked(const JobPtr& job, duration delay) {
+  if (job->cancelled) {
+    return;
+  }
+  job->generation++;
+  if (delay <= duration::zero()) {
+    enqueueLocked(job);
+    return;
+  }
+
+  // Snap the deadline to the nearest boundary on the wall clock, so that jobs with compatible
+  // intervals expire together. Rounding up would add the time a run took to every period: a
+  // job re-armed for 1s from within its run fired every 1.1s. Modules aligning themselves on the
+  // wall clock (e.g. clock) already ask for a boundary.
+  auto grid = std::chrono::duration_cast<duration>(TICK);
+  for (auto g : ALIGN_GRIDS) {
+    if (delay >= 4 * g) {
+      grid = std::chrono::duration_cast<duration>(g);
+      break;
+    }
+  }
+  auto now = std::chrono::system_clock::now().time_since_epoch();
+  auto deadline = now + delay;
+  if (auto rem = deadline % grid; rem >= grid / 2) {
+    deadline += grid - rem;
+  } else {
+    deadline -= rem;
+  }
+  auto expires = clock::now() + (deadline - now);
+
+  advanceLocked();
+  auto tick = static_cast<uint64_t>((expires - epoch_ + TICK - 1ns) / TICK);
+  wheel_->insert({tick, job, job->generation});
+  if (expires < next_wakeup_) {
+    driver_cv_.notify_one();
+  }
+}
+
+void Scheduler::advanceLocked() {
+  std::vector<TimerWheel::Entry> expired;
+  wheel_->advance(currentTick(), expired);
+  for (auto& entry : expired) {
+    if (entry.valid()) {
+      enqueueLocked(entry.job);
+    }
+  }
+}
+
+uint64_t Scheduler::currentTick() const {
+  return static_cast<uint64_t>((clock::now() - epoch_) / TICK);
+}
+
+void Scheduler::driverLoop() {
+  std::unique_lock lock(mutex_);
+  while (true) {
+    advanceLocked();
+    auto next = wheel_->nextExpiry();
+    if (next) {
+      next_wakeup_ = epoch_ + TICK * static_cast<int64_t>(*next);
+      driver_cv_.wait_until(lock, next_wakeup_);
+    } else {
+      next_wakeup_ = clock::time_point::max();
+      driver_cv_.wait(lock);
+    }
+  }
+}
+
+void Scheduler::workerLoop() {
+  std::unique_lock lock(mutex_);
+  while (true) {
+    auto has_work =
+        worker_cv_.wait_for(lock, WORKER_IDLE_TIMEOUT, [this] { return !queue_.empty(); });
+    if (!has_work) {
+      if (workers_ > CORE_WORKERS) {
+        workers_--;
+        idle_workers_--;
+        return;
+      }
+      continue;
+    }
+
+    auto job = std::move(queue_.front());
+    queue_.pop_front();
+    job->queued = false;
+    if (job->cancelled) {
+      continue;
+    }
+    idle_workers_--;
+    job->running = true;
+    job->worker = std::this_thread::get_id();
+    job->wake_pending = false;
+    job->next = Job::Next::Repeat;
+    blocking_workers_ += job->blocking ? 1 : 0;
+    lock.unlock();
+
+    bool failed = false;
+    try {
+      job->func();
+    } catch (const std::exception& e) {
+      spdlog::error("Scheduled job failed: {}", e.what());
+      failed = true;
+    }
+
+    lock.lock();
+    blocking_workers_ -= job->blocking ? 1 : 0;
+    job->running = false;
+    job->worker = {};
+    job->failures = failed ? job->failures + 1 : 0;
+    if (!job->cancelled) {
+      if (failed) {
+        // A transient error (e.g. a file that can't be opened) must not stop the job for good
+        armLocked(job, job->retryDelay());
+      } else if (job->wake_pending) {
+        enqueueLocked(job);
+      } else if (job->next == Job::Next::Repeat) {
+        enqueueLocked(job);
+      } else if (job->next == Job::Next::Delay) {
+        armLocked(job, job->delay);
+      }
+    }
+    idle_workers_++;
+    done_cv_.notify_all();
+  }
+}
+
+}  // namespace waybar::util
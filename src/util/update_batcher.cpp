@@ -0,0 +1,130 @@
+#include "util/update_batcher.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include "AModule.hpp"
+
+namespace waybar::util {
+
+namespace {
+
+// Longest wait for a frame clock tick, the compositor stops sending frames for hidden outputs
+constexpr auto TICK_TIMEOUT = std::chrono::milliseconds(250);
+
+}  // namespace
+
+UpdateBatcher::UpdateBatcher(Gtk::Widget& window, const Json::Value& config) : window_(window) {
+  if (const auto& coalescing = config["update-coalescing"]; coalescing.isUInt()) {
+    window_length_ = std::chrono::milliseconds(coalescing.asUInt());
+    mode_ = window_length_.count() > 0 ? Mode::Window : Mode::Immediate;
+  } else if (!coalescing.isNull()) {
+    spdlog::warn("update-coalescing must be a positive number of milliseconds, ignoring it");
+  }
+  if (mode_ == Mode::FrameClock) {
+    unmap_ = window_.signal_unmap().connect(sigc::mem_fun(*this, &UpdateBatcher::onUnmap));
+  }
+}
+
+UpdateBatcher::~UpdateBatcher() {
+  unmap_.disconnect();
+  removeTick();
+  timer_.disconnect();
+  spdlog::debug("Bar updates: {} requested, {} merged", requested_, merged_);
+}
+
+void UpdateBatcher::schedule(AModule* module, const std::string& name) {
+  requested_++;
+  if (mode_ == Mode::Immediate) {
+    runUpdate(module, name);
+    return;
+  }
+  if (!dirty_.insert(module).second) {
+    merged_++;
+    return;
+  }
+  pending_.emplace_back(module, name);
+  requestFlush();
+}
+
+void UpdateBatcher::cancel(AModule* module) {
+  if (dirty_.erase(module) != 0) {
+    std::erase_if(pending_, [module](const auto& entry) { return entry.first == module; });
+  }
+}
+
+void UpdateBatcher::requestFlush() {
+  if (flush_requested_) {
+    return;
+  }
+  flush_requested_ = true;
+  if (mode_ == Mode::Window) {
+    timer_ = Glib::signal_timeout().connect(
+        [this] {
+          flush();
+          return false;
+        },
+        window_length_.count());
+  } else if (window_.get_mapped()) {
+    tick_id_ = window_.add_tick_callback([this](const Glib::RefPtr<Gdk::FrameClock>&) {
+      tick_id_ = 0;
+      flush();
+      return false;
+    });
+    // In case the frame clock stopped ticking, whichever comes first flushes
+    timer_ = Glib::signal_timeout().connect(
+        [this] {
+          flush();
+          return false;
+        },
+        TICK_TIMEOUT.count());
+  } else {
+    flushOnIdle();
+  }
+}
+
+void UpdateBatcher::flushOnIdle() {
+  timer_ = Glib::signal_idle().connect([this] {
+    flush();
+    return false;
+  });
+}
+
+void UpdateBatcher::onUnmap() {
+  // The frame clock of an unmapped window doesn't tick, the pending tick would never come
+  if (tick_id_ != 0) {
+    removeTick();
+    timer_.disconnect();
+    flushOnIdle();
+  }
+}
+
+void UpdateBatcher::removeTick() {
+  if (tick_id_ != 0) {
+    window_.remove_tick_callback(tick_id_);
+    tick_id_ = 0;
+  }
+}
+
+void UpdateBatcher::flush() {
+  flush_requested_ = false;
+  removeTick();
+  timer_.disconnect();
+  // Updates may mark modules dirty again, they go to the next batch
+  auto batch = std::move(pending_);
+  pending_.clear();
+  dirty_.clear();
+  for (const auto& [module, name] : batch) {
+    runUpdate(module, name);
+  }
+  spdlog::trace("Bar updates: flushed {}, {} merged so far", batch.size(), merged_);
+}
+
+void UpdateBatcher::runUpdate(AModule* module, const std::string& name) {
+  try {
+    module->update();
+  } catch (const std::exception& e) {
+    spdlog::error("{}: {}", name, e.what());
+  }
+}
+
+}  // namespace waybar::util
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <spdlog/spdlog.h>
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Timing of the [.][benchmark] test cases, which only run when asked for by tag.
+ *
+ * Each run() calls a function `iterations` times with the iteration number, and adds up what it
+ * returns so that the compiler can't drop the calls. report() logs the average duration of a
+ * call for each run.
+ */
+class Benchmark {
+ public:
+  Benchmark(std::string name, size_t iterations)
+      : name_(std::move(name)), iterations_(iterations) {}
+
+  /// Microseconds per call of `func`
+  template <typename F>
+  double run(std::string label, F&& func) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations_; i++) {
+      sink_ += static_cast<size_t>(func(i));
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    auto perCall = elapsed.count() / iterations_;
+    results_.emplace_back(std::move(label), perCall);
+    return perCall;
+  }
+
+  /// Sum of what the calls returned, for the test to check
+  size_t sink() const { return sink_; }
+
+  void report() const {
+    std::string line = name_ + ":";
+    for (const auto& [label, perCall] : results_) {
+      line += fmt::format(" {:.3f} us {},", perCall, label);
+    }
+    line.pop_back();
+    spdlog::info("{}", line);
+  }
+
+ private:
+  std::string name_;
+  size_t iterations_;
+  size_t sink_ = 0;
+  std::vector<std::pair<std::string, double>> results_;
+};
@@ -4,6 +4,8 @@
 #include <catch2/catch.hpp>
 #endif
 
+#include <future>
+
 #include "fixtures/IPCTestFixture.hpp"
 
 namespace fs = std::filesystem;
@@ -57,3 +59,136 @@ TEST_CASE_METHOD(IPCTestFixture, "getSocket1Reply throws on no socket", "[getSoc
 
   CHECK_THROWS(getSocket1Reply(request));
 }
+
+TEST_CASE_METHOD(IPCTestFixture, "getSocket1JsonReply batches and caches queries",
+                 "[getSocket1JsonReply]") {
+  auto socketDir = tempDir / "hypr" / instanceSig;
+  fs::create_directories(socketDir);
+  socketFolder_ = socketDir;
+  setenv("HYPRLAND_INSTANCE_SIGNATURE", instanceSig, 1);
+
+  FakeSocket1 server(socketDir / ".socket.sock");
+
+  parseIPC("activewindow>>kitty,title");
+  REQUIRE(getSocket1JsonReply("clients")["query"] == "clients");
+  REQUIRE(getSocket1JsonReply("monitors")["query"] == "monitors");
+  REQUIRE(server.requests() == std::vector<std::string>{"j/clients", "j/monitors"});
+
+  // cached until the next event
+  REQUIRE(getSocket1JsonReply("clients")["query"] == "clients");
+  REQUIRE(server.requests().size() == 2);
+
+  // the queries seen on the last activewindow event are fetched in one round-trip
+  parseIPC("activewindow>>kitty,other title");
+  REQUIRE(getSocket1JsonReply("monitors")["query"] == "monitors");
+  REQUIRE(getSocket1JsonReply("clients")["query"] == "clients");
+  REQUIRE(server.requests().size() == 3);
+  REQUIRE(server.requests().back() == "[[BATCH]]j/monitors;j/clients;");
+
+  unsetenv("HYPRLAND_INSTANCE_SIGNATURE");
+}
+
+TEST_CASE_METHOD(IPCTestFixture, "getSocket1JsonReply only prefetches the last event's queries",
+                 "[getSocket1JsonReply]") {
+  auto socketDir = tempDir / "hypr" / instanceSig;
+  fs::create_directories(socketDir);
+  socketFolder_ = socketDir;
+  setenv("HYPRLAND_INSTANCE_SIGNATURE", instanceSig, 1);
+
+  FakeSocket1 server(socketDir / ".socket.sock", {{"monitors", "unknown request"}});
+
+  parseIPC("activewindow>>kitty,a");
+  getSocket1JsonText("clients");
+  getSocket1JsonText("monitors");
+  REQUIRE(server.requests().size() == 2);
+
+  // The failed prefetch keeps its slot in the batch reply, and isn't cached
+  parseIPC("activewindow>>kitty,b");
+  REQUIRE(*getSocket1JsonText("clients") == R"({"query": "clients"})");
+  REQUIRE(server.requests().back() == "[[BATCH]]j/clients;j/monitors;");
+  REQUIRE(*getSocket1JsonText("monitors") == "unknown request");
+  REQUIRE(server.requests().back() == "j/monitors");
+
+  // Once an event doesn't ask for monitors, the next one doesn't prefetch it
+  parseIPC("activewindow>>kitty,c");
+  getSocket1JsonText("clients");
+  REQUIRE(server.requests().back() == "[[BATCH]]j/clients;j/monitors;");
+  parseIPC("activewindow>>kitty,d");
+  getSocket1JsonText("clients");
+  REQUIRE(server.requests().back() == "j/clients");
+
+  unsetenv("HYPRLAND_INSTANCE_SIGNATURE");
+}
+
+TEST_CASE_METHOD(IPCTestFixture, "queueSocket1Command sends commands off the calling thread",
+                 "[queueSocket1Command]") {
+  auto socketDir = tempDir / "hypr" / instanceSig;
+  fs::create_directories(socketDir);
+  socketFolder_ = socketDir;
+  setenv("HYPRLAND_INSTANCE_SIGNATURE", instanceSig, 1);
+
+  FakeSocket1 server(socketDir / ".socket.sock");
+  std::promise<std::string> reply;
+  queueSocket1Command("dispatch workspace 2", "",
+                      [&reply](const std::string& text) { reply.set_value(text); });
+  auto future = reply.get_future();
+  REQUIRE(future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+  REQUIRE_FALSE(future.get().empty());
+  REQUIRE(server.requests() == std::vector<std::string>{"dispatch workspace 2"});
+
+  unsetenv("HYPRLAND_INSTANCE_SIGNATURE");
+}
+
+namespace {
+
+class RecordingHandler : public hyprland::EventHandler {
+ public:
+  explicit RecordingHandler(std::function<void()> onCall = {}) : onCall_(std::move(onCall)) {}
+
+  void onEvent(const std::string& ev) override {
+    events.push_back(ev);
+    if (onCall_) {
+      onCall_();
+    }
+  }
+
+  std::vector<std::string> events;
+
+ private:
+  std::function<void()> onCall_;
+};
+
+}  // namespace
+
+TEST_CASE_METHOD(IPCTestFixture, "Events are dispatched by name", "[registerForIPC]") {
+  RecordingHandler submap;
+  RecordingHandler layout;
+  registerForIPC("submap", &submap);
+  registerForIPC("activelayout", &layout);
+
+  parseIPC("submap>>resize");
+  parseIPC("submapv2>>resize");
+  parseIPC("activelayout>>kbd,us");
+  REQUIRE(submap.events == std::vector<std::string>{"submap>>resize"});
+  REQUIRE(layout.events == std::vector<std::string>{"activelayout>>kbd,us"});
+
+  unregisterForIPC(&submap);
+  parseIPC("submap>>");
+  REQUIRE(submap.events.size() == 1);
+  unregisterForIPC(&layout);
+}
+
+TEST_CASE_METHOD(IPCTestFixture, "Handlers can unregister themselves", "[registerForIPC]") {
+  RecordingHandler* self = nullptr;
+  RecordingHandler handler([&] { unregisterForIPC(self); });
+  RecordingHandler other;
+  self = &handler;
+  registerForIPC("submap", &handler);
+  registerForIPC("submap", &other);
+
+  parseIPC("submap>>resize");
+  parseIPC("submap>>");
+  REQUIRE(handler.events.size() == 1);
+  REQUIRE(other.events.size() == 2);
+  unregisterForIPC(&other);
+}
@@ -0,0 +1,116 @@
+#include "modules/hyprland/event.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <string>
+#include <vector>
+
+#include "../benchmark.hpp"
+
+namespace hyprland = waybar::modules::hyprland;
+
+TEST_CASE("Event lines are split into name and payload", "[event]") {
+  auto event = hyprland::Event::parse("openwindow>>80e62df0,2,kitty,vim ~/a>b.txt");
+  REQUIRE(event.name == "openwindow");
+  REQUIRE(event.payload == "80e62df0,2,kitty,vim ~/a>b.txt");
+
+  event = hyprland::Event::parse("configreloaded>>");
+  REQUIRE(event.name == "configreloaded");
+  REQUIRE(event.payload.empty());
+
+  event = hyprland::Event::parse("configreloaded");
+  REQUIRE(event.name == "configreloaded");
+  REQUIRE(event.payload.empty());
+}
+
+TEST_CASE("Event payloads are decoded in place", "[event]") {
+  const std::string line = "openwindow>>80e62df0,special:scratch,kitty,title, with, commas";
+  auto event = hyprland::Event::parse(line);
+  auto opened = hyprland::OpenWindowEvent::parse(event.payload);
+  REQUIRE(opened);
+  REQUIRE(opened->address == "80e62df0");
+  REQUIRE(opened->workspaceName == "special:scratch");
+  REQUIRE(opened->windowClass == "kitty");
+  REQUIRE(opened->title == "title, with, commas");
+  // views into the line, nothing copied
+  REQUIRE(opened->title.data() >= line.data());
+  REQUIRE(opened->title.data() < line.data() + line.size());
+
+  auto moved = hyprland::MoveWindowEvent::parse("80e62df0,4,name, with comma");
+  REQUIRE(moved);
+  REQUIRE(moved->workspaceId == "4");
+  REQUIRE(moved->workspaceName == "name, with comma");
+
+  auto title = hyprland::WindowValueEvent::parse("80e62df0,");
+  REQUIRE(title);
+  REQUIRE(title->value.empty());
+
+  auto movedWorkspace = hyprland::MoveWorkspaceEvent::parse("3,a,b,DP-1");
+  REQUIRE(movedWorkspace);
+  REQUIRE(movedWorkspace->id == "3");
+  REQUIRE(movedWorkspace->name == "a,b");
+  REQUIRE(movedWorkspace->monitor == "DP-1");
+
+  auto focused = hyprland::MonitorEvent::parseFocused("DP-2,-98");
+  REQUIRE(focused);
+  REQUIRE(focused->monitor == "DP-2");
+  REQUIRE(hyprland::parseInt(focused->workspace) == -98);
+
+  auto special = hyprland::MonitorEvent::parseSpecial(",DP-1");
+  REQUIRE(special);
+  REQUIRE(special->workspace.empty());
+  REQUIRE(special->monitor == "DP-1");
+}
+
+TEST_CASE("Malformed event payloads are rejected", "[event]") {
+  REQUIRE_FALSE(hyprland::OpenWindowEvent::parse("80e62df0,2,kitty"));
+  REQUIRE_FALSE(hyprland::MoveWindowEvent::parse("80e62df0"));
+  REQUIRE_FALSE(hyprland::WorkspaceEvent::parse("3"));
+  REQUIRE_FALSE(hyprland::MoveWorkspaceEvent::parse("3,DP-1"));
+  REQUIRE_FALSE(hyprland::parseInt("3a"));
+  REQUIRE_FALSE(hyprland::parseInt(""));
+}
+
+namespace {
+
+// The decoding done before the typed events: one std::string per field
+struct CopiedOpenWindow {
+  std::string address, workspaceName, windowClass, title;
+};
+
+CopiedOpenWindow copySplit(const std::string& ev) {
+  std::string eventName(begin(ev), begin(ev) + ev.find_first_of('>'));
+  std::string payload = ev.substr(eventName.size() + 2);
+  size_t last = 0;
+  size_t next = payload.find(',');
+  CopiedOpenWindow result;
+  result.address = payload.substr(last, next - last);
+  last = next;
+  next = payload.find(',', next + 1);
+  result.workspaceName = payload.substr(last + 1, next - last - 1);
+  last = next;
+  next = payload.find(',', next + 1);
+  result.windowClass = payload.substr(last + 1, next - last - 1);
+  result.title = payload.substr(next + 1);
+  return result;
+}
+
+}  // namespace
+
+TEST_CASE("Event decoding microbenchmark", "[.][benchmark][event]") {
+  const std::string line =
+      "openwindow>>5612f9e94d90,3,org.wezfurlong.wezterm,nvim src/modules/hyprland/workspaces.cpp "
+      "- ~/src/waybar";
+  Benchmark benchmark("openwindow decoding", 1000000);
+  benchmark.run("with copies", [&](size_t) { return copySplit(line).title.size(); });
+  benchmark.run("with views", [&](size_t) {
+    auto event = hyprland::Event::parse(line);
+    return hyprland::OpenWindowEvent::parse(event.payload)->title.size();
+  });
+  benchmark.report();
+  REQUIRE(benchmark.sink() > 0);
+}
@@ -1,3 +1,11 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <functional>
+#include <map>
+
 #include "modules/hyprland/backend.hpp"
 
 namespace fs = std::filesystem;
@@ -23,3 +31,85 @@ class IPCMock : public IPCTestFixture {
  protected:
   const char* instanceSig = "instance_sig";
 };
+
+/// Minimal socket1 server answering queries from `replies`, or with {"query": "<name>"}
+class FakeSocket1 {
+ public:
+  explicit FakeSocket1(const fs::path& path, std::map<std::string, std::string> replies = {})
+      : replies_(std::move(replies)) {
+    fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(path.c_str());
+    bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    listen(fd_, 8);
+    thread_ = std::thread([this] { serve(); });
+  }
+
+  ~FakeSocket1() {
+    shutdown(fd_, SHUT_RDWR);
+    close(fd_);
+    thread_.join();
+  }
+
+  std::vector<std::string> requests() {
+    std::lock_guard lock(mutex_);
+    return requests_;
+  }
+
+  void setReply(const std::string& name, std::string reply) {
+    std::lock_guard lock(mutex_);
+    replies_[name] = std::move(reply);
+  }
+
+ private:
+  std::string reply(const std::string& query) {
+    std::lock_guard lock(mutex_);
+    auto name = query.substr(2);
+    if (auto it = replies_.find(name); it != replies_.end()) {
+      return it->second;
+    }
+    return R"({"query": ")" + name + "\"}";
+  }
+
+  void serve() {
+    while (true) {
+      int client = accept(fd_, nullptr, nullptr);
+      if (client == -1) {
+        return;
+      }
+      std::array<char, 1024> buffer;
+      auto n = read(client, buffer.data(), buffer.size());
+      std::string request(buffer.data(), std::max<ssize_t>(n, 0));
+      {
+        std::lock_guard lock(mutex_);
+        requests_.push_back(request);
+      }
+
+      std::string response;
+      if (request.starts_with("[[BATCH]]")) {
+        std::string_view queries(request);
+        queries.remove_prefix(9);
+        while (!queries.empty()) {
+          auto end = queries.find(';');
+          if (!response.empty()) {
+            response += "\n\n\n";
+          }
+          response += reply(std::string(queries.substr(0, end)));
+          queries.remove_prefix(end == std::string_view::npos ? queries.size() : end + 1);
+        }
+      } else {
+        response = reply(request);
+      }
+      write(client, response.data(), response.size());
+      close(client);
+    }
+  }
+
+  int fd_;
+  std::map<std::string, std::string> replies_;
+  std::mutex mutex_;
+  std::vector<std::string> requests_;
+  std::thread thread_;
+};
@@ -0,0 +1,214 @@
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+
+#include <fstream>
+#include <sstream>
+
+#include "../benchmark.hpp"
+#include "fixtures/IPCTestFixture.hpp"
+#include "util/json.hpp"
+
+namespace hyprland = waybar::modules::hyprland;
+
+namespace {
+
+const std::map<std::string, std::string> SNAPSHOT = {
+    {"monitors", R"([
+      {"id": 0, "name": "DP-1", "focused": true,
+       "activeWorkspace": {"id": 1, "name": "1"}, "specialWorkspace": {"id": 0, "name": ""}},
+      {"id": 1, "name": "DP-2", "focused": false,
+       "activeWorkspace": {"id": 2, "name": "2"}, "specialWorkspace": {"id": 0, "name": ""}}
+    ])"},
+    {"workspaces", R"([
+      {"id": 1, "name": "1", "monitor": "DP-1", "windows": 1, "hasfullscreen": false,
+       "lastwindow": "0xa", "lastwindowtitle": "shell"},
+      {"id": 2, "name": "2", "monitor": "DP-2", "windows": 1, "hasfullscreen": false,
+       "lastwindow": "0xb", "lastwindowtitle": "browser"}
+    ])"},
+    {"clients", R"([
+      {"address": "0xa", "mapped": true, "hidden": false, "workspace": {"id": 1, "name": "1"},
+       "floating": false, "monitor": 0, "class": "kitty", "title": "shell",
+       "initialClass": "kitty", "initialTitle": "shell", "fullscreen": 0},
+      {"address": "0xb", "mapped": true, "hidden": false, "workspace": {"id": 2, "name": "2"},
+       "floating": false, "monitor": 1, "class": "firefox", "title": "browser",
+       "initialClass": "firefox", "initialTitle": "browser", "fullscreen": 0}
+    ])"},
+    {"activewindow", R"({"address": "0xa"})"},
+};
+
+class Handler : public hyprland::EventHandler {
+ public:
+  void onEvent(const std::string& ev) override { events.push_back(ev); }
+
+  std::vector<std::string> events;
+};
+
+class DeltaRecorder : public hyprland::StateListener {
+ public:
+  void onStateChanged(const std::vector<hyprland::StateDelta>& deltas) override {
+    received.insert(received.end(), deltas.begin(), deltas.end());
+  }
+
+  bool has(hyprland::StateDelta::Kind kind) const {
+    return std::ranges::any_of(received, [kind](const auto& delta) { return delta.kind == kind; });
+  }
+
+  std::vector<hyprland::StateDelta> received;
+};
+
+std::string readFixture(const std::string& name) {
+  std::ifstream file("test/hyprland/fixtures/" + name);
+  REQUIRE(file.is_open());
+  std::stringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+// The clients reply decoded through a Json::Value DOM, as done before JsonSchema
+std::vector<hyprland::ClientInfo> parseClientsDom(const std::string& reply) {
+  waybar::util::JsonParser parser;
+  std::vector<hyprland::ClientInfo> clients;
+  for (const auto& value : parser.parse(reply)) {
+    auto address = value["address"].asString();
+    clients.push_back({
+        .address = address.substr(2),
+        .workspaceId = value["workspace"]["id"].asInt(),
+        .workspaceName = value["workspace"]["name"].asString(),
+        .monitor = value["monitor"].asInt(),
+        .className = value["class"].asString(),
+        .initialClassName = value["initialClass"].asString(),
+        .title = value["title"].asString(),
+        .initialTitle = value["initialTitle"].asString(),
+        .mapped = value["mapped"].asBool(),
+        .hidden = value["hidden"].asBool(),
+        .floating = value["floating"].asBool(),
+        .fullscreen = value["fullscreen"].asBool(),
+        .grouped = !value["grouped"].empty(),
+        .swallowing = !value["swallowing"].isNull() && value["swallowing"].asString() != "0x0",
+    });
+  }
+  return clients;
+}
+
+}  // namespace
+
+TEST_CASE_METHOD(IPCTestFixture, "HyprlandState follows socket2 events", "[state]") {
+  auto socketDir = tempDir / "hypr" / instanceSig;
+  fs::create_directories(socketDir);
+  socketFolder_ = socketDir;
+  setenv("HYPRLAND_INSTANCE_SIGNATURE", instanceSig, 1);
+  FakeSocket1 server(socketDir / ".socket.sock", SNAPSHOT);
+
+  // Done by the event thread when the IPC starts
+  auto& hyprState = state();
+  hyprState.resync();
+  REQUIRE(hyprState.activeWorkspace()->id == 1);
+  REQUIRE(hyprState.activeWorkspace("DP-2")->lastWindowTitle == "browser");
+  const auto requests = server.requests().size();
+
+  DeltaRecorder recorder;
+  hyprState.addListener(&recorder);
+
+  SECTION("windows are counted incrementally") {
+    auto clients = SNAPSHOT.at("clients");
+    clients.insert(clients.rfind(']'), R"(,
+      {"address": "0xc", "mapped": true, "hidden": false, "workspace": {"id": 1, "name": "1"},
+       "floating": true, "monitor": 0, "class": "kitty", "title": "second, shell",
+       "initialClass": "term", "initialTitle": "term", "fullscreen": 0})");
+    server.setReply("clients", clients);
+
+    // The record is fetched for the state a window rule may have set
+    parseIPC("openwindow>>c,1,kitty,second, shell");
+    REQUIRE(hyprState.client("0xc")->title == "second, shell");
+    REQUIRE(hyprState.client("c")->floating);
+    REQUIRE(hyprState.client("c")->initialClassName == "term");
+    REQUIRE(hyprState.workspace(1)->windows == 2);
+    REQUIRE(server.requests().size() == requests + 1);
+
+    parseIPC("movewindowv2>>c,2,2");
+    REQUIRE(hyprState.client("c")->monitor == 1);
+    REQUIRE(hyprState.workspace(1)->windows == 1);
+    REQUIRE(hyprState.workspace(2)->windows == 2);
+
+    parseIPC("activewindowv2>>c");
+    parseIPC("windowtitlev2>>c,renamed");
+    REQUIRE(hyprState.activeWindow() == "c");
+    REQUIRE(hyprState.workspace(2)->lastWindowTitle == "renamed");
+
+    parseIPC("fullscreen>>1");
+    REQUIRE(hyprState.workspace(2)->hasFullscreen);
+    parseIPC("closewindow>>c");
+    REQUIRE_FALSE(hyprState.client("c"));
+    REQUIRE(hyprState.workspace(2)->windows == 1);
+    REQUIRE_FALSE(hyprState.workspace(2)->hasFullscreen);
+
+    REQUIRE(recorder.has(hyprland::StateDelta::Kind::ClientAdded));
+    REQUIRE(recorder.has(hyprland::StateDelta::Kind::ClientRemoved));
+    REQUIRE(server.requests().size() == requests + 1);
+  }
+
+  SECTION("focus changes update the monitors") {
+    parseIPC("focusedmonv2>>DP-2,2");
+    REQUIRE(hyprState.monitor("DP-2")->focused);
+    REQUIRE(hyprState.activeWorkspace()->id == 2);
+    REQUIRE(recorder.has(hyprland::StateDelta::Kind::MonitorChanged));
+    REQUIRE(server.requests().size() == requests);
+  }
+
+  SECTION("unknown references trigger a resync") {
+    parseIPC("movewindowv2>>d,2,2");
+    REQUIRE(recorder.has(hyprland::StateDelta::Kind::Resynced));
+    REQUIRE(server.requests().size() > requests);
+    REQUIRE_FALSE(hyprState.client("d"));
+  }
+
+  SECTION("handlers run when a fetch fails") {
+    Handler handler;
+    registerForIPC("createworkspacev2", &handler);
+    server.setReply("workspaces", "not json");
+
+    parseIPC("createworkspacev2>>3,3");
+    REQUIRE(handler.events == std::vector<std::string>{"createworkspacev2>>3,3"});
+    // Kept until a sync succeeds
+    REQUIRE(hyprState.workspace(1));
+    REQUIRE_FALSE(recorder.has(hyprland::StateDelta::Kind::Resynced));
+
+    server.setReply("workspaces", SNAPSHOT.at("workspaces"));
+    parseIPC("focusedmonv2>>DP-2,2");
+    REQUIRE(recorder.has(hyprland::StateDelta::Kind::Resynced));
+    unregisterForIPC(&handler);
+  }
+
+  hyprState.removeListener(&recorder);
+  unsetenv("HYPRLAND_INSTANCE_SIGNATURE");
+}
+
+TEST_CASE("Clients are read without a DOM", "[state]") {
+  const auto reply = readFixture("clients.json");
+  const auto expected = parseClientsDom(reply);
+  const auto clients = hyprland::ClientInfo::parseList(reply);
+
+  REQUIRE(clients.size() == 48);
+  REQUIRE(clients.size() == expected.size());
+  for (size_t i = 0; i < clients.size(); i++) {
+    REQUIRE(clients[i].toJson() == expected[i].toJson());
+    REQUIRE(clients[i].grouped == expected[i].grouped);
+    REQUIRE(clients[i].swallowing == expected[i].swallowing);
+  }
+  REQUIRE(clients[5].fullscreen);
+  REQUIRE(clients[13].grouped);
+}
+
+TEST_CASE("Clients decoding benchmark", "[.][benchmark][state]") {
+  const auto reply = readFixture("clients.json");
+  Benchmark benchmark(fmt::format("clients reply ({} KiB)", reply.size() / 1024), 500);
+  benchmark.run("with Json::Value", [&](size_t) { return parseClientsDom(reply).size(); });
+  benchmark.run("with JsonSchema",
+                [&](size_t) { return hyprland::ClientInfo::parseList(reply).size(); });
+  benchmark.report();
+  REQUIRE(benchmark.sink() > 0);
+}
@@ -0,0 +1,211 @@
+#include "modules/niri/state.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <string>
+#include <vector>
+
+#include "util/json.hpp"
+
+using waybar::modules::niri::NiriState;
+using waybar::modules::niri::StateDelta;
+using Kind = StateDelta::Kind;
+
+namespace {
+
+Json::Value parse(const std::string& json) {
+  waybar::util::JsonParser parser;
+  return parser.parse(json);
+}
+
+// Workspaces 1 and 2 on DP-1, 3 on HDMI-A-1; windows 10 and 11 on workspace 1, 12 on 3
+const std::string WORKSPACES = R"({"workspaces": [
+  {"id": 3, "idx": 1, "name": null, "output": "HDMI-A-1", "is_active": true, "is_focused": false,
+   "is_urgent": false, "active_window_id": 12},
+  {"id": 2, "idx": 2, "name": "web", "output": "DP-1", "is_active": false, "is_focused": false,
+   "is_urgent": false, "active_window_id": null},
+  {"id": 1, "idx": 1, "name": null, "output": "DP-1", "is_active": true, "is_focused": true,
+   "is_urgent": false, "active_window_id": 10}
+]})";
+
+const std::string WINDOWS = R"({"windows": [
+  {"id": 10, "title": "vim", "app_id": "kitty", "workspace_id": 1, "is_focused": true},
+  {"id": 11, "title": "Firefox", "app_id": "firefox", "workspace_id": 1, "is_focused": false},
+  {"id": 12, "title": "mpv", "app_id": "mpv", "workspace_id": 3, "is_focused": false}
+]})";
+
+NiriState load() {
+  NiriState state;
+  std::vector<StateDelta> deltas;
+  state.apply("WorkspacesChanged", parse(WORKSPACES), deltas);
+  state.apply("WindowsChanged", parse(WINDOWS), deltas);
+  return state;
+}
+
+std::vector<uint64_t> order(const NiriState& state) {
+  std::vector<uint64_t> ids;
+  for (const auto& [key, ws] : state.workspaces()) ids.push_back(key.id);
+  return ids;
+}
+
+}  // namespace
+
+TEST_CASE("NiriState indexes workspaces and windows", "[niri_state]") {
+  auto state = load();
+  REQUIRE(order(state) == std::vector<uint64_t>{1, 2, 3});
+  REQUIRE((*state.focusedWorkspace())["id"] == 1);
+  REQUIRE((*state.activeWorkspace("HDMI-A-1"))["id"] == 3);
+  REQUIRE(state.activeWorkspace("eDP-1") == nullptr);
+  REQUIRE((*state.workspace(2))["name"] == "web");
+  REQUIRE((*state.window(11))["title"] == "Firefox");
+  REQUIRE(state.windowCount(1) == 2);
+  REQUIRE(state.windowCount(2) == 0);
+  REQUIRE(state.windowCount(3) == 1);
+}
+
+TEST_CASE("NiriState reports what an event changed", "[niri_state]") {
+  auto state = load();
+  std::vector<StateDelta> deltas;
+
+  SECTION("workspace activation") {
+    REQUIRE(state.apply("WorkspaceActivated", parse(R"({"id": 2, "focused": true})"), deltas));
+    REQUIRE(deltas.size() == 2);
+    REQUIRE(deltas[0].kind == Kind::WorkspaceActivated);
+    REQUIRE(deltas[0].id == 1);
+    REQUIRE(deltas[1].kind == Kind::WorkspaceActivated);
+    REQUIRE(deltas[1].id == 2);
+    REQUIRE((*state.focusedWorkspace())["id"] == 2);
+    REQUIRE_FALSE((*state.workspace(1))["is_active"].asBool());
+    REQUIRE_FALSE((*state.workspace(1))["is_focused"].asBool());
+    // Other outputs are left alone
+    REQUIRE((*state.workspace(3))["is_active"].asBool());
+  }
+
+  SECTION("active window and urgency") {
+    REQUIRE(state.apply("WorkspaceActiveWindowChanged",
+                        parse(R"({"workspace_id": 1, "active_window_id": 11})"), deltas));
+    REQUIRE(state.apply("WorkspaceUrgencyChanged", parse(R"({"id": 2, "urgent": true})"), deltas));
+    // Nothing changed
+    REQUIRE(state.apply("WorkspaceUrgencyChanged", parse(R"({"id": 2, "urgent": true})"), deltas));
+    REQUIRE(deltas.size() == 2);
+    REQUIRE(deltas[0].kind == Kind::WorkspaceChanged);
+    REQUIRE(deltas[0].id == 1);
+    REQUIRE(deltas[1].id == 2);
+    REQUIRE((*state.workspace(2))["is_urgent"].asBool());
+  }
+
+  SECTION("window title") {
+    REQUIRE(state.apply("WindowOpenedOrChanged", parse(R"({"window": {"id": 11,
+        "title": "Waybar - Firefox", "app_id": "firefox", "workspace_id": 1,
+        "is_focused": false}})"),
+                        deltas));
+    REQUIRE(deltas.size() == 1);
+    REQUIRE(deltas[0].kind == Kind::WindowChanged);
+    REQUIRE(deltas[0].id == 11);
+    REQUIRE(deltas[0].workspaceId == 1);
+    REQUIRE((*state.window(11))["title"] == "Waybar - Firefox");
+  }
+
+  SECTION("window moved to another workspace") {
+    REQUIRE(state.apply("WindowOpenedOrChanged", parse(R"({"window": {"id": 11,
+        "title": "Firefox", "app_id": "firefox", "workspace_id": 2, "is_focused": false}})"),
+                        deltas));
+    REQUIRE(deltas.size() == 2);
+    REQUIRE(deltas[0].kind == Kind::WindowRemoved);
+    REQUIRE(deltas[0].workspaceId == 1);
+    REQUIRE(deltas[1].kind == Kind::WindowAdded);
+    REQUIRE(deltas[1].workspaceId == 2);
+    REQUIRE(state.windowCount(1) == 1);
+    REQUIRE(state.windowCount(2) == 1);
+  }
+
+  SECTION("window focus and close") {
+    REQUIRE(state.apply("WindowFocusChanged", parse(R"({"id": 12})"), deltas));
+    REQUIRE(deltas.back().kind == Kind::WindowFocusChanged);
+    REQUIRE(deltas.back().workspaceId == 3);
+    REQUIRE((*state.window(12))["is_focused"].asBool());
+    REQUIRE_FALSE((*state.window(10))["is_focused"].asBool());
+
+    REQUIRE(state.apply("WindowClosed", parse(R"({"id": 12})"), deltas));
+    REQUIRE(deltas.back().kind == Kind::WindowRemoved);
+    REQUIRE(state.window(12) == nullptr);
+    REQUIRE(state.windowCount(3) == 0);
+
+    REQUIRE(state.apply("WindowFocusChanged", parse(R"({"id": null})"), deltas));
+    REQUIRE(deltas.back().id == 0);
+  }
+
+  SECTION("unknown ids") {
+    REQUIRE(state.apply("WorkspaceActivated", parse(R"({"id": 9, "focused": true})"), deltas));
+    REQUIRE(state.apply("WindowClosed", parse(R"({"id": 99})"), deltas));
+    REQUIRE(deltas.empty());
+    REQUIRE((*state.focusedWorkspace())["id"] == 1);
+  }
+
+  SECTION("keyboard layouts") {
+    REQUIRE(state.apply("KeyboardLayoutsChanged", parse(R"({"keyboard_layouts":
+        {"names": ["English", "German"], "current_idx": 1}})"),
+                        deltas));
+    REQUIRE(state.keyboardLayoutNames().size() == 2);
+    REQUIRE(state.keyboardLayoutCurrent() == 1);
+    REQUIRE(state.apply("KeyboardLayoutSwitched", parse(R"({"idx": 0})"), deltas));
+    REQUIRE(state.keyboardLayoutCurrent() == 0);
+    REQUIRE(deltas.size() == 2);
+  }
+
+  SECTION("other events") {
+    REQUIRE_FALSE(state.apply("OverviewOpenedOrClosed", parse(R"({"is_open": true})"), deltas));
+  }
+}
+
+TEST_CASE("NiriState diffs the full lists", "[niri_state]") {
+  auto state = load();
+  std::vector<StateDelta> deltas;
+
+  SECTION("unchanged") {
+    state.apply("WorkspacesChanged", parse(WORKSPACES), deltas);
+    state.apply("WindowsChanged", parse(WINDOWS), deltas);
+    REQUIRE(deltas.empty());
+  }
+
+  SECTION("workspaces") {
+    // 2 moves before 1, 3 is removed and 4 added
+    state.apply("WorkspacesChanged", parse(R"({"workspaces": [
+      {"id": 1, "idx": 2, "name": null, "output": "DP-1", "is_active": true, "is_focused": true,
+       "is_urgent": false, "active_window_id": 10},
+      {"id": 2, "idx": 1, "name": "web", "output": "DP-1", "is_active": false,
+       "is_focused": false, "is_urgent": false, "active_window_id": null},
+      {"id": 4, "idx": 1, "name": null, "output": "HDMI-A-1", "is_active": true,
+       "is_focused": false, "is_urgent": false, "active_window_id": null}
+    ]})"),
+                deltas);
+    REQUIRE(order(state) == std::vector<uint64_t>{2, 1, 4});
+    REQUIRE(deltas.size() == 4);
+    REQUIRE(deltas[0].kind == Kind::WorkspaceMoved);
+    REQUIRE(deltas[1].kind == Kind::WorkspaceMoved);
+    REQUIRE(deltas[2].kind == Kind::WorkspaceAdded);
+    REQUIRE(deltas[2].id == 4);
+    REQUIRE(deltas[3].kind == Kind::WorkspaceRemoved);
+    REQUIRE(deltas[3].id == 3);
+    REQUIRE(state.workspace(3) == nullptr);
+    REQUIRE((*state.activeWorkspace("HDMI-A-1"))["id"] == 4);
+  }
+
+  SECTION("windows") {
+    state.apply("WindowsChanged", parse(R"({"windows": [
+      {"id": 10, "title": "nvim", "app_id": "kitty", "workspace_id": 1, "is_focused": true},
+      {"id": 12, "title": "mpv", "app_id": "mpv", "workspace_id": 3, "is_focused": false}
+    ]})"),
+                deltas);
+    REQUIRE(deltas.size() == 2);
+    REQUIRE(deltas[0].kind == Kind::WindowChanged);
+    REQUIRE(deltas[0].id == 10);
+    REQUIRE(deltas[1].kind == Kind::WindowRemoved);
+    REQUIRE(deltas[1].id == 11);
+    REQUIRE(state.windowCount(1) == 1);
+  }
+}
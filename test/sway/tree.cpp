@@ -0,0 +1,296 @@
+#include "modules/sway/ipc/tree.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <string>
+#include <vector>
+
+#include "../benchmark.hpp"
+#include "modules/sway/ipc/ipc.hpp"
+#include "util/json.hpp"
+
+using waybar::modules::sway::SwayTree;
+using waybar::modules::sway::TreeDelta;
+
+namespace {
+
+// A GET_TREE reply, trimmed to the fields the modules use
+const std::string TREE = R"({
+  "id": 1, "type": "root", "name": "root", "focused": false,
+  "nodes": [
+    {"id": 2, "type": "output", "name": "__i3", "focused": false,
+     "nodes": [
+       {"id": 3, "type": "workspace", "name": "__i3_scratch", "focused": false, "nodes": [],
+        "floating_nodes": [
+          {"id": 30, "type": "floating_con", "name": "notes", "app_id": "kitty",
+           "focused": false, "nodes": [], "floating_nodes": []}
+        ]}
+     ], "floating_nodes": []},
+    {"id": 4, "type": "output", "name": "DP-1", "current_workspace": "1", "focused": false,
+     "nodes": [
+       {"id": 10, "type": "workspace", "name": "1", "num": 1, "output": "DP-1",
+        "focused": false, "visible": true, "urgent": false,
+        "nodes": [
+          {"id": 11, "type": "con", "name": "vim", "app_id": "kitty", "focused": true,
+           "urgent": false, "nodes": [], "floating_nodes": []},
+          {"id": 12, "type": "con", "name": "Firefox", "app_id": "firefox", "focused": false,
+           "urgent": false, "nodes": [], "floating_nodes": []}
+        ],
+        "floating_nodes": [
+          {"id": 13, "type": "floating_con", "name": "calc", "app_id": "calc",
+           "focused": false, "urgent": false, "nodes": [], "floating_nodes": []}
+        ]},
+       {"id": 20, "type": "workspace", "name": "2", "num": 2, "output": "DP-1",
+        "focused": false, "visible": false, "urgent": false,
+        "nodes": [
+          {"id": 21, "type": "con", "name": "mpv", "app_id": "mpv", "focused": false,
+           "urgent": false, "nodes": [], "floating_nodes": []}
+        ],
+        "floating_nodes": []}
+     ], "floating_nodes": []},
+    {"id": 5, "type": "output", "name": "HDMI-A-1", "current_workspace": "5", "focused": false,
+     "nodes": [
+       {"id": 50, "type": "workspace", "name": "5", "num": 5, "output": "HDMI-A-1",
+        "focused": false, "visible": true, "urgent": false,
+        "nodes": [
+          {"id": 51, "type": "con", "name": null, "layout": "splitv", "focused": false,
+           "urgent": false,
+           "nodes": [
+             {"id": 52, "type": "con", "name": "htop", "app_id": "kitty", "focused": false,
+              "urgent": false, "nodes": [], "floating_nodes": []}
+           ],
+           "floating_nodes": []}
+        ],
+        "floating_nodes": []}
+     ], "floating_nodes": []}
+  ],
+  "floating_nodes": []
+})";
+
+Json::Value parse(const std::string& json) {
+  waybar::util::JsonParser parser;
+  return parser.parse(json);
+}
+
+SwayTree load() {
+  SwayTree tree;
+  tree.reset(parse(TREE));
+  return tree;
+}
+
+Json::Value window(int64_t id, const std::string& name, bool focused = false) {
+  Json::Value container;
+  container["id"] = Json::Int64(id);
+  container["type"] = "con";
+  container["name"] = name;
+  container["focused"] = focused;
+  container["nodes"] = Json::Value(Json::arrayValue);
+  container["floating_nodes"] = Json::Value(Json::arrayValue);
+  return container;
+}
+
+Json::Value windowEvent(const std::string& change, const Json::Value& container) {
+  Json::Value event;
+  event["change"] = change;
+  event["container"] = container;
+  return event;
+}
+
+Json::Value workspaceEvent(const std::string& change, const Json::Value& current,
+                           const Json::Value& old = Json::Value()) {
+  Json::Value event;
+  event["change"] = change;
+  event["current"] = current;
+  event["old"] = old;
+  return event;
+}
+
+}  // namespace
+
+TEST_CASE("SwayTree indexes the GET_TREE reply", "[sway_tree]") {
+  auto tree = load();
+  REQUIRE(tree.focusedId() == 11);
+  REQUIRE((*tree.node(13))["name"] == "calc");
+  REQUIRE((*tree.workspaceOf(11))["name"] == "1");
+  REQUIRE((*tree.workspaceOf(13))["name"] == "1");
+  REQUIRE((*tree.workspaceOf(10))["name"] == "1");
+  REQUIRE((*tree.workspaceOf(30))["name"] == "__i3_scratch");
+  REQUIRE(tree.workspaceOf(4) == nullptr);
+  REQUIRE(tree.node(99) == nullptr);
+}
+
+TEST_CASE("SwayTree applies window events", "[sway_tree]") {
+  auto tree = load();
+  std::vector<TreeDelta> deltas;
+
+  SECTION("title") {
+    const auto* firefox = tree.node(12);
+    REQUIRE(tree.apply(IPC_EVENT_WINDOW, windowEvent("title", window(12, "Waybar - Firefox")),
+                       deltas));
+    REQUIRE(deltas.size() == 1);
+    REQUIRE(deltas[0].kind == TreeDelta::Kind::TitleChanged);
+    REQUIRE(deltas[0].id == 12);
+    // Updated in place, in the tree the modules read
+    REQUIRE(tree.node(12) == firefox);
+    REQUIRE(tree.root()["nodes"][1]["nodes"][0]["nodes"][1]["name"] == "Waybar - Firefox");
+    REQUIRE(tree.focusedId() == 11);
+  }
+
+  SECTION("focus") {
+    REQUIRE(tree.apply(IPC_EVENT_WINDOW, windowEvent("focus", window(21, "mpv", true)), deltas));
+    REQUIRE(deltas[0].kind == TreeDelta::Kind::FocusChanged);
+    REQUIRE(tree.focusedId() == 21);
+    REQUIRE((*tree.node(21))["focused"].asBool());
+    REQUIRE_FALSE((*tree.node(11))["focused"].asBool());
+  }
+
+  SECTION("close") {
+    REQUIRE(tree.apply(IPC_EVENT_WINDOW, windowEvent("close", window(11, "vim")), deltas));
+    REQUIRE(deltas[0].kind == TreeDelta::Kind::NodeRemoved);
+    REQUIRE(tree.node(11) == nullptr);
+    REQUIRE(tree.focusedId() == -1);
+    // The next sibling moved, and is still found
+    const auto& workspace = *tree.node(10);
+    REQUIRE(workspace["nodes"].size() == 1);
+    REQUIRE(tree.node(12) == &workspace["nodes"][0]);
+    REQUIRE((*tree.node(12))["name"] == "Firefox");
+    REQUIRE(tree.workspaceOf(13) == &workspace);
+  }
+
+  SECTION("close the last window of a split") {
+    REQUIRE(tree.apply(IPC_EVENT_WINDOW, windowEvent("close", window(52, "htop")), deltas));
+    // Sway reaps the emptied split container without an event, but not the workspace
+    REQUIRE(tree.node(52) == nullptr);
+    REQUIRE(tree.node(51) == nullptr);
+    REQUIRE((*tree.node(50))["nodes"].empty());
+    REQUIRE(tree.root()["nodes"][2]["nodes"].size() == 1);
+  }
+
+  SECTION("events that don't tell where the container is") {
+    REQUIRE_FALSE(tree.apply(IPC_EVENT_WINDOW, windowEvent("new", window(14, "new")), deltas));
+    REQUIRE_FALSE(tree.apply(IPC_EVENT_WINDOW, windowEvent("move", window(12, "Firefox")), deltas));
+    REQUIRE_FALSE(
+        tree.apply(IPC_EVENT_WINDOW, windowEvent("floating", window(12, "Firefox")), deltas));
+  }
+
+  SECTION("unknown containers") {
+    REQUIRE_FALSE(tree.apply(IPC_EVENT_WINDOW, windowEvent("title", window(99, "?")), deltas));
+    REQUIRE_FALSE(tree.apply(IPC_EVENT_WINDOW, windowEvent("close", window(99, "?")), deltas));
+  }
+}
+
+TEST_CASE("SwayTree applies workspace events", "[sway_tree]") {
+  auto tree = load();
+  std::vector<TreeDelta> deltas;
+
+  SECTION("init and empty") {
+    Json::Value workspace;
+    workspace["id"] = 40;
+    workspace["type"] = "workspace";
+    workspace["name"] = "3";
+    workspace["output"] = "DP-1";
+    workspace["focused"] = true;
+    workspace["nodes"] = Json::Value(Json::arrayValue);
+    REQUIRE(tree.apply(IPC_EVENT_WORKSPACE, workspaceEvent("init", workspace), deltas));
+    REQUIRE(deltas.back().kind == TreeDelta::Kind::WorkspaceAdded);
+    REQUIRE((*tree.workspaceOf(40))["name"] == "3");
+    REQUIRE(tree.root()["nodes"][1]["nodes"].size() == 3);
+    // Appending left the other workspaces in place
+    REQUIRE((*tree.node(21))["name"] == "mpv");
+
+    REQUIRE(tree.apply(IPC_EVENT_WORKSPACE, workspaceEvent("empty", workspace), deltas));
+    REQUIRE(deltas.back().kind == TreeDelta::Kind::WorkspaceRemoved);
+    REQUIRE(tree.node(40) == nullptr);
+    REQUIRE(tree.root()["nodes"][1]["nodes"].size() == 2);
+  }
+
+  SECTION("focus") {
+    auto current = *tree.node(20);
+    current["visible"] = true;
+    current["nodes"][0]["focused"] = true;
+    auto old = *tree.node(10);
+    old["visible"] = false;
+    old["nodes"][0]["focused"] = false;
+    REQUIRE(tree.apply(IPC_EVENT_WORKSPACE, workspaceEvent("focus", current, old), deltas));
+    REQUIRE(tree.root()["nodes"][1]["current_workspace"] == "2");
+    REQUIRE(tree.focusedId() == 21);
+    REQUIRE((*tree.workspaceOf(tree.focusedId()))["name"] == "2");
+    REQUIRE_FALSE((*tree.node(11))["focused"].asBool());
+  }
+
+  SECTION("focus from another output") {
+    // From workspace 5 on HDMI-A-1 to workspace 2 on DP-1, where 1 was visible
+    auto current = *tree.node(20);
+    current["focused"] = true;
+    current["visible"] = true;
+    auto old = *tree.node(50);
+    REQUIRE(tree.apply(IPC_EVENT_WORKSPACE, workspaceEvent("focus", current, old), deltas));
+    REQUIRE(tree.root()["nodes"][1]["current_workspace"] == "2");
+    REQUIRE(tree.root()["nodes"][2]["current_workspace"] == "5");
+    REQUIRE((*tree.node(20))["visible"].asBool());
+    REQUIRE_FALSE((*tree.node(10))["visible"].asBool());
+    REQUIRE(deltas.back().kind == TreeDelta::Kind::WorkspaceChanged);
+    REQUIRE(deltas.back().id == 10);
+    // Still shown on its own output
+    REQUIRE((*tree.node(50))["visible"].asBool());
+  }
+
+  SECTION("rename") {
+    auto current = *tree.node(10);
+    current["name"] = "1:code";
+    REQUIRE(tree.apply(IPC_EVENT_WORKSPACE, workspaceEvent("rename", current), deltas));
+    REQUIRE(deltas.back().kind == TreeDelta::Kind::WorkspaceChanged);
+    REQUIRE(tree.root()["nodes"][1]["current_workspace"] == "1:code");
+    REQUIRE((*tree.workspaceOf(11))["name"] == "1:code");
+    REQUIRE(tree.focusedId() == 11);
+  }
+
+  SECTION("move and reload") {
+    REQUIRE_FALSE(tree.apply(IPC_EVENT_WORKSPACE, workspaceEvent("move", *tree.node(20)), deltas));
+    REQUIRE_FALSE(
+        tree.apply(IPC_EVENT_WORKSPACE, workspaceEvent("reload", Json::Value()), deltas));
+  }
+}
+
+TEST_CASE("SwayTree copies are independent", "[sway_tree]") {
+  auto tree = load();
+  SwayTree snapshot(tree);
+  std::vector<TreeDelta> deltas;
+  REQUIRE(tree.apply(IPC_EVENT_WINDOW, windowEvent("title", window(11, "nvim")), deltas));
+  REQUIRE((*snapshot.node(11))["name"] == "vim");
+  REQUIRE((*tree.node(11))["name"] == "nvim");
+  REQUIRE(snapshot.node(11) != tree.node(11));
+  REQUIRE(snapshot.focusedId() == 11);
+}
+
+TEST_CASE("SwayTree benchmark", "[.][benchmark][sway_tree]") {
+  constexpr int WINDOWS = 200;
+  constexpr int ITERATIONS = 200;
+  // A tree with many windows, as sent again after each event before
+  auto root = parse(TREE);
+  auto& windows = root["nodes"][1]["nodes"][1]["nodes"];
+  for (int i = 0; i < WINDOWS; i++) {
+    windows.append(window(100 + i, "terminal " + std::to_string(i)));
+  }
+  const auto reply = root.toStyledString();
+  SwayTree tree;
+  tree.reset(root);
+  waybar::util::JsonParser parser;
+  std::vector<TreeDelta> deltas;
+
+  Benchmark benchmark(fmt::format("{} windows, per title change", WINDOWS + 5), ITERATIONS);
+  benchmark.run("parsing the tree", [&](size_t) { return parser.parse(reply)["nodes"].size(); });
+  benchmark.run("applying it", [&](size_t i) {
+    auto event = parser.parse(
+        windowEvent("title", window(100 + i % WINDOWS, "title " + std::to_string(i)))
+            .toStyledString());
+    deltas.clear();
+    return tree.apply(IPC_EVENT_WINDOW, event, deltas);
+  });
+  benchmark.report();
+  REQUIRE(benchmark.sink() > 0);
+}
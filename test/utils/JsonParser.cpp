@@ -42,4 +42,26 @@ TEST_CASE("Json with chinese characters", "[json]") {
     Json::Value jsonValue = parser.parse(stringToTest);
     REQUIRE(jsonValue["test"].asString() == "你好");
   }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Json with escaped backslashes", "[json]") {
+  waybar::util::JsonParser parser;
+
+  SECTION("An escaped backslash followed by x is not a \\x escape") {
+    Json::Value jsonValue = parser.parse(R"({"test": "C:\\xyz"})");
+    REQUIRE(jsonValue["test"].asString() == "C:\\xyz");
+  }
+
+  SECTION("Escapes are only rewritten where needed") {
+    Json::Value jsonValue = parser.parse(R"({"test": "\\\xab\"\x41\n"})");
+    REQUIRE(jsonValue["test"].asString() == "\\\u00ab\"A\n");
+  }
+}
+
+TEST_CASE("Json errors", "[json]") {
+  waybar::util::JsonParser parser;
+  REQUIRE_THROWS_AS(parser.parse(R"({"test": )"), std::runtime_error);
+  REQUIRE_THROWS_AS(parser.parse(R"({"test": "\x)"), std::runtime_error);
+  // the parser is still usable after an error
+  REQUIRE(parser.parse(R"({"test": 1})")["test"].asInt() == 1);
+}
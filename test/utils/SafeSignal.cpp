@@ -141,3 +141,41 @@ TEST_CASE_METHOD(GlibTestsFixture, "SafeSignal copy/move counter", "[signal][thr
   producer.join();
   REQUIRE(count == NUM_EVENTS);
 }
+
+/*
+ * Check that the conflating variant only delivers the latest value and accounts for the others
+ */
+TEST_CASE_METHOD(GlibTestsFixture, "ConflatingSafeSignal delivers the latest value",
+                 "[signal][thread][util]") {
+  const int NUM_EVENTS = 1000;
+  int count = 0;
+  int last_value = 0;
+
+  ConflatingSafeSignal<int> test_signal;
+
+  std::thread producer;
+
+  // timeout the test in 500ms
+  setTimeout(500);
+
+  test_signal.connect([&](auto val) {
+    // values are never delivered out of order
+    REQUIRE(val > last_value);
+    last_value = val;
+    ++count;
+    if (val == NUM_EVENTS) {
+      this->quit();
+    }
+  });
+
+  run([&]() {
+    producer = std::thread([&]() {
+      for (auto i = 1; i <= NUM_EVENTS; ++i) {
+        test_signal.emit(i);
+      }
+    });
+  });
+  producer.join();
+  REQUIRE(last_value == NUM_EVENTS);
+  REQUIRE(count + test_signal.dropped() == NUM_EVENTS);
+}
@@ -0,0 +1,112 @@
+#include "util/command_queue.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+using waybar::util::CommandQueue;
+
+namespace {
+
+void waitFor(const std::atomic<bool>& flag) {
+  auto deadline = std::chrono::steady_clock::now() + 1s;
+  while (!flag && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(1ms);
+  }
+}
+
+}  // namespace
+
+TEST_CASE("CommandQueue runs commands in order off the calling thread",
+          "[command_queue][thread][util]") {
+  std::mutex mutex;
+  std::vector<int> ran;
+  std::atomic<bool> done = false;
+  std::atomic<bool> other_thread = true;
+  const auto main_tid = std::this_thread::get_id();
+
+  CommandQueue queue;
+  for (int i = 0; i < 5; i++) {
+    queue.push([&, i] {
+      other_thread = other_thread && std::this_thread::get_id() != main_tid;
+      std::lock_guard lock(mutex);
+      ran.push_back(i);
+    });
+  }
+  queue.push([&] { done = true; });
+  waitFor(done);
+
+  REQUIRE(done);
+  REQUIRE(other_thread);
+  std::lock_guard lock(mutex);
+  REQUIRE(ran == std::vector<int>{0, 1, 2, 3, 4});
+}
+
+TEST_CASE("CommandQueue push doesn't wait for the running command",
+          "[command_queue][thread][util]") {
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  std::atomic<bool> done = false;
+
+  CommandQueue queue;
+  auto start = std::chrono::steady_clock::now();
+  queue.push([released] { released.wait(); });
+  queue.push([&] { done = true; });
+  REQUIRE(std::chrono::steady_clock::now() - start < 50ms);
+  REQUIRE_FALSE(done);
+
+  release.set_value();
+  waitFor(done);
+  REQUIRE(done);
+}
+
+TEST_CASE("CommandQueue replaces queued commands with the same key",
+          "[command_queue][thread][util]") {
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  std::mutex mutex;
+  std::vector<std::string> ran;
+  std::atomic<bool> done = false;
+  auto record = [&](std::string name) {
+    return [&, name] {
+      std::lock_guard lock(mutex);
+      ran.push_back(name);
+    };
+  };
+
+  CommandQueue queue;
+  // Keeps the next commands queued
+  queue.push([released] { released.wait(); });
+  queue.push(record("workspace 2"), "switch");
+  queue.push(record("mark"));
+  queue.push(record("workspace 3"), "switch");
+  queue.push(record("workspace 4"), "switch");
+  queue.push([&] { done = true; });
+  release.set_value();
+  waitFor(done);
+
+  REQUIRE(done);
+  std::lock_guard lock(mutex);
+  REQUIRE(ran == std::vector<std::string>{"mark", "workspace 4"});
+}
+
+TEST_CASE("CommandQueue keeps running after a failed command", "[command_queue][thread][util]") {
+  std::atomic<bool> done = false;
+
+  CommandQueue queue;
+  queue.push([] { throw std::runtime_error("compositor went away"); });
+  queue.push([&] { done = true; });
+  waitFor(done);
+  REQUIRE(done);
+}
@@ -0,0 +1,71 @@
+#include "util/dispatcher.hpp"
+
+#include <glibmm.h>
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <thread>
+
+#include "fixtures/GlibTestsFixture.hpp"
+
+using waybar::util::Dispatcher;
+
+TEST_CASE_METHOD(GlibTestsFixture, "Dispatchers share one wakeup", "[dispatcher][thread][util]") {
+  const auto main_tid = std::this_thread::get_id();
+  Dispatcher first;
+  Dispatcher second;
+  int first_count = 0;
+  int second_count = 0;
+  bool main_thread = true;
+
+  setTimeout(500);
+
+  first.connect([&] {
+    main_thread = main_thread && std::this_thread::get_id() == main_tid;
+    first_count++;
+  });
+  second.connect([&] {
+    main_thread = main_thread && std::this_thread::get_id() == main_tid;
+    second_count++;
+    quit();
+  });
+
+  std::thread producer;
+  run([&] {
+    producer = std::thread([&] {
+      // Queued emissions of the same dispatcher are coalesced
+      for (int i = 0; i < 10; i++) {
+        first.emit();
+      }
+      second.emit();
+    });
+  });
+  producer.join();
+
+  REQUIRE(main_thread);
+  REQUIRE(first_count >= 1);
+  REQUIRE(first_count <= 10);
+  REQUIRE(second_count == 1);
+}
+
+TEST_CASE_METHOD(GlibTestsFixture, "Destroyed dispatchers are skipped", "[dispatcher][util]") {
+  int count = 0;
+  Dispatcher done;
+  done.connect([&] { quit(); });
+
+  setTimeout(500);
+
+  run([&] {
+    {
+      Dispatcher dispatcher;
+      dispatcher.connect([&] { count++; });
+      dispatcher.emit();
+    }
+    done.emit();
+  });
+
+  REQUIRE(count == 0);
+}
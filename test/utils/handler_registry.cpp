@@ -0,0 +1,104 @@
+#include "util/handler_registry.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace {
+
+struct Handler {
+  std::function<void()> onCall;
+  int calls = 0;
+
+  void call() {
+    calls++;
+    if (onCall) {
+      onCall();
+    }
+  }
+};
+
+using Registry = waybar::util::HandlerRegistry<std::string, Handler, int>;
+
+void dispatch(Registry& registry, const std::string& key) {
+  registry.dispatch(key, [](Handler& handler, int) { handler.call(); });
+}
+
+}  // namespace
+
+TEST_CASE("HandlerRegistry dispatches by key, in registration order", "[handler_registry][util]") {
+  Registry registry;
+  std::vector<int> order;
+  Handler first{[&] { order.push_back(1); }};
+  Handler second{[&] { order.push_back(2); }};
+  registry.add("a", &first, 1);
+  registry.add("a", &second, 2);
+  registry.add("b", &second, 3);
+
+  std::vector<int> data;
+  registry.dispatch(std::string("a"), [&](Handler& handler, int value) {
+    data.push_back(value);
+    handler.call();
+  });
+  REQUIRE(order == std::vector<int>{1, 2});
+  REQUIRE(data == std::vector<int>{1, 2});
+
+  registry.remove(&second);
+  dispatch(registry, "a");
+  dispatch(registry, "b");
+  REQUIRE(first.calls == 2);
+  REQUIRE(second.calls == 1);
+}
+
+TEST_CASE("HandlerRegistry handlers can change the registrations", "[handler_registry][util]") {
+  Registry registry;
+  Handler self;
+  Handler later;
+  Handler added;
+  self.onCall = [&] {
+    registry.remove(&self);
+    registry.remove(&later);
+    registry.add("a", &added);
+  };
+  registry.add("a", &self);
+  registry.add("a", &later);
+
+  dispatch(registry, "a");
+  // Removed before its turn, added for the next dispatch
+  REQUIRE(later.calls == 0);
+  REQUIRE(added.calls == 0);
+  dispatch(registry, "a");
+  REQUIRE(self.calls == 1);
+  REQUIRE(added.calls == 1);
+}
+
+TEST_CASE("HandlerRegistry remove waits for the running handler", "[handler_registry][util]") {
+  Registry registry;
+  std::atomic<bool> running = false;
+  std::atomic<bool> done = false;
+  Handler slow{[&] {
+    running = true;
+    std::this_thread::sleep_for(50ms);
+    done = true;
+  }};
+  registry.add("a", &slow);
+
+  std::thread dispatcher([&] { dispatch(registry, "a"); });
+  while (!running) {
+    std::this_thread::yield();
+  }
+  registry.remove(&slow);
+  REQUIRE(done);
+  dispatcher.join();
+}
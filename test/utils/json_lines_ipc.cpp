@@ -0,0 +1,223 @@
+#include "util/json_lines_ipc.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+using waybar::util::JsonEventHandler;
+using waybar::util::JsonLinesIpc;
+
+namespace {
+
+/// Compositor socket at $WAYBAR_TEST_SOCKET, serving one client at a time
+class FakeCompositor {
+ public:
+  FakeCompositor() {
+    path_ = std::filesystem::temp_directory_path() /
+            ("waybar-json-lines-" + std::to_string(getpid()) + ".sock");
+    std::filesystem::remove(path_);
+    listen_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path_.c_str(), sizeof(addr.sun_path) - 1);
+    REQUIRE(bind(listen_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    REQUIRE(listen(listen_, 4) == 0);
+    setenv("WAYBAR_TEST_SOCKET", path_.c_str(), 1);
+  }
+  ~FakeCompositor() {
+    hangUp();
+    close(listen_);
+    std::filesystem::remove(path_);
+    unsetenv("WAYBAR_TEST_SOCKET");
+  }
+
+  /// Wait for a client, and return the first line it sent
+  std::string accept() {
+    struct pollfd pfd = {listen_, POLLIN, 0};
+    REQUIRE(poll(&pfd, 1, 2000) == 1);
+    client_ = ::accept(listen_, nullptr, nullptr);
+    REQUIRE(client_ != -1);
+    std::string line;
+    char c;
+    while (read(client_, &c, 1) == 1 && c != '\n') {
+      line += c;
+    }
+    return line;
+  }
+
+  void write(const std::string& data) {
+    REQUIRE(::write(client_, data.data(), data.size()) == static_cast<ssize_t>(data.size()));
+  }
+
+  void hangUp() {
+    if (client_ != -1) {
+      close(client_);
+      client_ = -1;
+    }
+  }
+
+ private:
+  std::filesystem::path path_;
+  int listen_ = -1;
+  int client_ = -1;
+};
+
+class Recorder : public JsonEventHandler {
+ public:
+  void onEvent(const Json::Value& ev) override {
+    std::lock_guard lock(mutex_);
+    events_.push_back(ev);
+    cv_.notify_all();
+  }
+
+  /// The events received, once there are `n` of them
+  std::vector<Json::Value> waitFor(size_t n) {
+    std::unique_lock lock(mutex_);
+    cv_.wait_for(lock, 2s, [&] { return events_.size() >= n; });
+    return events_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<Json::Value> events_;
+};
+
+const JsonLinesIpc::Protocol PROTOCOL = {
+    .name = "Test",
+    .socketEnv = "WAYBAR_TEST_SOCKET",
+    .subscribe = "EventStream",
+    .ack = R"({"Ok":"Handled"})",
+};
+
+// Names the event after its single member, like Niri
+std::string reduce(const Json::Value& ev) { return ev.getMemberNames().at(0); }
+
+}  // namespace
+
+TEST_CASE("JsonLinesIpc subscribes and dispatches events by name", "[json_lines_ipc][util]") {
+  FakeCompositor compositor;
+  Recorder recorder;
+  std::vector<std::string> reduced;
+  JsonLinesIpc ipc(PROTOCOL, [&](const Json::Value& ev) {
+    reduced.push_back(reduce(ev));
+    return reduced.back();
+  });
+  ipc.registerForIPC("B", &recorder);
+
+  REQUIRE(compositor.accept() == R"("EventStream")");
+  compositor.write("{\"Ok\":\"Handled\"}\n{\"A\":{}}\n{\"B\":{\"n\":");
+  std::this_thread::sleep_for(20ms);
+  // A line split across reads, and a line that isn't JSON
+  compositor.write("1}}\nnot json\n{\"B\":{\"n\":2}}\n");
+
+  auto events = recorder.waitFor(2);
+  REQUIRE(events.size() == 2);
+  REQUIRE(events[0]["B"]["n"] == 1);
+  REQUIRE(events[1]["B"]["n"] == 2);
+  REQUIRE(reduced == std::vector<std::string>{"A", "B", "B"});
+
+  ipc.unregisterForIPC(&recorder);
+  compositor.write("{\"B\":{\"n\":3}}\n");
+  std::this_thread::sleep_for(50ms);
+  REQUIRE(recorder.waitFor(0).size() == 2);
+}
+
+TEST_CASE("JsonLinesIpc reconnects when the stream closes", "[json_lines_ipc][util]") {
+  FakeCompositor compositor;
+  Recorder recorder;
+  JsonLinesIpc ipc(PROTOCOL, reduce);
+  ipc.registerForIPC("A", &recorder);
+
+  REQUIRE(compositor.accept() == R"("EventStream")");
+  compositor.write("{\"Ok\":\"Handled\"}\n{\"A\":1}\n");
+  REQUIRE(recorder.waitFor(1).size() == 1);
+
+  compositor.hangUp();
+  REQUIRE(compositor.accept() == R"("EventStream")");
+  compositor.write("{\"Ok\":\"Handled\"}\n{\"A\":2}\n");
+  auto events = recorder.waitFor(2);
+  REQUIRE(events.size() == 2);
+  REQUIRE(events[1]["A"] == 2);
+}
+
+TEST_CASE("JsonLinesIpc retries when the stream is refused", "[json_lines_ipc][util]") {
+  FakeCompositor compositor;
+  Recorder recorder;
+  JsonLinesIpc ipc(PROTOCOL, reduce);
+  ipc.registerForIPC("A", &recorder);
+
+  REQUIRE(compositor.accept() == R"("EventStream")");
+  compositor.write("{\"Err\":\"busy\"}\n");
+  REQUIRE(compositor.accept() == R"("EventStream")");
+  compositor.write("{\"Ok\":\"Handled\"}\n{\"A\":1}\n");
+  REQUIRE(recorder.waitFor(1).size() == 1);
+}
+
+TEST_CASE("JsonLinesIpc backs off while the stream is refused", "[json_lines_ipc][util]") {
+  FakeCompositor compositor;
+  JsonLinesIpc ipc(PROTOCOL, reduce);
+
+  REQUIRE(compositor.accept() == R"("EventStream")");
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 4; i++) {
+    compositor.write("{\"Err\":\"busy\"}\n");
+    compositor.hangUp();
+    REQUIRE(compositor.accept() == R"("EventStream")");
+  }
+  // Retried after 100, 200, 400 and 800ms instead of every 100ms
+  REQUIRE(std::chrono::steady_clock::now() - start >= 1200ms);
+  compositor.write("{\"Ok\":\"Handled\"}\n");
+}
+
+TEST_CASE("JsonLinesIpc sends requests on a connection of their own", "[json_lines_ipc][util]") {
+  FakeCompositor compositor;
+  std::string request;
+  std::thread server([&] {
+    request = compositor.accept();
+    compositor.write("{\"Ok\":\"Handled\"}\n");
+  });
+  Json::Value action;
+  action["Action"]["FocusWorkspace"]["reference"]["Id"] = 3;
+  auto reply = JsonLinesIpc::send(PROTOCOL, action);
+  server.join();
+  REQUIRE(request == R"({"Action":{"FocusWorkspace":{"reference":{"Id":3}}}})");
+  REQUIRE(reply["Ok"] == "Handled");
+}
+
+TEST_CASE("JsonLinesIpc queues requests off the calling thread", "[json_lines_ipc][util]") {
+  FakeCompositor compositor;
+  JsonLinesIpc ipc(PROTOCOL, reduce);
+  REQUIRE(compositor.accept() == R"("EventStream")");
+
+  Json::Value action;
+  action["Action"]["FocusWorkspace"]["reference"]["Id"] = 3;
+  ipc.queue(action, "workspace");
+  REQUIRE(compositor.accept() == R"({"Action":{"FocusWorkspace":{"reference":{"Id":3}}}})");
+  compositor.write("{\"Err\":\"no such workspace\"}\n");
+}
+
+TEST_CASE("JsonLinesIpc without a compositor", "[json_lines_ipc][util]") {
+  unsetenv("WAYBAR_TEST_SOCKET");
+  REQUIRE_THROWS(JsonLinesIpc::send(PROTOCOL, "EventStream"));
+  // Only warns
+  JsonLinesIpc ipc(PROTOCOL, reduce);
+  std::this_thread::sleep_for(20ms);
+}
@@ -0,0 +1,124 @@
+#include "util/json_reader.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+using waybar::util::JsonReader;
+using waybar::util::JsonSchema;
+
+namespace {
+
+struct Window {
+  std::string address;
+  int workspaceId = -1;
+  std::string workspaceName;
+  std::string title;
+  bool focused = false;
+  bool urgent = false;
+  bool grouped = false;
+};
+
+const JsonSchema<Window> WINDOW_SCHEMA = {
+    {"address", &Window::address},
+    {"workspace.id", &Window::workspaceId},
+    {"workspace.name", &Window::workspaceName},
+    {"title", &Window::title},
+    {"focused", &Window::focused},
+    {"urgent", &Window::urgent},
+    {"grouped", [](Window& w, JsonReader& json) { w.grouped = json.readArraySize() > 0; }},
+};
+
+}  // namespace
+
+TEST_CASE("JsonReader walks a document in place", "[json_reader][util]") {
+  JsonReader json(R"( {"a": [1, 2.5, -3e2], "b": {"c": null, "d": true}, "e": "f"} )");
+  std::string_view key;
+  REQUIRE(json.beginObject());
+
+  REQUIRE(json.nextMember(key));
+  REQUIRE(key == "a");
+  REQUIRE(json.beginArray());
+  REQUIRE(json.nextElement());
+  REQUIRE(json.readInt() == 1);
+  REQUIRE(json.nextElement());
+  REQUIRE(json.readDouble() == 2.5);
+  REQUIRE(json.nextElement());
+  REQUIRE(json.readInt() == -300);
+  REQUIRE_FALSE(json.nextElement());
+
+  REQUIRE(json.nextMember(key));
+  REQUIRE(key == "b");
+  json.skip();
+
+  REQUIRE(json.nextMember(key));
+  REQUIRE(key == "e");
+  REQUIRE(json.readString() == "f");
+  REQUIRE_FALSE(json.nextMember(key));
+  REQUIRE(json.peek() == JsonReader::Type::End);
+}
+
+TEST_CASE("JsonReader decodes escapes", "[json_reader][util]") {
+  JsonReader json(R"(["a\"b\\c\/\n", "é😀", "\xab", "}{]["])");
+  REQUIRE(json.beginArray());
+  REQUIRE(json.nextElement());
+  REQUIRE(json.readString() == "a\"b\\c/\n");
+  REQUIRE(json.nextElement());
+  REQUIRE(json.readString() == "é\U0001F600");
+  REQUIRE(json.nextElement());
+  REQUIRE(json.readString() == "«");
+  REQUIRE(json.nextElement());
+  REQUIRE(json.readString() == "}{][");
+  REQUIRE_FALSE(json.nextElement());
+}
+
+TEST_CASE("JsonReader converts like Json::Value", "[json_reader][util]") {
+  JsonReader json(R"([2, true, null, "x", 0])");
+  REQUIRE(json.beginArray());
+  REQUIRE(json.nextElement());
+  REQUIRE(json.readBool());
+  REQUIRE(json.nextElement());
+  REQUIRE(json.readInt() == 1);
+  REQUIRE(json.nextElement());
+  REQUIRE(json.readString().empty());
+  REQUIRE(json.nextElement());
+  REQUIRE(json.readInt() == 0);
+  REQUIRE(json.nextElement());
+  REQUIRE_FALSE(json.readBool());
+  REQUIRE_FALSE(json.nextElement());
+}
+
+TEST_CASE("JsonReader rejects malformed documents", "[json_reader][util]") {
+  REQUIRE_THROWS(JsonReader(R"({"a": "b)").readString());
+  REQUIRE_THROWS(JsonReader(R"([1, {"a": [})").skip());
+  REQUIRE_THROWS(JsonReader("?").peek());
+  REQUIRE_THROWS(WINDOW_SCHEMA.readArray(R"([{"address" 1}])"));
+}
+
+TEST_CASE("JsonSchema reads the declared fields only", "[json_reader][util]") {
+  auto windows = WINDOW_SCHEMA.readArray(R"([
+    {"address": "0x1", "at": [0, 0], "workspace": {"id": 3, "name": "web"},
+     "title": "a \"quoted\" title", "focused": true, "grouped": ["0x1", "0x2"],
+     "extra": {"nested": [{"title": "not this one"}]}},
+    {"title": "second", "urgent": true, "workspace": null, "grouped": []}
+  ])");
+
+  REQUIRE(windows.size() == 2);
+  REQUIRE(windows[0].address == "0x1");
+  REQUIRE(windows[0].workspaceId == 3);
+  REQUIRE(windows[0].workspaceName == "web");
+  REQUIRE(windows[0].title == "a \"quoted\" title");
+  REQUIRE(windows[0].focused);
+  REQUIRE_FALSE(windows[0].urgent);
+  REQUIRE(windows[0].grouped);
+
+  REQUIRE(windows[1].title == "second");
+  REQUIRE(windows[1].workspaceId == -1);
+  REQUIRE(windows[1].urgent);
+  REQUIRE_FALSE(windows[1].grouped);
+
+  REQUIRE(WINDOW_SCHEMA.readArray("").empty());
+  REQUIRE(WINDOW_SCHEMA.read(R"({"title": "single"})").title == "single");
+}
@@ -0,0 +1,72 @@
+#include "util/line_buffer.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <string>
+
+using waybar::util::LineBuffer;
+
+namespace {
+
+void feed(LineBuffer& buffer, std::string_view data) {
+  auto space = buffer.prepare(data.size());
+  data.copy(space.data(), data.size());
+  buffer.commit(data.size());
+}
+
+}  // namespace
+
+TEST_CASE("LineBuffer splits complete lines", "[line_buffer][util]") {
+  LineBuffer buffer;
+  std::vector<std::string_view> lines;
+
+  feed(buffer, "workspace>>1\nactivewindow>>kitty,shell\n\nfocusedmon>>DP-1,1\n");
+  buffer.lines(lines);
+  REQUIRE(lines.size() == 4);
+  REQUIRE(lines[0] == "workspace>>1");
+  REQUIRE(lines[1] == "activewindow>>kitty,shell");
+  REQUIRE(lines[2].empty());
+  REQUIRE(lines[3] == "focusedmon>>DP-1,1");
+  REQUIRE(buffer.pending() == 0);
+}
+
+TEST_CASE("LineBuffer keeps partial lines across reads", "[line_buffer][util]") {
+  LineBuffer buffer(16);
+  std::vector<std::string_view> lines;
+
+  feed(buffer, "workspace>>1\nactive");
+  buffer.lines(lines);
+  REQUIRE(lines.size() == 1);
+  REQUIRE(lines[0] == "workspace>>1");
+  REQUIRE(buffer.pending() == 6);
+
+  lines.clear();
+  feed(buffer, "window>>kitty");
+  buffer.lines(lines);
+  REQUIRE(lines.empty());
+
+  feed(buffer, ",shell\n");
+  buffer.lines(lines);
+  REQUIRE(lines.size() == 1);
+  REQUIRE(lines[0] == "activewindow>>kitty,shell");
+  REQUIRE(buffer.pending() == 0);
+}
+
+TEST_CASE("LineBuffer grows for long lines", "[line_buffer][util]") {
+  LineBuffer buffer(8);
+  std::vector<std::string_view> lines;
+  const std::string title(10000, 'x');
+
+  for (size_t i = 0; i < title.size(); i += 100) {
+    feed(buffer, std::string_view(title).substr(i, 100));
+    buffer.lines(lines);
+  }
+  feed(buffer, "\nnext");
+  buffer.lines(lines);
+  REQUIRE(lines.size() == 1);
+  REQUIRE(lines[0] == title);
+  REQUIRE(buffer.pending() == 4);
+}
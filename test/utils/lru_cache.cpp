@@ -0,0 +1,80 @@
+#include "util/lru_cache.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <string>
+
+using waybar::util::LruCache;
+
+namespace {
+
+int* find(LruCache<int>& cache, std::string_view key) {
+  return cache.find(key, LruCache<int>::hash(key));
+}
+
+void insert(LruCache<int>& cache, std::string_view key, int value) {
+  cache.insert(key, LruCache<int>::hash(key), value);
+}
+
+}  // namespace
+
+TEST_CASE("LruCache finds inserted values", "[lru_cache]") {
+  LruCache<int> cache(4);
+  REQUIRE(find(cache, "a") == nullptr);
+  insert(cache, "a", 1);
+  insert(cache, "b", 2);
+
+  REQUIRE(*find(cache, "a") == 1);
+  REQUIRE(*find(cache, std::string("b")) == 2);
+  REQUIRE(find(cache, "c") == nullptr);
+  REQUIRE(cache.size() == 2);
+  REQUIRE(cache.hits() == 2);
+  REQUIRE(cache.misses() == 2);
+}
+
+TEST_CASE("LruCache evicts the least recently used entry", "[lru_cache]") {
+  LruCache<int> cache(3);
+  insert(cache, "a", 1);
+  insert(cache, "b", 2);
+  insert(cache, "c", 3);
+
+  // "a" is now more recent than "b"
+  REQUIRE(find(cache, "a"));
+  insert(cache, "d", 4);
+  REQUIRE(cache.size() == 3);
+  REQUIRE(find(cache, "b") == nullptr);
+  REQUIRE(*find(cache, "a") == 1);
+  REQUIRE(*find(cache, "c") == 3);
+  REQUIRE(*find(cache, "d") == 4);
+
+  // Keys longer than the small string buffer reuse evicted entries too
+  for (int i = 0; i < 100; i++) {
+    insert(cache, "a long window title, number " + std::to_string(i), i);
+  }
+  REQUIRE(cache.size() == 3);
+  REQUIRE(find(cache, "a") == nullptr);
+  REQUIRE(*find(cache, "a long window title, number 99") == 99);
+  REQUIRE(*find(cache, "a long window title, number 97") == 97);
+  REQUIRE(find(cache, "a long window title, number 96") == nullptr);
+
+  cache.clear();
+  REQUIRE(cache.size() == 0);
+  REQUIRE(find(cache, "a long window title, number 99") == nullptr);
+  insert(cache, "e", 5);
+  REQUIRE(*find(cache, "e") == 5);
+}
+
+TEST_CASE("LruCache survives being moved", "[lru_cache]") {
+  LruCache<int> cache(2);
+  insert(cache, "a", 1);
+  insert(cache, "b", 2);
+
+  LruCache<int> moved(std::move(cache));
+  REQUIRE(*find(moved, "a") == 1);
+  insert(moved, "c", 3);
+  REQUIRE(find(moved, "b") == nullptr);
+  REQUIRE(*find(moved, "c") == 3);
+}
@@ -0,0 +1,81 @@
+#include "util/reactor.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+using waybar::util::Reactor;
+
+TEST_CASE("Reactor dispatches fd readiness to callbacks", "[reactor][thread][util]") {
+  int fds[2];
+  REQUIRE(pipe(fds) == 0);
+
+  std::atomic<int> received = 0;
+  const auto main_tid = std::this_thread::get_id();
+  std::atomic<bool> other_thread = false;
+
+  auto watch = Reactor::instance().watch(
+      fds[0], EPOLLIN,
+      [&](uint32_t events) {
+        other_thread = std::this_thread::get_id() != main_tid;
+        char buf[16];
+        auto n = read(fds[0], buf, sizeof(buf));
+        if (n > 0) {
+          received += n;
+        }
+        return true;
+      },
+      "test");
+  REQUIRE(watch.active());
+
+  REQUIRE(write(fds[1], "abc", 3) == 3);
+  for (int i = 0; i < 100 && received < 3; i++) {
+    std::this_thread::sleep_for(5ms);
+  }
+  REQUIRE(received == 3);
+  REQUIRE(other_thread);
+
+  // no callbacks once the watch is reset
+  watch.reset();
+  REQUIRE(!watch.active());
+  REQUIRE(write(fds[1], "de", 2) == 2);
+  std::this_thread::sleep_for(50ms);
+  REQUIRE(received == 3);
+
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST_CASE("Reactor callback can stop watching its fd", "[reactor][thread][util]") {
+  int fds[2];
+  REQUIRE(pipe(fds) == 0);
+
+  std::atomic<int> calls = 0;
+  auto watch = Reactor::instance().watch(fds[0], EPOLLIN, [&](uint32_t) {
+    calls++;
+    return false;
+  });
+
+  REQUIRE(write(fds[1], "a", 1) == 1);
+  std::this_thread::sleep_for(50ms);
+  REQUIRE(write(fds[1], "b", 1) == 1);
+  std::this_thread::sleep_for(50ms);
+  REQUIRE(calls == 1);
+
+  watch.reset();
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST_CASE("Reactor rejects invalid fds", "[reactor][util]") {
+  REQUIRE_THROWS_AS(Reactor::instance().watch(-1, EPOLLIN, [](uint32_t) { return true; }),
+                    std::runtime_error);
+}
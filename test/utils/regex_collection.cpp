@@ -0,0 +1,55 @@
+#include "util/regex_collection.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <string>
+
+using waybar::util::RegexCollection;
+
+namespace {
+
+Json::Value rules() {
+  Json::Value map(Json::objectValue);
+  map["class<firefox>"] = "web";
+  map["class<kitty> title<.*vim.*>"] = "edit";
+  map["class<(\\w+)>"] = "app $1";
+  return map;
+}
+
+// More specific rules first, like the Hyprland workspaces module does
+int priority(std::string& rule) { return static_cast<int>(rule.size()); }
+
+}  // namespace
+
+TEST_CASE("RegexCollection applies the rule with the highest priority", "[regex_collection]") {
+  RegexCollection collection(rules(), "default", priority);
+  bool matched = false;
+
+  REQUIRE(collection.get("class<kitty> title<nvim>", matched) == "edit");
+  REQUIRE(matched);
+  REQUIRE(collection.get("class<kitty> title<zsh>") == "app kitty");
+  REQUIRE(collection.get("class<Firefox> title<news>") == "web");
+
+  REQUIRE(collection.get("title<orphan>", matched) == "default");
+  REQUIRE_FALSE(matched);
+}
+
+TEST_CASE("RegexCollection caches a bounded number of results", "[regex_collection]") {
+  RegexCollection collection(rules(), "default", priority, 2);
+  bool matched = false;
+
+  collection.get("class<firefox>");
+  REQUIRE(collection.get("class<firefox>", matched) == "web");
+  // Hits report whether a rule matched too
+  REQUIRE(matched);
+  REQUIRE(collection.cache_hits() == 1);
+  REQUIRE(collection.cache_misses() == 1);
+
+  collection.get("class<a>");
+  collection.get("class<b>");
+  REQUIRE(collection.get("class<firefox>") == "web");
+  REQUIRE(collection.cache_misses() == 4);
+}
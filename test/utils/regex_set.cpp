@@ -0,0 +1,209 @@
+#include "util/regex_set.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "../benchmark.hpp"
+
+using waybar::util::RegexSet;
+
+namespace {
+
+constexpr auto ICASE = std::regex_constants::ECMAScript | std::regex_constants::icase;
+
+const std::vector<std::string> PATTERNS = {
+    "class<firefox>",
+    "title<.*youtube.*>",
+    "class<kitty> title<.*vim.*>",
+    "^class<(.*)> title<(.*)>$",
+    "class<([^>]+)>",
+    R"((\w+)\s+(\d+))",
+    "a|ab|abc",
+    "(a|ab)(c|bcd)(d*)",
+    "x*",
+    "colou?r",
+    "[a-c]+z",
+    R"(\bvim\b)",
+    R"(\Bim)",
+    "a{2,3}",
+    "a{2,}?",
+    "(?:ab)+",
+    "(a)|(b)",
+    R"(.*?(\d+))",
+    "$",
+    "^$",
+    "(.*)-(.*)",
+    R"([\w.-]+@)",
+    R"(\x41\.)",
+    R"([^\s<>]+)",
+    // Left to std::regex
+    R"((o)\1)",
+    "foo(?=bar)",
+    "[[:digit:]]+",
+    // Loops that can match the empty string, left to std::regex too
+    "(.*?)*",
+    "(a?)?c",
+    "(a*)+b",
+};
+
+const std::vector<std::string> INPUTS = {
+    "class<firefox> title<YouTube - Mozilla Firefox>",
+    "class<kitty> title<nvim ~/src>",
+    "class<Kitty> title<vim>",
+    "",
+    "aaab",
+    "abcd",
+    "colour or color",
+    "user@host.org foo-bar",
+    "abc 123 def",
+    "A.",
+    "foobar",
+    "12-34",
+    "xylophone",
+    "c",
+};
+
+}  // namespace
+
+TEST_CASE("RegexSet matches like std::regex", "[regex_set]") {
+  for (const auto& pattern : PATTERNS) {
+    const std::regex regex(pattern, ICASE);
+    RegexSet set(ICASE);
+    set.add(pattern);
+
+    for (const auto& input : INPUTS) {
+      CAPTURE(pattern, input);
+      std::smatch expected;
+      auto found = std::regex_search(input, expected, regex);
+      auto match = set.search(input);
+      REQUIRE(match.has_value() == found);
+      if (!found) {
+        continue;
+      }
+      REQUIRE(match->size() == expected.size());
+      for (size_t i = 0; i < expected.size(); i++) {
+        CAPTURE(i);
+        REQUIRE(match->matched(i) == expected[i].matched);
+        REQUIRE((*match)[i] == expected[i].str());
+      }
+      const std::string fmt = "[$&|$1|$2|$`|$'|$$|$9|$]";
+      REQUIRE(match->format(fmt) == expected.format(fmt));
+    }
+  }
+}
+
+TEST_CASE("RegexSet reports the first pattern that matches", "[regex_set]") {
+  RegexSet set(ICASE);
+  REQUIRE(set.add("title<.*vim.*>") == 0);
+  REQUIRE(set.add(R"(class<(\w+)>)") == 1);
+  REQUIRE(set.add("class") == 2);
+  REQUIRE(set.add(R"((i)\1)") == 3);
+  REQUIRE(set.add("x") == 4);
+
+  SECTION("the earlier pattern wins, even when it matches further in the input") {
+    auto match = set.search("class<kitty> title<nvim>");
+    REQUIRE(match);
+    REQUIRE(match->pattern() == 0);
+    REQUIRE(match->format("$&") == "title<nvim>");
+  }
+
+  SECTION("later patterns match when earlier ones don't") {
+    auto match = set.search("class<kitty> title<zsh>");
+    REQUIRE(match);
+    REQUIRE(match->pattern() == 1);
+    REQUIRE(match->format("icon $1") == "icon kitty");
+  }
+
+  SECTION("std::regex patterns keep their place") {
+    auto match = set.search("skiing xylophone");
+    REQUIRE(match);
+    REQUIRE(match->pattern() == 3);
+    REQUIRE(match->prefix() == "sk");
+  }
+
+  SECTION("no match") { REQUIRE_FALSE(set.search("zzz")); }
+}
+
+TEST_CASE("RegexSet searches all patterns in one pass", "[regex_set]") {
+  RegexSet set(ICASE);
+  std::vector<std::regex> regexes;
+  // Most specific rules last, so that every pattern gets to win on some input
+  for (auto it = PATTERNS.rbegin(); it != PATTERNS.rend(); ++it) {
+    set.add(*it);
+    regexes.emplace_back(*it, ICASE);
+  }
+
+  for (const auto& input : INPUTS) {
+    CAPTURE(input);
+    auto match = set.search(input);
+    auto expected = std::find_if(regexes.begin(), regexes.end(), [&](const auto& regex) {
+      return std::regex_search(input, regex);
+    });
+    REQUIRE(match.has_value() == (expected != regexes.end()));
+    if (match) {
+      REQUIRE(match->pattern() == static_cast<size_t>(expected - regexes.begin()));
+    }
+  }
+}
+
+TEST_CASE("RegexSet finds every matching pattern", "[regex_set]") {
+  RegexSet set(ICASE);
+  std::vector<std::regex> regexes;
+  for (const auto& pattern : PATTERNS) {
+    set.add(pattern);
+    regexes.emplace_back(pattern, ICASE);
+  }
+
+  for (const auto& input : INPUTS) {
+    CAPTURE(input);
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < regexes.size(); i++) {
+      if (std::regex_search(input, regexes[i])) {
+        expected.push_back(i);
+      }
+    }
+    REQUIRE(set.matchAll(input) == expected);
+  }
+}
+
+TEST_CASE("RegexSet rejects invalid patterns", "[regex_set]") {
+  RegexSet set;
+  REQUIRE_THROWS_AS(set.add("(unclosed"), std::regex_error);
+  REQUIRE_THROWS_AS(set.add("[z-a]"), std::regex_error);
+  REQUIRE(set.empty());
+  REQUIRE(set.add("valid") == 0);
+  REQUIRE(set.search("still valid"));
+}
+
+TEST_CASE("RegexSet benchmark", "[.][benchmark][regex_set]") {
+  constexpr int ITERATIONS = 200;
+  std::vector<std::regex> regexes;
+  RegexSet set(ICASE);
+  for (int i = 0; i < 100; i++) {
+    auto pattern = i % 2 == 0 ? fmt::format("class<app{}>", i)
+                              : fmt::format("class<.*> title<.* - document {}>", i);
+    regexes.emplace_back(pattern, ICASE);
+    set.add(pattern);
+  }
+  const std::string input = "class<org.mozilla.firefox> title<Mozilla Firefox - Document 99>";
+
+  Benchmark benchmark("100 rules", ITERATIONS);
+  benchmark.run("with std::regex", [&](size_t) {
+    for (size_t i = 0; i < regexes.size(); i++) {
+      if (std::regex_search(input, regexes[i])) {
+        return i;
+      }
+    }
+    return regexes.size();
+  });
+  benchmark.run("with RegexSet", [&](size_t) { return set.search(input)->pattern(); });
+  benchmark.report();
+  REQUIRE(benchmark.sink() == 2 * ITERATIONS * 99);
+}
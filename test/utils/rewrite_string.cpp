@@ -0,0 +1,124 @@
+#include "util/rewrite_string.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+
+#include <string>
+#include <vector>
+
+#include "../benchmark.hpp"
+
+using waybar::util::RewriteRuleSet;
+
+namespace {
+
+// Rules in the spirit of the examples of the window modules' man pages
+Json::Value rules() {
+  Json::Value rules(Json::objectValue);
+  rules["(.*) — Mozilla Firefox"] = "🌎 $1";
+  rules["(.*) - Mozilla Firefox"] = "🌎 $1";
+  rules["(.*) - Chromium"] = " $1";
+  rules["(.*) - Visual Studio Code"] = "󰨞 $1";
+  rules["(.*) - zsh"] = "> [$1]";
+  rules["(.*) - fish"] = "> [$1]";
+  rules["nvim (.*)"] = " $1";
+  rules["vim (.*)"] = " $1";
+  rules["(.*)YouTube(.*)"] = "$1󰗃$2";
+  rules["Spotify( Premium)?"] = "";
+  rules["(.*) \\| Discord"] = "󰙯 $1";
+  rules["Telegram( \\(\\d+\\))?"] = "";
+  rules["(.*)Slack(.*)"] = "$1󰒱$2";
+  rules["Steam"] = "";
+  rules["(\\d+) unread - (.*)"] = "✉ $1 $2";
+  rules["htop"] = "";
+  rules["(.*)~/(.*)"] = "$1~/$2";
+  rules["[[:alpha:]]+ - Thunderbird"] = "";
+  rules["(.*) - (KeePassXC)"] = "🔑 $1";
+  rules["(.*)\\.pdf(.*)"] = " $1.pdf";
+  return rules;
+}
+
+const std::vector<std::string> TITLES = {
+    "GitHub - Alexays/Waybar: Highly customizable Wayland bar — Mozilla Firefox",
+    "Waybar - YouTube - Mozilla Firefox",
+    "Mozilla Firefox",
+    "Inbox (3) - Gmail - Chromium",
+    "rewrite_string.cpp - waybar - Visual Studio Code",
+    "~/src/waybar - zsh",
+    "htop",
+    "nvim ~/src/waybar/src/util/rewrite_string.cpp",
+    "vim .config/waybar/config.jsonc",
+    "Spotify Premium",
+    "Spotify",
+    "#general | Discord",
+    "Telegram (12)",
+    "Slack | general | Team",
+    "Steam",
+    "12 unread - Thunderbird",
+    "Inbox - Thunderbird",
+    "passwords.kdbx - KeePassXC",
+    "paper.pdf — Document Viewer",
+    "kitty",
+    "",
+};
+
+}  // namespace
+
+TEST_CASE("RewriteRuleSet rewrites like rewriteString", "[rewrite_string]") {
+  const auto config = rules();
+  RewriteRuleSet ruleSet(config);
+  REQUIRE_FALSE(ruleSet.empty());
+
+  // Twice, the second time from the cache
+  for (int i = 0; i < 2; i++) {
+    for (const auto& title : TITLES) {
+      CAPTURE(title);
+      REQUIRE(ruleSet.rewrite(title) == waybar::util::rewriteString(title, config));
+    }
+  }
+  REQUIRE(ruleSet.rewrite("nvim notes.md") == " notes.md");
+  // Every matching rule applies, on the result of the previous ones
+  REQUIRE(ruleSet.rewrite("Waybar - YouTube - Mozilla Firefox") == "🌎 Waybar - 󰗃");
+}
+
+TEST_CASE("RewriteRuleSet without rules keeps values", "[rewrite_string]") {
+  RewriteRuleSet ruleSet(Json::Value(Json::nullValue));
+  REQUIRE(ruleSet.empty());
+  REQUIRE(ruleSet.rewrite("title") == "title");
+}
+
+TEST_CASE("RewriteRuleSet skips invalid rules", "[rewrite_string]") {
+  Json::Value config(Json::objectValue);
+  config["(unclosed"] = "?";
+  config["(.*) - zsh"] = "> $1";
+  RewriteRuleSet ruleSet(config);
+  REQUIRE(ruleSet.rewrite("~ - zsh") == "> ~");
+  REQUIRE(ruleSet.rewrite("(unclosed") == "(unclosed");
+}
+
+TEST_CASE("RewriteRuleSet benchmark", "[.][benchmark][rewrite_string]") {
+  constexpr int ITERATIONS = 20;
+  const auto config = rules();
+  std::vector<std::string> corpus;
+  for (int i = 0; i < 10; i++) {
+    for (const auto& title : TITLES) {
+      corpus.push_back(title + (i == 0 ? "" : " " + std::to_string(i)));
+    }
+  }
+  RewriteRuleSet ruleSet(config, corpus.size());
+  // Going through the corpus in order, every title was evicted before it comes again
+  RewriteRuleSet uncached(config, 1);
+
+  Benchmark benchmark(fmt::format("{} rules, per title", config.size()),
+                      ITERATIONS * corpus.size());
+  auto title = [&](size_t i) -> const std::string& { return corpus[i % corpus.size()]; };
+  benchmark.run("with rewriteString",
+                [&](size_t i) { return waybar::util::rewriteString(title(i), config).size(); });
+  benchmark.run("with RewriteRuleSet", [&](size_t i) { return uncached.rewrite(title(i)).size(); });
+  benchmark.run("when cached", [&](size_t i) { return ruleSet.rewrite(title(i)).size(); });
+  benchmark.report();
+  REQUIRE(benchmark.sink() > 0);
+}
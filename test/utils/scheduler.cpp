@@ -0,0 +1,172 @@
+#include "util/scheduler.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+using waybar::util::PeriodicJob;
+
+TEST_CASE("PeriodicJob runs on the shared scheduler", "[scheduler][thread][util]") {
+  std::atomic<int> count = 0;
+  const auto main_tid = std::this_thread::get_id();
+  std::atomic<bool> other_thread = false;
+
+  PeriodicJob job;
+  job = [&] {
+    other_thread = std::this_thread::get_id() != main_tid;
+    count++;
+    job.sleep_for(20ms);
+  };
+
+  std::this_thread::sleep_for(200ms);
+  job.stop();
+
+  REQUIRE(other_thread);
+  // the first run is immediate, then one run per 20ms tick
+  REQUIRE(count >= 3);
+  REQUIRE(count <= 11);
+
+  // no runs after stop()
+  const int stopped_count = count;
+  std::this_thread::sleep_for(50ms);
+  REQUIRE(count == stopped_count);
+}
+
+TEST_CASE("PeriodicJob sleep() parks until wake_up()", "[scheduler][thread][util]") {
+  std::atomic<int> count = 0;
+
+  PeriodicJob job;
+  job = [&] {
+    count++;
+    job.sleep();
+  };
+
+  std::this_thread::sleep_for(50ms);
+  REQUIRE(count == 1);
+
+  job.wake_up();
+  std::this_thread::sleep_for(50ms);
+  REQUIRE(count == 2);
+}
+
+TEST_CASE("PeriodicJob wake_up() preempts a long delay", "[scheduler][thread][util]") {
+  std::atomic<int> count = 0;
+
+  PeriodicJob job;
+  job = [&] {
+    count++;
+    job.sleep_for(std::chrono::hours(1));
+  };
+
+  std::this_thread::sleep_for(50ms);
+  REQUIRE(count == 1);
+
+  job.wake_up();
+  std::this_thread::sleep_for(50ms);
+  REQUIRE(count == 2);
+}
+
+TEST_CASE("PeriodicJob stop() waits for the running job", "[scheduler][thread][util]") {
+  std::atomic<bool> started = false;
+  std::atomic<bool> finished = false;
+
+  PeriodicJob job;
+  job = [&] {
+    started = true;
+    std::this_thread::sleep_for(50ms);
+    finished = true;
+    job.sleep();
+  };
+
+  while (!started) {
+    std::this_thread::yield();
+  }
+  job.stop();
+  REQUIRE(finished);
+}
+
+TEST_CASE("PeriodicJob keeps its interval", "[scheduler][thread][util]") {
+  std::atomic<int> count = 0;
+  const auto start = std::chrono::steady_clock::now();
+  std::atomic<std::chrono::steady_clock::duration> last{};
+
+  PeriodicJob job;
+  job = [&] {
+    // The time a run takes must not add up over the periods
+    std::this_thread::sleep_for(20ms);
+    last = std::chrono::steady_clock::now() - start;
+    count++;
+    job.sleep_for(400ms);
+  };
+
+  while (count < 4) {
+    std::this_thread::sleep_for(10ms);
+  }
+  job.stop();
+  // 3 periods after the first run, instead of 3 * 500ms when deadlines were rounded up
+  REQUIRE(last.load() < 1400ms);
+}
+
+TEST_CASE("PeriodicJob is retried with a backoff when it throws", "[scheduler][thread][util]") {
+  std::atomic<int> count = 0;
+
+  PeriodicJob job;
+  job = [&] {
+    if (count++ == 0) {
+      job.sleep_for(20ms);
+      return;
+    }
+    throw std::runtime_error("Can't open /proc/stat");
+  };
+
+  // Runs at 0, 20ms, then retried 20ms, 40ms and 80ms after each failure
+  std::this_thread::sleep_for(250ms);
+  job.stop();
+  REQUIRE(count >= 4);
+  REQUIRE(count <= 6);
+}
+
+TEST_CASE("Blocking jobs don't stall the other jobs", "[scheduler][thread][util]") {
+  auto& scheduler = waybar::util::Scheduler::instance();
+  std::atomic<bool> release = false;
+  std::atomic<int> blocked = 0;
+  std::vector<waybar::util::Scheduler::JobPtr> scripts;
+  // More hung scripts than the worker cap
+  for (int i = 0; i < 20; i++) {
+    scripts.push_back(scheduler.add(
+        [&] {
+          blocked++;
+          while (!release) {
+            std::this_thread::sleep_for(5ms);
+          }
+        },
+        true));
+    scheduler.wake(scripts.back());
+  }
+  while (blocked < 20) {
+    std::this_thread::sleep_for(5ms);
+  }
+
+  std::atomic<int> count = 0;
+  PeriodicJob job;
+  job = [&] {
+    count++;
+    job.sleep_for(10ms);
+  };
+  std::this_thread::sleep_for(100ms);
+  job.stop();
+  REQUIRE(count >= 3);
+
+  release = true;
+  for (const auto& script : scripts) {
+    scheduler.cancel(script);
+  }
+}
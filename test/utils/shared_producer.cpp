@@ -0,0 +1,101 @@
+#include "util/shared_producer.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace std::chrono_literals;
+using Producer = waybar::util::SharedProducer<int>;
+
+namespace {
+
+std::function<Producer::Sampler()> counter(std::atomic<int>& samples) {
+  return [&samples] {
+    return [&samples](const waybar::util::StopSource&) -> std::optional<int> {
+      return ++samples;
+    };
+  };
+}
+
+}  // namespace
+
+TEST_CASE("SharedProducer samples once for all subscribers", "[shared_producer][util]") {
+  std::atomic<int> samples = 0;
+  std::atomic<int> notified_a = 0;
+  std::atomic<int> notified_b = 0;
+
+  auto a = Producer::subscribe("test:shared", 20ms, counter(samples), [&] { notified_a++; });
+  auto b = Producer::subscribe("test:shared", 20ms, counter(samples), [&] { notified_b++; });
+  REQUIRE(Producer::count() == 1);
+
+  std::this_thread::sleep_for(200ms);
+  a.reset();
+  b.reset();
+  REQUIRE(Producer::count() == 0);
+
+  // both bars see every sample, but it's only taken once per tick
+  REQUIRE(samples >= 3);
+  REQUIRE(samples <= 11);
+  REQUIRE(notified_a >= samples - 1);
+  REQUIRE(notified_b >= samples - 1);
+}
+
+TEST_CASE("SharedProducer keys are independent", "[shared_producer][util]") {
+  std::atomic<int> samples = 0;
+  auto a = Producer::subscribe("test:a", 0ms, counter(samples), [] {});
+  auto b = Producer::subscribe("test:b", 0ms, counter(samples), [] {});
+  REQUIRE(Producer::count() == 2);
+
+  std::this_thread::sleep_for(50ms);
+  REQUIRE(samples == 2);
+  REQUIRE(*a->latest() != *b->latest());
+}
+
+TEST_CASE("SharedProducer notifies late subscribers right away", "[shared_producer][util]") {
+  std::atomic<int> samples = 0;
+  auto a = Producer::subscribe("test:late", 0ms, counter(samples), [] {});
+  std::this_thread::sleep_for(50ms);
+  REQUIRE(samples == 1);
+
+  std::atomic<int> notified = 0;
+  auto b = Producer::subscribe("test:late", 0ms, counter(samples), [&] { notified++; });
+  REQUIRE(notified == 1);
+  REQUIRE(*b->latest() == 1);
+
+  // a parked producer only samples again when woken up
+  b->wake_up();
+  std::this_thread::sleep_for(50ms);
+  REQUIRE(samples == 2);
+  REQUIRE(notified == 2);
+}
+
+TEST_CASE("SharedProducer samplers can wake up their producer", "[shared_producer][util]") {
+  // stands for the state of an event source (e.g. an fd watch) owned by the sampler
+  auto state = std::make_shared<int>(0);
+  std::weak_ptr<int> released = state;
+  Producer* producer = nullptr;
+
+  auto a = Producer::subscribe(
+      "test:events", 1s,
+      [&producer, state = std::move(state)](Producer& self) -> Producer::Sampler {
+        producer = &self;
+        return [state](const waybar::util::StopSource&) -> std::optional<int> { return ++*state; };
+      },
+      [] {});
+  std::this_thread::sleep_for(50ms);
+  REQUIRE(*a->latest() == 1);
+
+  producer->wake_up();
+  std::this_thread::sleep_for(50ms);
+  REQUIRE(*a->latest() == 2);
+
+  // the sampler doesn't outlive the last subscription
+  a.reset();
+  REQUIRE(released.expired());
+}
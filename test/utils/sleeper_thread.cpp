@@ -0,0 +1,80 @@
+#include "util/sleeper_thread.hpp"
+
+#if __has_include(<catch2/catch_test_macros.hpp>)
+#include <catch2/catch_test_macros.hpp>
+#else
+#include <catch2/catch.hpp>
+#endif
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "util/command.hpp"
+
+using namespace std::chrono_literals;
+using waybar::util::SleeperThread;
+using waybar::util::StopSource;
+
+TEST_CASE("SleeperThread stop() interrupts sleep", "[sleeper_thread][thread][util]") {
+  std::atomic<int> count = 0;
+  auto start = std::chrono::steady_clock::now();
+  {
+    SleeperThread thread;
+    thread = [&] {
+      count++;
+      thread.sleep_for(std::chrono::hours(1));
+    };
+    std::this_thread::sleep_for(50ms);
+  }
+  REQUIRE(count == 1);
+  REQUIRE(std::chrono::steady_clock::now() - start < 1s);
+}
+
+TEST_CASE("SleeperThread stop() interrupts a blocking read", "[sleeper_thread][thread][util]") {
+  int fds[2];
+  REQUIRE(pipe(fds) == 0);
+  std::atomic<bool> stopped = false;
+  {
+    SleeperThread thread;
+    thread = [&] {
+      if (!thread.stop_source().wait(fds[0])) {
+        stopped = true;
+      }
+    };
+    std::this_thread::sleep_for(50ms);
+  }
+  REQUIRE(stopped);
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST_CASE("command::exec terminates the command on stop", "[command][thread][util]") {
+  StopSource stop;
+  auto start = std::chrono::steady_clock::now();
+  std::thread stopper([&stop] {
+    std::this_thread::sleep_for(50ms);
+    stop.request_stop();
+  });
+  auto res = waybar::util::command::exec("echo started; sleep 10", "", &stop);
+  stopper.join();
+
+  REQUIRE(res.out == "started");
+  REQUIRE(std::chrono::steady_clock::now() - start < 5s);
+}
+
+TEST_CASE("command::readLine splits the output", "[command][util]") {
+  int pid;
+  auto* fp = waybar::util::command::open("printf 'a\\nbc\\nd'", pid, "");
+  REQUIRE(fp != nullptr);
+  std::string buffer;
+  std::string line;
+
+  REQUIRE(waybar::util::command::readLine(fp, buffer, line));
+  REQUIRE(line == "a");
+  REQUIRE(waybar::util::command::readLine(fp, buffer, line));
+  REQUIRE(line == "bc");
+  REQUIRE(waybar::util::command::readLine(fp, buffer, line));
+  REQUIRE(line == "d");
+  REQUIRE_FALSE(waybar::util::command::readLine(fp, buffer, line));
+  waybar::util::command::close(fp, pid);
+}